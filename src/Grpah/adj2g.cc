@@ -14,14 +14,12 @@
 */  
 
 #include <iostream>
-#include <sstream>
 #include <string>
-#include <algorithm>
-#include <iterator>
-#include <list>
+#include "mapped_file.hpp"
 #include "token.hpp"
 
 using namespace std;
+using namespace NGraph;
 
 
 
@@ -29,18 +27,23 @@ int main()
 {
 
 	
-  const string delimiters = ",: \t";       // white space
-  std::string input_line;
+  const char *delimiters = ",: \t";       // white space
 
-  // read past the first two lines
-  //
+  mapped_file in("-");
+  line_scanner lines(in.data(), in.size());
+  str_tokenizer T(str_ref(), delimiters);
+  str_ref input_line;
 
-  while (getline(std::cin, input_line))
+  while (lines.next(input_line))
   {
-	    Tokenizer T(input_line, delimiters);
-      string from_node = T.next();
-      string to_node = T.next();
-      if (to_node.empty())
+      T.reset(input_line);
+      str_ref from_node, to_node;
+      if (!T.next(from_node))
+      {
+         std::cout << "\n";
+         continue;
+      }
+      if (!T.next(to_node))
       {
          std::cout << from_node << "\n";
       }
@@ -48,13 +51,12 @@ int main()
       {
          std::cout << from_node << " " << to_node << "\n";
       }
-      std::string neighbor;
-	    while ( ! (neighbor=T.next()).empty())
-        {
+      str_ref neighbor;
+      while (T.next(neighbor))
+      {
           std::cout << from_node << " " << neighbor << "\n";
-        }
+      }
   };
 
   return 0;
 }
-
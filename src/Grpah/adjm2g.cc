@@ -28,9 +28,11 @@
 
 #include <iostream>
 #include <string>
+#include "mapped_file.hpp"
 #include "token.hpp"
 
 using namespace std;
+using namespace NGraph;
 
 
 
@@ -38,18 +40,19 @@ int main()
 {
 
 	
-  std::string word;
-  std::string input_line;
+  mapped_file in("-");
+  line_scanner lines(in.data(), in.size());
+  str_ref input_line;
 
-  while (getline(std::cin, input_line))
+  while (lines.next(input_line))
   {
-      if (input_line.length() < 1)
+      if (input_line.size < 1)
           continue;
 
-      string home_node = input_line;
-      while (getline(std::cin, input_line))
+      str_ref home_node = input_line;
+      while (lines.next(input_line))
       {
-          if (input_line.length() < 1)
+          if (input_line.size < 1)
              break;
 
           std::cout << home_node << " " << input_line << "\n";
@@ -59,4 +62,3 @@ int main()
 
   return 0;
 }
-
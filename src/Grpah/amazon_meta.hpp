@@ -0,0 +1,439 @@
+#ifndef NGRAPH_AMAZON_META_H_
+#define NGRAPH_AMAZON_META_H_
+
+/*
+   Parallel, columnar parsing of the Amazon product metadata of the SNAP
+   collection (amazon-meta.txt; see process_amazon.cc for the format).
+
+   The input (a mapped_file) is split into one chunk per thread at record
+   boundaries (lines starting with "Id:"), and each chunk is parsed with
+   str_refs into the input, into columns of its own:
+
+        id, salesrank           one entry per product
+        asin, title             string_columns (bytes back to back)
+        group, category         ids, interned (in parallel) by a
+                                sharded_string_interner
+        similar                 the ASINs, a string_column, with an
+                                offset per product
+
+   The chunks' columns are then appended in order, and the similar ASINs
+   are looked up among the products' ASINs, giving the co-purchase graph
+   as a flat array of (Id, Id) edges.  So one pass over the input yields
+   both the graph and the metadata tables, and the results do not depend
+   on the number of threads: interned ids are in order of first
+   occurrence in the file.
+
+   Blocks of lines without an "Id:" line (the header of the file) are
+   skipped; reviews are not kept.
+*/
+
+#include <cstring>
+#include <vector>
+#include <utility>
+#include <stdint.h>
+#include "str_ref.hpp"
+#include "token.hpp"
+#include "string_intern.hpp"
+#include "ngraph_stats.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+
+/**
+    A column of strings, stored back to back in one array (the i-th is
+    bytes [offset(i), offset(i+1))).  Unlike a string_arena, it can be
+    appended to another column wholesale, and truncated.
+*/
+class string_column
+{
+  private:
+    std::vector<char> bytes_;
+    std::vector<uint64_t> offsets_;
+
+  public:
+    string_column() : bytes_(), offsets_(1, 0) {}
+
+    size_t size() const { return offsets_.size() - 1; }
+    size_t bytes() const { return bytes_.size(); }
+
+    str_ref operator[](size_t i) const
+    {
+        return str_ref(bytes_.empty() ? 0 : &bytes_[0] + offsets_[i],
+              offsets_[i+1] - offsets_[i]);
+    }
+
+    void push_back(const str_ref &s)
+    {
+        bytes_.insert(bytes_.end(), s.begin(), s.end());
+        offsets_.push_back(bytes_.size());
+    }
+
+    /** keep the first n strings */
+    void truncate(size_t n)
+    {
+        offsets_.resize(n + 1);
+        bytes_.resize(offsets_[n]);
+    }
+
+    void append(const string_column &C)
+    {
+        const uint64_t base = bytes_.size();
+        bytes_.insert(bytes_.end(), C.bytes_.begin(), C.bytes_.end());
+        offsets_.reserve(offsets_.size() + C.size());
+        for (size_t i=1; i<C.offsets_.size(); i++)
+          offsets_.push_back(base + C.offsets_[i]);
+    }
+
+    void reserve(size_t n, size_t bytes)
+    {
+        offsets_.reserve(n + 1);
+        bytes_.reserve(bytes);
+    }
+
+    void clear()
+    {
+        bytes_.clear();
+        offsets_.assign(1, 0);
+    }
+};
+
+
+/**
+    The products, one entry per record in each of the per-product
+    columns, in the order of the file.
+*/
+struct amazon_products
+{
+    typedef uint32_t Uint;
+    typedef std::pair<Uint,Uint> edge;
+    static const Uint no_group = 0xFFFFFFFFu;
+
+    std::vector<Uint> id;
+    string_column asin;
+    string_column title;
+    std::vector<Uint> group;                // into groups, or no_group
+    std::vector<Uint> salesrank;
+
+    std::vector<uint64_t> similar_offset;   // size()+1 entries
+    string_column similar;                  // ASINs, as listed
+
+    std::vector<uint64_t> category_offset;  // size()+1 entries
+    std::vector<Uint> category;             // into categories
+
+    string_column groups;                   // names, by group id
+    string_column categories;               // paths, by category id
+    std::vector<Uint> category_count;       // products, by category id
+
+    std::vector<edge> edges;                // co-purchases, (Id, Id)
+    size_t unresolved;                      // similar ASINs not listed
+
+    amazon_products() : id(), asin(), title(), group(), salesrank(),
+        similar_offset(1, 0), similar(), category_offset(1, 0), category(),
+        groups(), categories(), category_count(), edges(), unresolved(0) {}
+
+    size_t size() const { return id.size(); }
+
+    str_ref similar_asin(size_t i, size_t k) const
+    {
+        return similar[similar_offset[i] + k];
+    }
+    size_t num_similar(size_t i) const
+    {
+        return similar_offset[i+1] - similar_offset[i];
+    }
+    size_t num_categories(size_t i) const
+    {
+        return category_offset[i+1] - category_offset[i];
+    }
+};
+
+
+/**
+    Split data[0..size) into num_chunks pieces at record boundaries:
+    each boundary is moved forward to the next line starting with "Id:".
+*/
+inline std::vector<const char *> amazon_record_chunks(const char *data,
+      size_t size, unsigned int num_chunks)
+{
+    const char *end = data + size;
+    std::vector<const char *> bounds(num_chunks + 1, end);
+    bounds[0] = data;
+    for (unsigned int t=1; t<num_chunks; t++)
+    {
+      const char *s = data + size * t / num_chunks;
+      if (s < bounds[t-1])
+        s = bounds[t-1];
+      while (s < end)
+      {
+        const char *nl = (const char *) memchr(s, '\n', end - s);
+        s = (nl == 0 ? end : nl + 1);
+        if (end - s >= 3 && memcmp(s, "Id:", 3) == 0)
+          break;
+      }
+      bounds[t] = s;
+    }
+    return bounds;
+}
+
+
+namespace amazon_detail
+{
+
+typedef sharded_string_interner::handle handle;
+
+// one chunk's products, with group and categories as interner handles
+//
+struct chunk
+{
+    amazon_products P;
+    std::vector<handle> group;
+    std::vector<handle> category;
+
+    chunk() : P(), group(), category() {}
+};
+
+inline uint32_t to_uint(const str_ref &s)
+{
+    uint32_t v = 0;
+    for (size_t i=0; i<s.size && s[i] >= '0' && s[i] <= '9'; i++)
+      v = 10 * v + (s[i] - '0');
+    return v;
+}
+
+// remove leading and trailing whitespace
+//
+inline str_ref trim(const str_ref &s)
+{
+    static const delimiter_set blanks(" \t\n\r");
+    const char *b = blanks.skip(s.begin(), s.end());
+    const char *e = s.end();
+    while (e > b && blanks.contains(e[-1]))
+      e--;
+    return str_ref(b, e - b);
+}
+
+/*
+    Parse the records of data[p, end) into C; file_start is the start of
+    the whole input (interned strings are positioned by byte offset).
+*/
+inline void parse_chunk(const char *file_start, const char *p,
+      const char *end, chunk &C, sharded_string_interner &groups,
+      sharded_string_interner &categories)
+{
+    static const str_ref Id_s = "Id:";
+    static const str_ref ASIN_s = "ASIN:";
+    static const str_ref title_s = "title:";
+    static const str_ref group_s = "group:";
+    static const str_ref salesrank_s = "salesrank:";
+    static const str_ref similar_s = "similar:";
+    static const str_ref categories_s = "categories:";
+
+    static const delimiter_set blanks(" \t\r");
+
+    amazon_products &P = C.P;
+    line_scanner f(p, end - p);
+    str_tokenizer s(str_ref(), blanks);
+    str_ref line;
+
+    for (;;)
+    {
+      // eat up blank lines, until first non-blank or the end
+      bool found = false;
+      while (f.next(line))
+        if (line.size > 1)
+        {
+          found = true;
+          break;
+        }
+      if (!found)
+        break;
+
+      bool has_id = false;
+      uint32_t id = 0, salesrank = 0;
+      str_ref asin, title;
+      bool has_group = false;
+      const size_t similar_start = P.similar.size();
+      const size_t category_start = C.category.size();
+
+      do
+      {
+        str_ref key;
+        if (line.size <= 1)
+          break;
+        s.reset(line);
+        if (!s.next(key))
+          continue;
+
+        if (key == Id_s)
+        {
+          str_ref v;
+          has_id = s.next(v);
+          id = to_uint(v);
+        }
+        else if (key == ASIN_s)
+          s.next(asin);
+        else if (key == title_s)
+          title = trim(s.rest());
+        else if (key == group_s && !has_group)
+        {
+          const str_ref g = trim(s.rest());
+          C.group.push_back(groups.intern(g, g.data - file_start));
+          has_group = true;
+        }
+        else if (key == salesrank_s)
+        {
+          str_ref v;
+          if (s.next(v))
+            salesrank = to_uint(v);
+        }
+        else if (key == similar_s)
+        {
+          str_ref v;
+          const uint32_t N = (s.next(v) ? to_uint(v) : 0);
+          str_ref item_code;
+          for (uint32_t i=0; i<N && s.next(item_code); i++)
+            P.similar.push_back(item_code);
+        }
+        else if (key == categories_s)
+        {
+          str_ref v;
+          const uint32_t N = (s.next(v) ? to_uint(v) : 0);
+          str_ref category_code;
+          for (uint32_t i=0; i<N && f.next(category_code); i++)
+          {
+            const str_ref c = trim(category_code);
+            C.category.push_back(categories.intern(c, c.data - file_start));
+          }
+        }
+      }
+      while (f.next(line));
+
+      if (!has_id)
+      {
+        P.similar.truncate(similar_start);
+        C.category.resize(category_start);
+        if (has_group)
+          C.group.pop_back();
+        continue;
+      }
+      if (!has_group)
+        C.group.push_back((handle) sharded_string_interner::no_handle);
+
+      P.id.push_back(id);
+      P.asin.push_back(asin);
+      P.title.push_back(title);
+      P.salesrank.push_back(salesrank);
+      P.similar_offset.push_back(P.similar.size());
+      P.category_offset.push_back(C.category.size());
+    }
+}
+
+}
+// namespace amazon_detail
+
+
+/**
+    Parse the Amazon metadata in data[0..size) into P (see above).
+*/
+inline void parse_amazon_meta(const char *data, size_t size,
+      amazon_products &P)
+{
+    using namespace amazon_detail;
+
+#ifdef _OPENMP
+    const unsigned int num_chunks = omp_get_max_threads();
+#else
+    const unsigned int num_chunks = 1;
+#endif
+    std::vector<const char *> bounds =
+          amazon_record_chunks(data, size, num_chunks);
+    std::vector<chunk> C(num_chunks);
+    sharded_string_interner groups, categories;
+
+    {
+      stats::scoped_phase phase("parse");
+#ifdef _OPENMP
+      #pragma omp parallel for schedule(static, 1)
+#endif
+      for (int c=0; c<(int) num_chunks; c++)
+        parse_chunk(data, bounds[c], bounds[c+1], C[c], groups, categories);
+      groups.finalize(intern_first_seen);
+      categories.finalize(intern_first_seen);
+    }
+
+    stats::scoped_phase phase("columns");
+    P = amazon_products();
+    for (unsigned int i=0; i<groups.size(); i++)
+      P.groups.push_back(groups.str(i));
+    for (unsigned int i=0; i<categories.size(); i++)
+      P.categories.push_back(categories.str(i));
+    P.category_count.assign(categories.size(), 0);
+
+    for (unsigned int c=0; c<num_chunks; c++)
+    {
+      const amazon_products &Q = C[c].P;
+      const uint64_t similar_base = P.similar.size();
+      const uint64_t category_base = P.category.size();
+
+      P.id.insert(P.id.end(), Q.id.begin(), Q.id.end());
+      P.asin.append(Q.asin);
+      P.title.append(Q.title);
+      P.salesrank.insert(P.salesrank.end(), Q.salesrank.begin(),
+            Q.salesrank.end());
+      P.similar.append(Q.similar);
+      for (size_t i=1; i<Q.similar_offset.size(); i++)
+        P.similar_offset.push_back(similar_base + Q.similar_offset[i]);
+      for (size_t i=1; i<Q.category_offset.size(); i++)
+        P.category_offset.push_back(category_base + Q.category_offset[i]);
+
+      for (size_t i=0; i<C[c].group.size(); i++)
+        P.group.push_back(
+              C[c].group[i] == sharded_string_interner::no_handle ?
+              amazon_products::no_group : groups.id(C[c].group[i]));
+      for (size_t i=0; i<C[c].category.size(); i++)
+      {
+        const unsigned int k = categories.id(C[c].category[i]);
+        P.category.push_back(k);
+        P.category_count[k]++;
+      }
+      C[c] = chunk();
+    }
+
+    // the co-purchase edges: similar products that are listed themselves
+    stats::scoped_phase edges_phase("edges");
+    string_interner asins;
+    std::vector<uint32_t> product;          // first product of each ASIN
+    for (size_t i=0; i<P.size(); i++)
+      if (asins.intern(P.asin[i]) == product.size())
+        product.push_back(i);
+    std::vector<uint32_t> target(P.similar.size());
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 4096)
+#endif
+    for (long k=0; k<(long) target.size(); k++)
+    {
+      const unsigned int a = asins.find(P.similar[k]);
+      target[k] = (a == string_interner::no_id ? a : product[a]);
+    }
+
+    P.edges.reserve(target.size());
+    for (size_t i=0; i<P.size(); i++)
+      for (uint64_t k=P.similar_offset[i]; k<P.similar_offset[i+1]; k++)
+      {
+        if (target[k] == string_interner::no_id)
+          P.unresolved++;
+        else
+          P.edges.push_back(amazon_products::edge(P.id[i], P.id[target[k]]));
+      }
+    stats::edges_read() += P.edges.size();
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_AMAZON_META_H_
@@ -6,7 +6,7 @@
 
    Usage:
 
-   zcat graph.tg | group_ann graph.groups > graph.groups_ann
+   zcat graph.t | annotate_groups graph.groups > graph.groups_ann
   
    The format of (.t) is a node-num followed by the name-label, one perline.
 
@@ -19,82 +19,118 @@
 
 
 #include <string>
-#include <map>
-#include <strstream>
+#include <vector>
 #include <iostream>
+#include "mapped_file.hpp"
+#include "token.hpp"
 
 
 using namespace std;
+using namespace NGraph;
 
-typedef map<unsigned int, string> node_array_type;
+// labels refer directly into the mapped label file
+//
+typedef vector<str_ref> node_array_type;
 
-void read_labels(istream &f, node_array_type &node_array)
+
+static unsigned int to_uint(const str_ref &s)
 {
+    unsigned int v = 0;
+    for (size_t i=0; i<s.size && s[i] >= '0' && s[i] <= '9'; i++)
+      v = 10 * v + (s[i] - '0');
+    return v;
+}
 
-    string label;
-    string url;
-    unsigned int node_num =0;
 
-  while (f)
-  {
-    f >> node_num;
-    f >> ws;
-    getline(f, label);
+void read_labels(const mapped_file &f, node_array_type &node_array)
+{
+  static const delimiter_set blanks(" \t\r");
+
+  line_scanner lines(f.data(), f.size());
+  str_tokenizer T(str_ref(), blanks);
+  str_ref line, num;
 
-    node_array[node_num] = label;
+  while (lines.next(line))
+  {
+    T.reset(line);
+    if (!T.next(num))
+      continue;
+    unsigned int node_num = to_uint(num);
+
+    str_ref rest = T.rest();
+    const char *b = blanks.skip(rest.begin(), rest.end());
+    if (node_num >= node_array.size())
+      node_array.resize(node_num + 1);
+    node_array[node_num] = str_ref(b, rest.end() - b);
   }  
 }
 
 
-void print_group(istream &f, const node_array_type &node_array)
+/**
+    Print the labels of the next group (a blank-line separated list of
+    node numbers, one per line).
+
+    @return false if there are no more groups
+*/
+bool print_group(line_scanner &f, const node_array_type &node_array)
 {
-  string line;
-  unsigned int i;
+  str_ref line;
 
-  while (f, getline(f, line), line.length() < 1) {};  //move past blank lines
-  
-  while (line.length() > 0)
+  while (f.next(line) && line.size < 1) {};  //move past blank lines
+  if (line.size < 1)
+    return false;
+
+  while (line.size > 0)
   {
-    istrstream s(line);
-    line >> i;
-    cout << node_array[i] << "\n";
-    getline(f, line);
+    unsigned int i = to_uint(line);
+    if (i < node_array.size())
+      cout << node_array[i];
+    cout << "\n";
+    if (!f.next(line))
+      break;
   }
   cout << "\n";
+  return true;
 }
   
 
 
 void print_labels(ostream &f, const node_array_type &node_array)
 {
-    for ( node_array_type::const_iterator p = node_array.begin();
-                p != node_array.end(); p++)
+    for (unsigned int i=0; i<node_array.size(); i++)
     {
 
-      cout << p->first << " " << p->second << "\n";
+      f << i << " " << node_array[i] << "\n";
     }
 }
 
 
 int main(int argc, char *argv[])
 {
+  if (argc < 2)
+  {
+    cerr << "Usage: " << argv[0] << " graph.groups < graph.t\n";
+    return 1;
+  }
 
   node_array_type node_array;
   
-  
-  read_labels( std::cin, node_array);    
+  mapped_file label_file("-");
+  read_labels(label_file, node_array);    
 
-  istream groupfile;
-  groupfile.open(argv[1]);
+  mapped_file groupfile(argv[1]);
+  if (!groupfile.good())
+  {
+    cerr << "Error: " << groupfile.error() << "\n";
+    return 1;
+  }
 
-  while (groupfile)
+  line_scanner groups(groupfile.data(), groupfile.size());
+  while (print_group(groups, node_array))
   {
-    print_group(group_file), node_aray);
   }
   
   //print_labels(std::cout, node_array);
 
-
+  return 0;
 }
-
-
@@ -1,51 +1,147 @@
 #include <iostream>
-#include <set>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include "vertex_map.hpp"
+#include "sketch.hpp"
+#include "ngraph_stats.hpp"
 
-// Usage: create_imap [base]   (1-default)
+// Usage: create_imap [-n [-e error] | -b] [base]   (1-default)
+//
+// Numbers the distinct integers of the input (e.g. the vertices of a .g
+// file) as base, base+1, ... in increasing order, and prints the map
+// as "vertex number" pairs.
+//
+//   -n   only print the number of distinct integers, counted in one
+//        streaming pass (memory grows with the distinct integers only)
+//   -e   with -n, estimate the number in bounded memory instead, by
+//        HyperLogLog, with the given relative error (e.g. 0.01)
+//   -b   write the map in binary (see vertex_map.hpp), for renumber,
+//        mi0_2mi, ...
 
 using namespace std;
+using namespace NGraph;
+
+struct count_vertex
+{
+    exact_counter &C;
+    count_vertex(exact_counter &c) : C(c) {}
+    void operator()(uint64_t v) { C.add(v); }
+};
+
+struct sketch_vertex
+{
+    hyperloglog &H;
+    sketch_vertex(hyperloglog &h) : H(h) {}
+    void operator()(uint64_t v) { H.add(hash_uint(v)); }
+};
+
+
+// the number of distinct integers on stdin: exact if error is 0
+//
+static bool count_distinct(double error, double &count)
+{
+#ifdef _OPENMP
+    const unsigned int num_chunks = omp_get_max_threads();
+#else
+    const unsigned int num_chunks = 1;
+#endif
+    vector<exact_counter> C(error > 0.0 ? 0 : num_chunks);
+    vector<hyperloglog> H(error > 0.0 ? num_chunks : 0,
+          hyperloglog(hyperloglog::precision_for(error)));
+
+    line_block_reader in("-");
+    const char *data;
+    size_t size;
+    while (in.next(data, size))
+    {
+      vector<const char *> bounds = line_chunks(data, size, num_chunks);
+#ifdef _OPENMP
+      #pragma omp parallel for schedule(static, 1)
+#endif
+      for (int t=0; t<(int) num_chunks; t++)
+      {
+        if (error > 0.0)
+        {
+          sketch_vertex visit(H[t]);
+          scan_vertices(bounds[t], bounds[t+1], visit);
+        }
+        else
+        {
+          count_vertex visit(C[t]);
+          scan_vertices(bounds[t], bounds[t+1], visit);
+        }
+      }
+    }
+    for (unsigned int t=1; t<C.size(); t++)
+      C[0].merge(C[t]);
+    for (unsigned int t=1; t<H.size(); t++)
+      H[0].merge(H[t]);
+    count = (error > 0.0 ? H[0].estimate() : (double) C[0].size());
+    return in.good();
+}
 
 int main(int argc, char *argv[])
 {
-    typedef unsigned int Int;
+    NGraph::stats::parse_options(argc, argv);
+
+    typedef vertex_map::vertex Int;
     bool count_only = false;
+    bool binary = false;
+    double error = 0.0;
 
     Int base = 1;
     
-    if (argc > 1)
+    for (int i=1; i<argc; i++)
     {
-
-       string option(argv[1]);
+       string option(argv[i]);
 
        if (option == "-n")
           count_only = true;
+       else if (option == "-b")
+          binary = true;
+       else if (option == "-e" && i+1 < argc)
+          error = atof(argv[++i]);
        else
-          base = atoi(argv[1]);
+          base = atoi(argv[i]);
     }
 
-    set<Int> V;
-
-    while (cin)
+    if (count_only)
     {
-      Int i;
-      cin >> i;
-      V.insert(i);
+        double count = 0;
+        {
+          stats::scoped_phase phase("count");
+          if (!count_distinct(error, count))
+          {
+            cerr << "Error: read failed\n";
+            return 1;
+          }
+        }
+        printf("%.0f\n", count);
+        return NGraph::stats::finish(0);
     }
 
-    if (count_only)
+    mapped_file in("-");
+    vector<Int> V;
     {
-        cout << V.size() <<  "\n";
+      stats::scoped_phase phase("read");
+      collect_vertices(in.data(), in.size(), V);
     }
-    else
+
+    vertex_map M;
+    M.compact(V, base);
+
+    stats::scoped_phase phase("write");
+    if (binary)
     {
-      Int i=base;
-      for (set<Int>::const_iterator p=V.begin(); p!=V.end(); p++, i++)
+      if (!M.save(stdout))
       {
-        cout << *p << " " << i  << "\n";
+        cerr << "Error: write failed\n";
+        return 1;
       }
     }
+    else
+      M.write_text(stdout);
 
     return 0;
 }
-
-
@@ -0,0 +1,309 @@
+#ifndef NGRAPH_DENDROGRAM_H_
+#define NGRAPH_DENDROGRAM_H_
+
+/*
+   The merge history of a union-find (e.g. the clusters of a percolation,
+   see g2Ptree), kept so that the clusters as of any earlier point can be
+   found without redoing the merges:
+
+        cluster_at_step(v, k)    the cluster of v after k merges
+        cluster_at_level(v, h)   the cluster of v once everything up to
+                                 level h is merged
+        cut(h, label)            the clusters of all elements at level h
+
+   Each element is a node, stored in flat arrays by order of insertion.
+   A merge of two clusters makes the root of the smaller one a child of
+   the root of the larger, and records on the child the merge step (a
+   count of merges), the level then current (set_level(), e.g. a degree
+   threshold) and its size at the time.  Since a root only ever gains
+   children, the step (and level) increases along any path to the root,
+   and since a root is attached to one at least as large, paths have at
+   most log2(n) edges: the cluster of v at step k is the last node on v's
+   path reached by merges made up to step k.  cut() labels every element
+   with one pass over the nodes (each walks only until it meets a node
+   already labeled).
+
+   Levels must not decrease between merges.  An element exists from its
+   insertion on: before that, it is in no cluster (none()).
+
+   A dendrogram can be filled by an equivalence (see
+   equivalence::record_dendrogram()), or directly through merge().
+   save() and load() use a binary file (magic "NGDENDR1").
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <stdint.h>
+
+namespace NGraph
+{
+
+template <typename T>
+class dendrogram
+{
+  public:
+    typedef T value_type;
+    typedef uint32_t index_t;
+
+    static index_t none() { return ~(index_t) 0; }
+
+  private:
+    std::vector<T> element_;
+    std::vector<index_t> parent_;       // none() for roots
+    std::vector<index_t> step_;         // of the merge into parent
+    std::vector<double> height_;        // level of the merge into parent
+    std::vector<index_t> size_;         // as of the merge (or now, roots)
+    std::vector<index_t> born_step_;    // merges made before insertion
+    std::vector<double> born_height_;   // level at insertion
+    std::map<T, index_t> node_;
+
+    index_t num_merges_;
+    index_t num_roots_;
+    double level_;
+
+    index_t walk(index_t i, size_t k) const
+    {
+        while (parent_[i] != none() && step_[i] <= k)
+          i = parent_[i];
+        return i;
+    }
+
+    index_t walk_level(index_t i, double h) const
+    {
+        while (parent_[i] != none() && height_[i] <= h)
+          i = parent_[i];
+        return i;
+    }
+
+    template <class V>
+    static bool write_array(FILE *f, const std::vector<V> &A)
+    {
+        return A.empty() || fwrite(&A[0], sizeof(V), A.size(), f) == A.size();
+    }
+
+    template <class V>
+    static bool read_array(FILE *f, std::vector<V> &A, size_t n)
+    {
+        A.resize(n);
+        return n == 0 || fread(&A[0], sizeof(V), n, f) == n;
+    }
+
+  public:
+
+    dendrogram() : element_(), parent_(), step_(), height_(), size_(),
+        born_step_(), born_height_(), node_(), num_merges_(0), num_roots_(0),
+        level_(0.0) {}
+
+    /** the level recorded with the merges (and insertions) to come */
+    void set_level(double h) { level_ = h; }
+    double level() const { return level_; }
+
+    size_t num_elements() const { return element_.size(); }
+    size_t num_merges() const { return num_merges_; }
+    size_t num_clusters() const { return num_roots_; }
+
+    /** the node of element a, or none() */
+    index_t node(const T &a) const
+    {
+        typename std::map<T, index_t>::const_iterator p = node_.find(a);
+        return (p == node_.end() ? none() : p->second);
+    }
+
+    const T &element(index_t i) const { return element_[i]; }
+    index_t parent(index_t i) const { return parent_[i]; }
+    index_t step(index_t i) const { return step_[i]; }
+    double height(index_t i) const { return height_[i]; }
+    index_t size(index_t i) const { return size_[i]; }
+    index_t born_step(index_t i) const { return born_step_[i]; }
+    double born_height(index_t i) const { return born_height_[i]; }
+
+    /** the node of a, added (as a cluster of its own) if new */
+    index_t insert(const T &a)
+    {
+        std::pair<typename std::map<T, index_t>::iterator, bool> p =
+              node_.insert(std::make_pair(a, (index_t) element_.size()));
+        if (!p.second)
+          return p.first->second;
+        element_.push_back(a);
+        parent_.push_back(none());
+        step_.push_back(none());
+        height_.push_back(0.0);
+        size_.push_back(1);
+        born_step_.push_back(num_merges_);
+        born_height_.push_back(level_);
+        num_roots_++;
+        return p.first->second;
+    }
+
+    /** the current root of node i */
+    index_t root(index_t i) const
+    {
+        while (parent_[i] != none())
+          i = parent_[i];
+        return i;
+    }
+
+    /**
+        Merge the clusters of a and b (inserting either if new); the
+        larger absorbs the smaller (b's on a tie, as in equivalence).
+
+        @return true if they were in different clusters
+    */
+    bool merge(const T &a, const T &b)
+    {
+        index_t ra = root(insert(a));
+        index_t rb = root(insert(b));
+        if (ra == rb)
+          return false;
+        if (size_[ra] > size_[rb])
+          std::swap(ra, rb);
+        parent_[ra] = rb;
+        step_[ra] = ++num_merges_;
+        height_[ra] = level_;
+        size_[rb] += size_[ra];
+        num_roots_--;
+        return true;
+    }
+
+    /**
+        The cluster (its root node) of a after the first k merges, or
+        none() if a was not inserted by then.
+    */
+    index_t cluster_at_step(const T &a, size_t k) const
+    {
+        const index_t i = node(a);
+        if (i == none() || born_step_[i] > k)
+          return none();
+        return walk(i, k);
+    }
+
+    /**
+        The cluster (its root node) of a once all merges at levels up to
+        h are made, or none() if a was inserted at a higher level.
+    */
+    index_t cluster_at_level(const T &a, double h) const
+    {
+        const index_t i = node(a);
+        if (i == none() || born_height_[i] > h)
+          return none();
+        return walk_level(i, h);
+    }
+
+    /**
+        The clusters at level h: label[i] is the root node of the cluster
+        of node i, or none() for nodes inserted at higher levels.
+
+        @return the number of clusters
+    */
+    size_t cut(double h, std::vector<index_t> &label) const
+    {
+        const size_t n = element_.size();
+        label.assign(n, none());
+        std::vector<index_t> path;
+        size_t clusters = 0;
+        for (size_t i=0; i<n; i++)
+        {
+          if (label[i] != none() || born_height_[i] > h)
+            continue;
+          index_t j = (index_t) i;
+          while (label[j] == none() && parent_[j] != none() && height_[j] <= h)
+          {
+            path.push_back(j);
+            j = parent_[j];
+          }
+          index_t r = label[j];
+          if (r == none())
+          {
+            r = label[j] = j;
+            clusters++;
+          }
+          for (size_t p=0; p<path.size(); p++)
+            label[path[p]] = r;
+          path.clear();
+        }
+        return clusters;
+    }
+
+    bool save(FILE *f) const
+    {
+        const uint64_t n = element_.size();
+        const uint32_t element_bytes = sizeof(T);
+        bool ok = fwrite("NGDENDR1", 8, 1, f) == 1 &&
+              fwrite(&element_bytes, sizeof(element_bytes), 1, f) == 1 &&
+              fwrite(&num_merges_, sizeof(num_merges_), 1, f) == 1 &&
+              fwrite(&n, sizeof(n), 1, f) == 1 &&
+              fwrite(&level_, sizeof(level_), 1, f) == 1;
+        ok = ok && write_array(f, element_) && write_array(f, parent_) &&
+              write_array(f, step_) && write_array(f, height_) &&
+              write_array(f, size_) && write_array(f, born_step_) &&
+              write_array(f, born_height_);
+        return ok && fflush(f) == 0;
+    }
+
+    bool load(FILE *f, std::string &error)
+    {
+        char magic[8];
+        uint32_t element_bytes = 0;
+        index_t merges = 0;
+        uint64_t n = 0;
+        double level = 0.0;
+        if (fread(magic, 8, 1, f) != 1 || memcmp(magic, "NGDENDR1", 8) != 0 ||
+            fread(&element_bytes, sizeof(element_bytes), 1, f) != 1 ||
+            fread(&merges, sizeof(merges), 1, f) != 1 ||
+            fread(&n, sizeof(n), 1, f) != 1 ||
+            fread(&level, sizeof(level), 1, f) != 1)
+        {
+          error = "not a saved dendrogram";
+          return false;
+        }
+        if (element_bytes != sizeof(T))
+        {
+          error = "dendrogram elements are of a different size";
+          return false;
+        }
+        dendrogram D;
+        if (!read_array(f, D.element_, n) || !read_array(f, D.parent_, n) ||
+            !read_array(f, D.step_, n) || !read_array(f, D.height_, n) ||
+            !read_array(f, D.size_, n) || !read_array(f, D.born_step_, n) ||
+            !read_array(f, D.born_height_, n))
+        {
+          error = "saved dendrogram is truncated";
+          return false;
+        }
+        for (size_t i=0; i<n; i++)
+        {
+          D.node_.insert(std::make_pair(D.element_[i], (index_t) i));
+          if (D.parent_[i] == none())
+            D.num_roots_++;
+        }
+        D.num_merges_ = merges;
+        D.level_ = level;
+        swap(D);
+        return true;
+    }
+
+    void swap(dendrogram &D)
+    {
+        element_.swap(D.element_);
+        parent_.swap(D.parent_);
+        step_.swap(D.step_);
+        height_.swap(D.height_);
+        size_.swap(D.size_);
+        born_step_.swap(D.born_step_);
+        born_height_.swap(D.born_height_);
+        node_.swap(D.node_);
+        std::swap(num_merges_, D.num_merges_);
+        std::swap(num_roots_, D.num_roots_);
+        std::swap(level_, D.level_);
+    }
+};
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_DENDROGRAM_H_
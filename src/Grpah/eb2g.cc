@@ -0,0 +1,28 @@
+//
+// Converts a binary edge file (.eb) back into a text graph (.g).
+//
+// Usage:  cat graph.eb | eb2g > graph.g
+//
+
+#include <iostream>
+#include "edge_stream.hpp"
+#include "ngraph_stats.hpp"
+
+using namespace std;
+using namespace NGraph;
+
+int main(int argc, char *argv[])
+{
+  NGraph::stats::parse_options(argc, argv);
+
+  edge_reader in(stdin);
+  text_edge_writer out(stdout);
+
+  edge_record e;
+  while (in.next(e))
+    out.put(e);
+  out.flush();
+
+  stats::edges_written() += out.count();
+  return 0;
+}
@@ -0,0 +1,285 @@
+#ifndef NGRAPH_EDGE_MERGE_H_
+#define NGRAPH_EDGE_MERGE_H_
+
+/*
+   Merge-based set algebra over sorted edge streams.
+
+   Given k sorted edge sources (see edge_stream.hpp), merge_edge_sets()
+   performs a single k-way merge and writes the union, intersection,
+   difference or symmetric difference of their edge sets, in sorted order
+   and without duplicates, to an edge sink.  Only one record per input is
+   held at a time (plus each stream's fixed buffer), so memory use does
+   not depend on the size of the graphs.
+
+   The result of each operation is defined record-by-record, treating
+   each input as a set of records (duplicates within an input count
+   once):
+
+        edge_union                  in at least one input
+        edge_intersection           in every input
+        edge_difference             in the first input, and no other
+        edge_symmetric_difference   in an odd number of inputs
+
+   Isolated-vertex records (v, no_vertex) are treated like any other
+   record.  (So, unlike tGraph::intersect(), which keeps every vertex
+   common to both graphs, an intersection keeps a vertex only through
+   its edges or isolated-vertex records.)
+
+   Any class with  bool next(edge_record &)  can be a source, and any
+   class with  void put(const edge_record &)  can be a sink.  The merge
+   itself is also available as an iterator, edge_merger, for stages that
+   need to inspect which inputs contributed each record (e.g. counting
+   duplicates).
+*/
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "edge_stream.hpp"
+
+namespace NGraph
+{
+
+enum edge_set_operation
+{
+    edge_union,
+    edge_intersection,
+    edge_difference,
+    edge_symmetric_difference
+};
+
+
+/**
+    k-way merge of sorted edge sources.  Each call to next() yields the
+    next distinct record, the number of inputs it appeared in, the total
+    number of times it appeared (including duplicates within an input),
+    and whether it appeared in the first input.
+*/
+template <class Source>
+class edge_merger
+{
+  private:
+
+    struct head
+    {
+        edge_record e;
+        unsigned int source;
+    };
+
+    // min-heap order on (record, source)
+    struct head_greater
+    {
+        bool operator()(const head &a, const head &b) const
+        {
+            return (b.e < a.e) || (a.e == b.e && a.source > b.source);
+        }
+    };
+
+    std::vector<Source *> sources_;
+    std::vector<head> heap_;
+
+    void advance(unsigned int s)
+    {
+        head h;
+        if (sources_[s]->next(h.e))
+        {
+          h.source = s;
+          heap_.push_back(h);
+          std::push_heap(heap_.begin(), heap_.end(), head_greater());
+        }
+    }
+
+  public:
+
+    edge_merger(const std::vector<Source *> &sources) : sources_(sources),
+          heap_()
+    {
+        heap_.reserve(sources_.size());
+        for (unsigned int s=0; s<sources_.size(); s++)
+          advance(s);
+    }
+
+    unsigned int num_sources() const { return sources_.size(); }
+
+    /**
+        @param e           next distinct record, in sorted order
+        @param num_inputs  number of distinct inputs containing e
+        @param multiplicity total number of occurrences of e
+        @param in_first    true if the first input contains e
+        @return false when all inputs are exhausted
+    */
+    bool next(edge_record &e, unsigned int &num_inputs,
+          size_t &multiplicity, bool &in_first)
+    {
+        if (heap_.empty())
+          return false;
+
+        e = heap_.front().e;
+        num_inputs = 0;
+        multiplicity = 0;
+        in_first = false;
+
+        int last_source = -1;
+        while (!heap_.empty() && heap_.front().e == e)
+        {
+          unsigned int s = heap_.front().source;
+          std::pop_heap(heap_.begin(), heap_.end(), head_greater());
+          heap_.pop_back();
+
+          // equal records come out grouped by source, in source order
+          if ((int) s != last_source)
+          {
+            num_inputs++;
+            last_source = s;
+          }
+          if (s == 0)
+            in_first = true;
+          multiplicity++;
+          advance(s);
+        }
+        return true;
+    }
+};
+
+
+/**
+    @return true if a record found in num_inputs of k inputs (and in the
+    first input, if in_first) belongs to the result of op.
+*/
+inline bool edge_set_selects(edge_set_operation op, unsigned int num_inputs,
+      unsigned int k, bool in_first)
+{
+    switch (op)
+    {
+      case edge_union:
+          return num_inputs > 0;
+      case edge_intersection:
+          return num_inputs == k;
+      case edge_difference:
+          return in_first && num_inputs == 1;
+      case edge_symmetric_difference:
+          return (num_inputs % 2) == 1;
+    }
+    return false;
+}
+
+
+/**
+    Merge sorted sources, writing the records selected by op to out.
+
+    @return the number of records written.
+*/
+template <class Source, class Sink>
+size_t merge_edge_sets(const std::vector<Source *> &sources,
+      edge_set_operation op, Sink &out)
+{
+    edge_merger<Source> M(sources);
+    const unsigned int k = sources.size();
+
+    size_t written = 0;
+    edge_record e;
+    unsigned int num_inputs = 0;
+    size_t multiplicity = 0;
+    bool in_first = false;
+    while (M.next(e, num_inputs, multiplicity, in_first))
+    {
+      if (edge_set_selects(op, num_inputs, k, in_first))
+      {
+        out.put(e);
+        written++;
+      }
+    }
+    return written;
+}
+
+
+/**
+    Apply op to sorted binary edge files, writing the (sorted) result as
+    a binary edge file to out.  A filename of "-" denotes stdin.
+
+    The memory budget is shared among the input and output buffers.
+
+    @return true on success; otherwise error describes the problem.
+*/
+inline bool merge_edge_files(edge_set_operation op,
+      const std::vector<const char *> &filenames, size_t memory_bytes,
+      FILE *out, std::string &error)
+{
+    const size_t buffer_bytes = memory_bytes / (filenames.size() + 1);
+
+    std::vector<edge_reader *> sources;
+    for (unsigned int i=0; i<filenames.size(); i++)
+    {
+      if (std::string(filenames[i]) == "-")
+        sources.push_back(new edge_reader(stdin, buffer_bytes, true));
+      else
+        sources.push_back(new edge_reader(filenames[i], buffer_bytes, true));
+    }
+
+    edge_writer W(out, buffer_bytes);
+    merge_edge_sets(sources, op, W);
+    W.flush();
+
+    error.clear();
+    for (unsigned int i=0; i<sources.size(); i++)
+    {
+      if (error.empty() && !sources[i]->good())
+        error = sources[i]->error();
+      delete sources[i];
+    }
+    if (error.empty() && !W.good())
+      error = W.error();
+
+    return error.empty();
+}
+
+
+/**
+    Common driver for the streaming (-b) mode of gunion, gintersect,
+    gminus and gsymm_diff:
+
+        cat A.eb | tool -b [-m MB] B.eb [C.eb ...] > result.eb
+
+    argv[0] is the first argument after -b.  stdin is the second input
+    if stdin_second (so that "cat A | gminus B" computes B - A, as the
+    in-memory version does), and the first input otherwise.
+
+    @return the tool's exit status
+*/
+inline int edge_set_tool(edge_set_operation op, int argc, char *argv[],
+      bool stdin_second)
+{
+    size_t memory_mb = 64;
+    std::vector<const char *> files;
+    for (int i=0; i<argc; i++)
+    {
+      if (std::string(argv[i]) == "-m" && i+1 < argc)
+        memory_mb = atoi(argv[++i]);
+      else
+        files.push_back(argv[i]);
+    }
+
+    if (files.empty())
+    {
+      std::cerr << "Error: no input graph (.eb) given.\n";
+      return 1;
+    }
+    files.insert(files.begin() + (stdin_second ? 1 : 0), "-");
+
+    std::string error;
+    if (!merge_edge_files(op, files, memory_mb << 20, stdout, error))
+    {
+      std::cerr << "Error: " << error << "\n";
+      return 1;
+    }
+    return 0;
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_EDGE_MERGE_H_
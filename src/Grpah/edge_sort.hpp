@@ -0,0 +1,556 @@
+#ifndef NGRAPH_EDGE_SORT_H_
+#define NGRAPH_EDGE_SORT_H_
+
+/*
+   External-memory sorting of edge lists, for graphs larger than RAM.
+
+   Edges are added one at a time to an external_edge_sorter.  They are
+   collected into a run buffer (whose size is set by the memory budget);
+   each full buffer is radix-sorted in parallel and written to a
+   temporary file in the temp directory.  finish() then merges the runs
+   with a k-way merge (edge_merge.hpp), in several passes if there are
+   more runs than the memory budget allows to be open at once, and
+   streams the sorted edges to a sink.  If all edges fit into a single
+   run, nothing is written to disk.
+
+   The canonicalizing operations that tools such as gcompact, g2ug,
+   g2cug and grepeated_edges otherwise perform by building a tGraph are
+   options of the sorter:
+
+        remove_self_loops   drop edges (a,a), leaving a vertex record (a)
+        symmetrize          add (b,a) for every edge (a,b)
+        undirected          store each edge as (min(a,b), max(a,b))
+        unique              emit each distinct record once
+
+   The first three are applied as edges are added (so they also shrink
+   the runs); deduplication happens during the merge.  finish_counted()
+   passes each distinct record to the sink together with its
+   multiplicity, which is how duplicates are counted without holding
+   the graph.
+
+   Temporary files are removed as soon as they have been merged.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include <stdint.h>
+#include "edge_stream.hpp"
+#include "edge_merge.hpp"
+#include "ngraph_stats.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+
+// ---------------------------------------------------------------------
+//  parallel LSD radix sort on 64-bit keys
+// ---------------------------------------------------------------------
+
+/**
+    Sort keys[0..n) with a least-significant-digit radix sort, using tmp
+    (of at least n elements) as scratch space.  Each 16-bit digit pass
+    is split among the available threads: every thread histograms its
+    own contiguous chunk, and the per-thread offsets are derived from a
+    single prefix sum, so that the scatter needs no synchronization and
+    the sort is stable.  Passes over digits that are equal for all keys
+    are skipped.
+*/
+inline void radix_sort(uint64_t *keys, uint64_t *tmp, size_t n)
+{
+    const unsigned int digit_bits = 16;
+    const size_t num_buckets = 1 << digit_bits;
+    const uint64_t mask = num_buckets - 1;
+
+#ifdef _OPENMP
+    const unsigned int num_threads = (n < (1 << 16) ? 1 : omp_get_max_threads());
+#else
+    const unsigned int num_threads = 1;
+#endif
+
+    std::vector<size_t> count(num_threads * num_buckets);
+    uint64_t *src = keys;
+    uint64_t *dst = tmp;
+
+    for (unsigned int shift = 0; shift < 64; shift += digit_bits)
+    {
+      std::fill(count.begin(), count.end(), 0);
+
+#ifdef _OPENMP
+      #pragma omp parallel num_threads(num_threads)
+#endif
+      {
+#ifdef _OPENMP
+        const unsigned int t = omp_get_thread_num();
+#else
+        const unsigned int t = 0;
+#endif
+        const size_t begin = n * t / num_threads;
+        const size_t end = n * (t+1) / num_threads;
+        size_t *c = &count[t * num_buckets];
+        for (size_t i=begin; i<end; i++)
+          c[(src[i] >> shift) & mask]++;
+      }
+
+      // skip the pass if every key has the same digit
+      bool trivial = false;
+      for (size_t b=0; b<num_buckets && !trivial; b++)
+      {
+        size_t total = 0;
+        for (unsigned int t=0; t<num_threads; t++)
+          total += count[t * num_buckets + b];
+        if (total == n)
+          trivial = true;
+        else if (total != 0)
+          break;
+      }
+      if (trivial)
+        continue;
+
+      // exclusive prefix sum, in (bucket, thread) order
+      size_t sum = 0;
+      for (size_t b=0; b<num_buckets; b++)
+        for (unsigned int t=0; t<num_threads; t++)
+        {
+          size_t c = count[t * num_buckets + b];
+          count[t * num_buckets + b] = sum;
+          sum += c;
+        }
+
+#ifdef _OPENMP
+      #pragma omp parallel num_threads(num_threads)
+#endif
+      {
+#ifdef _OPENMP
+        const unsigned int t = omp_get_thread_num();
+#else
+        const unsigned int t = 0;
+#endif
+        const size_t begin = n * t / num_threads;
+        const size_t end = n * (t+1) / num_threads;
+        size_t *c = &count[t * num_buckets];
+        for (size_t i=begin; i<end; i++)
+          dst[c[(src[i] >> shift) & mask]++] = src[i];
+      }
+
+      std::swap(src, dst);
+    }
+
+    if (src != keys)
+      std::copy(src, src + n, keys);
+}
+
+
+inline uint64_t edge_key(const edge_record &e)
+{
+    return (((uint64_t) e.from) << 32) | e.to;
+}
+
+inline edge_record key_edge(uint64_t k)
+{
+    return make_edge_record((unsigned int) (k >> 32),
+          (unsigned int) (k & 0xFFFFFFFFu));
+}
+
+
+// ---------------------------------------------------------------------
+//  external sorter
+// ---------------------------------------------------------------------
+
+struct edge_sort_options
+{
+    size_t memory_bytes;        // total budget for run and merge buffers
+    std::string temp_dir;
+    bool remove_self_loops;
+    bool symmetrize;
+    bool undirected;
+    bool unique;
+
+    edge_sort_options() : memory_bytes(256 << 20), temp_dir(),
+        remove_self_loops(false), symmetrize(false), undirected(false),
+        unique(false)
+    {
+        const char *t = getenv("TMPDIR");
+        temp_dir = (t != 0 && *t != 0 ? t : "/tmp");
+    }
+};
+
+
+/**
+    Adds a multiplicity-aware put() to a plain edge sink, repeating each
+    record multiplicity times (or once, if unique).
+*/
+template <class Sink>
+class repeat_sink
+{
+  private:
+    Sink &out_;
+    bool unique_;
+
+  public:
+    repeat_sink(Sink &out, bool unique) : out_(out), unique_(unique) {}
+
+    void put(const edge_record &e, size_t multiplicity)
+    {
+        size_t n = (unique_ ? 1 : multiplicity);
+        for (size_t i=0; i<n; i++)
+          out_.put(e);
+    }
+};
+
+
+/**
+    Drops the isolated-vertex record (v, no_vertex) of a vertex that has
+    out-edges, since (in sorted order) it immediately follows them.  (A
+    vertex with only in-edges keeps its record; that is redundant but
+    harmless, as reading it back creates no new vertex.)
+*/
+template <class Sink>
+class vertex_record_filter
+{
+  private:
+    Sink &out_;
+    bool have_last_;
+    unsigned int last_from_;
+
+  public:
+    vertex_record_filter(Sink &out) : out_(out), have_last_(false),
+        last_from_(0) {}
+
+    void put(const edge_record &e)
+    {
+        if (e.is_vertex_only() && have_last_ && last_from_ == e.from)
+          return;
+        have_last_ = true;
+        last_from_ = e.from;
+        out_.put(e);
+    }
+};
+
+
+class external_edge_sorter
+{
+  private:
+    edge_sort_options opt_;
+    std::vector<uint64_t> run_;
+    size_t run_capacity_;
+    std::vector<std::string> run_files_;
+    size_t num_added_;
+    std::string error_;
+
+    // minimum per-stream buffer during merging
+    static size_t min_merge_buffer() { return 1 << 16; }
+
+    external_edge_sorter(const external_edge_sorter &);
+    external_edge_sorter & operator=(const external_edge_sorter &);
+
+    void push(const edge_record &e)
+    {
+        run_.push_back(edge_key(e));
+        if (run_.size() == run_capacity_)
+          spill();
+    }
+
+    void sort_run()
+    {
+        stats::scoped_phase phase("sort run");
+        std::vector<uint64_t> tmp(run_.size());
+        if (!run_.empty())
+          radix_sort(&run_[0], &tmp[0], run_.size());
+    }
+
+    bool temp_file(std::string &name, FILE *&f)
+    {
+        std::string pattern = opt_.temp_dir + "/ngraph_sort_XXXXXX";
+        std::vector<char> buf(pattern.begin(), pattern.end());
+        buf.push_back(0);
+        int fd = mkstemp(&buf[0]);
+        if (fd < 0 || (f = fdopen(fd, "w+b")) == 0)
+        {
+          if (fd >= 0)
+          {
+            close(fd);
+            unlink(&buf[0]);
+          }
+          error_ = "could not create a temporary file in [" +
+                opt_.temp_dir + "]";
+          return false;
+        }
+        name = &buf[0];
+        return true;
+    }
+
+    // sort the current run and write it to a temporary file
+    //
+    void spill()
+    {
+        if (run_.empty() || !error_.empty())
+          return;
+        sort_run();
+
+        stats::scoped_phase phase("write run");
+        std::string name;
+        FILE *f = 0;
+        if (!temp_file(name, f))
+        {
+          run_.clear();
+          return;
+        }
+        {
+          edge_writer W(f, min_merge_buffer());
+          for (size_t i=0; i<run_.size(); i++)
+            W.put(key_edge(run_[i]));
+          W.flush();
+          if (!W.good())
+            error_ = "could not write temporary file [" + name + "]";
+        }
+        fclose(f);
+        run_files_.push_back(name);
+        run_.clear();
+    }
+
+    size_t max_fan_in() const
+    {
+        size_t k = opt_.memory_bytes / min_merge_buffer();
+        return (k < 2 ? 2 : k - 1);
+    }
+
+    // merge run files [first, last) into sink
+    //
+    template <class CountedSink>
+    void merge_runs(size_t first, size_t last, CountedSink &out)
+    {
+        const size_t k = last - first;
+        const size_t buffer_bytes = opt_.memory_bytes / (k + 1);
+
+        std::vector<edge_reader *> sources;
+        for (size_t i=first; i<last; i++)
+          sources.push_back(new edge_reader(run_files_[i].c_str(),
+                    buffer_bytes));
+
+        edge_merger<edge_reader> M(sources);
+        edge_record e;
+        unsigned int num_inputs = 0;
+        size_t multiplicity = 0;
+        bool in_first = false;
+        while (M.next(e, num_inputs, multiplicity, in_first))
+          out.put(e, multiplicity);
+
+        for (size_t i=0; i<sources.size(); i++)
+        {
+          if (error_.empty() && !sources[i]->good())
+            error_ = sources[i]->error();
+          delete sources[i];
+          unlink(run_files_[first + i].c_str());
+        }
+    }
+
+    // remove the run files (those already merged are gone; unlink()
+    // then fails harmlessly)
+    //
+    void remove_runs()
+    {
+        for (size_t i=0; i<run_files_.size(); i++)
+          unlink(run_files_[i].c_str());
+        run_files_.clear();
+    }
+
+    // reduce the number of runs until they can all be merged at once; on
+    // an error, all run files (of this pass and earlier ones) are removed
+    //
+    void reduce_runs()
+    {
+        const size_t fan_in = max_fan_in();
+        while (run_files_.size() > fan_in && error_.empty())
+        {
+          stats::scoped_phase phase("merge pass");
+          std::vector<std::string> merged;
+          for (size_t first = 0; first < run_files_.size(); first += fan_in)
+          {
+            size_t last = std::min(first + fan_in, run_files_.size());
+            if (last - first == 1)
+            {
+              merged.push_back(run_files_[first]);
+              continue;
+            }
+            std::string name;
+            FILE *f = 0;
+            if (temp_file(name, f))
+            {
+              edge_writer W(f, min_merge_buffer());
+              repeat_sink<edge_writer> R(W, opt_.unique);
+              merge_runs(first, last, R);
+              W.flush();
+              if (error_.empty() && !W.good())
+                error_ = "could not write temporary file [" + name + "]";
+              fclose(f);
+              merged.push_back(name);
+            }
+            if (!error_.empty())
+            {
+              run_files_.insert(run_files_.end(), merged.begin(),
+                    merged.end());
+              remove_runs();
+              return;
+            }
+          }
+          run_files_ = merged;
+        }
+    }
+
+  public:
+
+    external_edge_sorter(const edge_sort_options &opt) : opt_(opt), run_(),
+        run_capacity_(0), run_files_(), num_added_(0), error_()
+    {
+        // the run and its radix-sort scratch space share the budget
+        run_capacity_ = opt_.memory_bytes / (2 * sizeof(uint64_t));
+        if (run_capacity_ < 1024)
+          run_capacity_ = 1024;
+        run_.reserve(run_capacity_);
+    }
+
+    ~external_edge_sorter()
+    {
+        remove_runs();
+    }
+
+    bool good() const { return error_.empty(); }
+    const std::string &error() const { return error_; }
+
+    /** number of edges added (before any filtering) */
+    size_t num_added() const { return num_added_; }
+
+    /** number of runs written to disk so far */
+    size_t num_runs() const { return run_files_.size(); }
+
+    void add(const edge_record &e)
+    {
+        num_added_++;
+        if (e.is_vertex_only())
+        {
+          push(e);
+          return;
+        }
+        if (opt_.remove_self_loops && e.from == e.to)
+        {
+          // keep the vertex, in case the loop was its only edge
+          push(make_edge_record(e.from, no_vertex));
+          return;
+        }
+
+        if (opt_.undirected && e.to < e.from)
+          push(make_edge_record(e.to, e.from));
+        else
+          push(e);
+
+        if (opt_.symmetrize && e.from != e.to)
+          push(make_edge_record(e.to, e.from));
+    }
+
+    void add(unsigned int from, unsigned int to)
+    {
+        add(make_edge_record(from, to));
+    }
+
+    /**
+        Stream the sorted edges to out.put(e, multiplicity), once per
+        distinct record.  (unique is ignored here; the multiplicity tells
+        the sink how many copies there were.)
+    */
+    template <class CountedSink>
+    bool finish_counted(CountedSink &out)
+    {
+        if (run_files_.empty())
+        {
+          // everything fit in memory
+          sort_run();
+          stats::scoped_phase phase("merge");
+          size_t i = 0;
+          while (i < run_.size())
+          {
+            size_t j = i + 1;
+            while (j < run_.size() && run_[j] == run_[i])
+              j++;
+            out.put(key_edge(run_[i]), j - i);
+            i = j;
+          }
+          run_.clear();
+          return good();
+        }
+
+        spill();
+        std::vector<uint64_t>().swap(run_);     // release the run buffer
+
+        // intermediate passes must keep duplicates for counting
+        bool unique = opt_.unique;
+        opt_.unique = false;
+        reduce_runs();
+        opt_.unique = unique;
+
+        if (good())
+        {
+          stats::scoped_phase phase("merge");
+          merge_runs(0, run_files_.size(), out);
+        }
+        remove_runs();
+        return good();
+    }
+
+    /**
+        Stream the sorted edges to out.put(e); duplicates are removed if
+        the unique option is set.
+    */
+    template <class Sink>
+    bool finish(Sink &out)
+    {
+        repeat_sink<Sink> R(out, opt_.unique);
+        return finish_counted(R);
+    }
+};
+
+
+/**
+    Options shared by the external (-x) modes of the edge tools:
+
+        -x          sort externally instead of building a tGraph
+        -m MB       memory budget (default 256)
+        -T dir      directory for temporary runs (default $TMPDIR or /tmp)
+
+    Recognized options are removed from argv.
+
+    @return true if -x was given
+*/
+inline bool parse_external_sort_options(int &argc, char *argv[],
+      edge_sort_options &opt)
+{
+    bool external = false;
+    int j = 1;
+    for (int i=1; i<argc; i++)
+    {
+      std::string a(argv[i]);
+      if (a == "-x")
+        external = true;
+      else if (a == "-m" && i+1 < argc)
+        opt.memory_bytes = ((size_t) atoi(argv[++i])) << 20;
+      else if (a == "-T" && i+1 < argc)
+        opt.temp_dir = argv[++i];
+      else
+        argv[j++] = argv[i];
+    }
+    argc = j;
+    argv[argc] = 0;
+    return external;
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_EDGE_SORT_H_
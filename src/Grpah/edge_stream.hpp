@@ -0,0 +1,365 @@
+#ifndef NGRAPH_EDGE_STREAM_H_
+#define NGRAPH_EDGE_STREAM_H_
+
+/*
+   Buffered streams of edges, for tools that process graphs too large to
+   hold in memory as a tGraph.
+
+   A binary edge file (.eb) is a plain sequence of records
+
+            unsigned int from, to;
+
+   in host byte order, with no header.  An isolated vertex v is stored
+   as the record (v, no_vertex), so that it sorts after all of v's
+   edges.  A file is "sorted" if its records are in nondecreasing
+   (from, to) order; sorted files are what the merge-based set
+   operations (edge_merge.hpp) and the external sorter (edge_sort.hpp)
+   consume and produce.
+
+   Readers never allocate per record: each owns a single fixed-size
+   buffer, so the memory used by a stream is bounded by its buffer size
+   regardless of the length of the file.
+
+   Errors (unreadable files, unsorted input where sorted input was
+   required) are reported through good() and error(), rather than by
+   exiting, so that each tool can report them in its own way.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sstream>
+
+namespace NGraph
+{
+
+const unsigned int no_vertex = 0xFFFFFFFFu;
+
+struct edge_record
+{
+    unsigned int from;
+    unsigned int to;
+
+    bool is_vertex_only() const { return to == no_vertex; }
+};
+
+inline edge_record make_edge_record(unsigned int from, unsigned int to)
+{
+    edge_record e = {from, to};
+    return e;
+}
+
+inline bool operator<(const edge_record &a, const edge_record &b)
+{
+    return (a.from < b.from) || (a.from == b.from && a.to < b.to);
+}
+
+inline bool operator==(const edge_record &a, const edge_record &b)
+{
+    return a.from == b.from && a.to == b.to;
+}
+
+inline bool operator!=(const edge_record &a, const edge_record &b)
+{
+    return !(a == b);
+}
+
+// default buffer size per stream
+//
+const size_t edge_stream_buffer_bytes = 1 << 20;
+
+
+/**
+    Reads edge_records from a binary edge file (or stdin).
+
+    If check_sorted is set, reading stops with an error at the first
+    record that is smaller than its predecessor.
+*/
+class edge_reader
+{
+  private:
+    FILE *f_;
+    bool owns_file_;
+    std::vector<edge_record> buffer_;
+    size_t pos_;
+    size_t len_;
+    bool check_sorted_;
+    bool have_last_;
+    edge_record last_;
+    size_t count_;
+    std::string error_;
+    std::string name_;
+
+    edge_reader(const edge_reader &);
+    edge_reader & operator=(const edge_reader &);
+
+    void init(size_t buffer_bytes)
+    {
+        size_t n = buffer_bytes / sizeof(edge_record);
+        buffer_.resize(n > 0 ? n : 1);
+        if (f_ == 0)
+          error_ = "[" + name_ + "] could not be opened";
+    }
+
+    bool fill()
+    {
+        pos_ = 0;
+        len_ = fread(&buffer_[0], sizeof(edge_record), buffer_.size(), f_);
+        return len_ > 0;
+    }
+
+  public:
+
+    edge_reader(FILE *f, size_t buffer_bytes = edge_stream_buffer_bytes,
+          bool check_sorted = false) : f_(f), owns_file_(false), buffer_(),
+          pos_(0), len_(0), check_sorted_(check_sorted), have_last_(false),
+          last_(), count_(0), error_(), name_("stdin")
+    {
+        init(buffer_bytes);
+    }
+
+    edge_reader(const char *filename,
+          size_t buffer_bytes = edge_stream_buffer_bytes,
+          bool check_sorted = false) : f_(fopen(filename, "rb")),
+          owns_file_(true), buffer_(), pos_(0), len_(0),
+          check_sorted_(check_sorted), have_last_(false), last_(),
+          count_(0), error_(), name_(filename)
+    {
+        init(buffer_bytes);
+    }
+
+    ~edge_reader()
+    {
+        if (owns_file_ && f_ != 0)
+          fclose(f_);
+    }
+
+    bool good() const { return error_.empty(); }
+    const std::string &error() const { return error_; }
+    const std::string &name() const { return name_; }
+
+    /** number of records read so far */
+    size_t count() const { return count_; }
+
+    bool next(edge_record &e)
+    {
+        if (!good())
+          return false;
+        if (pos_ == len_ && !fill())
+          return false;
+
+        e = buffer_[pos_++];
+        if (check_sorted_)
+        {
+          if (have_last_ && e < last_)
+          {
+            std::ostringstream msg;
+            msg << "[" << name_ << "] is not sorted: record " << count_
+                << " (" << e.from << " " << e.to << ") follows ("
+                << last_.from << " " << last_.to << ")";
+            error_ = msg.str();
+            return false;
+          }
+          last_ = e;
+          have_last_ = true;
+        }
+        count_++;
+        return true;
+    }
+};
+
+
+/**
+    Writes edge_records to a binary edge file (or stdout).
+*/
+class edge_writer
+{
+  private:
+    FILE *f_;
+    bool owns_file_;
+    std::vector<edge_record> buffer_;
+    size_t len_;
+    size_t count_;
+    std::string error_;
+
+    edge_writer(const edge_writer &);
+    edge_writer & operator=(const edge_writer &);
+
+  public:
+
+    edge_writer(FILE *f, size_t buffer_bytes = edge_stream_buffer_bytes) :
+          f_(f), owns_file_(false),
+          buffer_(buffer_bytes / sizeof(edge_record) + 1), len_(0),
+          count_(0), error_() {}
+
+    edge_writer(const char *filename,
+          size_t buffer_bytes = edge_stream_buffer_bytes) :
+          f_(fopen(filename, "wb")), owns_file_(true),
+          buffer_(buffer_bytes / sizeof(edge_record) + 1), len_(0),
+          count_(0), error_()
+    {
+        if (f_ == 0)
+          error_ = std::string("[") + filename + "] could not be created";
+    }
+
+    ~edge_writer()
+    {
+        close();
+    }
+
+    bool good() const { return error_.empty(); }
+    const std::string &error() const { return error_; }
+
+    /** number of records written so far */
+    size_t count() const { return count_; }
+
+    void put(const edge_record &e)
+    {
+        buffer_[len_++] = e;
+        count_++;
+        if (len_ == buffer_.size())
+          flush();
+    }
+
+    void put(unsigned int from, unsigned int to)
+    {
+        put(make_edge_record(from, to));
+    }
+
+    void flush()
+    {
+        if (f_ == 0)
+        {
+          len_ = 0;
+          return;
+        }
+        if (len_ > 0 &&
+            fwrite(&buffer_[0], sizeof(edge_record), len_, f_) != len_)
+          error_ = "write failed";
+        len_ = 0;
+        fflush(f_);
+    }
+
+    void close()
+    {
+        flush();
+        if (owns_file_ && f_ != 0)
+          fclose(f_);
+        f_ = 0;
+    }
+};
+
+
+/**
+    Reads edges from a text graph (.g) file: one "from to" or "vertex"
+    per line, skipping comment lines that start with '%' or '#'.
+    Vertex-only lines are returned as (v, no_vertex).
+*/
+class text_edge_reader
+{
+  private:
+    FILE *f_;
+    bool owns_file_;
+    std::vector<char> line_;
+    size_t count_;
+    std::string error_;
+
+    text_edge_reader(const text_edge_reader &);
+    text_edge_reader & operator=(const text_edge_reader &);
+
+  public:
+
+    text_edge_reader(FILE *f) : f_(f), owns_file_(false), line_(4096),
+          count_(0), error_() {}
+
+    text_edge_reader(const char *filename) : f_(fopen(filename, "r")),
+          owns_file_(true), line_(4096), count_(0), error_()
+    {
+        if (f_ == 0)
+          error_ = std::string("[") + filename + "] could not be opened";
+    }
+
+    ~text_edge_reader()
+    {
+        if (owns_file_ && f_ != 0)
+          fclose(f_);
+    }
+
+    bool good() const { return error_.empty(); }
+    const std::string &error() const { return error_; }
+    size_t count() const { return count_; }
+
+    bool next(edge_record &e)
+    {
+        if (f_ == 0)
+          return false;
+
+        while (fgets(&line_[0], line_.size(), f_) != 0)
+        {
+          // discard the remainder of overlong lines
+          if (strchr(&line_[0], '\n') == 0)
+          {
+            int c;
+            while ((c = getc(f_)) != EOF && c != '\n')
+              ;
+          }
+
+          char *p = &line_[0];
+          if (*p == '%' || *p == '#')
+            continue;
+
+          char *end = 0;
+          unsigned long a = strtoul(p, &end, 10);
+          if (end == p)
+            continue;             // blank line
+          p = end;
+          unsigned long b = strtoul(p, &end, 10);
+
+          e.from = (unsigned int) a;
+          e.to = (end == p ? no_vertex : (unsigned int) b);
+          count_++;
+          return true;
+        }
+        return false;
+    }
+};
+
+
+/**
+    Writes edges as a text graph (.g) file.
+*/
+class text_edge_writer
+{
+  private:
+    FILE *f_;
+    size_t count_;
+
+  public:
+    text_edge_writer(FILE *f) : f_(f), count_(0) {}
+
+    size_t count() const { return count_; }
+
+    void put(const edge_record &e)
+    {
+        if (e.is_vertex_only())
+          fprintf(f_, "%u\n", e.from);
+        else
+          fprintf(f_, "%u %u\n", e.from, e.to);
+        count_++;
+    }
+
+    void put(unsigned int from, unsigned int to)
+    {
+        put(make_edge_record(from, to));
+    }
+
+    void flush() { fflush(f_); }
+};
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_EDGE_STREAM_H_
@@ -44,13 +44,16 @@
 #include <set>
 #include <map>
 #include <vector>
+#include "ngraph_stats.hpp"
+#include "ngraph_alloc.hpp"
+#include "dendrogram.hpp"
 
 using namespace std;
 
 // move elements form set B into set A
 //
-template <typename T>
-void absorb(set<T> &A, set<T> &B)
+template <typename T, typename Cmp, typename Alloc>
+void absorb(set<T,Cmp,Alloc> &A, set<T,Cmp,Alloc> &B)
 {
 
     if (&A == &B)
@@ -63,15 +66,22 @@ void absorb(set<T> &A, set<T> &B)
 
 
 
-template <typename T>
+// Alloc is the allocator of the element sets and the maps (rebound to
+// their node types); see ngraph_alloc.hpp.
+//
+template <typename T, typename Alloc = std::allocator<T> >
 class equivalence
 {
   public: 
     typedef T value_type;
     typedef unsigned int index_t;
-    typedef set<T> element_set;
-    typedef typename map<index_t, element_set>::iterator iterator;
-    typedef typename map<index_t, element_set>::const_iterator const_iterator;
+    typedef set<T, less<T>, Alloc> element_set;
+    typedef map<T, index_t, less<T>, typename Alloc::template
+          rebind<pair<const T, index_t> >::other> element_map;
+    typedef map<index_t, element_set, less<index_t>, typename Alloc::template
+          rebind<pair<const index_t, element_set> >::other> class_map;
+    typedef typename class_map::iterator iterator;
+    typedef typename class_map::const_iterator const_iterator;
     
     // this is used to keep an (optional) merge list of classes
     //
@@ -85,20 +95,23 @@ class equivalence
 
     private: 
 
-   map<T, index_t> E_;        // map of element and its equiv
+   element_map E_;            // map of element and its equiv
                               // equivalence class number start at
                               // 1, so if E_[a] == 0 then a is not
                               // in any equivalance class
 
-    map<index_t,  set<T> > S_;      // list of equivalence classes
+    class_map S_;               // list of equivalence classes
     index_t equivalence_class_num_; // counter for new equiv classes
 
     // optional record of initial equivalence indices and merges
     bool recording_;
-    map<T, index_t> E1_;   // first equivalance index on an element
+    element_map E1_;   // first equivalance index on an element
     vector<triplet> M_;    // merges of equivalence classes (indices)
+
+    // optional dendrogram, filled as elements are inserted and merged
+    NGraph::dendrogram<T> *tree_;
          
-    const set<T> empty_set_;
+    const element_set empty_set_;
 
 public:
 
@@ -107,7 +120,7 @@ public:
     const_iterator end() const { return S_.end(); }
 
     equivalence(void): E_(), S_(), equivalence_class_num_(0), 
-          recording_(false), E1_(), M_() {};
+          recording_(false), E1_(), M_(), tree_(0) {};
 
     static const element_set &collection(const_iterator p) 
     {
@@ -127,7 +140,7 @@ public:
 
     unsigned int class_size(unsigned int i) const
     {
-      typename map<index_t, set<T> >::const_iterator  p = S_.find(i);
+      typename class_map::const_iterator  p = S_.find(i);
 
       if (p == S_.end())
         return 0;
@@ -175,7 +188,16 @@ public:
         return M_;
     }
 
-    const map<T, index_t> & original_class_indices() const
+    // record the insertions and merges from now on into D (or stop, if
+    // D is 0); D.set_level() may be called between them, e.g. once per
+    // percolation threshold
+    //
+    void record_dendrogram(NGraph::dendrogram<T> *D)
+    {
+        tree_ = D;
+    }
+
+    const element_map & original_class_indices() const
     {
         return E1_;
     }
@@ -183,7 +205,7 @@ public:
 
      unsigned int index(const T& a) const
      {
-       typename map<T, unsigned int>::const_iterator p = E_.find(a);
+       typename element_map::const_iterator p = E_.find(a);
        return (p== E_.end() ? 0 : p->second);
      }
 
@@ -194,7 +216,7 @@ public:
      }
 
 
-     const set<T>& operator[](unsigned int i) const
+     const element_set& operator[](unsigned int i) const
      {
          if (i==0)
          {
@@ -202,7 +224,7 @@ public:
          }
          else
          {  
-           typename map<index_t, set<T> >::const_iterator p = S_.find(i);
+           typename class_map::const_iterator p = S_.find(i);
            if (p==S_.end())
               return empty_set_;
             else
@@ -226,7 +248,7 @@ public:
 
 
 
-     const set<T>& operator()(const T& a) const
+     const element_set& operator()(const T& a) const
      {
         return  this->operator[](index(a));
      }
@@ -234,6 +256,9 @@ public:
 
     void insert(const T& a)
     {
+        if (tree_)
+          tree_->insert(a);
+
         // if a is not in an equivalence class, create a new one
         if (E_.find(a) == E_.end())
         {
@@ -241,9 +266,10 @@ public:
           E_[a] = i;
           if (recording_)
               E1_[a] = i;
-          set<T> s;
+          element_set s;
           s.insert(a);
           S_[i] = s;
+          ++NGraph::stats::sets_allocated();
         }
     }
 
@@ -261,7 +287,9 @@ public:
     }
     void insert(const T& a, const T& b)
     {
-        
+      if (tree_)
+        tree_->merge(a, b);
+
       // four cases, wether or not a and b are already in equiv classes
 
       unsigned int E_a = E_[a];
@@ -288,18 +316,18 @@ public:
              // b into a:   a <- b 
              //
 
-             set<T> &sa = S_[E_a];
-             set<T> &sb = S_[E_b];
+             element_set &sa = S_[E_a];
+             element_set &sb = S_[E_b];
 
              unsigned int bigger_class_index = 
                 (sa.size() > sb.size() ? E_a : E_b);
              unsigned int smaller_class_index  = 
                   (sa.size() > sb.size() ? E_b : E_a);
 
-             set<T> &bigger_class = (sa.size() > sb.size() ? sa : sb);
-             set<T> &smaller_class = (sa.size() > sb.size() ? sb : sa);
+             element_set &bigger_class = (sa.size() > sb.size() ? sa : sb);
+             element_set &smaller_class = (sa.size() > sb.size() ? sb : sa);
 
-             typename set<T>::const_iterator t = smaller_class.begin(); 
+             typename element_set::const_iterator t = smaller_class.begin(); 
              for (; t !=smaller_class.end(); t++)
              {
                   // cerr << "changing "<< *t << " [" << E_[*t] << "] to " 
@@ -309,6 +337,7 @@ public:
              }
              absorb(bigger_class, smaller_class);
              S_.erase(smaller_class_index);
+             ++NGraph::stats::merges_performed();
    
              if (recording_)
               M_.push_back( make_triplet(smaller_class_index, 
@@ -331,7 +360,7 @@ public:
           else // neither a nor b has one -- so create a new one! 
           {
 
-              set<T> s;
+              element_set s;
               s.insert(a);
               s.insert(b);
               unsigned int i = ++equivalence_class_num_;
@@ -342,6 +371,7 @@ public:
                   E1_[a] = E1_[b] = i;
               }
               S_[i] = s;          // S_[E_[a]] = {a, b}
+              ++NGraph::stats::sets_allocated();
           }
         }
      }
@@ -363,16 +393,16 @@ public:
      }
 };
 
-template <typename T>
-std::ostream & operator<<(std::ostream &s, const equivalence<T> &S)
+template <typename T, typename Alloc>
+std::ostream & operator<<(std::ostream &s, const equivalence<T,Alloc> &S)
 {
-    typedef typename equivalence<T>::element_set  equiv_elm_set;
-    typedef typename equivalence<T>::const_iterator equiv_const_iterator;
+    typedef typename equivalence<T,Alloc>::element_set  equiv_elm_set;
+    typedef typename equivalence<T,Alloc>::const_iterator equiv_const_iterator;
     typedef typename equiv_elm_set::const_iterator equiv_elm_set_const_iterator;
 
     for (equiv_const_iterator p = S.begin(); p!=S.end(); p++)
     {
-          const equiv_elm_set &E = equivalence<T>::collection(p);
+          const equiv_elm_set &E = equivalence<T,Alloc>::collection(p);
           for (equiv_elm_set_const_iterator e = E.begin(); e!=E.end(); e++)
           {
             s << *e << " " ;
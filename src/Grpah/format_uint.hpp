@@ -0,0 +1,53 @@
+#ifndef NGRAPH_FORMAT_UINT_H_
+#define NGRAPH_FORMAT_UINT_H_
+
+/*
+   Decimal formatting of unsigned integers into a character buffer, for
+   the text writers (ngraph_write.hpp, mtx_io.hpp, vertex_map.hpp) that
+   build their output in memory rather than through an ostream.
+*/
+
+#include <cstring>
+#include <stdint.h>
+
+namespace NGraph
+{
+
+/**
+    Format v in decimal at p, two digits at a time, returning the end of
+    the digits.  (At most 20 characters are written.)
+*/
+inline char *format_uint(char *p, uint64_t v)
+{
+    static const char pairs[] =
+        "00010203040506070809101112131415161718192021222324"
+        "25262728293031323334353637383940414243444546474849"
+        "50515253545556575859606162636465666768697071727374"
+        "75767778798081828384858687888990919293949596979899";
+
+    char digits[20];
+    char *q = digits + 20;
+    while (v >= 100)
+    {
+      const unsigned int r = (unsigned int) (v % 100) * 2;
+      v /= 100;
+      *--q = pairs[r + 1];
+      *--q = pairs[r];
+    }
+    if (v >= 10)
+    {
+      *--q = pairs[2 * v + 1];
+      *--q = pairs[2 * v];
+    }
+    else
+      *--q = (char) ('0' + v);
+    const size_t n = digits + 20 - q;
+    memcpy(p, q, n);
+    return p + n;
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_FORMAT_UINT_H_
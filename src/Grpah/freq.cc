@@ -2,36 +2,183 @@
 //
 //  (basically a word frequency)
 //  and prints out the degree and how many times it occured
+//
+//  Words are counted in parallel chunks with a sharded string interner
+//  (see string_intern.hpp); the list is printed in alphabetical order.
+//
+//  Usage:  freq [-d | -k top] [-e error] [-o out.sketch] [file ...]
+//
+//   -d   only print the number of distinct words, estimated in bounded
+//        memory by HyperLogLog (relative error -e, default 0.01)
+//   -k   only print the top most frequent words, "word  count" in
+//        decreasing order of count, estimated by a Count-Min sketch:
+//        counts are over by at most -e (default 0.0001) times the number
+//        of words, with probability 0.99
+//   -o   save the sketch (with -d or -k), to merge with those of other
+//        inputs: inputs named *.sketch are read as saved sketches
+//
+//  The input (stdin if no files are given) is read in blocks, so that
+//  with -d or -k the memory used does not grow with it.
 
 #include <iostream>
 #include <string>
-#include <map>
-
-#define foreach(p,C)   for (p=C.begin(); p!=C.end(); (p)++)
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include "mapped_file.hpp"
+#include "string_intern.hpp"
+#include "sketch.hpp"
+#include "token.hpp"
+#include "ngraph_stats.hpp"
 
 using namespace std;
+using namespace NGraph;
+
+enum freq_mode { exact_mode, distinct_mode, top_mode };
 
-int main()
+int main(int argc, char *argv[])
 {
-   map<string, unsigned int> F;
+   NGraph::stats::parse_options(argc, argv);
 
-   while(cin)
+   freq_mode mode = exact_mode;
+   size_t top = 0;
+   double error_bound = 0.0;
+   const char *sketch_filename = 0;
+   vector<const char *> inputs;
+   bool usage = false;
+
+   for (int i=1; i<argc; i++)
+   {
+     string a(argv[i]);
+     if (a == "-d")
+       mode = distinct_mode;
+     else if (a == "-k" && i+1 < argc)
+     {
+       mode = top_mode;
+       top = atol(argv[++i]);
+     }
+     else if (a == "-e" && i+1 < argc)
+       error_bound = atof(argv[++i]);
+     else if (a == "-o" && i+1 < argc)
+       sketch_filename = argv[++i];
+     else if (a[0] != '-' || a == "-")
+       inputs.push_back(argv[i]);
+     else
+       usage = true;
+   }
+   if (usage || error_bound < 0.0 || (mode == top_mode && top == 0) ||
+         (mode == exact_mode && sketch_filename != 0))
    {
-      string word;
-      cin >> word;
-      if ( word != "")
-        F[word]++;
+     cerr << "Usage: " << argv[0] << " [-d | -k top] [-e error] "
+          << "[-o out.sketch] [file ...]\n";
+     return 1;
    }
+   if (inputs.empty())
+     inputs.push_back("-");
 
+#ifdef _OPENMP
+   const unsigned int num_chunks = omp_get_max_threads();
+#else
+   const unsigned int num_chunks = 1;
+#endif
 
-  // now print out the frequency list
+   // one sketch per thread, merged at the end
+   sharded_string_interner F;
+   vector<hyperloglog> H(mode == distinct_mode ? num_chunks : 0,
+         hyperloglog(hyperloglog::precision_for(
+         error_bound > 0.0 ? error_bound : 0.01)));
+   vector<heavy_hitters<string> > T(mode == top_mode ? num_chunks : 0,
+         heavy_hitters<string>(top, error_bound > 0.0 ? error_bound : 1e-4));
 
-  map<string, unsigned int>::const_iterator p;
-  foreach(p, F)
+   uint64_t position = 0;          // of the block, over all the inputs
+   string error;
+   {
+     stats::scoped_phase phase("count");
+     for (size_t n=0; n<inputs.size(); n++)
+     {
+       if (mode != exact_mode && is_sketch_file(inputs[n]))
+       {
+         const bool ok = (mode == distinct_mode ?
+               merge_sketch(inputs[n], H[0], error) :
+               merge_sketch(inputs[n], T[0], error));
+         if (!ok)
+         {
+           cerr << "Error: " << error << "\n";
+           return 1;
+         }
+         continue;
+       }
+
+       line_block_reader in(inputs[n]);
+       const char *data;
+       size_t size;
+       while (in.next(data, size))
+       {
+         vector<const char *> bounds = line_chunks(data, size, num_chunks);
+#ifdef _OPENMP
+         #pragma omp parallel for schedule(static, 1)
+#endif
+         for (int t=0; t<(int) num_chunks; t++)
+         {
+           str_tokenizer W(str_ref(bounds[t], bounds[t+1] - bounds[t]),
+                 " \t\n\v\f\r");
+           str_ref word;
+           if (mode == exact_mode)
+             while (W.next(word))
+               F.intern(word, position + (word.data - data));
+           else if (mode == distinct_mode)
+             while (W.next(word))
+               H[t].add(NGraph::hash(word));
+           else
+             while (W.next(word))
+               T[t].add(NGraph::hash(word), word);
+         }
+         position += size;
+       }
+       if (!in.good())
+       {
+         cerr << "Error: " << in.error() << "\n";
+         return 1;
+       }
+     }
+
+     if (mode == exact_mode)
+       F.finalize(intern_sorted);
+     for (unsigned int t=1; t<H.size(); t++)
+       H[0].merge(H[t]);
+     for (unsigned int t=1; t<T.size(); t++)
+       T[0].merge(T[t]);
+   }
+
+  if (sketch_filename != 0 && !(mode == distinct_mode ?
+        save_sketch(sketch_filename, H[0]) :
+        save_sketch(sketch_filename, T[0])))
   {
+    cerr << "Error: [" << sketch_filename << "] could not be written\n";
+    return 1;
+  }
 
-    cout << p->first << "  " << p->second << "\n";
+  // now print out the frequency list
+
+  if (mode == distinct_mode)
+  {
+    printf("%.0f\n", H[0].estimate());
+    cerr << "# relative error " << H[0].error() << "\n";
+  }
+  else if (mode == top_mode)
+  {
+    vector<heavy_hitters<string>::item> I = T[0].top();
+    for (size_t i=0; i<I.size() && i<top; i++)
+      cout << I[i].first << "  " << I[i].second << "\n";
+    cerr << "# counts over by at most "
+         << (uint64_t) (T[0].sketch().epsilon() * T[0].sketch().total())
+         << " (of " << T[0].sketch().total() << " words)\n";
   }
+  else
+    for (unsigned int i=0; i<F.size(); i++)
+    {
+      cout << F.str(i) << "  " << F.count(i) << "\n";
+    }
 
-  return 0;
+  return NGraph::stats::finish(0);
 }
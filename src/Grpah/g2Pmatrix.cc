@@ -44,6 +44,8 @@ typedef double conductance_t ;
 
 int main(int argc, char *argv[])
 {
+    NGraph::stats::parse_options(argc, argv);
+
     bool print_matrix = true;
     bool compute_avg_sparsity = false;
     bool compute_avg_conductance = false;
@@ -164,5 +166,5 @@ int main(int argc, char *argv[])
     cerr << "print time   : " << Q_print.read() << " secs\n";
     cerr << "Total time   : " << Q_total.read() << " secs\n";
 
-    return 0;
+    return NGraph::stats::finish(0);
 }
@@ -14,6 +14,7 @@
 
     [degree] [#clusters] [#total_cluster_sizes] [#max_cluster_size] [#vertices]
 
+    For the average over many random orders, see gpercolate.
 
 */
 
@@ -35,6 +36,7 @@ using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
+    NGraph::stats::parse_options(argc, argv);
 
     bool print_distribution = false;
     bool print_clustering = false;
@@ -145,6 +147,6 @@ int main(int argc, char *argv[])
         cout << "\n";
     }
 
-    return 0;
+    return NGraph::stats::finish(0);
       
 }
@@ -5,13 +5,21 @@
 
     Usage:
 
-      cat foo.g | g2Pmetric_level [min-cluster_size] [max-degree]   
+      cat foo.g | g2Pmetric_level [-l] [min-cluster_size] [max-degree]   
 
+      g2Pmetric_level [-l] -d foo.dendro [min-cluster_size] [max-degree...]
 
-    Output:  the clusters, seperaeted by blank links, with one one node per 
-    line.
 
+    Output:  the clusters, seperaeted by blank links, with one one node per 
+    line (or, with -l, one cluster per line).
 
+    With -d, the clusters are cut from the dendrogram saved by g2Ptree -o,
+    rather than recomputed from the graph, so any number of degrees can be
+    queried at the cost of one pass over the vertices each.  Degrees may
+    be given on the command line, or else are read from stdin, one per
+    line; when there is more than one, each degree's clusters are
+    preceded by a "# degree d" line.  Clusters are listed in order of
+    their smallest vertex.
 
 */
 
@@ -23,26 +31,137 @@
 #include <algorithm>
 #include <numeric>
 #include <iomanip>
+#include <cstdio>
+#include <cstdlib>
 #include "ngraph.hpp"
 #include "ngraph_weak.hpp"
+#include "dendrogram.hpp"
 
 
 
 using namespace std;
 using namespace NGraph;
 
-int main(int argc, char *argv[])
+typedef dendrogram<Graph::vertex> Tree;
+
+
+// the clusters of T at the given degree, as g2Pmetric_level prints them
+//
+void print_level(const Tree &T, double degree, unsigned int min_cluster_size,
+      bool line_output)
 {
+    vector<Tree::index_t> label;
+    T.cut(degree, label);
+
+    vector<Tree::index_t> slot(label.size(), Tree::none());
+    vector< vector<Graph::vertex> > clusters;
+    for (size_t i=0; i<label.size(); i++)
+    {
+      if (label[i] == Tree::none())
+        continue;
+      if (slot[label[i]] == Tree::none())
+      {
+        slot[label[i]] = clusters.size();
+        clusters.push_back(vector<Graph::vertex>());
+      }
+      clusters[slot[label[i]]].push_back(T.element(i));
+    }
+    for (size_t c=0; c<clusters.size(); c++)
+      sort(clusters[c].begin(), clusters[c].end());
+    sort(clusters.begin(), clusters.end());
+
+    for (size_t c=0; c<clusters.size(); c++)
+    {
+      const vector<Graph::vertex> &C = clusters[c];
+      if (C.size() < min_cluster_size)
+        continue;
+      for (size_t i=0; i<C.size(); i++)
+        cout << C[i] << (line_output ? " " : "\n");
+      cout << "\n";
+    }
+}
+
+
+int query_dendrogram(const char *filename, unsigned int min_cluster_size,
+      const vector<double> &degrees, bool line_output)
+{
+    Tree T;
+    string error;
+    FILE *f = fopen(filename, "rb");
+    if (f == 0)
+    {
+      cerr << "Error: [" << filename << "] could not be opened\n";
+      return 1;
+    }
+    const bool ok = T.load(f, error);
+    fclose(f);
+    if (!ok)
+    {
+      cerr << "Error: [" << filename << "] " << error << "\n";
+      return 1;
+    }
 
-    if (argc <= 2)
-      exit(1);
+    if (degrees.size() == 1)
+    {
+      print_level(T, degrees[0], min_cluster_size, line_output);
+      return 0;
+    }
+    for (size_t i=0; i<degrees.size(); i++)
+    {
+      cout << "# degree " << degrees[i] << "\n";
+      print_level(T, degrees[i], min_cluster_size, line_output);
+    }
+    if (degrees.empty())
+    {
+      string line;
+      while (getline(cin, line))
+      {
+        if (line.empty())
+          continue;
+        const double d = atof(line.c_str());
+        cout << "# degree " << d << "\n";
+        print_level(T, d, min_cluster_size, line_output);
+        cout.flush();
+      }
+    }
+    return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+    NGraph::stats::parse_options(argc, argv);
 
     bool line_output = false;
+    const char *dendrogram_filename = 0;
     int arg_num = 1;
-    if (string(argv[arg_num]) == "-l")
+    for (; arg_num < argc && argv[arg_num][0] == '-'; arg_num++)
+    {
+        if (string(argv[arg_num]) == "-l")
+          line_output = true;
+        else if (string(argv[arg_num]) == "-d" && arg_num+1 < argc)
+          dendrogram_filename = argv[++arg_num];
+        else
+          break;
+    }
+
+    if (dendrogram_filename && arg_num < argc)
     {
-        line_output = true;
-        arg_num++;
+        const unsigned int min_cluster_size = atoi(argv[arg_num++]);
+        vector<double> degrees;
+        for (; arg_num < argc; arg_num++)
+          degrees.push_back(atof(argv[arg_num]));
+        return NGraph::stats::finish(query_dendrogram(dendrogram_filename,
+              min_cluster_size, degrees, line_output));
+    }
+
+    if (argc - arg_num < 2)
+    {
+      cerr << "Usage: cat foo.g | " << argv[0]
+           << " [-l] min_cluster_size max_degree\n"
+           << "       " << argv[0]
+           << " [-l] -d foo.dendro min_cluster_size [degree ...]\n";
+      return 1;
     }
     const unsigned int min_cluster_size = atoi(argv[arg_num++]);
     const unsigned int degree_level = atoi(argv[arg_num++]);
@@ -68,8 +187,8 @@ int main(int argc, char *argv[])
     set<Graph::vertex> V;
     string input_line;
 
-    for (DegreeList::const_iterator p=D.begin(); (p->first <= degree_level); 
-                p++)
+    for (DegreeList::const_iterator p=D.begin(); 
+                p != D.end() && p->first <= degree_level; p++)
     {
      
         const set<Graph::vertex> &L = p->second;
@@ -107,6 +226,6 @@ int main(int argc, char *argv[])
     }
 
 
-    return 0;
+    return NGraph::stats::finish(0);
       
 }
@@ -14,8 +14,12 @@
 
     Usage: 
 
-       cat foo.g | g2Pmatrix
+       cat foo.g | g2Ptree [-o foo.dendro]
 
+    With -o, the percolation hierarchy (vertices added in order of
+    degree, the level of each merge being the degree) is saved as a
+    dendrogram (see dendrogram.hpp) instead, for g2Pmetric_level -d to
+    cut at any degree without redoing the percolation.
 
 
 */
@@ -28,6 +32,7 @@
 #include <algorithm>
 #include <numeric>
 #include <iomanip>
+#include <cstdio>
 #include "ngraph.hpp"
 #include "ngraph_weak.hpp"
 #include "ngraph_conductance.hpp"
@@ -44,6 +49,16 @@ typedef double conductance_t ;
 
 int main(int argc, char *argv[])
 {
+    NGraph::stats::parse_options(argc, argv);
+
+    const char *dendrogram_filename = 0;
+    if (argc == 3 && string(argv[1]) == "-o")
+      dendrogram_filename = argv[2];
+    else if (argc != 1)
+    {
+      cerr << "Usage: cat foo.g | " << argv[0] << " [-o foo.dendro]\n";
+      return 1;
+    }
 
     Graph G;
     std::cin >> G;
@@ -66,12 +81,17 @@ int main(int argc, char *argv[])
                              // so far (E)
     string input_line;
 
-    E.recording_on();
+    dendrogram<Graph::vertex> T;
+    if (dendrogram_filename)
+      E.record_dendrogram(&T);
+    else
+      E.recording_on();
 
     for (DegreeList::const_iterator p=D.begin(); p!=D.end(); p++)
     {
      
         const set<Graph::vertex> &L = p->second;
+        T.set_level(p->first);
 
         // now find weak component set of this subgraph
 
@@ -79,6 +99,20 @@ int main(int argc, char *argv[])
 
     }
 
+    if (dendrogram_filename)
+    {
+      FILE *f = fopen(dendrogram_filename, "wb");
+      const bool ok = (f != 0 && T.save(f));
+      if (f)
+        fclose(f);
+      if (!ok)
+      {
+        cerr << "Error: [" << dendrogram_filename << "] could not be written\n";
+        return 1;
+      }
+      return NGraph::stats::finish(0);
+    }
+
     // now dump out merges
     typedef vector<Equiv::triplet> Merge_List;
     const Merge_List &M = E.merge_list();
@@ -102,5 +136,5 @@ int main(int argc, char *argv[])
     }
     
 
-    return 0;  
+    return NGraph::stats::finish(0);  
 }
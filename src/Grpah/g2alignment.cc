@@ -22,6 +22,8 @@ using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
+    NGraph::stats::parse_options(argc, argv);
+
     ifstream graph_file;
     graph_file.open(argv[1]);
     if (!graph_file)
@@ -51,6 +53,6 @@ int main(int argc, char *argv[])
      }
 
 
-  return 0;
+  return NGraph::stats::finish(0);
 }
 
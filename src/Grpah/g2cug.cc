@@ -1,5 +1,6 @@
 // Converts a regular '*.g' file into a compact undirected graph.
-// (Stores only (i,j) where i < j and 
+// (Stores only (i,j) where i < j and no self-loops (i,i); a vertex whose
+// only edges were self-loops is kept as a single-number line.)
 
 
 #include <iostream>
@@ -8,9 +9,13 @@
 #include <string>
 #include <cmath>
 #include "ngraph.hpp"
+#include "edge_sort.hpp"
 
 //
-//  Usage g2cug < graph.g  > graph_undirected.g
+//  Usage g2cug [-x [-m MB] [-T dir]] < graph.g  > graph_undirected.g
+//
+//   -x  sort externally, for graphs larger than memory (the output is
+//       the same graph, with edges in sorted order)
 //
 
 using namespace std;
@@ -18,7 +23,30 @@ using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
+  NGraph::stats::parse_options(argc, argv);
+
+  edge_sort_options opt;
+  if (parse_external_sort_options(argc, argv, opt))
+  {
+    opt.undirected = true;
+    opt.remove_self_loops = true;
+    opt.unique = true;
+    external_edge_sorter S(opt);
+    text_edge_reader in(stdin);
+    edge_record e;
+    while (in.next(e))
+      S.add(e);
 
+    text_edge_writer W(stdout);
+    vertex_record_filter<text_edge_writer> F(W);
+    if (!S.finish(F))
+    {
+      cerr << "Error: " << S.error() << "\n";
+      return 1;
+    }
+    W.flush();
+    return 0;
+  }
 
   Graph G;
 
@@ -27,12 +55,14 @@ int main(int argc, char *argv[])
 
   while (G.read_line(std::cin, v1, v2, vertex_only))
   {
-      if (vertex_only)
+      if (vertex_only || v1 == v2)
       {
         G.insert_vertex(v1);
       }
-      else
+      else if (v1 < v2)
         G.insert_edge(v1,v2);
+      else
+        G.insert_edge(v2,v1);
   }
 
   std::cout << G ;
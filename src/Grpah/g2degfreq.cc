@@ -1,12 +1,12 @@
 #include <iostream>
-#include <iomanip>
-#include <algorithm>
 #include <string>
-#include <set>
-#include "ngraph.hpp"
+#include "graph_stats.hpp"
 
 //
-//  Usage a.out [-u] < graph.dat     (-u for undirected)
+//  Usage a.out < graph.dat
+//
+//  Prints one line per degree (in + out), "degree v1 v2 ...", listing
+//  the vertices of that degree.
 //
 
 using namespace std;
@@ -14,37 +14,16 @@ using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
-  Graph A;
-
-  bool undirected = false;
-  if (argv[1])
-  {
-    std::string arg1(argv[1]);
-    undirected = (arg1 == "-u");
-  }
-
-
-  cin >> A;
+  NGraph::stats::parse_options(argc, argv);
 
-  typedef map< unsigned int, set<Graph::vertex> > DegreeList;
-  DegreeList D;
-
-
-  for ( Graph::const_iterator p = A.begin(); p!=A.end(); p++)
-  {
-      D[Graph::in_degree(p) + Graph::out_degree(p)].insert(Graph::node(p));
-  }
-
-  for (DegreeList::iterator d=D.begin(); d!=D.end(); d++)
+  stats_graph S;
+  string error;
+  if (!S.read("-", error))
   {
-    cout << d->first;
-    set<Graph::vertex> &S = d->second;
-    for (set<Graph::vertex>::const_iterator v=S.begin(); v!=S.end(); v++)
-    {
-      cout << " " << *v ;
-    }
-    cout << "\n";
+    cerr << "Error: " << error << "\n";
+    return 1;
   }
 
+  write_degree_classes(cout, S);
+  return 0;
 }
-
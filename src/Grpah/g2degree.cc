@@ -1,20 +1,20 @@
 #include <iostream>
-#include <iomanip>
-#include <algorithm>
 #include <string>
-#include <cmath>
-#include "ngraph.hpp"
+#include "graph_stats.hpp"
 
 //
 //  Usage a.out [-u] < graph.dat     (-u for undirected)
 //
+//  Prints " vertex in-degree out-degree" (" vertex degree" with -u) for
+//  each vertex; see gstats for more statistics from the same read.
+//
 
 using namespace std;
 using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
-  Graph A;
+  NGraph::stats::parse_options(argc, argv);
 
   bool undirected = false;
   if (argv[1])
@@ -23,24 +23,14 @@ int main(int argc, char *argv[])
     undirected = (arg1 == "-u");
   }
 
-  cin >> A;
-
-  for ( Graph::const_iterator p = A.begin(); p!=A.end(); p++)
+  stats_graph S;
+  string error;
+  if (!S.read("-", error))
   {
-      std::cout <<  std::left << " "  <<  Graph::node(p) ;
-
-      if (undirected)
-      {
-         std::cout <<  " " << Graph::in_degree(p); 
-      }
-      else
-      {
-         std::cout <<  " " << Graph::in_degree(p)
-            << " " <<  Graph::out_degree(p) ;
-      }
-      cout  << "\n";
-      std::cout.flush();
+    cerr << "Error: " << error << "\n";
+    return 1;
   }
 
+  write_degrees(cout, S, undirected);
+  return 0;
 }
-
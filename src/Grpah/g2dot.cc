@@ -21,6 +21,7 @@ digraph G {
 #include <algorithm>
 #include <string>
 #include <cmath>
+#include <cstdio>
 #include "ngraph.hpp"
 
 //
@@ -32,6 +33,7 @@ using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
+  NGraph::stats::parse_options(argc, argv);
 
   Graph G;
 
@@ -39,32 +41,16 @@ int main(int argc, char *argv[])
   // read in graph, recording only (i,j), where i <= j
 
 
-  // now write out graph in GraphViz format
+  // now write out graph in GraphViz format (isolated vertices, if
+  // any, first)
 
-  cout << "digraph G{\n";
-
-  // list out isolated vertices, if any
-
-  for (Graph::const_iterator p = G.begin(); p != G.end(); p++)
-  {
-      if (Graph::out_neighbors(p).size() == 0  &&
-          Graph::in_neighbors(p).size() == 0)
-      {
-        cout << Graph::node(p) << ";\n";
-      }
-  }
-  for (Graph::const_iterator p = G.begin(); p != G.end(); p++)
+  string error;
+  if (!write_graph(stdout, G, write_options(dot_format), error))
   {
-      const Graph::vertex_set &out = Graph::out_neighbors(p);
-      Graph::vertex from = Graph::node(p);
-      for (Graph::vertex_set::const_iterator q = out.begin();
-                  q != out.end(); q++)
-      {
-           cout << from << "->" << *q << " ;\n";
-      }
+    cerr << "Error: " << error << "\n";
+    return 1;
   }
-  cout << "}\n";
 
-  return 0;
+  return NGraph::stats::finish(0);
 }
 
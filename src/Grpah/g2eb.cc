@@ -0,0 +1,68 @@
+//
+// Converts a text graph (.g) into a binary edge file (.eb), the input
+// format of the streaming (-b) modes of gunion, gintersect, gminus and
+// gsymm_diff.
+//
+// Usage:  cat graph.g | g2eb [-s] > graph.eb
+//
+//   -s  sort the edges and remove duplicates (in memory; use gsort for
+//       graphs larger than memory)
+//
+// Isolated vertices (single-number lines) are kept as (v, no_vertex)
+// records.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "edge_stream.hpp"
+#include "ngraph_stats.hpp"
+
+using namespace std;
+using namespace NGraph;
+
+int main(int argc, char *argv[])
+{
+  NGraph::stats::parse_options(argc, argv);
+
+  bool sort_edges = (argc > 1 && string(argv[1]) == "-s");
+
+  text_edge_reader in(stdin);
+  edge_writer out(stdout);
+  edge_record e;
+
+  if (!sort_edges)
+  {
+    stats::scoped_phase phase("convert");
+    while (in.next(e))
+      out.put(e);
+  }
+  else
+  {
+    vector<edge_record> E;
+    {
+      stats::scoped_phase phase("read");
+      while (in.next(e))
+        E.push_back(e);
+    }
+    {
+      stats::scoped_phase phase("sort");
+      sort(E.begin(), E.end());
+      E.erase(unique(E.begin(), E.end()), E.end());
+    }
+    stats::scoped_phase phase("write");
+    for (size_t i=0; i<E.size(); i++)
+      out.put(E[i]);
+  }
+  stats::edges_read() += in.count();
+  stats::edges_written() += out.count();
+
+  out.flush();
+  if (!out.good())
+  {
+    cerr << "Error: " << out.error() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -1,60 +1,171 @@
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
-#include <map>
-#include "ngraph.hpp"
+#include <vector>
+#include <cstdio>
+#include "vertex_map.hpp"
+#include "ngraph_stats.hpp"
 
 /*
     convert a general integer graph file into a contigous 0-based
     graph.
 
-   -t option displays the table (mapping) rather than the graph
+    Usage:  g2g0 [-t] < foo.g > foo.g0
+            g2g0 foo.g0 foo.imap0 < foo.g
+
+   -t option displays the table (mapping) rather than the graph; with
+   two filenames, the graph and the table are written to them.
+
+   Vertices are numbered in increasing order; the graph is written
+   sorted, without duplicate edges.  The table lists "vertex 0-based"
+   pairs, as mi0_2mi and renumber expect.
 
 */
 
 using namespace std;
 using namespace NGraph;
 
-int main(int argc, char *argv[])
+typedef vertex_map::vertex vertex;
+
+// edges as (from << 32 | to) keys, and vertex-only lines
+//
+static void read_edges(const char *data, size_t size, vector<uint64_t> &E,
+      vector<uint64_t> &S)
 {
+#ifdef _OPENMP
+    const unsigned int num_chunks = omp_get_max_threads();
+#else
+    const unsigned int num_chunks = 1;
+#endif
+    vector<const char *> bounds = line_chunks(data, size, num_chunks);
+    vector<vector<uint64_t> > CE(num_chunks), CS(num_chunks);
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1)
+#endif
+    for (int c=0; c<(int) num_chunks; c++)
+    {
+      const char *p = bounds[c];
+      const char *end = bounds[c+1];
+      while (p < end)
+      {
+        uint64_t a, b;
+        if (*p != '%' && *p != '#' && mtx_parse_uint(p, end, a) &&
+            a < vertex_map::no_vertex)
+        {
+          if (mtx_parse_uint(p, end, b) && b < vertex_map::no_vertex)
+            CE[c].push_back((a << 32) | b);
+          else
+            CS[c].push_back(a);
+        }
+        mtx_skip_line(p, end);
+      }
+    }
 
-    if (argc ==2 && string(argv[1]) == "-h")
+    for (unsigned int c=0; c<num_chunks; c++)
     {
-        cerr << "Usage: " << argv[0] << " outfiename.g0 outfilename.imap0 \n";
-        exit(1);
+      E.insert(E.end(), CE[c].begin(), CE[c].end());
+      S.insert(S.end(), CS[c].begin(), CS[c].end());
+      vector<uint64_t>().swap(CE[c]);
+      vector<uint64_t>().swap(CS[c]);
     }
-   
+    stats::edges_read() += E.size() + S.size();
+}
 
-    Graph G;
 
-    cin >> G;
+static void sort_unique(vector<uint64_t> &K)
+{
+    vector<uint64_t> tmp(K.size());
+    if (!K.empty())
+      radix_sort(&K[0], &tmp[0], K.size());
+    K.erase(unique(K.begin(), K.end()), K.end());
+}
 
-    typedef map<Graph::vertex, Graph::vertex> imap;
-  
-    imap M;
 
-    for (Graph::const_iterator p = G.begin(); p!=G.end(); p++)
+static void write_graph(FILE *f, const vector<uint64_t> &E)
+{
+    stats::scoped_phase phase("write");
+    char buf[64];
+    for (size_t i=0; i<E.size(); i++)
     {
-      M[Graph::node(p)] = 0;
+      char *p = format_uint(buf, E[i] >> 32);
+      *p++ = ' ';
+      p = format_uint(p, E[i] & 0xFFFFFFFFUL);
+      *p++ = '\n';
+      fwrite(buf, 1, p - buf, f);
+    }
+    stats::edges_written() += E.size();
+}
+
+
+int main(int argc, char *argv[])
+{
+    NGraph::stats::parse_options(argc, argv);
+
+    bool table = (argc == 2 && string(argv[1]) == "-t");
+
+    if ((argc == 2 && !table) || argc > 3)
+    {
+        cerr << "Usage: " << argv[0] << " [-t] < foo.g > foo.g0\n"
+             << "       " << argv[0] << " outfilename.g0 outfilename.imap0"
+             << " < foo.g\n";
+        return 1;
+    }
+
+    mapped_file in("-");
+    vector<uint64_t> E, V;
+    {
+      stats::scoped_phase phase("read");
+      read_edges(in.data(), in.size(), E, V);
     }
 
     // now start numbering the nodes of G as 0,1,2, ...
-    Graph::vertex count = 0;
-    for (imap::iterator p = M.begin(); p!=M.end(); p++)
+    vertex_map M;
     {
-        p->second = count++;
+      stats::scoped_phase phase("number");
+      V.reserve(V.size() + 2 * E.size());
+      for (size_t i=0; i<E.size(); i++)
+      {
+        V.push_back(E[i] >> 32);
+        V.push_back(E[i] & 0xFFFFFFFFUL);
+      }
+      sort_unique(V);
+      M.compact(vector<vertex>(V.begin(), V.end()));
     }
 
-      for (Graph::const_iterator p = G.begin(); p!=G.end(); p++)
+    if (table)
+    {
+      M.write_text(stdout);
+      return 0;
+    }
+
+    {
+      stats::scoped_phase phase("remap");
+#ifdef _OPENMP
+      #pragma omp parallel for schedule(static)
+#endif
+      for (long i=0; i<(long) E.size(); i++)
+        E[i] = ((uint64_t) M.find(E[i] >> 32) << 32) |
+                M.find(E[i] & 0xFFFFFFFFUL);
+      sort_unique(E);
+    }
+
+    if (argc == 3)
+    {
+      FILE *g = fopen(argv[1], "w");
+      FILE *m = fopen(argv[2], "w");
+      if (g == 0 || m == 0)
       {
-         Graph::vertex to = M[Graph::node(p)];
-         for (Graph::const_vertex_iterator e=Graph::out_begin(p); 
-                  e != Graph::out_end(p); e++)
-         {
-            cout << to << " " << M[Graph::node(e)] << "\n";
-         }
+        cerr << "Error: could not open [" << (g == 0 ? argv[1] : argv[2])
+             << "]\n";
+        return 1;
       }
+      write_graph(g, E);
+      M.write_text(m);
+      fclose(g);
+      fclose(m);
+    }
+    else
+      write_graph(stdout, E);
 
     return 0;
 }
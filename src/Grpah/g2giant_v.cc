@@ -1,73 +1,77 @@
 #include <iostream>
 #include <string>
-#include <set>
-#include "set_ops.hpp"
-#include "ngraph.hpp"
-#include "ngraph_components.hpp"
-#include "equivalence.hpp"
+#include <vector>
+#include "ngraph_static.hpp"
+#include "ngraph_static_io.hpp"
+#include "ngraph_bfs.hpp"
 
 /*
     Extract largest weakly connected componnent out of grahp.
 
-    Usage:  cat graph.g | g2giant_component > graph.v
+    Usage:  cat graph.g | g2giant_v > graph.v
+            g2giant_v graph.csr > graph.v
+
+    Components are found by repeated breadth-first search of the
+    undirected graph (ngraph_bfs.hpp), each search skipping the vertices
+    already reached; vertex numbers not used in the graph are ignored.
 
 */
 
 using namespace std;
 using namespace NGraph;
 
+typedef unsigned int vertex;
+
 int main(int argc, char *argv[])
 {
-   Graph G;
-   bool verbose = false;
-   bool line_verbose = false;
-   bool print_largest = false;
-
-  typedef unsigned int uInt;
-
-   if (argc > 1)
-   {
-      std::string arg1(argv[1]);
-      verbose = (arg1 == "-v");
-      line_verbose = (arg1 == "-lv" || arg1 == "-lv");
-      print_largest = (arg1 == "-b");
-   }
-
-   cin >> G;
-
-   // Now find number of connected components
-
-   typedef equivalence<Graph::vertex> equiv;
-   equiv E = components(G);
+  NGraph::stats::parse_options(argc, argv);
 
+  const char *filename = "-";
+  for (int i=1; i<argc; i++)
+    if (argv[i][0] != '-' || string(argv[i]) == "-")
+      filename = argv[i];
 
+  static_tGraph<vertex> G;
+  vector<char> present;
+  string error;
+  {
+    stats::scoped_phase phase("read");
+    if (!read_static_graph(filename, G, error, &present))
+    {
+      cerr << "Error: " << error << "\n";
+      return 1;
+    }
+    G = undirected_graph(G);
+  }
 
-   // Find the largest componnent (equivalence class)
-
-   uInt max_index  = 0;
-   uInt max = 0;
-   for (uInt i=0; i<E.num_classes(); i++)
-   {
-      if (E.class_size(i) > max)
-      {
-          max = E.class_size(i);
-          max_index = i;
-      }
-   }
-
-  // Now E has the equivalence class of graph nodes that correspond to
-  // connected graphs. The size of each partition denotes how many 
-  // vertices it has. Then, we use the subgraph_size() method to find
-  // out how many edges are in each connecgted component.
-  //
+  // one search per component, keeping the largest (the first found on
+  // ties, i.e. the one with the smallest vertex)
 
-  const set<Graph::vertex> &e = E[max_index];
-  typedef set<Graph::vertex>::const_iterator iter;
-  for (iter p=e.begin(); p!=e.end(); p++)
+  const vertex n = G.num_vertices();
+  bfs_engine<vertex> B(G);
+  vertex giant = 0;
+  size_t giant_size = 0;
+  B.reset();
+  for (vertex v=0; v<n; v++)
   {
-      cout << *p << " ";
+    if (!present[v] || B.reached(v))
+      continue;
+    size_t s = B.run(v, 0, false);
+    if (s > giant_size)
+    {
+      giant_size = s;
+      giant = v;
+    }
   }
- cout << "\n";
+
+  if (giant_size > 0)
+    B.run(giant, 0);
+
+  stats::scoped_phase phase("write");
+  for (vertex v=0; v<n; v++)
+    if (present[v] && B.reached(v))
+      cout << v << " ";
+  cout << "\n";
 
   return 0;
 }
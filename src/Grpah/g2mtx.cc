@@ -1,52 +1,107 @@
-// Converts a regular '*.g' file into a compact undirected graph.
-// (Stores only (i,j) where i < j and does not store (i,i)
-
-
-#include <iostream>
-#include <iomanip>
-#include <algorithm>
-#include <string>
-#include <cmath>
-#include "nigraph.cc"
-
+// Converts a regular '*.g' file into a MatrixMarket file, storing the
+// graph as a symmetric pattern matrix (only (i,j) with i >= j).
+//
+//  Usage g2mtx [-m MB] [-T dir] < graph.g > graph.mtx
 //
-//  Usage a.out < graph.g    
+// Edges are sorted and deduplicated externally (see edge_sort.hpp), so
+// the graph need not fit in memory.  Vertex ids are used as the (1-based)
+// MatrixMarket indices, as mtx2g reads them back; if the graph contains
+// vertex 0, all ids are shifted up by one.
 //
 
+#include <iostream>
+#include <cstdio>
+#include "edge_sort.hpp"
+#include "mtx_io.hpp"
+#include "ngraph_stats.hpp"
+
 using namespace std;
+using namespace NGraph;
+
 
-template <class T>
-T max(T x1, T x2, T x3)
+// collects the sorted edges, keeping track of the largest vertex id
+//
+class extent_sink
 {
-  T max1 =  (x1 > x2) ? x1 : x2;
-  return (max1 > x3) ?  max1 : x3;
-  
-}
+  public:
+    edge_writer &out;
+    unsigned int max_vertex;
+    bool has_zero;
+
+    extent_sink(edge_writer &W) : out(W), max_vertex(0), has_zero(false) {}
+
+    void put(const edge_record &e)
+    {
+        unsigned int hi = (e.is_vertex_only() ? e.from : e.to);
+        if (hi > max_vertex)
+          max_vertex = hi;
+        if (e.from == 0)
+          has_zero = true;
+        if (!e.is_vertex_only())
+          out.put(e);
+    }
+};
 
 
 int main(int argc, char *argv[])
 {
+  NGraph::stats::parse_options(argc, argv);
 
+  edge_sort_options opt;
+  parse_external_sort_options(argc, argv, opt);
+  opt.undirected = true;
+  opt.unique = true;
 
-  Graph A;
-  int max_node = 0;
+  external_edge_sorter S(opt);
+  {
+    stats::scoped_phase phase("sort");
+    text_edge_reader in(stdin);
+    edge_record e;
+    while (in.next(e))
+      S.add(e);
+  }
 
-  while (!std::cin.eof())
+  // the header needs the number of entries, so the sorted edges are
+  // staged in a temporary file
+  FILE *tmp = tmpfile();
+  if (tmp == 0)
+  {
+    cerr << "Error: could not create a temporary file.\n";
+    return 1;
+  }
+  edge_writer W(tmp);
+  extent_sink X(W);
+  if (!S.finish(X))
   {
-     int v1, v2;
+    cerr << "Error: " << S.error() << "\n";
+    return 1;
+  }
+  W.flush();
+  rewind(tmp);
 
-     std::cin >> v1 >> v2;
-     if (v1 >= v2)
-      A.insert_edge(v1, v2);
-     else 
-      A.insert_edge(v2, v1);
+  const unsigned int shift = (X.has_zero ? 1 : 0);
 
-    max_node = max( max_node, v1, v2);
-  }
+  mtx_header h;
+  h.symmetry = mtx_symmetric;
+  h.rows = h.cols = X.max_vertex + shift;
+  h.entries = W.count();
 
- std::cout << "%%MatrixMarket matrix coordinate pattern symmetric\n";
- std::cout << max_node << "  " << max_node << " " << A.num_edges() << "\n";
- std::cout << A << "\n";
+  {
+    stats::scoped_phase phase("write");
+    mtx_writer M(stdout, h);
+    edge_reader R(tmp);
+    edge_record e;
+    while (R.next(e))
+      M.put((uint64_t) e.to + shift, (uint64_t) e.from + shift);
+    M.flush();
+    stats::edges_written() += M.count();
+    if (!W.good() || !R.good() || !M.good())
+    {
+      cerr << "Error: could not write the matrix.\n";
+      return 1;
+    }
+  }
+  fclose(tmp);
 
+  return 0;
 }
-
@@ -45,6 +45,8 @@ inline UInt random(UInt low, UInt high)
 
 int main(int argc, char *argv[])
 {
+  NGraph::stats::parse_options(argc, argv);
+
   bool print_timing = false;
   if (argc > 1)
   {
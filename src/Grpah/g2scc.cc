@@ -1,8 +1,9 @@
 #include <iostream>
 #include "ngraph_scc.cc"
 
-int main()
+int main(int argc, char *argv[])
 {
+    NGraph::stats::parse_options(argc, argv);
 
     Graph G;
 
@@ -10,6 +11,7 @@ int main()
 
 //    std::cout << "Graph: \n" << G << "\n";
 
+    NGraph::stats::scoped_phase phase("compute");
     SCC SCC_G(G);
 
 #if 0
@@ -20,6 +22,6 @@ int main()
     }
 #endif
 
-    return 0;
+    return NGraph::stats::finish(0);
 }
 
@@ -26,21 +26,20 @@ optonal labels) are listed first, followed by a '#', then edge list.
 #include <string>
 #include <map>
 #include <set>
+#include <cstdio>
 #include "ngraph.hpp"
 
 using namespace std;
 using namespace NGraph;
 
-typedef map<unsigned int, string> node_label_array;
-typedef Graph::const_iterator const_node_iterator;
-typedef Graph::vertex_set  vertex_set;
 
 int main(int argc, char *argv[])
 {
+  NGraph::stats::parse_options(argc, argv);
 
   typedef unsigned int uInt;
   bool node_labels  = false;
-  node_label_array M;
+  vertex_labels M;
 
   if (argc > 1)
     node_labels = true;
@@ -73,66 +72,17 @@ int main(int argc, char *argv[])
 
   cin >> G;
 
-  if (node_labels)
-  {
-		 for (const_node_iterator p=G.begin(); p!=G.end(); p++)
-		  {
-		      Graph::vertex v = Graph::node(p);
-		      node_label_array::const_iterator L = M.find(v);
-		      if ( L != M.end())
-		          cout << v << " " << L->second  << "\n";
-		      else
-		          cout << v <<  "\n";
-		  }
-	}
-  else
-  {
-		 for (const_node_iterator p=G.begin(); p!=G.end(); p++)
-		  {
-		      Graph::vertex v = Graph::node(p);
-		       cout << v <<  " " << v << "\n";
-		  }
-  }
-
-  cout << "#\n";
-
-#if 0
-  for (const_node_iterator p=G.begin(); p!=G.end(); p++)
-  {
-      Graph::vertex this_node = Graph::node(p);
-      vertex_set E  = Graph::out_neighbors(p);
-
-      if (E.size() > 0)
-      {
-        for (vertex_set::const_iterator q = E.begin(); q!=E.end(); q++)
-        {
-           cout << this_node << " " << *q << "\n";
-        }
-      }
-  }
-#endif
-
-  // modified version of  cout << G, where we don't print out 
-  // isolated nodes.  (These are already accounted for in the TGF
-  // node delcaration portion of the output file.
-
-  //cout << G;
+  // vertices (with their labels, if given, else their number), "#",
+  // then the edges
 
-  for (Graph::const_node_iterator p=G.begin(); p != G.end(); p++)
+  string error;
+  if (!write_graph(stdout, G, write_options(tgf_format,
+        node_labels ? &M : 0), error))
   {
-    const Graph::vertex_set &out = Graph::out_neighbors(p);
-    Graph::vertex v = p->first;
-
-    // if not isolated node..
-    //
-    if (!(out.size() == 0 && Graph::in_neighbors(p).size() == 0))
-    {
-       for (Graph::vertex_set::const_iterator q=out.begin();
-                q!=out.end(); q++)
-           cout << v << " " << *q << "\n";
-    }
+    cerr << "Error: " << error << "\n";
+    return 1;
   }
 
-  return 0;
+  return NGraph::stats::finish(0);
 }
 
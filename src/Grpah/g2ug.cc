@@ -8,9 +8,12 @@
 #include <string>
 #include <cmath>
 #include "ngraph.hpp"
+#include "edge_sort.hpp"
 
 //
-//  Usage a.out < graph.g    
+//  Usage a.out [-x [-m MB] [-T dir]] < graph.g    
+//
+//   -x  symmetrize by sorting externally, for graphs larger than memory
 //
 
 using namespace std;
@@ -18,7 +21,29 @@ using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
+  NGraph::stats::parse_options(argc, argv);
+
+  edge_sort_options opt;
+  if (parse_external_sort_options(argc, argv, opt))
+  {
+    opt.symmetrize = true;
+    opt.unique = true;
+    external_edge_sorter S(opt);
+    text_edge_reader in(stdin);
+    edge_record e;
+    while (in.next(e))
+      if (!e.is_vertex_only())
+        S.add(e);
 
+    text_edge_writer W(stdout);
+    if (!S.finish(W))
+    {
+      cerr << "Error: " << S.error() << "\n";
+      return 1;
+    }
+    W.flush();
+    return NGraph::stats::finish(0);
+  }
 
   Graph A;
 
@@ -48,6 +48,7 @@ using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
+   NGraph::stats::parse_options(argc, argv);
 
    if (argc < 2)
     {
@@ -103,6 +104,6 @@ int main(int argc, char *argv[])
         cout << "\n";
     }
 
-    return 0;
+    return NGraph::stats::finish(0);
       
 }
@@ -0,0 +1,932 @@
+//
+// gbench: time the core NGraph operations on generated graphs of
+// increasing size and degree skew, for each available graph
+// representation, and report the results as JSON.
+//
+// Usage:  gbench [-n min_log2] [-N max_log2] [-d avg_degree] [-r reps]
+//                [-o op1,op2,...] [-b baseline.json] [-t tolerance]
+//                > results.json
+//
+//    -n, -N    range of graph sizes, as log2(num_vertices) (default 10..14,
+//              in steps of 2)
+//    -d        average out-degree of the generated graphs (default 8)
+//    -r        repetitions per measurement; the fastest is reported
+//              (default 3)
+//    -o        only run the listed operations (default: all)
+//    -b        compare against a previous gbench JSON output; prints a
+//              comparison table to stderr and exits with status 2 if any
+//              operation is slower than the baseline by more than the
+//              tolerance
+//    -t        relative tolerance for -b (default 0.10, i.e. 10%)
+//
+// Each graph size is generated with three degree distributions: uniform
+// (Erdos-Renyi) and two power-law (Chung-Lu) graphs with exponents 2.5
+// and 2.1.  The generator is deterministic, so runs are comparable across
+// machines and builds.
+//
+// For every measurement the output records elapsed time, edges/sec, the
+// number and size of heap allocations, the peak live heap during the
+// operation, and the peak resident set size of the process so far.
+//
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+#include <stdint.h>
+#include <sys/resource.h>
+#include "ngraph.hpp"
+#include "pagerank.hpp"
+#include "ngraph_components.hpp"
+#include "ngraph_conductance.hpp"
+#include "ngraph_cluster_coeff.cc"
+#include "ngraph_scc.cc"
+#include "ngraph_static.hpp"
+#include "mtx_io.hpp"
+#include "reorder.hpp"
+#include "ngraph_concurrent.hpp"
+#include "tnt_stopwatch.h"
+
+using namespace std;
+using namespace NGraph;
+
+typedef unsigned int UInt;
+
+// ---------------------------------------------------------------------
+//  heap allocation accounting
+//
+//  Every allocation carries a small header with its size, so that the
+//  live heap (and its peak) can be tracked across operator delete.  The
+//  counters are updated atomically, since some of the operations
+//  allocate from several threads.
+// ---------------------------------------------------------------------
+
+static size_t alloc_count_ = 0;
+static size_t alloc_bytes_ = 0;
+static size_t live_bytes_ = 0;
+static size_t peak_live_bytes_ = 0;
+
+static const size_t alloc_header_ = 16;    // keeps malloc alignment
+
+static void *counted_malloc(size_t n)
+{
+    char *p = (char *) malloc(n + alloc_header_);
+    if (p == 0)
+      throw std::bad_alloc();
+    *((size_t *) p) = n;
+    __sync_fetch_and_add(&alloc_count_, 1);
+    __sync_fetch_and_add(&alloc_bytes_, n);
+    const size_t live = __sync_add_and_fetch(&live_bytes_, n);
+    size_t peak = peak_live_bytes_;
+    while (live > peak)
+    {
+      const size_t seen = __sync_val_compare_and_swap(&peak_live_bytes_,
+            peak, live);
+      if (seen == peak)
+        break;
+      peak = seen;
+    }
+    return p + alloc_header_;
+}
+
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+static void counted_free(void *q)
+{
+    if (q == 0)
+      return;
+    char *p = ((char *) q) - alloc_header_;
+    __sync_fetch_and_sub(&live_bytes_, *((size_t *) p));
+    free(p);
+}
+
+#if __cplusplus >= 201103L
+void *operator new(size_t n) { return counted_malloc(n); }
+void *operator new[](size_t n) { return counted_malloc(n); }
+void operator delete(void *p) noexcept { counted_free(p); }
+void operator delete[](void *p) noexcept { counted_free(p); }
+#else
+void *operator new(size_t n) throw(std::bad_alloc)
+{
+    return counted_malloc(n);
+}
+void *operator new[](size_t n) throw(std::bad_alloc)
+{
+    return counted_malloc(n);
+}
+void operator delete(void *p) throw() { counted_free(p); }
+void operator delete[](void *p) throw() { counted_free(p); }
+#endif
+
+
+static long peak_rss_kb()
+{
+    struct rusage r;
+    getrusage(RUSAGE_SELF, &r);
+    return r.ru_maxrss;         // kilobytes on Linux
+}
+
+
+// ---------------------------------------------------------------------
+//  deterministic graph generation
+// ---------------------------------------------------------------------
+
+// xorshift64* : small, fast, and identical on every platform (unlike
+// rand()), so that generated graphs are reproducible.
+//
+class bench_rng
+{
+  private:
+    uint64_t s_;
+
+  public:
+    bench_rng(uint64_t seed) : s_(seed ? seed : 0x9E3779B97F4A7C15UL) {}
+
+    uint64_t next()
+    {
+        s_ ^= s_ >> 12;
+        s_ ^= s_ << 25;
+        s_ ^= s_ >> 27;
+        return s_ * 2685821657736338717UL;
+    }
+
+    // uniform in [0,1)
+    double uniform()
+    {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // uniform in [0,n)
+    UInt operator()(UInt n)
+    {
+        return (UInt) (uniform() * n);
+    }
+};
+
+typedef pair<UInt,UInt> Edge;
+
+//
+// skew == 0 generates a uniform (Erdos-Renyi) graph; otherwise skew is
+// the exponent of a power-law degree distribution (Chung-Lu model),
+// where vertex i gets weight (i+1)^(-1/(skew-1)).
+//
+static void generate_edges(UInt n, UInt m, double skew, uint64_t seed,
+      vector<Edge> &E)
+{
+    bench_rng rng(seed);
+    E.clear();
+    E.reserve(m);
+
+    if (skew == 0.0)
+    {
+      for (UInt i=0; i<m; i++)
+      {
+          UInt a = rng(n);
+          UInt b = rng(n);
+          E.push_back(Edge(a,b));
+      }
+      return;
+    }
+
+    vector<double> cumulative(n);
+    double exponent = -1.0 / (skew - 1.0);
+    double sum = 0.0;
+    for (UInt i=0; i<n; i++)
+    {
+        sum += pow((double) (i+1), exponent);
+        cumulative[i] = sum;
+    }
+
+    for (UInt i=0; i<m; i++)
+    {
+        UInt a = lower_bound(cumulative.begin(), cumulative.end(),
+                    rng.uniform() * sum) - cumulative.begin();
+        UInt b = lower_bound(cumulative.begin(), cumulative.end(),
+                    rng.uniform() * sum) - cumulative.begin();
+        if (a >= n) a = n-1;
+        if (b >= n) b = n-1;
+        E.push_back(Edge(a,b));
+    }
+}
+
+
+// ---------------------------------------------------------------------
+//  measurements
+// ---------------------------------------------------------------------
+
+struct bench_result
+{
+    string op;
+    string rep;
+    string skew;
+    UInt log2_n;
+    UInt num_vertices;
+    UInt num_edges;
+    double seconds;
+    double edges_per_sec;
+    size_t allocs;
+    size_t alloc_bytes;
+    size_t heap_peak_bytes;
+    long rss_peak_kb;
+};
+
+
+struct bench_config
+{
+    UInt min_log2;
+    UInt max_log2;
+    UInt degree;
+    UInt reps;
+    set<string> ops;    // empty means all
+
+    bool selected(const string &op) const
+    {
+        return ops.empty() || ops.count(op) > 0;
+    }
+};
+
+
+//
+// Records one repetition of an operation.  Construct it immediately
+// before the timed code, and call stop() immediately after.
+//
+class bench_probe
+{
+  private:
+    TNT::Stopwatch Q_;
+    size_t count0_, bytes0_;
+
+  public:
+    size_t allocs, bytes, heap_peak;
+    double seconds;
+
+    bench_probe() : Q_(TNT::wall_seconds), count0_(alloc_count_),
+          bytes0_(alloc_bytes_), allocs(0), bytes(0), heap_peak(0),
+          seconds(0.0)
+    {
+        peak_live_bytes_ = live_bytes_;
+        heap_peak = live_bytes_;
+        Q_.start();
+    }
+
+    void stop()
+    {
+        seconds = Q_.stop();
+        allocs = alloc_count_ - count0_;
+        bytes = alloc_bytes_ - bytes0_;
+        heap_peak = peak_live_bytes_ - heap_peak;
+    }
+};
+
+
+static void record(vector<bench_result> &R, const string &op,
+      const string &rep, const string &skew, UInt log2_n, UInt n, UInt m,
+      const vector<bench_probe> &probes, double work)
+{
+    // report the fastest repetition
+    UInt best = 0;
+    for (UInt i=1; i<probes.size(); i++)
+      if (probes[i].seconds < probes[best].seconds)
+        best = i;
+
+    const bench_probe &p = probes[best];
+
+    bench_result r;
+    r.op = op;
+    r.rep = rep;
+    r.skew = skew;
+    r.log2_n = log2_n;
+    r.num_vertices = n;
+    r.num_edges = m;
+    r.seconds = p.seconds;
+    r.edges_per_sec = (p.seconds > 0.0 ? work / p.seconds : 0.0);
+    r.allocs = p.allocs;
+    r.alloc_bytes = p.bytes;
+    r.heap_peak_bytes = p.heap_peak;
+    r.rss_peak_kb = peak_rss_kb();
+    R.push_back(r);
+
+    cerr << setw(14) << op << " " << setw(8) << rep << " 2^" << setw(2)
+         << log2_n << " " << setw(8) << skew << " " << setw(12)
+         << p.seconds << " s\n";
+}
+
+
+//
+// The suite is written against the generic graph interface, so that
+// each representation is measured by the same code.
+//
+template <class GraphT>
+void run_suite(const string &rep, const bench_config &C,
+      vector<bench_result> &R)
+{
+    static const double skews[] = { 0.0, 2.5, 2.1 };
+    static const char *skew_names[] = { "uniform", "pl2.5", "pl2.1" };
+    const UInt num_skews = sizeof(skews) / sizeof(skews[0]);
+
+    for (UInt lg = C.min_log2; lg <= C.max_log2; lg += 2)
+    {
+      for (UInt s=0; s<num_skews; s++)
+      {
+        const UInt n = 1u << lg;
+        const UInt m = n * C.degree;
+        const string skew = skew_names[s];
+
+        vector<Edge> E;
+        generate_edges(n, m, skews[s], 1 + lg * 7919 + s, E);
+
+        // reference graph used by the read-only operations; every
+        // vertex is present, since SCC assumes 0-based contiguous ids
+        GraphT G;
+        for (UInt i=0; i<n; i++)
+          G.insert_vertex(i);
+        for (UInt i=0; i<E.size(); i++)
+          G.insert_edge(E[i].first, E[i].second);
+        const UInt ne = G.num_edges();
+        const UInt nv = G.num_vertices();
+
+        bench_rng rng(lg * 31 + s);
+
+        if (C.selected("insert_edge"))
+        {
+          vector<bench_probe> P;
+          for (UInt r=0; r<C.reps; r++)
+          {
+            GraphT A;
+            bench_probe p;
+            for (UInt i=0; i<E.size(); i++)
+              A.insert_edge(E[i].first, E[i].second);
+            p.stop();
+            P.push_back(p);
+          }
+          record(R, "insert_edge", rep, skew, lg, nv, ne, P, E.size());
+        }
+
+        if (C.selected("parse"))
+        {
+          ostringstream text;
+          for (UInt i=0; i<E.size(); i++)
+            text << E[i].first << " " << E[i].second << "\n";
+          const string buffer = text.str();
+
+          vector<bench_probe> P;
+          for (UInt r=0; r<C.reps; r++)
+          {
+            istringstream in(buffer);
+            GraphT A;
+            bench_probe p;
+            in >> A;
+            p.stop();
+            P.push_back(p);
+          }
+          record(R, "parse", rep, skew, lg, nv, ne, P, E.size());
+        }
+
+        if (C.selected("subgraph"))
+        {
+          typename GraphT::vertex_set half;
+          for (typename GraphT::const_iterator v=G.begin(); v!=G.end(); v++)
+            if (rng(2) == 0)
+              half.insert(GraphT::node(v));
+
+          vector<bench_probe> P;
+          for (UInt r=0; r<C.reps; r++)
+          {
+            bench_probe p;
+            GraphT S = G.subgraph(half);
+            p.stop();
+            P.push_back(p);
+          }
+          record(R, "subgraph", rep, skew, lg, nv, ne, P, ne);
+        }
+
+        if (C.selected("pagerank"))
+        {
+          const UInt iterations = 10;
+          vector<bench_probe> P;
+          for (UInt r=0; r<C.reps; r++)
+          {
+            UInt used = 0;
+            bench_probe p;
+            pagerank(G, used, iterations, 0.0);
+            p.stop();
+            P.push_back(p);
+          }
+          record(R, "pagerank", rep, skew, lg, nv, ne, P,
+                (double) iterations * ne);
+        }
+
+        if (C.selected("components"))
+        {
+          vector<bench_probe> P;
+          for (UInt r=0; r<C.reps; r++)
+          {
+            bench_probe p;
+            components(G);
+            p.stop();
+            P.push_back(p);
+          }
+          record(R, "components", rep, skew, lg, nv, ne, P, ne);
+        }
+
+        if (C.selected("cluster_coeff"))
+        {
+          vector<bench_probe> P;
+          for (UInt r=0; r<C.reps; r++)
+          {
+            bench_probe p;
+            cluster_coeff(G);
+            p.stop();
+            P.push_back(p);
+          }
+          record(R, "cluster_coeff", rep, skew, lg, nv, ne, P, ne);
+        }
+
+        if (C.selected("scc"))
+        {
+          // SCC prints each component to std::cout; discard it
+          vector<bench_probe> P;
+          for (UInt r=0; r<C.reps; r++)
+          {
+            std::streambuf *out = cout.rdbuf(0);
+            bench_probe p;
+            SCC scc(G);
+            p.stop();
+            cout.rdbuf(out);
+            P.push_back(p);
+          }
+          record(R, "scc", rep, skew, lg, nv, ne, P, ne);
+        }
+
+        if (C.selected("conductance"))
+        {
+          // clusters are the out-neighborhoods of random vertices
+          vector<typename GraphT::vertex_set> clusters;
+          double work = 0.0;
+          for (UInt i=0; i<64; i++)
+          {
+            typename GraphT::const_iterator v = G.find(rng(n));
+            if (v == G.end())
+              continue;
+            typename GraphT::vertex_set c = GraphT::out_neighbors(v);
+            c.insert(GraphT::node(v));
+            for (typename GraphT::vertex_set::const_iterator q = c.begin();
+                    q != c.end(); q++)
+              work += G.out_degree(*q) + G.in_degree(*q);
+            clusters.push_back(c);
+          }
+
+          vector<bench_probe> P;
+          for (UInt r=0; r<C.reps; r++)
+          {
+            bench_probe p;
+            for (UInt i=0; i<clusters.size(); i++)
+              conductance(G, clusters[i]);
+            p.stop();
+            P.push_back(p);
+          }
+          record(R, "conductance", rep, skew, lg, nv, ne, P, work);
+        }
+
+        if (C.selected("absorb"))
+        {
+          const UInt merges = n / 8;
+          vector<Edge> pairs;
+          for (UInt i=0; i<merges; i++)
+            pairs.push_back(Edge(rng(n), rng(n)));
+
+          vector<bench_probe> P;
+          for (UInt r=0; r<C.reps; r++)
+          {
+            GraphT A(G);
+            bench_probe p;
+            for (UInt i=0; i<pairs.size(); i++)
+              A.absorb(pairs[i].first, pairs[i].second);
+            p.stop();
+            P.push_back(p);
+          }
+          record(R, "absorb", rep, skew, lg, nv, ne, P, merges);
+        }
+      }
+    }
+}
+
+
+//
+// one pull-style sweep (y[v] = sum of x over the in-neighbors of v), the
+// access pattern of pagerank; its speed depends on the vertex numbering
+//
+static double pull_sweep(const static_Graph &G, const vector<double> &x,
+      vector<double> &y)
+{
+    double sum = 0.0;
+    for (UInt v=0; v<G.num_vertices(); v++)
+    {
+      double s = 0.0;
+      for (static_Graph::const_iterator q = G.in_neighbors_begin(v);
+              q != G.in_neighbors_end(v); q++)
+        s += x[*q];
+      y[v] = s;
+      sum += s;
+    }
+    return sum;
+}
+
+
+//
+// The static (CSR) representation cannot be modified, so it has its own
+// operations: building from an edge list, parsing MatrixMarket text, a
+// pass over all out-neighbors, and writing MatrixMarket text.
+//
+void run_csr_suite(const string &rep, const bench_config &C,
+      vector<bench_result> &R)
+{
+    static const double skews[] = { 0.0, 2.5, 2.1 };
+    static const char *skew_names[] = { "uniform", "pl2.5", "pl2.1" };
+    const UInt num_skews = sizeof(skews) / sizeof(skews[0]);
+
+    for (UInt lg = C.min_log2; lg <= C.max_log2; lg += 2)
+    {
+      for (UInt s=0; s<num_skews; s++)
+      {
+        const UInt n = 1u << lg;
+        const UInt m = n * C.degree;
+        const string skew = skew_names[s];
+
+        vector<Edge> E;
+        generate_edges(n, m, skews[s], 1 + lg * 7919 + s, E);
+
+        vector<UInt> from(E.size()), to(E.size());
+        for (UInt i=0; i<E.size(); i++)
+        {
+          from[i] = E[i].first;
+          to[i] = E[i].second;
+        }
+
+        static_Graph G(n, from, to);
+        const UInt ne = G.num_edges();
+        const UInt nv = G.num_vertices();
+
+        if (C.selected("build"))
+        {
+          vector<bench_probe> P;
+          for (UInt r=0; r<C.reps; r++)
+          {
+            bench_probe p;
+            static_Graph A(n, from, to);
+            p.stop();
+            P.push_back(p);
+          }
+          record(R, "build", rep, skew, lg, nv, ne, P, E.size());
+        }
+
+        // ingest: parallel inserts into a concurrent_graph, then its CSR
+        // copy (as rep "concurrent")
+        if (C.selected("ingest"))
+        {
+          vector<bench_probe> P;
+          for (UInt r=0; r<C.reps; r++)
+          {
+            bench_probe p;
+            concurrent_graph<UInt> A;
+            A.insert_edges(from, to);
+            static_Graph S;
+            A.to_static(S);
+            p.stop();
+            P.push_back(p);
+          }
+          record(R, "ingest", "concurrent", skew, lg, nv, ne, P, E.size());
+        }
+
+        if (C.selected("parse_mtx"))
+        {
+          ostringstream text;
+          text << "%%MatrixMarket matrix coordinate pattern general\n"
+               << n << " " << n << " " << E.size() << "\n";
+          for (UInt i=0; i<E.size(); i++)
+            text << E[i].first + 1 << " " << E[i].second + 1 << "\n";
+          const string buffer = text.str();
+
+          vector<bench_probe> P;
+          for (UInt r=0; r<C.reps; r++)
+          {
+            mtx_matrix A;
+            string error;
+            bench_probe p;
+            read_mtx(buffer.data(), buffer.size(), A, mtx_read_options(),
+                  error);
+            p.stop();
+            P.push_back(p);
+          }
+          record(R, "parse_mtx", rep, skew, lg, nv, ne, P, E.size());
+        }
+
+        if (C.selected("scan"))
+        {
+          vector<bench_probe> P;
+          UInt sum = 0;
+          for (UInt r=0; r<C.reps; r++)
+          {
+            bench_probe p;
+            for (UInt v=0; v<nv; v++)
+              for (static_Graph::const_iterator q = G.out_neighbors_begin(v);
+                      q != G.out_neighbors_end(v); q++)
+                sum += *q;
+            p.stop();
+            P.push_back(p);
+          }
+          if (sum == 1)       // keep the loop from being optimized away
+            cerr << "";
+          record(R, "scan", rep, skew, lg, nv, ne, P, ne);
+        }
+
+        if (C.selected("write_mtx"))
+        {
+          vector<bench_probe> P;
+          for (UInt r=0; r<C.reps; r++)
+          {
+            FILE *f = fopen("/dev/null", "w");
+            string error;
+            bench_probe p;
+            write_mtx(f, G, error);
+            p.stop();
+            fclose(f);
+            P.push_back(p);
+          }
+          record(R, "write_mtx", rep, skew, lg, nv, ne, P, ne);
+        }
+
+        // reorder: RCM ordering plus renumbering; pull: a pull sweep
+        // before and after (as rep "<rep>+rcm")
+        //
+        if (C.selected("reorder") || C.selected("pull"))
+        {
+          vector<bench_probe> P;
+          static_Graph H;
+          for (UInt r=0; r<C.reps; r++)
+          {
+            bench_probe p;
+            vertex_permutation<UInt> Q(rcm_order(G));
+            H = Q.apply(G);
+            p.stop();
+            P.push_back(p);
+          }
+          if (C.selected("reorder"))
+            record(R, "reorder", rep, skew, lg, nv, ne, P, ne);
+
+          if (C.selected("pull"))
+          {
+            vector<double> x(nv, 1.0), y(nv);
+            double sum = 0.0;
+            for (UInt k=0; k<2; k++)
+            {
+              const static_Graph &A = (k == 0 ? G : H);
+              vector<bench_probe> S;
+              for (UInt r=0; r<C.reps; r++)
+              {
+                bench_probe p;
+                sum += pull_sweep(A, x, y);
+                p.stop();
+                S.push_back(p);
+              }
+              record(R, "pull", (k == 0 ? rep : rep + "+rcm"), skew, lg, nv,
+                    ne, S, ne);
+            }
+            if (sum == 1)
+              cerr << "";
+          }
+        }
+      }
+    }
+}
+
+
+// ---------------------------------------------------------------------
+//  JSON output and baseline comparison
+// ---------------------------------------------------------------------
+
+static string result_key(const string &op, const string &rep,
+      const string &skew, UInt log2_n)
+{
+    ostringstream key;
+    key << op << "/" << rep << "/" << skew << "/" << log2_n;
+    return key.str();
+}
+
+
+// extract the value of "name" from a single-line JSON object, as
+// written by write_json() below.
+//
+static bool json_field(const string &line, const string &name, string &value)
+{
+    string tag = "\"" + name + "\":";
+    string::size_type p = line.find(tag);
+    if (p == string::npos)
+      return false;
+    p += tag.size();
+    while (p < line.size() && line[p] == ' ')
+      p++;
+    if (p < line.size() && line[p] == '"')
+    {
+      string::size_type q = line.find('"', p+1);
+      value = line.substr(p+1, q-p-1);
+    }
+    else
+    {
+      string::size_type q = line.find_first_of(",}", p);
+      value = line.substr(p, q-p);
+    }
+    return true;
+}
+
+
+static bool read_baseline(const char *filename, map<string,double> &B)
+{
+    ifstream f(filename);
+    if (!f)
+      return false;
+
+    string line;
+    while (getline(f, line))
+    {
+      string op, rep, skew, lg, secs;
+      if (json_field(line, "op", op) && json_field(line, "rep", rep) &&
+          json_field(line, "skew", skew) && json_field(line, "log2_n", lg)
+          && json_field(line, "seconds", secs))
+      {
+        B[result_key(op, rep, skew, atoi(lg.c_str()))] =
+              atof(secs.c_str());
+      }
+    }
+    return true;
+}
+
+
+static void write_json(ostream &s, const bench_config &C,
+      const vector<bench_result> &R, const map<string,double> &B)
+{
+    s << "{\n";
+    s << "  \"benchmark\": \"gbench\",\n";
+    s << "  \"degree\": " << C.degree << ",\n";
+    s << "  \"reps\": " << C.reps << ",\n";
+    s << "  \"results\": [\n";
+    s << setprecision(6);
+    for (UInt i=0; i<R.size(); i++)
+    {
+      const bench_result &r = R[i];
+      s << "    {\"op\": \"" << r.op << "\", \"rep\": \"" << r.rep
+        << "\", \"skew\": \"" << r.skew << "\", \"log2_n\": " << r.log2_n
+        << ", \"vertices\": " << r.num_vertices
+        << ", \"edges\": " << r.num_edges
+        << ", \"seconds\": " << r.seconds
+        << ", \"edges_per_sec\": " << r.edges_per_sec
+        << ", \"allocs\": " << r.allocs
+        << ", \"alloc_bytes\": " << r.alloc_bytes
+        << ", \"heap_peak_bytes\": " << r.heap_peak_bytes
+        << ", \"rss_peak_kb\": " << r.rss_peak_kb;
+
+      map<string,double>::const_iterator b =
+            B.find(result_key(r.op, r.rep, r.skew, r.log2_n));
+      if (b != B.end())
+      {
+        s << ", \"baseline_seconds\": " << b->second
+          << ", \"speedup\": " <<
+              (r.seconds > 0.0 ? b->second / r.seconds : 0.0);
+      }
+      s << "}" << (i+1 < R.size() ? "," : "") << "\n";
+    }
+    s << "  ]\n";
+    s << "}\n";
+}
+
+
+// returns the number of operations slower than the baseline
+//
+static UInt compare_baseline(const vector<bench_result> &R,
+      const map<string,double> &B, double tolerance)
+{
+    UInt regressions = 0;
+
+    cerr << "\n" << setw(14) << "op" << " " << setw(8) << "rep"
+         << " size " << setw(8) << "skew" << " " << setw(12) << "baseline"
+         << " " << setw(12) << "current" << "  ratio\n";
+
+    for (UInt i=0; i<R.size(); i++)
+    {
+      const bench_result &r = R[i];
+      map<string,double>::const_iterator b =
+            B.find(result_key(r.op, r.rep, r.skew, r.log2_n));
+      if (b == B.end())
+        continue;
+
+      double ratio = (b->second > 0.0 ? r.seconds / b->second : 1.0);
+      bool slower = (ratio > 1.0 + tolerance);
+      if (slower)
+        regressions++;
+
+      cerr << setw(14) << r.op << " " << setw(8) << r.rep << " 2^"
+           << setw(2) << r.log2_n << " " << setw(8) << r.skew << " "
+           << setw(12) << b->second << " " << setw(12) << r.seconds
+           << "  " << setprecision(3) << ratio << setprecision(6)
+           << (slower ? "  SLOWER" : "") << "\n";
+    }
+    return regressions;
+}
+
+
+static void usage(const char *prog)
+{
+    cerr << "Usage: " << prog << " [-n min_log2] [-N max_log2] "
+         << "[-d avg_degree] [-r reps]\n"
+         << "          [-o op1,op2,...] [-b baseline.json] [-t tolerance]\n"
+         << "  ops: insert_edge parse subgraph pagerank components "
+         << "cluster_coeff\n"
+         << "       scc conductance absorb\n"
+         << "  static (CSR) ops: build parse_mtx scan write_mtx reorder "
+         << "pull ingest\n";
+}
+
+
+int main(int argc, char *argv[])
+{
+    bench_config C;
+    C.min_log2 = 10;
+    C.max_log2 = 14;
+    C.degree = 8;
+    C.reps = 3;
+
+    const char *baseline_filename = 0;
+    double tolerance = 0.10;
+
+    for (int i=1; i<argc; i++)
+    {
+      string arg(argv[i]);
+      if (i+1 >= argc)
+      {
+        usage(argv[0]);
+        exit(1);
+      }
+      string val(argv[++i]);
+
+      if (arg == "-n")
+        C.min_log2 = atoi(val.c_str());
+      else if (arg == "-N")
+        C.max_log2 = atoi(val.c_str());
+      else if (arg == "-d")
+        C.degree = atoi(val.c_str());
+      else if (arg == "-r")
+        C.reps = atoi(val.c_str());
+      else if (arg == "-b")
+        baseline_filename = argv[i];
+      else if (arg == "-t")
+        tolerance = atof(val.c_str());
+      else if (arg == "-o")
+      {
+        istringstream ops(val);
+        string op;
+        while (getline(ops, op, ','))
+          C.ops.insert(op);
+      }
+      else
+      {
+        usage(argv[0]);
+        exit(1);
+      }
+    }
+    if (C.reps < 1)
+      C.reps = 1;
+
+    map<string,double> B;
+    if (baseline_filename && !read_baseline(baseline_filename, B))
+    {
+      cerr << "Error: [" << baseline_filename << "] could not be opened.\n";
+      exit(1);
+    }
+
+    vector<bench_result> R;
+    run_suite<Graph>("tGraph", C, R);
+    run_csr_suite("csr", C, R);
+
+    write_json(cout, C, R, B);
+
+    if (baseline_filename)
+    {
+      UInt regressions = compare_baseline(R, B, tolerance);
+      if (regressions > 0)
+      {
+        cerr << regressions << " operation(s) slower than baseline.\n";
+        return 2;
+      }
+    }
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+//
+// Breadth-first search from one or more source vertices, by the
+// direction-optimizing engine of ngraph_bfs.hpp.
+//
+// Usage:  gbfs [-u] [-p] [-r] [[-i] graph.g | graph.csr | graph.mtx | graph.cgr]
+//              source...
+//
+//      -u      ignore edge directions
+//      -p      also print the BFS-tree parent of each vertex
+//      -r      print only the reachable vertices (a .v list)
+//
+// The graph (-i, or any argument that is not a vertex number) is read
+// from stdin (as .g) if not given.  A compressed graph (.cgr; see
+// gcompress) is searched without decompressing it, unless -u is given.
+//
+// Output: [vertex] [depth] (and [parent] with -p) for each vertex reached;
+// the sources have depth 0 and are their own parents.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include "ngraph_static.hpp"
+#include "ngraph_static_io.hpp"
+#include "ngraph_compressed.hpp"
+#include "ngraph_bfs.hpp"
+#include "ngraph_stats.hpp"
+
+using namespace std;
+using namespace NGraph;
+
+typedef unsigned int vertex;
+
+template <class Graph>
+void search(const Graph &G, const vector<vertex> &sources,
+      bool print_parents, bool reachable_only)
+{
+  const unsigned int mode = (reachable_only ? 0 :
+        bfs_depths | (print_parents ? bfs_parents : 0));
+  bfs_engine<vertex, Graph> B(G);
+  size_t reached = B.run(sources, mode);
+
+  cerr << "# reached " << reached << " of " << G.num_vertices()
+       << " vertices, " << B.num_levels() << " levels ("
+       << B.bottom_up_steps() << " bottom-up)\n";
+
+  stats::scoped_phase phase("write");
+  const vertex n = G.num_vertices();
+  for (vertex v=0; v<n; v++)
+  {
+    if (!B.reached(v))
+      continue;
+    cout << v;
+    if (!reachable_only)
+    {
+      cout << " " << B.depths()[v];
+      if (print_parents)
+        cout << " " << B.parents()[v];
+    }
+    cout << "\n";
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  NGraph::stats::parse_options(argc, argv);
+
+  bool undirected = false;
+  bool print_parents = false;
+  bool reachable_only = false;
+  const char *filename = "-";
+  vector<vertex> sources;
+  bool usage = false;
+
+  for (int i=1; i<argc; i++)
+  {
+    string a(argv[i]);
+    if (a == "-u")
+      undirected = true;
+    else if (a == "-p")
+      print_parents = true;
+    else if (a == "-r")
+      reachable_only = true;
+    else if (a == "-i" && i+1 < argc)
+      filename = argv[++i];
+    else if (!a.empty() && a.find_first_not_of("0123456789") == string::npos)
+      sources.push_back(atoi(argv[i]));
+    else if (!a.empty() && a[0] != '-' && string(filename) == "-")
+      filename = argv[i];
+    else
+      usage = true;
+  }
+
+  if (usage || sources.empty())
+  {
+    cerr << "Usage: " << argv[0] << " [-u] [-p] [-r] "
+         << "[[-i] graph.g | graph.csr | graph.mtx | graph.cgr] source... "
+         << "> out\n";
+    return 1;
+  }
+
+  const string name(filename);
+  const bool compressed = name.size() > 4 &&
+        name.compare(name.size() - 4, 4, ".cgr") == 0;
+
+  static_tGraph<vertex> G;
+  compressed_tGraph<vertex> C;
+  string error;
+  {
+    stats::scoped_phase phase("read");
+    bool ok = true;
+    if (compressed)
+    {
+      FILE *f = fopen(filename, "rb");
+      ok = (f != 0 && C.load(f, error));
+      if (f == 0)
+        error = "could not be opened";
+      if (f)
+        fclose(f);
+      if (!ok)
+        error = "[" + name + "] " + error;
+      else if (undirected)
+        G = C.to_static();
+    }
+    else
+      ok = read_static_graph(filename, G, error);
+    if (!ok)
+    {
+      cerr << "Error: " << error << "\n";
+      return 1;
+    }
+    if (undirected)
+      G = undirected_graph(G);
+  }
+
+  if (compressed && !undirected)
+    search(C, sources, print_parents, reachable_only);
+  else
+    search(G, sources, print_parents, reachable_only);
+
+  return 0;
+}
@@ -32,6 +32,7 @@ using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
+    NGraph::stats::parse_options(argc, argv);
 
     if (argc <= 1)
       exit(1);
@@ -101,6 +102,6 @@ int main(int argc, char *argv[])
     }
 
 
-    return 0;
+    return NGraph::stats::finish(0);
       
 }
@@ -30,13 +30,15 @@ double cluster_coeff_directed(const Graph &G, Graph::const_iterator t)
 
 
 
-int main()
+int main(int argc, char *argv[])
 {
+  NGraph::stats::parse_options(argc, argv);
 
   Graph G;
 
   cin >> G;
 
+  stats::scoped_phase phase("compute");
   for (Graph::const_iterator p=G.begin(); p!=G.end(); p++)
   {
       cout << Graph::node(p) << " " << 
@@ -44,6 +46,6 @@ int main()
   }
 
 
-  return 0;
+  return NGraph::stats::finish(0);
 }
 
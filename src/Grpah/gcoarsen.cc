@@ -8,6 +8,17 @@ Usage is
 where the input is a list of clusters (one per line), where each 
 cluster is a list of vertices
 
+With -w, 
+
+  cat nodes.txt | gcoarsen -w foo.g > foo_coarsen.wg
+
+keeps the multiplicities instead: each cluster becomes its first vertex
+(without -w, each merge keeps the vertex of higher degree), and the
+edges between two clusters become one edge weighted by their number (as
+a "from to weight" weighted edge list, see nwgraph.hpp).  Either way,
+edges inside a cluster are dropped; a cluster left with no edges is
+written as a lone vertex.
+
 
 */
 
@@ -19,14 +30,106 @@ cluster is a list of vertices
 #include <map>
 #include <set>
 #include "ngraph.hpp"
+#include "nwgraph.hpp"
 
 using namespace std;
 using namespace NGraph;
 
 typedef map<unsigned int, string> node_array_type;
 
+
+int coarsen_weighted(const char *filename)
+{
+  typedef nwGraph_d::vertex vertex;
+
+  mapped_file graph_file(filename);
+  if (!graph_file.good())
+  {
+    cerr << "Error: " << graph_file.error() << "\n";
+    return 1;
+  }
+
+  vertex n = 0;
+  vector<vertex> from, to;
+  vector<double> w;
+  string error;
+  if (!parse_weighted_edges(graph_file.data(), graph_file.size(), n, from,
+        to, w, error))
+  {
+    cerr << "Error: [" << filename << "] " << error << "\n";
+    return 1;
+  }
+
+  // present[v]: v is a vertex of the (coarsened) graph
+  vector<char> present(n, 0);
+  for (size_t k=0; k<from.size(); k++)
+    present[from[k]] = present[to[k]] = 1;
+
+  // every vertex starts as its own cluster
+  vector<vertex> cluster(n);
+  for (vertex v=0; v<n; v++)
+    cluster[v] = v;
+
+  string line;
+  while ( getline(cin, line))
+  {
+      vertex v;
+      vertex v1;
+      stringstream s(line);
+      if ( !(s >> v1) )
+          break;
+      while (s >> v)
+      {
+        if (v < n && v1 < n && v != v1)
+        {
+          cluster[v] = v1;
+          present[v] = 0;
+        }
+      }
+  }
+
+  vector<vertex> cfrom, cto;
+  vector<double> cw;
+  for (size_t k=0; k<from.size(); k++)
+  {
+    vertex a = cluster[from[k]];
+    vertex b = cluster[to[k]];
+    if (a != b)
+    {
+      cfrom.push_back(a);
+      cto.push_back(b);
+      cw.push_back(w[k]);
+    }
+  }
+  nwGraph_d C(n, cfrom, cto, cw);
+
+  for (vertex v=0; v<n; v++)
+  {
+    if (!present[v] || cluster[v] != v)
+      continue;
+    if (C.out_degree(v) == 0 && C.in_degree(v) == 0)
+      cout << v << "\n";
+    nwGraph_d::const_weight_iterator q = C.out_weights_begin(v);
+    for (nwGraph_d::const_iterator p = C.out_neighbors_begin(v);
+          p != C.out_neighbors_end(v); p++, q++)
+      cout << v << " " << *p << " " << *q << "\n";
+  }
+  return 0;
+}
+
+
 int main(int argc, char *argv[])
 {
+  NGraph::stats::parse_options(argc, argv);
+
+  if (argc == 3 && string(argv[1]) == "-w")
+    return coarsen_weighted(argv[2]);
+
+  if (argc != 2)
+  {
+    cerr << "Usage: cat nodes.txt | " << argv[0] << " [-w] foo.g\n";
+    return 1;
+  }
 
   Graph G;
 
@@ -53,11 +156,18 @@ int main(int argc, char *argv[])
       while (s >> v)
       {
         G.smart_absorb(v1, v);
+
+        // either may survive: absorb into it from now on, and drop the
+        // edge (if any) between the two that became a self-loop, so that
+        // edges inside a cluster vanish, as with -w
+        if (!G.includes_vertex(v1))
+          v1 = v;
+        G.remove_edge(v1, v1);
       }
   }
 
   cout << G;
 
-  return 0;
+  return NGraph::stats::finish(0);
 }
 
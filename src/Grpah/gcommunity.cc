@@ -0,0 +1,159 @@
+//
+// Finds communities of a graph (taken as undirected), by Louvain
+// modularity optimization or label propagation (see ngraph_community.hpp),
+// and writes them as "community vertex" lines (.mi, sorted by community,
+// as g2mi.csh produced), or one line of vertices per community (.v, as
+// read by g2alignment).
+//
+// Usage:  gcommunity [-a louvain|lpa] [-v] [-r resolution] [-i iterations]
+//                    [graph.g | graph.csr | graph.mtx] > graph.mi
+//
+//   -a   algorithm (louvain by default)
+//   -v   write .v lines instead of .mi
+//   -r   modularity resolution (louvain; default 1, larger for smaller
+//        communities)
+//   -i   maximum sweeps per level (louvain) or passes (lpa)
+//
+// Vertex numbers are used as they are (no renumbering to 0-based ids
+// is needed); the graph is read from stdin (as .g) if not given.  The
+// number of communities and their modularity are reported on stderr.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include "ngraph_static.hpp"
+#include "ngraph_static_io.hpp"
+#include "ngraph_community.hpp"
+#include "ngraph_write.hpp"
+#include "ngraph_stats.hpp"
+
+using namespace std;
+using namespace NGraph;
+
+typedef unsigned int vertex;
+
+int main(int argc, char *argv[])
+{
+  NGraph::stats::parse_options(argc, argv);
+
+  string algorithm = "louvain";
+  bool v_format = false;
+  community_options opt;
+  unsigned int iterations = 0;
+  const char *filename = "-";
+  bool usage = false;
+
+  for (int i=1; i<argc; i++)
+  {
+    string a(argv[i]);
+    if (a == "-a" && i+1 < argc)
+      algorithm = argv[++i];
+    else if (a == "-v")
+      v_format = true;
+    else if (a == "-r" && i+1 < argc)
+      opt.resolution = atof(argv[++i]);
+    else if (a == "-i" && i+1 < argc)
+      iterations = atoi(argv[++i]);
+    else if (a[0] != '-' || a == "-")
+      filename = argv[i];
+    else
+      usage = true;
+  }
+
+  if (usage || (algorithm != "louvain" && algorithm != "lpa") ||
+        opt.resolution <= 0.0)
+  {
+    cerr << "Usage: " << argv[0] << " [-a louvain|lpa] [-v] [-r resolution] "
+         << "[-i iterations] [graph.g | graph.csr | graph.mtx] > graph.mi\n";
+    return 1;
+  }
+
+  static_tGraph<vertex> G;
+  vector<char> present;
+  string error;
+  {
+    stats::scoped_phase phase("read");
+    if (!read_static_graph(filename, G, error, &present))
+    {
+      cerr << "Error: " << error << "\n";
+      return 1;
+    }
+  }
+  const nwGraph<vertex> U = community_graph(G);
+
+  vector<vertex> community;
+  if (algorithm == "lpa")
+    label_propagation(U, community, iterations > 0 ? iterations : 100);
+  else
+  {
+    if (iterations > 0)
+      opt.max_sweeps = iterations;
+    louvain(U, community, opt);
+  }
+  const double Q = modularity(U, community, opt.resolution);
+
+  // vertices of the graph only (not the gaps in its numbering)
+  if (present.size() < community.size())
+    present.resize(community.size(), 1);
+  const vertex k = renumber_communities(community, &present);
+
+  // bucket the vertices by community
+  vector<size_t> start(k + 1, 0);
+  for (size_t v=0; v<community.size(); v++)
+    if (present[v])
+      start[community[v] + 1]++;
+  for (vertex c=0; c<k; c++)
+    start[c+1] += start[c];
+  vector<vertex> members(start[k]);
+  {
+    vector<size_t> next(start.begin(), start.end() - 1);
+    for (size_t v=0; v<community.size(); v++)
+      if (present[v])
+        members[next[community[v]]++] = (vertex) v;
+  }
+
+  cerr << "# " << k << " communities of " << members.size()
+       << " vertices, modularity " << Q << "\n";
+
+  stats::scoped_phase phase("write");
+  graph_sink out(stdout);
+  text_buffer b;
+  bool ok = true;
+  for (vertex c=0; c<k && ok; c++)
+  {
+    for (size_t i=start[c]; i<start[c+1]; i++)
+    {
+      char *p = b.reserve(2 * 20 + 2);
+      if (v_format)
+      {
+        if (i > start[c])
+          *p++ = ' ';
+      }
+      else
+      {
+        p = format_uint(p, c);
+        *p++ = ' ';
+      }
+      p = format_uint(p, members[i]);
+      if (!v_format)
+        *p++ = '\n';
+      b.commit(p);
+    }
+    if (v_format)
+      b.put("\n", 1);
+    if (b.size() > (1 << 20))
+    {
+      ok = out.write(b);
+      b.clear();
+    }
+  }
+  if (!ok || !out.write(b) || !out.flush())
+  {
+    cerr << "Error: write failed\n";
+    return 1;
+  }
+  return NGraph::stats::finish(0);
+}
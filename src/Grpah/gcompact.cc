@@ -1,10 +1,13 @@
 //
-// usage:  cat graphA.g graphB.g | gcompact  
+// usage:  cat graphA.g graphB.g | gcompact  [-x [-m MB] [-T dir]]
+//
+//   -x  sort and deduplicate externally, for graphs larger than memory
 //
 
 #include <iostream>
 #include <fstream>
 #include "ngraph.hpp"
+#include "edge_sort.hpp"
 
 
 using namespace std;
@@ -12,11 +15,33 @@ using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
+   NGraph::stats::parse_options(argc, argv);
+
+   edge_sort_options opt;
+   if (parse_external_sort_options(argc, argv, opt))
+   {
+      opt.unique = true;
+      external_edge_sorter S(opt);
+      text_edge_reader in(stdin);
+      edge_record e;
+      while (in.next(e))
+        S.add(e);
+
+      text_edge_writer W(stdout);
+      vertex_record_filter<text_edge_writer> F(W);
+      if (!S.finish(F))
+      {
+        cerr << "Error: " << S.error() << "\n";
+        return 1;
+      }
+      W.flush();
+      return 0;
+   }
 
    Graph A;
    cin >> A;
    cout << A;
 
-   return 0;
+   return NGraph::stats::finish(0);
 }
 
@@ -22,6 +22,8 @@ using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
+   NGraph::stats::parse_options(argc, argv);
+
    Graph G;
    bool verbose = false;
    bool line_verbose = false;
@@ -84,5 +86,5 @@ int main(int argc, char *argv[])
      }
   }
 
-   return 0;
+   return NGraph::stats::finish(0);
 }
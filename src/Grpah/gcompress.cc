@@ -0,0 +1,145 @@
+//
+// Compresses a graph into a .cgr file (gap-coded stream-vbyte rows; see
+// ngraph_compressed.hpp), optionally renumbering its vertices first for
+// smaller gaps (see reorder.hpp), and reports the space per edge.
+//
+// Usage:  gcompress [-o order] [-p perm.imap] [-d]
+//                   [graph.g | graph.csr | graph.mtx | graph.cgr] > graph.cgr
+//
+//   -o   degree, bfs, rcm, gorder or none (the default)
+//   -p   write the permutation as "old new" pairs (see greorder; swap
+//        the columns to map back to the original numbering)
+//   -d   decompress: write a .csr file (from any of the inputs)
+//
+// The graph is read from stdin (as .g) if not given.
+//
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include "ngraph_static.hpp"
+#include "ngraph_static_io.hpp"
+#include "ngraph_compressed.hpp"
+#include "reorder.hpp"
+#include "ngraph_stats.hpp"
+
+using namespace std;
+using namespace NGraph;
+
+typedef unsigned int vertex;
+
+int main(int argc, char *argv[])
+{
+  NGraph::stats::parse_options(argc, argv);
+
+  string order = "none";
+  const char *perm_filename = 0;
+  const char *filename = "-";
+  bool decompress = false;
+  bool usage = false;
+
+  for (int i=1; i<argc; i++)
+  {
+    string a(argv[i]);
+    if (a == "-o" && i+1 < argc)
+      order = argv[++i];
+    else if (a == "-p" && i+1 < argc)
+      perm_filename = argv[++i];
+    else if (a == "-d")
+      decompress = true;
+    else if (a[0] != '-' || a == "-")
+      filename = argv[i];
+    else
+      usage = true;
+  }
+
+  if (usage)
+  {
+    cerr << "Usage: " << argv[0] << " [-o order] [-p perm.imap] [-d] "
+         << "[graph.g | graph.csr | graph.mtx | graph.cgr] > graph.cgr\n";
+    return 1;
+  }
+
+  const string name(filename);
+  static_tGraph<vertex> G;
+  string error;
+  {
+    stats::scoped_phase phase("read");
+    bool ok = true;
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".cgr") == 0)
+    {
+      compressed_tGraph<vertex> C;
+      FILE *f = fopen(filename, "rb");
+      ok = (f != 0 && C.load(f, error));
+      if (f == 0)
+        error = "could not be opened";
+      if (f)
+        fclose(f);
+      if (ok)
+        G = C.to_static();
+      else
+        error = "[" + name + "] " + error;
+    }
+    else
+      ok = read_static_graph(filename, G, error);
+    if (!ok)
+    {
+      cerr << "Error: " << error << "\n";
+      return 1;
+    }
+  }
+
+  if (order != "none")
+  {
+    vector<vertex> new_id;
+    {
+      stats::scoped_phase phase("order");
+      if (!compute_order(G, order, new_id))
+      {
+        cerr << "Error: unknown order \"" << order << "\"\n";
+        return 1;
+      }
+    }
+    if (perm_filename)
+    {
+      ofstream perm(perm_filename);
+      for (size_t v=0; v<new_id.size(); v++)
+        perm << v << " " << new_id[v] << "\n";
+      if (!perm)
+      {
+        cerr << "Error: could not write " << perm_filename << "\n";
+        return 1;
+      }
+    }
+    stats::scoped_phase phase("renumber");
+    G = vertex_permutation<vertex>(new_id).apply(G);
+  }
+
+  bool ok = true;
+  if (decompress)
+  {
+    stats::scoped_phase phase("write");
+    ok = G.save(stdout);
+  }
+  else
+  {
+    compressed_tGraph<vertex> C(G);
+    const double m = (G.num_edges() > 0 ? (double) G.num_edges() : 1.0);
+    cerr << "# " << G.num_vertices() << " vertices, " << G.num_edges()
+         << " edges: " << C.out_bytes_per_edge() << " bytes/edge (out), "
+         << C.memory() / m << " (both directions; CSR "
+         << (G.num_edges() * 2.0 * sizeof(vertex) +
+             (G.num_vertices() + 1) * 2.0 * sizeof(size_t)) / m << ")\n";
+    stats::scoped_phase phase("write");
+    ok = C.save(stdout);
+  }
+  stats::edges_written() += G.num_edges();
+  if (!ok)
+  {
+    cerr << "Error: could not write graph\n";
+    return 1;
+  }
+  return 0;
+}
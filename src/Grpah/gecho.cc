@@ -1,3 +1,13 @@
+//
+// Reads a .g graph from stdin and writes it back out (deduplicated and
+// sorted), as .g or in another format (see ngraph_write.hpp).
+//
+// Usage:  gecho [-f g|mtx|tgf|dot|udot|pajek] < graph.g > graph.out
+//
+
+#include <iostream>
+#include <string>
+#include <cstdio>
 #include "ngraph.hpp"
 
 
@@ -6,11 +16,35 @@ using namespace std;
 
 int  main(int argc, char *argv[])
 {
+    NGraph::stats::parse_options(argc, argv);
+
+    graph_format format = g_format;
+    bool usage = false;
+    for (int i=1; i<argc; i++)
+    {
+      string a(argv[i]);
+      if (a == "-f" && i+1 < argc && parse_graph_format(argv[i+1], format))
+        i++;
+      else
+        usage = true;
+    }
+    if (usage)
+    {
+      cerr << "Usage: " << argv[0] << " [-f g|mtx|tgf|dot|udot|pajek] "
+           << "< graph.g > graph.out\n";
+      return 1;
+    }
 
     Graph A;
     cin >> A;
-    cout << A;
 
-    return 0;
+    string error;
+    if (!write_graph(stdout, A, write_options(format), error))
+    {
+      cerr << "Error: " << error << "\n";
+      return 1;
+    }
+
+    return NGraph::stats::finish(0);
 
 }
@@ -45,6 +45,8 @@ inline UInt random(UInt low, UInt high)
 
 int main(int argc, char *argv[])
 {
+  NGraph::stats::parse_options(argc, argv);
+
   if (argc < 3)
   {
     cerr << "Usage:  " << argv[0] << " num_vertices   num_edges \n";
@@ -0,0 +1,152 @@
+//
+// PageRank that is brought up to date after a batch of edge changes,
+// instead of being recomputed (see ngraph_pagerank_incremental.hpp).
+//
+// Usage:  gipagerank [-i inserts.g] [-d deletes.g] [-s state] [-t tolerance]
+//                    [-o updated.csr] [graph.g | graph.csr | graph.mtx]
+//                    > graph.p
+//
+//   -i   edges to insert (a .g edge list)
+//   -d   edges to delete (a .g edge list); deletions are applied first
+//   -s   scores of the graph saved by an earlier run; they are read, if
+//        the file exists, instead of being computed, and the updated
+//        scores are written back
+//   -t   largest residual left at any vertex (default 1e-8)
+//   -o   write the updated graph (as .csr)
+//
+// So an hourly batch of changes is
+//
+//        gipagerank -s g.pr -i new.g -d old.g -o g1.csr g.csr > g1.p
+//
+// after which g1.csr and g.pr are the graph and scores for the next.
+// The graph is read from stdin (as .g) if not given.  The scores are
+// those of gpagerank (not normalized; damping 0.85).
+//
+// Output: two columns, [vertex] [pagerank], for the non-isolated vertices.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include "ngraph_static.hpp"
+#include "ngraph_static_io.hpp"
+#include "ngraph_pagerank_incremental.hpp"
+#include "ngraph_stats.hpp"
+
+using namespace std;
+using namespace NGraph;
+
+typedef unsigned int vertex;
+typedef static_tGraph<vertex>::edge edge;
+
+int main(int argc, char *argv[])
+{
+  NGraph::stats::parse_options(argc, argv);
+
+  const char *insert_filename = 0;
+  const char *delete_filename = 0;
+  const char *state_filename = 0;
+  const char *output_filename = 0;
+  const char *filename = "-";
+  double tolerance = 1e-8;
+  bool usage = false;
+
+  for (int i=1; i<argc; i++)
+  {
+    string a(argv[i]);
+    if (a == "-i" && i+1 < argc)
+      insert_filename = argv[++i];
+    else if (a == "-d" && i+1 < argc)
+      delete_filename = argv[++i];
+    else if (a == "-s" && i+1 < argc)
+      state_filename = argv[++i];
+    else if (a == "-o" && i+1 < argc)
+      output_filename = argv[++i];
+    else if (a == "-t" && i+1 < argc)
+      tolerance = atof(argv[++i]);
+    else if (a[0] != '-' || a == "-")
+      filename = argv[i];
+    else
+      usage = true;
+  }
+
+  if (usage || tolerance <= 0.0)
+  {
+    cerr << "Usage: " << argv[0] << " [-i inserts.g] [-d deletes.g] "
+         << "[-s state] [-t tolerance]\n"
+         << "         [-o updated.csr] [graph.g | graph.csr | graph.mtx] "
+         << "> graph.p\n";
+    return 1;
+  }
+
+  static_tGraph<vertex> G;
+  vector<edge> insertions, deletions;
+  string error;
+  {
+    stats::scoped_phase phase("read");
+    if (!read_static_graph(filename, G, error) ||
+        !read_edge_set(insert_filename, insertions, error) ||
+        !read_edge_set(delete_filename, deletions, error))
+    {
+      cerr << "Error: " << error << "\n";
+      return 1;
+    }
+  }
+
+  incremental_pagerank<vertex> R(0.85, tolerance);
+  FILE *state = (state_filename ? fopen(state_filename, "rb") : 0);
+  if (state)
+  {
+    const bool ok = R.load(state, error);
+    fclose(state);
+    if (!ok || R.scores().size() != G.num_vertices())
+    {
+      cerr << "Error: [" << state_filename << "] "
+           << (ok ? "is not for this graph" : error) << "\n";
+      return 1;
+    }
+  }
+  else
+  {
+    R.compute(G);
+    cerr << "# computed: " << R.pushes() << " pushes\n";
+  }
+
+  if (insert_filename || delete_filename)
+  {
+    update_counts C = R.update(G, insertions, deletions);
+    cerr << "# inserted " << C.edges_inserted << " removed "
+         << C.edges_removed << " edges: " << R.pushes() << " pushes\n";
+  }
+  cerr << "# residual norm " << R.residual_norm() << "\n";
+
+  if (state_filename)
+  {
+    FILE *f = fopen(state_filename, "wb");
+    if (f == 0 || !R.save(f))
+    {
+      cerr << "Error: could not write " << state_filename << "\n";
+      return 1;
+    }
+    fclose(f);
+  }
+  if (output_filename)
+  {
+    FILE *f = fopen(output_filename, "wb");
+    if (f == 0 || !G.save(f))
+    {
+      cerr << "Error: could not write " << output_filename << "\n";
+      return 1;
+    }
+    fclose(f);
+  }
+
+  stats::scoped_phase phase("write");
+  const vector<double> &P = R.scores();
+  for (vertex v=0; v<P.size(); v++)
+    if (!G.isolated(v))
+      printf("%u  %g\n", v, P[v]);
+  return 0;
+}
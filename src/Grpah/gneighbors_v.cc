@@ -27,7 +27,8 @@ using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
- 
+    NGraph::stats::parse_options(argc, argv);
+
     typedef set<Graph::vertex>  vertex_set;
 
     if (argc < 2)
@@ -85,5 +86,5 @@ int main(int argc, char *argv[])
     }
 
     
-    return 0;
+    return NGraph::stats::finish(0);
 }
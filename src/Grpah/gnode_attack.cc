@@ -1,82 +1,101 @@
-#include <fstream>
 #include <iostream>
 #include <string>
-#include <set>
-#include "set_ops.hpp"
-#include "ngraph.hpp"
-#include "ngraph_components.hpp"
-#include "equivalence.hpp"
+#include <vector>
+#include <cstdlib>
+#include "ngraph_static.hpp"
+#include "ngraph_static_io.hpp"
+#include "ngraph_snapshot.hpp"
 
 /*
     Given a list of nodes, this program lists the number of connected
     components remaining in the graph.
 
-    Usage:  cat nodes_to_remove.v | gnode_attack
+    Usage:  cat nodes_to_remove.v | gnode_attack [-i] graph.g
 
-    output:  one line per node_removed
+    output:  one line per node_removed:
+
+        [node] [components] [min size] [avg size] [max size]
+
+    Nodes are removed one after another, each line describing the graph
+    without all the nodes so far.  With -i each node is instead removed
+    from the original graph alone: every such scenario is a snapshot
+    of the graph (ngraph_snapshot.hpp), sharing all it does not change,
+    and the scenarios are measured in parallel.
 
 */
 
 using namespace std;
 using namespace NGraph;
 
+typedef unsigned int vertex;
+
+static void print(vertex v, const component_summary &C)
+{
+    cout << v << " " << C.num_components << " " << C.min << " "
+         << C.mean << " " << C.max << "\n";
+}
+
 int main(int argc, char *argv[])
 {
-   Graph G;
+   NGraph::stats::parse_options(argc, argv);
 
-   if (argc < 2)
+   bool independent = false;
+   const char *graph_filename = 0;
+   for (int i=1; i<argc; i++)
    {
-      cerr << "Usage: "<< argv[0] << " graph.g < graph.v \n";
+      if (string(argv[i]) == "-i")
+        independent = true;
+      else
+        graph_filename = argv[i];
+   }
+
+   if (graph_filename == 0)
+   {
+      cerr << "Usage: "<< argv[0] << " [-i] graph.g < graph.v \n";
       exit(1);
    }
 
-   const char *graph_filename = argv[1];
-   ifstream graph_file;
-   graph_file.open( graph_filename);
-    if (!graph_filename)
-    {
-        cerr << "Error: [" << graph_filename << "] could not be opened.\n";
+   snapshot_graph<vertex> G;
+   {
+      static_tGraph<vertex> S;
+      vector<char> present;
+      string error;
+      stats::scoped_phase phase("read");
+      if (!read_static_graph(graph_filename, S, error, &present))
+      {
+        cerr << "Error: " << error << "\n";
         exit(1);
-    }
-    graph_file >> G;
-
-
-   // Now find number of connected components
+      }
+      G = snapshot_graph<vertex>(S, &present);
+   }
 
-   typedef equivalence<Graph::vertex> equiv;
+   vector<vertex> nodes;
+   vertex node_to_remove;
+   while (cin >> node_to_remove)
+      nodes.push_back(node_to_remove);
 
-   Graph::vertex node_to_remove;
-   while (cin>>node_to_remove)
+   if (!independent)
    {
-      G.remove_vertex(node_to_remove);  
-      equiv E = components(G);
-
-      // compute the min, max, and average component sizes
-
-      unsigned int Min=0, Max=0;
-      double Avg=0.0;
-
-      equiv::const_iterator p=E.begin();
-      if (p != E.end())
-      {
-          unsigned int class_size =  equiv::collection(p).size();
-          Min = Max = class_size;
-          Avg += class_size;
-          p++;
-      }
-      for (; p!=E.end(); p++)
+      for (size_t i=0; i<nodes.size(); i++)
       {
-          //const equiv::element_set &V = equiv::collection(p);
-          unsigned int class_size =  equiv::collection(p).size();
-          if (class_size > Max)  Max = class_size;
-          if (class_size < Min) Min = class_size;
-          Avg += class_size;
+        G.remove_vertex(nodes[i]);
+        print(nodes[i], component_sizes(G));
       }
-      Avg /= E.size();
-      cout << node_to_remove << " " << E.size() << " " << Min << 
-              " " << Avg << " " << Max << "\n";;
+      return NGraph::stats::finish(0);
    }
 
+   vector<component_summary> C(nodes.size());
+#ifdef _OPENMP
+   #pragma omp parallel for schedule(dynamic, 1)
+#endif
+   for (long i=0; i<(long) nodes.size(); i++)
+   {
+      snapshot_graph<vertex> S = G.snapshot();
+      S.remove_vertex(nodes[i]);
+      C[i] = component_sizes(S);
+   }
+   for (size_t i=0; i<nodes.size(); i++)
+      print(nodes[i], C[i]);
 
-   return 0;
+   return NGraph::stats::finish(0);
 }
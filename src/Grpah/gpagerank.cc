@@ -20,7 +20,8 @@ typedef unsigned int uInt;
 
 int main(int argc, char *argv[])
 {
-  
+  NGraph::stats::parse_options(argc, argv);
+
   uInt max_iterations = 200; 
   
   // stop if page rank values change by max of 0.0001%
@@ -49,6 +50,6 @@ int main(int argc, char *argv[])
   }
 
 
-  return 0;
+  return NGraph::stats::finish(0);
 }
 
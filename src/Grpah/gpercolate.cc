@@ -0,0 +1,109 @@
+//
+// Percolation of a graph (taken as undirected), averaged over many random
+// orders of adding its vertices (site) or edges (bond; see
+// ngraph_percolation.hpp).  Where g2Pmetric follows the one order it is
+// given, this runs all the trials, in parallel, in one invocation.
+//
+// Usage:  gpercolate [-b] [-t trials] [-s seed] [-p points]
+//                    [graph.g | graph.csr | graph.mtx] > curve
+//
+//   -b   bond percolation (edges added), rather than site (vertices)
+//   -t   number of random orders (default 100)
+//   -s   random seed (default 1); the same seed gives the same curve
+//   -p   report about this many evenly spaced steps (default: every step)
+//
+// Output: one line per reported step,
+//
+//   [step] [fraction] [largest] [var] [susceptibility] [var] [clusters] [var]
+//
+// where step is the number of vertices (edges) added, fraction the same as
+// a fraction of all of them, largest the size of the largest cluster as a
+// fraction of the vertices, susceptibility the sum of the squares of the
+// other cluster sizes over the number of vertices, and clusters the number
+// of clusters; each is the mean over the trials, followed by its variance.
+// The graph is read from stdin (as .g) if not given.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include "ngraph_static.hpp"
+#include "ngraph_static_io.hpp"
+#include "ngraph_percolation.hpp"
+#include "ngraph_stats.hpp"
+
+using namespace std;
+using namespace NGraph;
+
+typedef unsigned int vertex;
+
+int main(int argc, char *argv[])
+{
+  NGraph::stats::parse_options(argc, argv);
+
+  percolation_options opt;
+  const char *filename = "-";
+  bool usage = false;
+
+  for (int i=1; i<argc; i++)
+  {
+    string a(argv[i]);
+    if (a == "-b")
+      opt.bond = true;
+    else if (a == "-t" && i+1 < argc)
+      opt.trials = atoi(argv[++i]);
+    else if (a == "-s" && i+1 < argc)
+      opt.seed = strtoul(argv[++i], 0, 10);
+    else if (a == "-p" && i+1 < argc)
+      opt.points = atol(argv[++i]);
+    else if (a[0] != '-' || a == "-")
+      filename = argv[i];
+    else
+      usage = true;
+  }
+
+  if (usage || opt.trials == 0)
+  {
+    cerr << "Usage: " << argv[0] << " [-b] [-t trials] [-s seed] [-p points] "
+         << "[graph.g | graph.csr | graph.mtx] > curve\n";
+    return 1;
+  }
+
+  static_tGraph<vertex> G;
+  vector<char> present;
+  string error;
+  {
+    stats::scoped_phase phase("read");
+    if (!read_static_graph(filename, G, error, &present))
+    {
+      cerr << "Error: " << error << "\n";
+      return 1;
+    }
+  }
+  const static_tGraph<vertex> U = undirected_graph(G);
+
+  percolation_curve C;
+  percolation(U, &present, opt, C);
+
+  cerr << "# " << (opt.bond ? "bond" : "site") << " percolation, "
+       << C.trials << " trials, " << C.num_vertices << " vertices, "
+       << U.num_edges() / 2 << " edges\n";
+
+  stats::scoped_phase phase("write");
+  const double N = (C.num_steps > 0 ? (double) C.num_steps : 1.0);
+  for (size_t i=0; i<C.step.size(); i++)
+  {
+    printf("%lu %g %g %g %g %g %g %g\n", (unsigned long) C.step[i],
+          C.step[i] / N, C.largest_mean[i], C.largest_var[i],
+          C.susceptibility_mean[i], C.susceptibility_var[i],
+          C.clusters_mean[i], C.clusters_var[i]);
+  }
+  if (fflush(stdout) != 0)
+  {
+    cerr << "Error: write failed\n";
+    return 1;
+  }
+  return NGraph::stats::finish(0);
+}
@@ -61,6 +61,8 @@ bool single_incoming_edge(Graph::const_iterator p)
 
 int main(int argc, char *argv[])
 {
+  NGraph::stats::parse_options(argc, argv);
+
   Graph A;
 
   cin >> A;
@@ -157,6 +159,6 @@ int main(int argc, char *argv[])
 #endif
 
   cout << A ;
-  return 0;
+  return NGraph::stats::finish(0);
 }
 
@@ -0,0 +1,599 @@
+#ifndef GRAPH_STATS_H_
+#define GRAPH_STATS_H_
+
+/*
+   Graph statistics from a single read of the graph.
+
+   A stats_graph reads a .g edge list (or a .csr or .mtx file; see
+   ngraph_static_io.hpp) once, keeping both views the old tools built
+   separately:
+
+        the raw edge stream     edge lines with repeats, self-loops, and
+                                the degrees counted with multiplicity (as
+                                mg2degree)
+        the graph               distinct edges in CSR form, and which
+                                vertices occur in the file (as a tGraph
+                                read with cin >> G)
+
+   compute_graph_statistics() then derives, in parallel passes over the
+   CSR arrays, the selected statistics: sizes, in/out/total degree
+   distributions (min, max, mean, variance, histogram), self-loops,
+   repeated edges, isolated vertices, reciprocity, degree correlation
+   and assortativity, and the clustering coefficient.  The write_*
+   functions print the reports of the old per-statistic tools.
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdint.h>
+#include "ngraph_static.hpp"
+#include "ngraph_static_io.hpp"
+#include "ngraph_stats.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+
+/**
+    A graph read for statistics; vertices are unsigned ints.
+*/
+class stats_graph
+{
+  public:
+    typedef unsigned int vertex;
+    typedef static_tGraph<vertex> graph;
+
+  private:
+    graph G_;
+    std::vector<char> present_;
+    std::vector<vertex> multi_in_;      // degrees with repeated edges
+    std::vector<vertex> multi_out_;
+    size_t num_present_;
+    size_t edge_lines_;
+    size_t self_loop_lines_;
+
+    void finish(std::vector<uint64_t> &keys, std::vector<uint64_t> &vertices,
+          bool symmetric)
+    {
+        edge_lines_ = keys.size();
+        self_loop_lines_ = 0;
+        for (size_t i=0; i<keys.size(); i++)
+          self_loop_lines_ += ((keys[i] >> 32) == (keys[i] & 0xFFFFFFFFUL));
+
+        if (symmetric)
+        {
+          const size_t m = keys.size();
+          for (size_t i=0; i<m; i++)
+            if ((keys[i] >> 32) != (keys[i] & 0xFFFFFFFFUL))
+              keys.push_back((keys[i] << 32) | (keys[i] >> 32));
+        }
+
+        // degrees with multiplicity, before the repeats go
+        vertex n = 0;
+        for (size_t i=0; i<vertices.size(); i++)
+          if (vertices[i] + 1 > n)
+            n = (vertex) (vertices[i] + 1);
+        for (size_t i=0; i<keys.size(); i++)
+        {
+          n = std::max(n, (vertex) ((keys[i] >> 32) + 1));
+          n = std::max(n, (vertex) ((keys[i] & 0xFFFFFFFFUL) + 1));
+        }
+        multi_in_.assign(n, 0);
+        multi_out_.assign(n, 0);
+        for (size_t i=0; i<keys.size(); i++)
+        {
+          multi_out_[keys[i] >> 32]++;
+          multi_in_[keys[i] & 0xFFFFFFFFUL]++;
+        }
+
+        sort_edge_keys(keys);
+        std::vector<vertex> from, to;
+        edge_keys_to_list(keys, vertices, n, from, to, &present_);
+        std::vector<uint64_t>().swap(keys);
+        G_ = graph(n, from, to);
+
+        num_present_ = 0;
+        for (vertex v=0; v<n; v++)
+          num_present_ += present_[v];
+    }
+
+  public:
+
+    stats_graph() : G_(), present_(), multi_in_(), multi_out_(),
+        num_present_(0), edge_lines_(0), self_loop_lines_(0) {}
+
+    /**
+        Read a .g, .csr or .mtx file ("-" is a .g file on stdin).  With
+        symmetric, every edge is also taken in the other direction (as
+        graph_summary does).
+    */
+    bool read(const char *filename, std::string &error,
+          bool symmetric = false)
+    {
+        stats::scoped_phase phase("read");
+
+        const std::string name(filename);
+        std::vector<uint64_t> keys, vertices;
+        if (name.size() > 4 && (name.compare(name.size() - 4, 4, ".csr") == 0
+              || name.compare(name.size() - 4, 4, ".mtx") == 0))
+        {
+          graph G;
+          if (!read_static_graph(filename, G, error))
+            return false;
+          keys.reserve(G.num_edges());
+          for (vertex v=0; v<G.num_vertices(); v++)
+          {
+            if (G.isolated(v))
+              vertices.push_back(v);
+            for (const vertex *w = G.out_neighbors_begin(v);
+                  w != G.out_neighbors_end(v); w++)
+              keys.push_back(((uint64_t) v << 32) | *w);
+          }
+        }
+        else
+        {
+          mapped_file in(filename);
+          if (!in.good())
+          {
+            error = in.error();
+            return false;
+          }
+          if (!parse_edge_keys(in.data(), in.size(), keys, vertices, error))
+          {
+            error = "[" + name + "] " + error;
+            return false;
+          }
+        }
+        finish(keys, vertices, symmetric);
+        return true;
+    }
+
+    const graph &csr() const { return G_; }
+
+    /** one more than the largest vertex number */
+    vertex num_vertices() const { return G_.num_vertices(); }
+
+    /** true for the vertices that occur in the file */
+    bool present(vertex v) const { return present_[v] != 0; }
+
+    /** number of vertices that occur in the file */
+    size_t num_present() const { return num_present_; }
+
+    /** edge lines read, repeats included */
+    size_t edge_lines() const { return edge_lines_; }
+
+    /** self-loop lines read, repeats included */
+    size_t self_loop_lines() const { return self_loop_lines_; }
+
+    /** degrees counting repeated edges */
+    const std::vector<vertex> &multi_in_degrees() const { return multi_in_; }
+    const std::vector<vertex> &multi_out_degrees() const { return multi_out_; }
+};
+
+
+/**
+    Distribution of a degree over the vertices that occur in the graph;
+    histogram[d] is the number of vertices of degree d.
+*/
+struct degree_summary
+{
+    size_t min;
+    size_t max;
+    double mean;
+    double variance;
+    std::vector<size_t> histogram;
+};
+
+
+// which statistics to compute, beyond sizes and degree distributions
+//
+const unsigned int stats_reciprocity = 1;
+const unsigned int stats_correlation = 2;
+const unsigned int stats_clustering = 4;
+const unsigned int stats_all = 7;
+
+
+struct graph_statistics
+{
+    size_t num_vertices;            // vertices in the file
+    size_t num_edges;               // distinct edges
+    size_t edge_lines;              // edges read, repeats included
+    size_t repeated_edges;          // edge_lines - num_edges
+    size_t self_loops;              // distinct
+    size_t isolated_vertices;
+    size_t sources;                 // vertices with in-degree 0 only
+    size_t sinks;                   // vertices with out-degree 0 only
+
+    degree_summary in_degree;
+    degree_summary out_degree;
+    degree_summary total_degree;    // in + out
+
+    double reciprocity;             // fraction of the (non-loop) edges
+                                    // whose reverse is also an edge
+    double degree_correlation;      // as avg_degree_correlation()
+    double assortativity;           // Newman's r, out-degree of the tail
+                                    // against in-degree of the head
+    double clustering;              // as cluster_coeff()
+};
+
+
+/**
+    Summary of degree(v) over the present vertices, in parallel.
+*/
+template <typename Degree>
+degree_summary summarize_degrees(const stats_graph &S, Degree degree)
+{
+    const long n = S.num_vertices();
+    degree_summary D;
+    D.min = D.max = 0;
+    D.mean = D.variance = 0.0;
+
+    size_t max_degree = 0;
+    size_t min_degree = (size_t) -1;
+    double sum = 0.0, sum_sq = 0.0;
+
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+      size_t my_max = 0, my_min = (size_t) -1;
+      double my_sum = 0.0, my_sum_sq = 0.0;
+#ifdef _OPENMP
+      #pragma omp for schedule(static)
+#endif
+      for (long v=0; v<n; v++)
+        if (S.present(v))
+        {
+          const size_t d = degree(v);
+          my_max = std::max(my_max, d);
+          my_min = std::min(my_min, d);
+          my_sum += d;
+          my_sum_sq += (double) d * d;
+        }
+#ifdef _OPENMP
+      #pragma omp critical
+#endif
+      {
+        max_degree = std::max(max_degree, my_max);
+        min_degree = std::min(min_degree, my_min);
+        sum += my_sum;
+        sum_sq += my_sum_sq;
+      }
+    }
+
+    const size_t k = S.num_present();
+    if (k == 0)
+      return D;
+    D.min = min_degree;
+    D.max = max_degree;
+    D.mean = sum / k;
+    D.variance = std::max(0.0, sum_sq / k - D.mean * D.mean);
+
+    D.histogram.assign(max_degree + 1, 0);
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+      std::vector<size_t> my_histogram(max_degree + 1, 0);
+#ifdef _OPENMP
+      #pragma omp for schedule(static)
+#endif
+      for (long v=0; v<n; v++)
+        if (S.present(v))
+          my_histogram[degree(v)]++;
+#ifdef _OPENMP
+      #pragma omp critical
+#endif
+      for (size_t d=0; d<=max_degree; d++)
+        D.histogram[d] += my_histogram[d];
+    }
+    return D;
+}
+
+
+// degree functions for summarize_degrees()
+//
+struct in_degree_of
+{
+    const stats_graph::graph &G;
+    explicit in_degree_of(const stats_graph::graph &g) : G(g) {}
+    size_t operator()(long v) const { return G.in_degree(v); }
+};
+
+struct out_degree_of
+{
+    const stats_graph::graph &G;
+    explicit out_degree_of(const stats_graph::graph &g) : G(g) {}
+    size_t operator()(long v) const { return G.out_degree(v); }
+};
+
+struct total_degree_of
+{
+    const stats_graph::graph &G;
+    explicit total_degree_of(const stats_graph::graph &g) : G(g) {}
+    size_t operator()(long v) const
+    {
+        return G.in_degree(v) + G.out_degree(v);
+    }
+};
+
+
+inline double pearson(double n, double sum_x, double sum_y, double sum_xy,
+      double sum_x2, double sum_y2)
+{
+    return (n * sum_xy - sum_x * sum_y) /
+        std::sqrt((n * sum_x2 - sum_x * sum_x) * (n * sum_y2 - sum_y * sum_y));
+}
+
+
+/**
+    Compute the statistics of S; which selects the optional ones
+    (stats_reciprocity, stats_correlation, stats_clustering).  Those not
+    selected are 0.
+
+    The degree correlation is that of avg_degree_correlation(): the out-
+    degree of a vertex against the mean out-degree of its out-neighbors,
+    over the vertices with out-edges.  The clustering coefficient is
+    cluster_coeff()'s: the fraction of the ordered pairs of out-neighbors
+    of a vertex joined by an edge, averaged over all vertices.
+*/
+inline graph_statistics compute_graph_statistics(const stats_graph &S,
+      unsigned int which = stats_all)
+{
+    typedef stats_graph::vertex vertex;
+    const stats_graph::graph &G = S.csr();
+    const long n = G.num_vertices();
+
+    graph_statistics R;
+    R.num_vertices = S.num_present();
+    R.num_edges = G.num_edges();
+    R.edge_lines = S.edge_lines();
+    R.repeated_edges = R.edge_lines - std::min(R.edge_lines, R.num_edges);
+    R.self_loops = R.isolated_vertices = R.sources = R.sinks = 0;
+    R.reciprocity = R.degree_correlation = R.assortativity = 0.0;
+    R.clustering = 0.0;
+
+    stats::scoped_phase phase("statistics");
+
+    R.in_degree = summarize_degrees(S, in_degree_of(G));
+    R.out_degree = summarize_degrees(S, out_degree_of(G));
+    R.total_degree = summarize_degrees(S, total_degree_of(G));
+
+    size_t self_loops = 0, isolated = 0, sources = 0, sinks = 0;
+    size_t non_loops = 0, reciprocal = 0;
+    double cx = 0, cy = 0, cxy = 0, cx2 = 0, cy2 = 0, cn = 0;   // correlation
+    double ax = 0, ay = 0, axy = 0, ax2 = 0, ay2 = 0;           // assortativity
+    double cc = 0.0;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 1024) \
+        reduction(+:self_loops) reduction(+:isolated) reduction(+:sources) \
+        reduction(+:sinks) reduction(+:non_loops) reduction(+:reciprocal) \
+        reduction(+:cx) reduction(+:cy) reduction(+:cxy) reduction(+:cx2) \
+        reduction(+:cy2) reduction(+:cn) reduction(+:ax) reduction(+:ay) \
+        reduction(+:axy) reduction(+:ax2) reduction(+:ay2) reduction(+:cc)
+#endif
+    for (long v=0; v<n; v++)
+    {
+      if (!S.present(v))
+        continue;
+      const vertex *b = G.out_neighbors_begin(v);
+      const vertex *e = G.out_neighbors_end(v);
+      const size_t out = e - b;
+      const size_t in = G.in_degree(v);
+
+      if (in == 0 && out == 0)
+        isolated++;
+      else if (in == 0)
+        sources++;
+      else if (out == 0)
+        sinks++;
+      if (std::binary_search(b, e, (vertex) v))
+        self_loops++;
+
+      if (which & stats_reciprocity)
+        for (const vertex *w = b; w != e; w++)
+          if (*w != (vertex) v)
+          {
+            non_loops++;
+            reciprocal += G.includes_edge(*w, (vertex) v);
+          }
+
+      if ((which & stats_correlation) && out > 0)
+      {
+        double avg = 0.0;
+        for (const vertex *w = b; w != e; w++)
+        {
+          avg += G.out_degree(*w);
+          const double y = G.in_degree(*w);
+          ax += out;
+          ay += y;
+          axy += out * y;
+          ax2 += (double) out * out;
+          ay2 += y * y;
+        }
+        avg /= out;
+        cx += out;
+        cy += avg;
+        cxy += out * avg;
+        cx2 += (double) out * out;
+        cy2 += avg * avg;
+        cn += 1;
+      }
+
+      if ((which & stats_clustering) && out >= 2)
+      {
+        size_t links = 0;
+        for (const vertex *w = b; w != e; w++)
+        {
+          // |out(w) intersect out(v)|, by merging the sorted rows
+          const vertex *p = G.out_neighbors_begin(*w);
+          const vertex *pe = G.out_neighbors_end(*w);
+          const vertex *q = b;
+          while (p != pe && q != e)
+          {
+            if (*p < *q)
+              p++;
+            else if (*q < *p)
+              q++;
+            else
+            {
+              links++;
+              p++;
+              q++;
+            }
+          }
+        }
+        cc += (double) links / (out * (out - 1));
+      }
+    }
+    stats::edges_scanned() += G.num_edges();
+
+    R.self_loops = self_loops;
+    R.isolated_vertices = isolated;
+    R.sources = sources;
+    R.sinks = sinks;
+    if (non_loops > 0)
+      R.reciprocity = (double) reciprocal / non_loops;
+    if (which & stats_correlation)
+    {
+      R.degree_correlation = pearson(cn, cx, cy, cxy, cx2, cy2);
+      R.assortativity = pearson(G.num_edges(), ax, ay, axy, ax2, ay2);
+    }
+    if ((which & stats_clustering) && R.num_vertices > 0)
+      R.clustering = cc / R.num_vertices;
+    return R;
+}
+
+
+/**
+    Per-vertex degrees, as g2degree: " v in out" (" v in" if undirected).
+*/
+inline void write_degrees(std::ostream &s, const stats_graph &S,
+      bool undirected)
+{
+    const stats_graph::graph &G = S.csr();
+    for (stats_graph::vertex v=0; v<S.num_vertices(); v++)
+    {
+      if (!S.present(v))
+        continue;
+      s << " " << v << " " << G.in_degree(v);
+      if (!undirected)
+        s << " " << G.out_degree(v);
+      s << "\n";
+    }
+}
+
+
+/**
+    Per-vertex degrees counting repeated edges, as mg2degree: "v in out".
+*/
+inline void write_multi_degrees(std::ostream &s, const stats_graph &S)
+{
+    const std::vector<stats_graph::vertex> &in = S.multi_in_degrees();
+    const std::vector<stats_graph::vertex> &out = S.multi_out_degrees();
+    for (stats_graph::vertex v=0; v<S.num_vertices(); v++)
+      if (S.present(v))
+        s << v << " " << in[v] << " " << out[v] << "\n";
+}
+
+
+/**
+    Vertices by total (in + out) degree, as g2degfreq: one line per
+    degree, "d v1 v2 ...".
+*/
+inline void write_degree_classes(std::ostream &s, const stats_graph &S)
+{
+    typedef stats_graph::vertex vertex;
+    const stats_graph::graph &G = S.csr();
+    const vertex n = S.num_vertices();
+
+    // counting sort of the vertices by degree
+    std::vector<size_t> start;
+    for (vertex v=0; v<n; v++)
+      if (S.present(v))
+      {
+        const size_t d = G.in_degree(v) + G.out_degree(v);
+        if (d + 2 > start.size())
+          start.resize(d + 2, 0);
+        start[d + 1]++;
+      }
+    for (size_t d=1; d<start.size(); d++)
+      start[d] += start[d-1];
+    std::vector<vertex> order(start.empty() ? 0 : start.back());
+    std::vector<size_t> pos(start);
+    for (vertex v=0; v<n; v++)
+      if (S.present(v))
+        order[pos[G.in_degree(v) + G.out_degree(v)]++] = v;
+
+    for (size_t d=0; d+1<start.size(); d++)
+    {
+      if (start[d] == start[d+1])
+        continue;
+      s << d;
+      for (size_t i=start[d]; i<start[d+1]; i++)
+        s << " " << order[i];
+      s << "\n";
+    }
+}
+
+
+/**
+    Degree histograms, "name d count" for each degree with count > 0.
+*/
+inline void write_histogram(std::ostream &s, const char *name,
+      const degree_summary &D)
+{
+    for (size_t d=0; d<D.histogram.size(); d++)
+      if (D.histogram[d] > 0)
+        s << name << " " << d << " " << D.histogram[d] << "\n";
+}
+
+
+/**
+    All the statistics, one "name value" line each.
+*/
+inline void write_statistics(std::ostream &s, const graph_statistics &R,
+      unsigned int which = stats_all)
+{
+    s << "vertices " << R.num_vertices << "\n";
+    s << "edges " << R.num_edges << "\n";
+    s << "edge_lines " << R.edge_lines << "\n";
+    s << "repeated_edges " << R.repeated_edges << "\n";
+    s << "self_loops " << R.self_loops << "\n";
+    s << "isolated_vertices " << R.isolated_vertices << "\n";
+    s << "sources " << R.sources << "\n";
+    s << "sinks " << R.sinks << "\n";
+
+    const char *names[] = {"in_degree", "out_degree", "total_degree"};
+    const degree_summary *D[] = {&R.in_degree, &R.out_degree, &R.total_degree};
+    for (unsigned int i=0; i<3; i++)
+    {
+      s << names[i] << "_min " << D[i]->min << "\n";
+      s << names[i] << "_max " << D[i]->max << "\n";
+      s << names[i] << "_mean " << D[i]->mean << "\n";
+      s << names[i] << "_variance " << D[i]->variance << "\n";
+    }
+
+    if (which & stats_reciprocity)
+      s << "reciprocity " << R.reciprocity << "\n";
+    if (which & stats_correlation)
+    {
+      s << "degree_correlation " << R.degree_correlation << "\n";
+      s << "assortativity " << R.assortativity << "\n";
+    }
+    if (which & stats_clustering)
+      s << "clustering " << R.clustering << "\n";
+}
+
+}
+// namespace NGraph
+
+#endif
+// GRAPH_STATS_H_
@@ -1,48 +1,107 @@
 #include <iostream>
 #include <string>
 #include <sstream>
-#include "ngraph.hpp"
-#include "ngraph_algorithms.cc"
-#include "ngraph_cluster_coeff.cc"
+#include <cstdlib>
+#include <cctype>
+#include "graph_stats.hpp"
+#include "ngraph_static.hpp"
+#include "ngraph_distance.hpp"
+
+/*
+    Usage:  graph_summary [-u] [-d [samples]] < graph.g
+
+    Prints [vertices] [edges] [clustering coefficient] [degree correlation]
+    of the graph, taken as undirected (-u: each edge is listed in both
+    directions, so count it once).  The graph is read once, into CSR
+    form, by graph_stats.hpp; gstats -s reports more statistics.
+
+    -d adds a section of distance statistics:
+
+        diameter [lower] [upper]         (equal when exact, by iFUB, of the
+                                          component of a largest-degree
+                                          vertex)
+        avg_path_length [mean] [+-95%]   (from BFSs out of samples sources,
+        effective_diameter [d] [+-95%]    default 256; 90% of the pairs)
+        hop [d] [pairs within d hops]    (one line per distance)
+
+*/
 
 using namespace std;
+using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
+  NGraph::stats::parse_options(argc, argv);
 
   int reps =1;
-  Graph A;
 
   bool undirected = false;
-  if (argv[1])
+  bool distances = false;
+  unsigned int samples = 256;
+  for (int i=1; i<argc; i++)
   {
-    std::string arg1(argv[1]);
-    undirected = (arg1 == "-u");
-    istringstream buffer(arg1);
-    buffer >> reps;
+    std::string arg(argv[i]);
+    if (arg == "-u")
+      undirected = true;
+    else if (arg == "-d")
+    {
+      distances = true;
+      if (i+1 < argc && isdigit(argv[i+1][0]))
+        samples = atoi(argv[++i]);
+    }
+    else
+    {
+      istringstream buffer(arg);
+      buffer >> reps;
+    }
   }
 
-  while (!std::cin.eof())
+  // for an undirected graph
+  stats_graph A;
+  string error;
+  if (!A.read("-", error, true))
   {
-     int v1, v2;
-
-     std::cin >> v1 >> v2;
-     // for an undirected graph
-     A.insert_edge(v1, v2);
-     A.insert_edge(v2, v1);
+    cerr << "Error: " << error << "\n";
+    return 1;
   }
+  graph_statistics R = compute_graph_statistics(A,
+        stats_correlation | stats_clustering);
+
+  size_t n_edges = (undirected) ? R.num_edges/2 : R.num_edges;
+
+  std::cout << R.num_vertices << " " << n_edges <<  " "
+      << R.clustering << " " << R.degree_correlation << "\n";
 
-#if 0
-    std::cout << "Avg Degree corrleation: "<<avg_degree_correlation(A) << "\n";
-    std::cout << "Max Degree corrleation: "<<max_degree_correlation(A) << "\n";
-    std::cout << "Max sqrt  corrleation: "<<max_sqrt_degree_correlation(A) << "\n";
-#endif
+  if (!distances)
+    return 0;
 
-   unsigned int n_edges = (undirected) ? A.num_edges()/2 : A.num_edges();
+  // distance statistics
 
-    std::cout << A.num_vertices() << " " << n_edges <<  " " 
-        << cluster_coeff(A) << " " << avg_degree_correlation(A) << "\n";
+  typedef stats_graph::vertex vertex;
+  const stats_graph::graph &S = A.csr();
+
+  vertex hub = 0;
+  for (vertex v=0; v<S.num_vertices(); v++)
+    if (S.out_degree(v) > S.out_degree(hub))
+      hub = v;
+
+  diameter_bounds D = ifub_diameter(S, hub);
+  std::cout << "diameter " << D.lower << " " << D.upper << "\n";
+
+  srand(1);
+  std::vector<vertex> sources = sample_sources(S, samples);
+  distance_profile P = distance_sample(S, sources);
+
+  std::cout << "avg_path_length " << P.average_path_length << " "
+      << P.average_path_length_error << "\n";
+  std::cout << "effective_diameter " << P.effective_diameter << " "
+      << P.effective_diameter_error << "\n";
+  double within = 0.0;
+  for (unsigned int d=1; d<P.pairs.size(); d++)
+  {
+    within += P.pairs[d];
+    std::cout << "hop " << d << " " << (size_t) (within + 0.5) << "\n";
+  }
 
   return 0;
 }
-
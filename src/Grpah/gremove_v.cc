@@ -19,6 +19,7 @@ using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
+  NGraph::stats::parse_options(argc, argv);
 
   if (argc <= 1)
   {
@@ -52,5 +53,5 @@ int main(int argc, char *argv[])
   G.remove_vertex_set(V);
   cout << G;
 
-  return 0;
+  return NGraph::stats::finish(0);
 }
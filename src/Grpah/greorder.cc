@@ -0,0 +1,165 @@
+//
+// Renumbers the vertices of a graph for memory locality (see
+// reorder.hpp), and reports the average log gap of the neighbor lists
+// before and after.
+//
+// Usage:  greorder [-o order] [-w window] [-p perm.imap] [-g] [-t] [-n]
+//                  [graph.csr | graph.mtx] > reordered.csr
+//
+//   -o   degree, bfs, rcm (default), gorder or none
+//   -w   window size for gorder (default 5)
+//   -p   write the permutation as "old new" pairs: renumber (mi0_2mi,
+//        ...) with this map takes vertex numbers of the original graph
+//        to the reordered one; to map results on the reordered graph
+//        back, swap its columns first (awk '{print $2, $1}')
+//   -g   read a .g graph from stdin, instead of a .csr file
+//   -t   write a .g graph, instead of .csr
+//   -n   only report the locality; write no graph
+//
+// A .csr file of "-" (or none) is read from stdin; names ending in .mtx
+// are read as MatrixMarket files.
+//
+
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include "ngraph.hpp"
+#include "ngraph_static.hpp"
+#include "mtx_io.hpp"
+#include "reorder.hpp"
+#include "ngraph_stats.hpp"
+
+using namespace std;
+using namespace NGraph;
+
+static bool ends_with(const string &s, const string &suffix)
+{
+  return s.size() >= suffix.size() &&
+         s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+  NGraph::stats::parse_options(argc, argv);
+
+  string order = "rcm";
+  unsigned int window = 5;
+  const char *perm_filename = 0;
+  const char *filename = "-";
+  bool text_in = false;
+  bool text_out = false;
+  bool report_only = false;
+  bool usage = false;
+
+  for (int i=1; i<argc; i++)
+  {
+    string a(argv[i]);
+    if (a == "-o" && i+1 < argc)
+      order = argv[++i];
+    else if (a == "-w" && i+1 < argc)
+      window = atoi(argv[++i]);
+    else if (a == "-p" && i+1 < argc)
+      perm_filename = argv[++i];
+    else if (a == "-g")
+      text_in = true;
+    else if (a == "-t")
+      text_out = true;
+    else if (a == "-n")
+      report_only = true;
+    else if (a[0] != '-' || a == "-")
+      filename = argv[i];
+    else
+      usage = true;
+  }
+
+  if (usage)
+  {
+    cerr << "Usage: " << argv[0] << " [-o degree|bfs|rcm|gorder|none] "
+         << "[-w window] [-p perm.imap] [-g] [-t] [-n] [graph.csr] "
+         << "> reordered.csr\n";
+    return 1;
+  }
+
+  static_Graph G;
+  string error;
+  {
+    stats::scoped_phase phase("read");
+    bool ok = true;
+    if (text_in)
+    {
+      Graph A;
+      cin >> A;
+      G = static_Graph(A);
+    }
+    else if (ends_with(filename, ".mtx"))
+      ok = read_mtx(filename, G, mtx_read_options(), error);
+    else
+    {
+      FILE *f = (string(filename) == "-" ? stdin : fopen(filename, "rb"));
+      if (f == 0)
+      {
+        error = "could not be opened";
+        ok = false;
+      }
+      else
+      {
+        ok = G.load(f, error);
+        if (f != stdin)
+          fclose(f);
+      }
+    }
+    if (!ok)
+    {
+      cerr << "Error: [" << filename << "] " << error << "\n";
+      return 1;
+    }
+  }
+
+  vector<static_Graph::vertex> new_id;
+  {
+    stats::scoped_phase phase("order");
+    if (!compute_order(G, order, new_id, window))
+    {
+      cerr << "Error: unknown order [" << order << "]\n";
+      return 1;
+    }
+  }
+
+  vertex_permutation<static_Graph::vertex> P(new_id);
+  static_Graph H;
+  {
+    stats::scoped_phase phase("permute");
+    H = P.apply(G);
+  }
+
+  cerr << "average log gap: " << average_log_gap(G) << " before, "
+       << average_log_gap(H) << " after (" << order << ")\n";
+
+  if (perm_filename)
+  {
+    FILE *f = fopen(perm_filename, "w");
+    if (f == 0)
+    {
+      cerr << "Error: [" << perm_filename << "] could not be opened\n";
+      return 1;
+    }
+    for (size_t v=0; v<new_id.size(); v++)
+      fprintf(f, "%lu %u\n", (unsigned long) v, new_id[v]);
+    fclose(f);
+  }
+
+  if (report_only)
+    return 0;
+
+  stats::scoped_phase phase("write");
+  stats::edges_written() += H.num_edges();
+  if (text_out)
+    cout << H;
+  else if (!H.save(stdout))
+  {
+    cerr << "Error: write failed\n";
+    return 1;
+  }
+  return NGraph::stats::finish(0);
+}
@@ -1,12 +1,59 @@
+//
+// Prints the repeated edges of a graph: each edge is printed once for
+// every occurrence after its first.
+//
+// usage:  cat graph.g | grepeated_edges [-x [-m MB] [-T dir]]
+//
+//   -x  sort externally instead of holding the graph in memory (the
+//       repeated edges then come out in sorted order)
+//
+
 #include <iostream>
 #include "ngraph.hpp"
+#include "edge_sort.hpp"
 
 
 using namespace std;
 using namespace NGraph;
 
-int main()
+
+// prints multiplicity-1 copies of each repeated edge
+//
+class repeat_printer
+{
+  public:
+    void put(const edge_record &e, size_t multiplicity)
+    {
+        if (e.is_vertex_only())
+          return;
+        for (size_t i=1; i<multiplicity; i++)
+          printf("%u %u\n", e.from, e.to);
+    }
+};
+
+
+int main(int argc, char *argv[])
 {
+   NGraph::stats::parse_options(argc, argv);
+
+   edge_sort_options opt;
+   if (parse_external_sort_options(argc, argv, opt))
+   {
+      external_edge_sorter S(opt);
+      text_edge_reader in(stdin);
+      edge_record e;
+      while (in.next(e))
+        S.add(e);
+
+      repeat_printer P;
+      if (!S.finish_counted(P))
+      {
+        cerr << "Error: " << S.error() << "\n";
+        return 1;
+      }
+      return 0;
+   }
+
    Graph G;
    bool vertex_only = false;
    Graph::vertex v1=0, v2=0;
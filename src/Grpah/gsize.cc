@@ -1,17 +1,23 @@
 #include <iostream>
-#include "ngraph.hpp"
+#include <string>
+#include "graph_stats.hpp"
 
 
 using namespace std;
 using namespace NGraph;
 
-int main()
+int main(int argc, char *argv[])
 {
-   Graph G;
+   NGraph::stats::parse_options(argc, argv);
 
-   cin >> G;
-   cout << G.num_vertices() << " " << G.num_edges() << "\n";
-   //cout << G;
+   stats_graph S;
+   string error;
+   if (!S.read("-", error))
+   {
+      cerr << "Error: " << error << "\n";
+      return 1;
+   }
+   cout << S.num_present() << " " << S.csr().num_edges() << "\n";
 
    return 0;
 }
@@ -0,0 +1,148 @@
+//
+// External-memory sort of an edge list, for graphs larger than memory.
+//
+// Usage:  cat graph.g | gsort [options] > sorted.g
+//
+//   -u        unique: remove duplicate edges
+//   -s        symmetrize: add (j,i) for every edge (i,j)
+//   -U        undirected: store every edge as (i,j) with i < j
+//   -l        remove self-loops (i,i); i is kept as a vertex (a single-number
+//             line) if it has no other out-edges
+//   -d        print only repeated edges, as "i j count"
+//   -b        input is a binary edge file (.eb), rather than text (.g)
+//   -B        write a binary edge file (.eb), rather than text (.g)
+//   -m MB     memory budget (default 256)
+//   -T dir    directory for temporary runs (default $TMPDIR or /tmp)
+//
+// Edges are sorted by (from, to); isolated vertices (single-number
+// lines) sort after the edges of that vertex.
+//
+
+#include <iostream>
+#include <string>
+#include "edge_sort.hpp"
+#include "ngraph_stats.hpp"
+
+using namespace std;
+using namespace NGraph;
+
+
+// prints records that occur more than once, with their multiplicity
+//
+class duplicate_printer
+{
+  public:
+    size_t count;
+
+    duplicate_printer() : count(0) {}
+
+    void put(const edge_record &e, size_t multiplicity)
+    {
+        if (multiplicity > 1 && !e.is_vertex_only())
+        {
+          printf("%u %u %lu\n", e.from, e.to, (unsigned long) multiplicity);
+          count++;
+        }
+    }
+};
+
+
+// the vertex records left by removed self-loops are only needed for
+// vertices without other out-edges
+//
+template <class Sink>
+static bool finish_filtered(external_edge_sorter &S, Sink &W)
+{
+    vertex_record_filter<Sink> F(W);
+    return S.finish(F);
+}
+
+int main(int argc, char *argv[])
+{
+  NGraph::stats::parse_options(argc, argv);
+
+  edge_sort_options opt;
+  parse_external_sort_options(argc, argv, opt);
+
+  bool binary_in = false;
+  bool binary_out = false;
+  bool duplicates = false;
+
+  for (int i=1; i<argc; i++)
+  {
+    string a(argv[i]);
+    if (a == "-u")
+      opt.unique = true;
+    else if (a == "-s")
+      opt.symmetrize = true;
+    else if (a == "-U")
+      opt.undirected = true;
+    else if (a == "-l")
+      opt.remove_self_loops = true;
+    else if (a == "-d")
+      duplicates = true;
+    else if (a == "-b")
+      binary_in = true;
+    else if (a == "-B")
+      binary_out = true;
+    else
+    {
+      cerr << "Usage: " << argv[0] << " [-u] [-s] [-U] [-l] [-d] [-b] [-B]"
+           << " [-m MB] [-T dir] < graph > sorted\n";
+      return 1;
+    }
+  }
+
+  external_edge_sorter S(opt);
+  edge_record e;
+  {
+    stats::scoped_phase phase("runs");
+    if (binary_in)
+    {
+      edge_reader in(stdin);
+      while (in.next(e))
+        S.add(e);
+    }
+    else
+    {
+      text_edge_reader in(stdin);
+      while (in.next(e))
+        S.add(e);
+    }
+  }
+  stats::edges_read() += S.num_added();
+
+  bool ok = true;
+  if (duplicates)
+  {
+    duplicate_printer P;
+    ok = S.finish_counted(P);
+    stats::edges_written() += P.count;
+  }
+  else if (binary_out)
+  {
+    edge_writer W(stdout);
+    ok = (opt.remove_self_loops ? finish_filtered(S, W) : S.finish(W));
+    W.flush();
+    stats::edges_written() += W.count();
+    if (ok && !W.good())
+    {
+      cerr << "Error: " << W.error() << "\n";
+      return 1;
+    }
+  }
+  else
+  {
+    text_edge_writer W(stdout);
+    ok = (opt.remove_self_loops ? finish_filtered(S, W) : S.finish(W));
+    W.flush();
+    stats::edges_written() += W.count();
+  }
+
+  if (!ok)
+  {
+    cerr << "Error: " << S.error() << "\n";
+    return 1;
+  }
+  return 0;
+}
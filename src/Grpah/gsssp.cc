@@ -0,0 +1,82 @@
+//
+// Shortest-path distances from a source vertex in a weighted graph, by
+// parallel delta-stepping (see nwgraph_algorithms.hpp).
+//
+// Usage:  gsssp [-d delta] source [graph.wg | graph.csr] > distances
+//
+// The graph is a weighted edge list ("from to weight" lines; a missing
+// weight is 1), read from stdin if not given, or a .csr file whose
+// values are the weights.  Weights must be non-negative.  Parallel edges
+// (the same "from to" with several weights) count as the shortest of
+// them.
+//
+// Output: two columns, [vertex] [distance], for the reachable vertices.
+//
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "nwgraph.hpp"
+#include "nwgraph_algorithms.hpp"
+#include "ngraph_stats.hpp"
+
+using namespace std;
+using namespace NGraph;
+
+int main(int argc, char *argv[])
+{
+  NGraph::stats::parse_options(argc, argv);
+
+  double delta = 0.0;
+  const char *source_arg = 0;
+  const char *filename = "-";
+  bool usage = false;
+
+  for (int i=1; i<argc; i++)
+  {
+    string a(argv[i]);
+    if (a == "-d" && i+1 < argc)
+      delta = atof(argv[++i]);
+    else if (a[0] != '-' && source_arg == 0)
+      source_arg = argv[i];
+    else if (a[0] != '-' || a == "-")
+      filename = argv[i];
+    else
+      usage = true;
+  }
+
+  if (usage || source_arg == 0)
+  {
+    cerr << "Usage: " << argv[0] << " [-d delta] source [graph.wg | graph.csr]"
+         << " > distances\n";
+    return 1;
+  }
+
+  nwGraph_d G;
+  string error;
+  {
+    stats::scoped_phase phase("read");
+    if (!read_nwgraph(filename, G, error, min_parallel_edges))
+    {
+      cerr << "Error: " << error << "\n";
+      return 1;
+    }
+  }
+
+  for (size_t k=0; k<G.num_edges(); k++)
+    if (G.out_weights()[k] < 0.0)
+    {
+      cerr << "Error: negative edge weight\n";
+      return 1;
+    }
+
+  const unsigned int source = atoi(source_arg);
+  vector<double> dist = delta_stepping(G, source, delta);
+
+  stats::scoped_phase phase("write");
+  for (unsigned int v=0; v<dist.size(); v++)
+    if (dist[v] != numeric_limits<double>::infinity())
+      cout << v << " " << dist[v] << "\n";
+
+  return NGraph::stats::finish(0);
+}
@@ -0,0 +1,133 @@
+//
+// Graph statistics, any number of reports from a single read of the
+// graph (see graph_stats.hpp).
+//
+// Usage:  gstats [-u] [-s] [-r report,...] [graph.g | graph.csr | graph.mtx]
+//
+//      -u      the graph is undirected, each edge listed both ways:
+//              edges are counted once, and degree prints one column
+//      -s      take every edge in both directions (as graph_summary)
+//      -r      reports, in order (default summary):
+//
+//              summary     "name value" lines: sizes, self-loops,
+//                          repeated edges, isolated vertices, degree
+//                          min/max/mean/variance, reciprocity, degree
+//                          correlation, assortativity, clustering
+//              size        [vertices] [edges]                 (as gsize)
+//              degree      [vertex] [in] [out]             (as g2degree)
+//              mdegree     degrees counting repeated edges (as mg2degree)
+//              degfreq     [degree] [vertices...]         (as g2degfreq)
+//              hist        "in|out|total [degree] [count]" histograms
+//
+// The graph is read from stdin (as .g) if not given.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "graph_stats.hpp"
+#include "ngraph_stats.hpp"
+
+using namespace std;
+using namespace NGraph;
+
+int main(int argc, char *argv[])
+{
+  NGraph::stats::parse_options(argc, argv);
+
+  bool undirected = false;
+  bool symmetric = false;
+  string report_list = "summary";
+  const char *filename = "-";
+  bool usage = false;
+
+  for (int i=1; i<argc; i++)
+  {
+    string a(argv[i]);
+    if (a == "-u")
+      undirected = true;
+    else if (a == "-s")
+      symmetric = true;
+    else if (a == "-r" && i+1 < argc)
+      report_list = argv[++i];
+    else if (a[0] != '-' || a == "-")
+      filename = argv[i];
+    else
+      usage = true;
+  }
+
+  vector<string> reports;
+  for (size_t p = 0; p <= report_list.size(); )
+  {
+    size_t q = report_list.find(',', p);
+    if (q == string::npos)
+      q = report_list.size();
+    reports.push_back(report_list.substr(p, q - p));
+    p = q + 1;
+  }
+
+  unsigned int which = 0;
+  bool need_summary = false;
+  for (size_t i=0; i<reports.size(); i++)
+  {
+    const string &r = reports[i];
+    if (r == "summary")
+    {
+      which = stats_all;
+      need_summary = true;
+    }
+    else if (r == "hist")
+      need_summary = true;
+    else if (r != "size" && r != "degree" && r != "mdegree" && r != "degfreq")
+    {
+      cerr << "Error: unknown report " << r << "\n";
+      usage = true;
+    }
+  }
+
+  if (usage)
+  {
+    cerr << "Usage: " << argv[0] << " [-u] [-s] "
+         << "[-r summary,size,degree,mdegree,degfreq,hist] "
+         << "[graph.g | graph.csr | graph.mtx]\n";
+    return 1;
+  }
+
+  stats_graph S;
+  string error;
+  if (!S.read(filename, error, symmetric))
+  {
+    cerr << "Error: " << error << "\n";
+    return 1;
+  }
+
+  graph_statistics R;
+  if (need_summary)
+    R = compute_graph_statistics(S, which);
+
+  stats::scoped_phase phase("write");
+  for (size_t i=0; i<reports.size(); i++)
+  {
+    const string &r = reports[i];
+    if (r == "summary")
+      write_statistics(cout, R);
+    else if (r == "size")
+      cout << S.num_present() << " "
+           << (undirected ? S.csr().num_edges() / 2 : S.csr().num_edges())
+           << "\n";
+    else if (r == "degree")
+      write_degrees(cout, S, undirected);
+    else if (r == "mdegree")
+      write_multi_degrees(cout, S);
+    else if (r == "degfreq")
+      write_degree_classes(cout, S);
+    else if (r == "hist")
+    {
+      write_histogram(cout, "in", R.in_degree);
+      write_histogram(cout, "out", R.out_degree);
+      write_histogram(cout, "total", R.total_degree);
+    }
+  }
+
+  return 0;
+}
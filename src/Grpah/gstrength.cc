@@ -0,0 +1,76 @@
+//
+// Weighted degrees (strengths) of a weighted graph.
+//
+// Usage:  gstrength [-s] [graph.wg | graph.csr] > graph.strength
+//
+// Output: five columns, [vertex] [out-degree] [in-degree] [out-strength]
+// [in-strength], where a strength is the sum of the weights of the
+// edges; with -s, only a summary of the out-strengths.
+//
+// The graph is a weighted edge list ("from to weight" lines; a missing
+// weight is 1, and repeated edges add up), read from stdin if not
+// given, or a .csr file whose values are the weights.
+//
+
+#include <iostream>
+#include <string>
+#include "nwgraph.hpp"
+#include "nwgraph_algorithms.hpp"
+#include "ngraph_stats.hpp"
+
+using namespace std;
+using namespace NGraph;
+
+int main(int argc, char *argv[])
+{
+  NGraph::stats::parse_options(argc, argv);
+
+  bool summary = false;
+  const char *filename = "-";
+
+  for (int i=1; i<argc; i++)
+  {
+    string a(argv[i]);
+    if (a == "-s")
+      summary = true;
+    else if (a[0] != '-' || a == "-")
+      filename = argv[i];
+    else
+    {
+      cerr << "Usage: " << argv[0] << " [-s] [graph.wg | graph.csr]\n";
+      return 1;
+    }
+  }
+
+  nwGraph_d G;
+  string error;
+  {
+    stats::scoped_phase phase("read");
+    if (!read_nwgraph(filename, G, error))
+    {
+      cerr << "Error: " << error << "\n";
+      return 1;
+    }
+  }
+
+  if (summary)
+  {
+    vector<double> strength;
+    strength_summary S = strength_stats(G, strength);
+    cout << "vertices:      " << G.num_vertices() << "\n"
+         << "edges:         " << G.num_edges() << "\n"
+         << "total weight:  " << S.total << "\n"
+         << "min strength:  " << S.min << "\n"
+         << "max strength:  " << S.max << " (vertex " << S.max_vertex << ")\n"
+         << "mean strength: " << S.mean << "\n"
+         << "std deviation: " << S.stddev << "\n";
+    return 0;
+  }
+
+  for (unsigned int v=0; v<G.num_vertices(); v++)
+    if (!G.isolated(v))
+      cout << v << " " << G.out_degree(v) << " " << G.in_degree(v) << " "
+           << G.out_strength(v) << " " << G.in_strength(v) << "\n";
+
+  return 0;
+}
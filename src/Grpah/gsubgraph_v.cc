@@ -20,7 +20,8 @@ using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
-  
+    NGraph::stats::parse_options(argc, argv);
+
     if (argc < 2)
     {
         cerr << "Usage: " << argv[0] << " graph.g < graph.v \n";
@@ -59,5 +60,5 @@ int main(int argc, char *argv[])
 
     cout << G_V;
 
-    return 0;
+    return NGraph::stats::finish(0);
 }
@@ -0,0 +1,50 @@
+//
+// usage:  cat graphA.g | gsymm_diff graphB.g > graph_symm_diff.g
+//         cat graphA.eb | gsymm_diff -b [-m MB] graphB.eb [...] > graph.eb
+//
+// Edges found in exactly one of the two graphs (or, with more than two
+// graphs in -b mode, in an odd number of them).
+//
+//  -b  streaming mode: the inputs are sorted binary edge files (see g2eb
+//      and gsort), merged without loading either graph into memory.  The
+//      result is a sorted binary edge file, usable by the next stage.
+//  -m  memory budget (MB) for the stream buffers in -b mode (default 64)
+//
+
+#include <iostream>
+#include <fstream>
+#include "ngraph.hpp"
+#include "edge_merge.hpp"
+
+
+using namespace std;
+using namespace NGraph;
+
+int main(int argc, char *argv[])
+{
+   NGraph::stats::parse_options(argc, argv);
+
+   if (argc > 1 && std::string(argv[1]) == "-b")
+     return edge_set_tool(edge_symmetric_difference, argc-2, argv+2, false);
+
+   if (argc < 2)
+   {
+     cerr << "Usage:  cat graphA.g | gsymm_diff graphB.g > graph_symm_diff.g\n";
+     exit(1);
+   }
+
+   const char *graph_filename_B  = argv[1];
+   ifstream graph_file_B;
+   graph_file_B.open(graph_filename_B);
+
+   Graph A;
+   cin >> A;
+
+   Graph B;
+   graph_file_B >> B;
+   graph_file_B.close();
+
+   cout << ((A - B) + (B - A));
+
+   return NGraph::stats::finish(0);
+}
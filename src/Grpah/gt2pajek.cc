@@ -24,10 +24,10 @@
 
 #include <iostream>
 #include <fstream>
-#include <map>
-#include <set>
+#include <sstream>
+#include <string>
+#include <cstdio>
 #include "ngraph.hpp"
-#include "set_ops.hpp"
 
 using namespace std;
 using namespace NGraph;
@@ -35,56 +35,61 @@ using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
+   NGraph::stats::parse_options(argc, argv);
 
    if (argc < 3)
    {
        cerr << "Usage: " << argv[0] << " graph.g  graph.t \n";
-       exit (1);
+       return 1;
    }
 
    const char *graph_filename = argv[1];
    const char *vertex_label_filename = argv[2];
-   ifstream graph_file;
-   ifstream vertex_label_file;
+   ifstream graph_file(graph_filename);
+   ifstream vertex_label_file(vertex_label_filename);
 
-   //cerr << "Opening ["<< graph_filename << "]" << endl;
-
-   graph_file.open( graph_filename);
-   if (!graph_filename)
+   if (!graph_file)
    {
        cerr << "Error: [" << graph_filename << "] could not be opened.\n";
-       exit(1);
+       return 1;
    }
-
-
-   vertex_label_file.open(vertex_label_filename);
-   if (!vertex_label_filename)
-   {        cerr << "Error: ["<< vertex_label_filename<< "] could not
-be opened.\n";
-       exit(1);
+   if (!vertex_label_file)
+   {
+       cerr << "Error: [" << vertex_label_filename << "] could not be opened.\n";
+       return 1;
    }
 
+   // each line of the .t file is a vertex and its label (the rest of
+   // the line)
 
-
-
-  Graph G;
-  graph_file >> G;
-
-  map<Graph::vertex, string> T;
-
-   while (!vertex_label_file.eof())
+   vertex_labels T;
+   Graph::vertex_set V;
+   string line;
+   while (getline(vertex_label_file, line))
    {
+       istringstream s(line);
        Graph::vertex node;
-
-       vertex_file >> node ;
+       if (!(s >> node))
+         continue;
+       string label;
+       getline(s >> ws, label);
+       T[node] = label;
        V.insert(node);
    }
 
-  Graph G;
-  graph_file >> G;
+   Graph G;
+   graph_file >> G;
 
-  Graph G_V = G.subgraph(V);
+   // only the labeled vertices (the .t file may list more)
 
-   cout << G_V;
+   Graph G_V = G.subgraph(V);
+
+   string error;
+   if (!write_graph(stdout, G_V, write_options(pajek_format, &T), error))
+   {
+       cerr << "Error: " << error << "\n";
+       return 1;
+   }
 
-   return 0;
+   return NGraph::stats::finish(0);
+}
@@ -14,6 +14,7 @@ typedef Graph::const_vertex_iterator cvit;
 
 int main(int argc, char *argv[])
 {
+  NGraph::stats::parse_options(argc, argv);
 
   Graph G;
 
@@ -37,6 +38,6 @@ int main(int argc, char *argv[])
   }
 
   
-  return 0;
+  return NGraph::stats::finish(0);
 }
 
@@ -1,10 +1,17 @@
 //
-// usage:  cat graphA.g | gunion graphB.g > graph_uion.g
+// usage:  cat graphA.g | gunion graphB.g > graph_union.g
+//         cat graphA.eb | gunion -b [-m MB] graphB.eb [...] > graph_union.eb
+//
+//  -b  streaming mode: the inputs are sorted binary edge files (see g2eb
+//      and gsort), merged without loading either graph into memory.  The
+//      result is a sorted binary edge file, usable by the next stage.
+//  -m  memory budget (MB) for the stream buffers in -b mode (default 64)
 //
 
 #include <iostream>
 #include <fstream>
 #include "ngraph.hpp"
+#include "edge_merge.hpp"
 
 
 using namespace std;
@@ -12,7 +19,10 @@ using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
+   NGraph::stats::parse_options(argc, argv);
 
+   if (argc > 1 && std::string(argv[1]) == "-b")
+     return edge_set_tool(edge_union, argc-2, argv+2, false);
 
    if (argc < 2)
    {
@@ -35,7 +45,7 @@ int main(int argc, char *argv[])
    //cout << B.intersect(A);
    cout << B + A;
 
-   return 0;
+   return NGraph::stats::finish(0);
 }
 
 
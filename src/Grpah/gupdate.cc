@@ -0,0 +1,94 @@
+//
+// Applies a batch of edge deletions and insertions to a graph, in
+// parallel (static_tGraph::update(); see ngraph_static.hpp).
+//
+// Usage:  gupdate [-i inserts.g] [-d deletes.g] [-t]
+//                 [graph.g | graph.csr | graph.mtx] > updated.csr
+//
+//   -i   edges to insert (a .g edge list)
+//   -d   edges to delete (a .g edge list); deletions are applied first
+//   -t   write a .g graph, instead of .csr
+//
+// The graph is read from stdin (as .g) if not given.  The numbers of
+// edges actually inserted and removed are reported on stderr.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include "ngraph_static.hpp"
+#include "ngraph_static_io.hpp"
+#include "ngraph_stats.hpp"
+
+using namespace std;
+using namespace NGraph;
+
+typedef unsigned int vertex;
+typedef static_tGraph<vertex>::edge edge;
+
+int main(int argc, char *argv[])
+{
+  NGraph::stats::parse_options(argc, argv);
+
+  const char *insert_filename = 0;
+  const char *delete_filename = 0;
+  const char *filename = "-";
+  bool text_output = false;
+  bool usage = false;
+
+  for (int i=1; i<argc; i++)
+  {
+    string a(argv[i]);
+    if (a == "-i" && i+1 < argc)
+      insert_filename = argv[++i];
+    else if (a == "-d" && i+1 < argc)
+      delete_filename = argv[++i];
+    else if (a == "-t")
+      text_output = true;
+    else if (a[0] != '-' || a == "-")
+      filename = argv[i];
+    else
+      usage = true;
+  }
+
+  if (usage)
+  {
+    cerr << "Usage: " << argv[0] << " [-i inserts.g] [-d deletes.g] [-t] "
+         << "[graph.g | graph.csr | graph.mtx] > updated.csr\n";
+    return 1;
+  }
+
+  static_tGraph<vertex> G;
+  vector<edge> insertions, deletions;
+  string error;
+  {
+    stats::scoped_phase phase("read");
+    if (!read_static_graph(filename, G, error) ||
+        !read_edge_set(insert_filename, insertions, error) ||
+        !read_edge_set(delete_filename, deletions, error))
+    {
+      cerr << "Error: " << error << "\n";
+      return 1;
+    }
+  }
+
+  update_counts C;
+  {
+    stats::scoped_phase phase("update");
+    C = G.update(insertions, deletions);
+  }
+  cerr << "# inserted " << C.edges_inserted << " removed " << C.edges_removed
+       << " edges, " << C.vertices_inserted << " new vertices\n";
+
+  stats::scoped_phase phase("write");
+  stats::edges_written() += G.num_edges();
+  if (text_output)
+    cout << G;
+  else if (!G.save(stdout))
+  {
+    cerr << "Error: could not write graph\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "nwgraph.hpp"
+#include "nwgraph_algorithms.hpp"
+#include "ngraph_stats.hpp"
+
+// computes page_rank for a weighted graph, where each vertex passes its
+// rank to its out-neighbors in proportion to the edge weights
+//
+//
+//  Usage  cat graph.wg |  gwpagerank [num-iteratons] [min-delta] > graph.p    
+//
+// The input is a weighted edge list ("from to weight" lines; a missing
+// weight is 1, and repeated edges add up); see nwgraph.hpp.
+//
+// two colums: [node] [pagerank]
+//
+
+using namespace std;
+using namespace NGraph;
+
+
+typedef unsigned int uInt;
+
+int main(int argc, char *argv[])
+{
+  NGraph::stats::parse_options(argc, argv);
+
+  uInt max_iterations = 200; 
+  
+  // stop if page rank values change by max of 0.0001%
+  double max_delta = 0.000001;              
+
+  if (argc >1)
+    max_iterations = atoi(argv[1]);
+
+  if (argc > 2)
+    max_delta = atof(argv[2]);
+
+
+  nwGraph_d G;
+  string error;
+  {
+    stats::scoped_phase phase("read");
+    if (!read_nwgraph("-", G, error))
+    {
+      cerr << "Error: " << error << "\n";
+      return 1;
+    }
+  }
+ 
+  uInt iterations_used = 0;
+  vector<double> P = weighted_pagerank(G, iterations_used, max_iterations, 
+          max_delta);
+
+  cerr << "iterations = " << iterations_used << 
+          "  max_delta = " << max_delta << "\n";
+  for (uInt v=0; v<P.size(); v++)
+  {
+      if (!G.isolated(v))
+        cout << v << "  " << P[v] << "\n";
+  }
+
+
+  return 0;
+}
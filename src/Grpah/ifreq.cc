@@ -2,38 +2,205 @@
 //
 //  (basically a word frequency)
 //  and prints out the degree and how many times it occured
+//
+//  (ifreq is freq for integers: the list is printed in numerical order.)
+//  Integers are counted in parallel chunks, each with its own hash
+//  table (see sketch.hpp), merged at the end; other tokens are skipped.
+//
+//  Usage:  ifreq [-d | -k top] [-e error] [-o out.sketch] [file ...]
+//
+//  -d, -k, -e and -o are as for freq: distinct count or top integers,
+//  estimated in bounded memory, and saved sketches (*.sketch) to merge.
 
 #include <iostream>
 #include <string>
-#include <map>
-
-#define foreach(p,C)   for (p=C.begin(); p!=C.end(); (p)++)
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include "mapped_file.hpp"
+#include "sketch.hpp"
+#include "token.hpp"
+#include "ngraph_stats.hpp"
 
 using namespace std;
+using namespace NGraph;
 
-int main()
+enum freq_mode { exact_mode, distinct_mode, top_mode };
+
+// a whole token of (optional sign and) decimal digits
+//
+static bool parse_int(const str_ref &s, long &x)
 {
-  typedef int file_content_type;
-  typedef  map<file_content_type, unsigned int> Word_count;
+    size_t i = (s.size > 0 && (s[0] == '-' || s[0] == '+') ? 1 : 0);
+    if (i == s.size)
+      return false;
+    unsigned long v = 0;
+    for (; i<s.size; i++)
+    {
+      if (s[i] < '0' || s[i] > '9')
+        return false;
+      v = 10 * v + (s[i] - '0');
+    }
+    x = (s[0] == '-' ? -(long) v : (long) v);
+    return true;
+}
 
-   Word_count F;
+struct signed_less
+{
+    bool operator()(const exact_counter::item &a,
+          const exact_counter::item &b) const
+    {
+        return (long) a.first < (long) b.first;
+    }
+};
+
+int main(int argc, char *argv[])
+{
+   NGraph::stats::parse_options(argc, argv);
 
-   file_content_type word;
+   freq_mode mode = exact_mode;
+   size_t top = 0;
+   double error_bound = 0.0;
+   const char *sketch_filename = 0;
+   vector<const char *> inputs;
+   bool usage = false;
 
-   while(cin >> word)
+   for (int i=1; i<argc; i++)
    {
-        F[word]++;
+     string a(argv[i]);
+     if (a == "-d")
+       mode = distinct_mode;
+     else if (a == "-k" && i+1 < argc)
+     {
+       mode = top_mode;
+       top = atol(argv[++i]);
+     }
+     else if (a == "-e" && i+1 < argc)
+       error_bound = atof(argv[++i]);
+     else if (a == "-o" && i+1 < argc)
+       sketch_filename = argv[++i];
+     else if (a[0] != '-' || a == "-")
+       inputs.push_back(argv[i]);
+     else
+       usage = true;
    }
+   if (usage || error_bound < 0.0 || (mode == top_mode && top == 0) ||
+         (mode == exact_mode && sketch_filename != 0))
+   {
+     cerr << "Usage: " << argv[0] << " [-d | -k top] [-e error] "
+          << "[-o out.sketch] [file ...]\n";
+     return 1;
+   }
+   if (inputs.empty())
+     inputs.push_back("-");
 
+#ifdef _OPENMP
+   const unsigned int num_chunks = omp_get_max_threads();
+#else
+   const unsigned int num_chunks = 1;
+#endif
 
-  // now print out the frequency list
+   // one counter or sketch per thread, merged at the end
+   vector<exact_counter> F(mode == exact_mode ? num_chunks : 0);
+   vector<hyperloglog> H(mode == distinct_mode ? num_chunks : 0,
+         hyperloglog(hyperloglog::precision_for(
+         error_bound > 0.0 ? error_bound : 0.01)));
+   vector<heavy_hitters<long> > T(mode == top_mode ? num_chunks : 0,
+         heavy_hitters<long>(top, error_bound > 0.0 ? error_bound : 1e-4));
 
-  Word_count::const_iterator p;
-  foreach(p, F)
+   string error;
+   {
+     stats::scoped_phase phase("count");
+     for (size_t n=0; n<inputs.size(); n++)
+     {
+       if (mode != exact_mode && is_sketch_file(inputs[n]))
+       {
+         const bool ok = (mode == distinct_mode ?
+               merge_sketch(inputs[n], H[0], error) :
+               merge_sketch(inputs[n], T[0], error));
+         if (!ok)
+         {
+           cerr << "Error: " << error << "\n";
+           return 1;
+         }
+         continue;
+       }
+
+       line_block_reader in(inputs[n]);
+       const char *data;
+       size_t size;
+       while (in.next(data, size))
+       {
+         vector<const char *> bounds = line_chunks(data, size, num_chunks);
+#ifdef _OPENMP
+         #pragma omp parallel for schedule(static, 1)
+#endif
+         for (int t=0; t<(int) num_chunks; t++)
+         {
+           str_tokenizer W(str_ref(bounds[t], bounds[t+1] - bounds[t]),
+                 " \t\n\v\f\r");
+           str_ref word;
+           long x;
+           while (W.next(word))
+           {
+             if (!parse_int(word, x))
+               continue;
+             if (mode == exact_mode)
+               F[t].add((uint64_t) x);
+             else if (mode == distinct_mode)
+               H[t].add(hash_uint((uint64_t) x));
+             else
+               T[t].add(hash_uint((uint64_t) x), x);
+           }
+         }
+       }
+       if (!in.good())
+       {
+         cerr << "Error: " << in.error() << "\n";
+         return 1;
+       }
+     }
+
+     for (unsigned int t=1; t<F.size(); t++)
+       F[0].merge(F[t]);
+     for (unsigned int t=1; t<H.size(); t++)
+       H[0].merge(H[t]);
+     for (unsigned int t=1; t<T.size(); t++)
+       T[0].merge(T[t]);
+   }
+
+  if (sketch_filename != 0 && !(mode == distinct_mode ?
+        save_sketch(sketch_filename, H[0]) :
+        save_sketch(sketch_filename, T[0])))
   {
+    cerr << "Error: [" << sketch_filename << "] could not be written\n";
+    return 1;
+  }
 
-    cout << p->first << "  " << p->second << "\n";
+  // now print out the frequency list
+
+  if (mode == distinct_mode)
+  {
+    printf("%.0f\n", H[0].estimate());
+    cerr << "# relative error " << H[0].error() << "\n";
+  }
+  else if (mode == top_mode)
+  {
+    vector<heavy_hitters<long>::item> I = T[0].top();
+    for (size_t i=0; i<I.size() && i<top; i++)
+      cout << I[i].first << "  " << I[i].second << "\n";
+    cerr << "# counts over by at most "
+         << (uint64_t) (T[0].sketch().epsilon() * T[0].sketch().total())
+         << " (of " << T[0].sketch().total() << " integers)\n";
+  }
+  else
+  {
+    vector<exact_counter::item> I = F[0].items();
+    sort(I.begin(), I.end(), signed_less());
+    for (size_t i=0; i<I.size(); i++)
+      cout << (long) I[i].first << "  " << I[i].second << "\n";
   }
 
-  return 0;
+  return NGraph::stats::finish(0);
 }
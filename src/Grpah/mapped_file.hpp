@@ -0,0 +1,251 @@
+#ifndef NGRAPH_MAPPED_FILE_H_
+#define NGRAPH_MAPPED_FILE_H_
+
+/*
+   Read-only view of a whole input file, for parsers that split their
+   input into chunks (one per thread) rather than reading it line by
+   line.
+
+   Regular files are memory-mapped, so no copy is made; anything that
+   cannot be mapped (stdin, pipes) is read into a buffer instead.  Either
+   way, data() .. data()+size() is the file's contents, and stays valid
+   for the lifetime of the object.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace NGraph
+{
+
+class mapped_file
+{
+  private:
+    const char *data_;
+    size_t size_;
+    void *map_;
+    std::vector<char> buffer_;
+    std::string error_;
+
+    mapped_file(const mapped_file &);
+    mapped_file & operator=(const mapped_file &);
+
+    void read_all(int fd)
+    {
+        const size_t chunk = 1 << 20;
+        size_t len = 0;
+        for (;;)
+        {
+          buffer_.resize(len + chunk);
+          ssize_t r = read(fd, &buffer_[len], chunk);
+          if (r < 0)
+          {
+            error_ = "read failed";
+            break;
+          }
+          if (r == 0)
+            break;
+          len += r;
+        }
+        buffer_.resize(len);
+        data_ = (len > 0 ? &buffer_[0] : 0);
+        size_ = len;
+    }
+
+    void open_fd(int fd)
+    {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+        {
+          void *p = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+          if (p != MAP_FAILED)
+          {
+            madvise(p, st.st_size, MADV_SEQUENTIAL);
+            map_ = p;
+            data_ = (const char *) p;
+            size_ = st.st_size;
+            return;
+          }
+        }
+        read_all(fd);
+    }
+
+  public:
+
+    /**
+        @param filename  file to map; "-" denotes stdin
+    */
+    mapped_file(const char *filename) : data_(0), size_(0), map_(0),
+        buffer_(), error_()
+    {
+        if (std::string(filename) == "-")
+        {
+          open_fd(0);
+          return;
+        }
+        int fd = open(filename, O_RDONLY);
+        if (fd < 0)
+        {
+          error_ = std::string("[") + filename + "] could not be opened";
+          return;
+        }
+        open_fd(fd);
+        close(fd);
+    }
+
+    ~mapped_file()
+    {
+        if (map_ != 0)
+          munmap(map_, size_);
+    }
+
+    bool good() const { return error_.empty(); }
+    const std::string &error() const { return error_; }
+
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+
+    /** true if the file is mapped, rather than copied */
+    bool mapped() const { return map_ != 0; }
+};
+
+
+/**
+    Split data[0..size) into num_chunks pieces for parallel parsing,
+    moving each boundary forward to the start of a line.  Chunk t is
+    [bounds[t], bounds[t+1]); some chunks may be empty.
+*/
+inline std::vector<const char *> line_chunks(const char *data, size_t size,
+      unsigned int num_chunks)
+{
+    const char *end = data + size;
+    std::vector<const char *> bounds(num_chunks + 1, end);
+    bounds[0] = data;
+    for (unsigned int t=1; t<num_chunks; t++)
+    {
+      const char *s = data + size * t / num_chunks;
+      if (s < bounds[t-1])
+        s = bounds[t-1];
+      while (s < end && s > data && s[-1] != '\n')
+        s++;
+      bounds[t] = s;
+    }
+    return bounds;
+}
+
+
+/**
+    Reads a file (or stdin) in blocks of whole lines, for tools that make
+    one pass over input too large to hold in memory: each block is the
+    next block_bytes or so of the input, cut after its last newline (the
+    rest is carried over to the next block).  A line longer than a block
+    makes the block grow to hold it.
+*/
+class line_block_reader
+{
+  private:
+    FILE *f_;
+    bool close_;
+    std::vector<char> buffer_;
+    size_t carry_;          // bytes of the next block already read
+    size_t size_;           // of the current block
+    uint64_t offset_;       // of the current block, in the input
+    bool eof_;
+    std::string error_;
+
+    line_block_reader(const line_block_reader &);
+    line_block_reader & operator=(const line_block_reader &);
+
+  public:
+
+    /**
+        @param filename  file to read; "-" denotes stdin
+    */
+    line_block_reader(const char *filename, size_t block_bytes = 64 << 20) :
+        f_(0), close_(false), buffer_(block_bytes > 0 ? block_bytes : 1),
+        carry_(0), size_(0), offset_(0), eof_(false), error_()
+    {
+        if (std::string(filename) == "-")
+          f_ = stdin;
+        else
+        {
+          f_ = fopen(filename, "rb");
+          close_ = true;
+          if (f_ == 0)
+            error_ = std::string("[") + filename + "] could not be opened";
+        }
+    }
+
+    ~line_block_reader()
+    {
+        if (close_ && f_ != 0)
+          fclose(f_);
+    }
+
+    bool good() const { return error_.empty(); }
+    const std::string &error() const { return error_; }
+
+    /** position of the current block in the input */
+    uint64_t offset() const { return offset_; }
+
+    /**
+        The next block, as data[0..size).
+
+        @return false at the end of the input (or on an error)
+    */
+    bool next(const char *&data, size_t &size)
+    {
+        if (f_ == 0)
+          return false;
+
+        // move the carried-over bytes to the front
+        offset_ += size_;
+        const size_t rest = carry_ - size_;
+        if (rest > 0 && size_ > 0)
+          memmove(&buffer_[0], &buffer_[size_], rest);
+        size_t len = rest;
+
+        for (;;)
+        {
+          if (!eof_ && len < buffer_.size())
+          {
+            len += fread(&buffer_[len], 1, buffer_.size() - len, f_);
+            if (len < buffer_.size())
+            {
+              eof_ = true;
+              if (ferror(f_))
+                error_ = "read failed";
+            }
+          }
+          size_t end = len;
+          if (!eof_)
+          {
+            while (end > 0 && buffer_[end-1] != '\n')
+              end--;
+            if (end == 0)
+            {
+              buffer_.resize(2 * buffer_.size());
+              continue;
+            }
+          }
+          carry_ = len;
+          size_ = end;
+          data = &buffer_[0];
+          size = end;
+          return end > 0;
+        }
+    }
+};
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_MAPPED_FILE_H_
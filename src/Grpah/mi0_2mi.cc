@@ -1,57 +1,70 @@
 #include <iostream>
-#include <fstream>
-#include <map>
 #include <string>
+#include <cstdio>
+#include "vertex_map.hpp"
+#include "ngraph_stats.hpp"
 
 
 /*
 
   Transform a 0-based community listing (.mi0) back to original vertex numbers.
   Requires the original mapping of [original-vertex -> 0-based-vertex]
+  (text, or binary from create_imap -b).
 
-  Usage :   cat foo.mi0 | mi0_2mi foo.imap0 > foo.mi 
+  Usage :   cat foo.mi0 | mi0_2mi [-k | -d | -z] foo.imap0 > foo.mi 
+
+    -k   keep vertices not in the map as is
+    -d   drop lines with vertices not in the map
+    -z   map vertices not in the map to 0
+
+  Without -k, -d or -z, a vertex not in the map is an error.
 
 */
 
-typedef unsigned int Int;
 using namespace std;
+using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
+  NGraph::stats::parse_options(argc, argv);
+
+  remap_options opt;
+  parse_unmapped_option(argc, argv, opt);
+  opt.column = 1;         // "community vertex" lines
 
-  if (argc <= 1)
+  if (argc != 2)
   {
-    std::cerr << "Usage :   cat foo.mi0 | mi0_2mi foo.imap0 > foo.mi\n";
-    exit(1);
+    std::cerr << "Usage :   cat foo.mi0 | mi0_2mi [-k | -d | -z] foo.imap0 "
+              << "> foo.mi\n";
+    return 1;
   }
 
-
-    // build the invermap  map  
-    map<Int, Int> inv_map;
-
-      const char *map_filename = argv[1];
-      ifstream map_file;
-      map_file.open(map_filename);
-      while(map_file)
+    // build the inverse map
+    vertex_map inv_map;
+    {
+      stats::scoped_phase phase("read map");
+      vertex_map M;
+      string error;
+      if (!M.read(argv[1], error))
       {
-        Int node1, node2;
-        map_file >> node1 >> node2;
-        inv_map[node2] = node1;
+        cerr << "Error: " << error << "\n";
+        return 1;
       }
-      map_file.close();
-    
+      inv_map = M.inverse();
+    }
     
     // now start applying inverse map
     
-    while (cin)
+    mapped_file in("-");
+    string error;
+    stats::scoped_phase phase("remap");
+    if (!remap_lines(in.data(), in.size(), vertex_mapper(inv_map), opt,
+            stdout, error))
     {
-        Int community_number;
-        Int zero_based_vertex;
-        cin >> community_number >> zero_based_vertex  ;
-        cout << community_number << " " << inv_map[zero_based_vertex] << "\n";
+      cerr << "Error: " << error << "\n";
+      return 1;
     }
 
-
     return 0;
     
 }
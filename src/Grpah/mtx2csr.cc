@@ -0,0 +1,81 @@
+//
+// Converts a MatrixMarket coordinate file into a binary CSR graph file
+// (.csr, see ngraph_static.hpp), parsing the file in parallel.
+//
+// Usage:  mtx2csr [-w] [-s] [-d] [-m] matrix.mtx > graph.csr
+//
+//   -w   keep the matrix values as edge weights
+//   -s   keep symmetric storage as is (default: expand to both (i,j)
+//        and (j,i))
+//   -d   remove diagonal entries (self-loops)
+//   -m   write a general MatrixMarket file instead of .csr
+//
+// A matrix file of "-" (or none) is read from stdin.  Row/column i of
+// the matrix becomes vertex i-1.
+//
+
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include "mtx_io.hpp"
+#include "ngraph_stats.hpp"
+
+using namespace std;
+using namespace NGraph;
+
+int main(int argc, char *argv[])
+{
+  NGraph::stats::parse_options(argc, argv);
+
+  mtx_read_options opt;
+  bool write_mtx_file = false;
+  const char *filename = "-";
+
+  for (int i=1; i<argc; i++)
+  {
+    string a(argv[i]);
+    if (a == "-w")
+      opt.values = true;
+    else if (a == "-s")
+      opt.expand_symmetry = false;
+    else if (a == "-d")
+      opt.remove_diagonal = true;
+    else if (a == "-m")
+      write_mtx_file = true;
+    else if (a[0] != '-' || a == "-")
+      filename = argv[i];
+    else
+    {
+      cerr << "Usage: " << argv[0] << " [-w] [-s] [-d] [-m] matrix.mtx"
+           << " > graph.csr\n";
+      return 1;
+    }
+  }
+
+  mtx_matrix A;
+  string error;
+  if (!read_mtx(filename, A, opt, error))
+  {
+    cerr << "Error: [" << filename << "] " << error << "\n";
+    return 1;
+  }
+
+  bool ok = false;
+  if (write_mtx_file)
+    ok = write_mtx(stdout, A, error);
+  else
+  {
+    stats::scoped_phase phase("write");
+    size_t n = max(A.num_rows(), A.num_cols());
+    A.offsets.resize(n + 1, A.offsets.back());
+    ok = write_csr_file(stdout, n, A.offsets, A.columns, &A.values,
+              &A.imag_values);
+    error = "write failed";
+  }
+  if (!ok)
+  {
+    cerr << "Error: " << error << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,669 @@
+#ifndef NGRAPH_MTX_IO_H_
+#define NGRAPH_MTX_IO_H_
+
+/*
+   MatrixMarket (.mtx) coordinate files, read directly into compressed
+   sparse row form, and written from it.
+
+   read_mtx() maps the file (see mapped_file.hpp), splits the entries
+   into one chunk per thread at line boundaries, and parses the chunks in
+   parallel, without going through a text stream or a tGraph.  Entries
+   are then placed into CSR rows in parallel (build_csr() in
+   ngraph_static.hpp).
+
+   Options:
+
+        values            keep the numerical values (for real, integer
+                          and complex matrices) as edge weights; complex
+                          values are kept as real and imaginary parts
+        expand_symmetry   store a symmetric, skew-symmetric or hermitian
+                          matrix in full, i.e. add (j,i) for each stored
+                          off-diagonal (i,j), with its value negated
+                          (skew) or conjugated (hermitian)
+        remove_diagonal   drop (i,i) entries, as mtx2g does
+
+   MatrixMarket indices are 1-based; CSR rows and columns are 0-based.
+
+   mtx_writer is the matching streaming writer: it writes the banner and
+   size line, then one entry per put(), through a fixed buffer with hand-
+   rolled integer formatting.
+
+   Errors are reported as a message, with the line number where
+   applicable, rather than by exiting.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <stdint.h>
+#include "mapped_file.hpp"
+#include "format_uint.hpp"
+#include "ngraph_static.hpp"
+#include "ngraph_stats.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+
+enum mtx_field
+{
+    mtx_pattern,
+    mtx_real,
+    mtx_integer,
+    mtx_complex
+};
+
+enum mtx_symmetry
+{
+    mtx_general,
+    mtx_symmetric,
+    mtx_skew_symmetric,
+    mtx_hermitian
+};
+
+struct mtx_header
+{
+    mtx_field field;
+    mtx_symmetry symmetry;  // general, once read_mtx() has expanded it
+    size_t rows;
+    size_t cols;
+    size_t entries;     // as stored in the file
+
+    mtx_header() : field(mtx_pattern), symmetry(mtx_general), rows(0),
+        cols(0), entries(0) {}
+};
+
+struct mtx_read_options
+{
+    bool values;
+    bool expand_symmetry;
+    bool remove_diagonal;
+
+    mtx_read_options() : values(false), expand_symmetry(true),
+        remove_diagonal(false) {}
+};
+
+
+/**
+    A sparse matrix in CSR form: the entries of row i are
+    columns[offsets[i]..offsets[i+1]) (sorted), with values and
+    imag_values in the same positions if they were kept.
+*/
+struct mtx_matrix
+{
+    mtx_header header;
+    std::vector<size_t> offsets;
+    std::vector<unsigned int> columns;
+    std::vector<double> values;
+    std::vector<double> imag_values;
+
+    size_t num_rows() const { return header.rows; }
+    size_t num_cols() const { return header.cols; }
+    size_t num_entries() const { return columns.size(); }
+};
+
+
+// ---------------------------------------------------------------------
+//  parsing helpers
+// ---------------------------------------------------------------------
+
+inline bool mtx_is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline void mtx_skip_blanks(const char *&p, const char *end)
+{
+    while (p < end && mtx_is_blank(*p))
+      p++;
+}
+
+inline void mtx_skip_line(const char *&p, const char *end)
+{
+    while (p < end && *p != '\n')
+      p++;
+    if (p < end)
+      p++;
+}
+
+inline bool mtx_parse_uint(const char *&p, const char *end, uint64_t &v)
+{
+    mtx_skip_blanks(p, end);
+    if (p == end || *p < '0' || *p > '9')
+      return false;
+    v = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+      v = v * 10 + (*p++ - '0');
+    return true;
+}
+
+// the input is not null-terminated, so each number is copied out before
+// handing it to strtod()
+//
+inline bool mtx_parse_double(const char *&p, const char *end, double &v)
+{
+    mtx_skip_blanks(p, end);
+    char token[64];
+    size_t n = 0;
+    while (p < end && n < sizeof(token) - 1 && !mtx_is_blank(*p) && *p != '\n')
+      token[n++] = *p++;
+    token[n] = 0;
+    if (n == 0)
+      return false;
+    char *stop = 0;
+    v = strtod(token, &stop);
+    return *stop == 0;
+}
+
+inline std::string mtx_lower_word(const char *&p, const char *end)
+{
+    mtx_skip_blanks(p, end);
+    std::string w;
+    while (p < end && !mtx_is_blank(*p) && *p != '\n')
+      w += (char) tolower(*p++);
+    return w;
+}
+
+/**
+    Parse the banner, comments and size line, leaving p at the first
+    entry.
+*/
+inline bool read_mtx_header(const char *&p, const char *end, mtx_header &h,
+      std::string &error)
+{
+    const std::string banner = "%%MatrixMarket";
+    if ((size_t) (end - p) < banner.size() ||
+          strncmp(p, banner.c_str(), banner.size()) != 0)
+    {
+      error = "missing %%MatrixMarket banner";
+      return false;
+    }
+    p += banner.size();
+
+    std::string object = mtx_lower_word(p, end);
+    std::string format = mtx_lower_word(p, end);
+    std::string field = mtx_lower_word(p, end);
+    std::string symmetry = mtx_lower_word(p, end);
+    mtx_skip_line(p, end);
+
+    if (object != "matrix" || format != "coordinate")
+    {
+      error = "only coordinate matrices are supported (found " + object +
+            " " + format + ")";
+      return false;
+    }
+
+    if (field == "pattern") h.field = mtx_pattern;
+    else if (field == "real") h.field = mtx_real;
+    else if (field == "integer") h.field = mtx_integer;
+    else if (field == "complex") h.field = mtx_complex;
+    else
+    {
+      error = "unknown field type [" + field + "]";
+      return false;
+    }
+
+    if (symmetry == "general") h.symmetry = mtx_general;
+    else if (symmetry == "symmetric") h.symmetry = mtx_symmetric;
+    else if (symmetry == "skew-symmetric") h.symmetry = mtx_skew_symmetric;
+    else if (symmetry == "hermitian") h.symmetry = mtx_hermitian;
+    else
+    {
+      error = "unknown symmetry type [" + symmetry + "]";
+      return false;
+    }
+
+    // comments and blank lines
+    for (;;)
+    {
+      const char *q = p;
+      mtx_skip_blanks(q, end);
+      if (q < end && (*q == '%' || *q == '\n'))
+        mtx_skip_line(p, end);
+      else
+        break;
+    }
+
+    uint64_t rows = 0, cols = 0, entries = 0;
+    if (!mtx_parse_uint(p, end, rows) || !mtx_parse_uint(p, end, cols) ||
+          !mtx_parse_uint(p, end, entries))
+    {
+      error = "missing or invalid size line";
+      return false;
+    }
+    mtx_skip_line(p, end);
+
+    if (rows > 0xFFFFFFFFu || cols > 0xFFFFFFFFu)
+    {
+      error = "matrix dimensions exceed 32-bit indices";
+      return false;
+    }
+    h.rows = rows;
+    h.cols = cols;
+    h.entries = entries;
+    return true;
+}
+
+
+// entries parsed by one thread
+//
+struct mtx_chunk
+{
+    std::vector<unsigned int> row;
+    std::vector<unsigned int> col;
+    std::vector<double> val;
+    std::vector<double> imag;
+    size_t entries;           // as stored, before expansion
+    const char *error_pos;
+    std::string error;
+
+    mtx_chunk() : row(), col(), val(), imag(), entries(0), error_pos(0),
+        error() {}
+};
+
+
+inline void parse_mtx_chunk(const char *p, const char *end,
+      const mtx_header &h, const mtx_read_options &opt, mtx_chunk &C)
+{
+    const bool has_value = (h.field != mtx_pattern);
+    const bool keep_value = opt.values && has_value;
+    const bool keep_imag = keep_value && h.field == mtx_complex;
+    const bool expand = opt.expand_symmetry && h.symmetry != mtx_general;
+    const double mirror_sign = (h.symmetry == mtx_skew_symmetric ? -1.0 : 1.0);
+    const double mirror_imag_sign =
+          (h.symmetry == mtx_hermitian ? -1.0 : 1.0);
+
+    while (p < end)
+    {
+      const char *line = p;
+      mtx_skip_blanks(p, end);
+      if (p == end)
+        break;
+      if (*p == '\n' || *p == '%')
+      {
+        mtx_skip_line(p, end);
+        continue;
+      }
+
+      uint64_t i = 0, j = 0;
+      double re = 1.0, im = 0.0;
+      if (!mtx_parse_uint(p, end, i) || !mtx_parse_uint(p, end, j) ||
+            (has_value && !mtx_parse_double(p, end, re)) ||
+            (h.field == mtx_complex && !mtx_parse_double(p, end, im)))
+      {
+        C.error = "malformed entry";
+        C.error_pos = line;
+        return;
+      }
+      if (i < 1 || i > h.rows || j < 1 || j > h.cols)
+      {
+        C.error = "index out of range";
+        C.error_pos = line;
+        return;
+      }
+      mtx_skip_line(p, end);
+      C.entries++;
+
+      if (i == j && opt.remove_diagonal)
+        continue;
+
+      C.row.push_back(i - 1);
+      C.col.push_back(j - 1);
+      if (keep_value)
+        C.val.push_back(re);
+      if (keep_imag)
+        C.imag.push_back(im);
+
+      if (expand && i != j)
+      {
+        C.row.push_back(j - 1);
+        C.col.push_back(i - 1);
+        if (keep_value)
+          C.val.push_back(mirror_sign * re);
+        if (keep_imag)
+          C.imag.push_back(mirror_sign * mirror_imag_sign * im);
+      }
+    }
+}
+
+
+/**
+    Parse a MatrixMarket coordinate file held in memory into CSR form.
+
+    @return true on success; otherwise error describes the problem.
+*/
+inline bool read_mtx(const char *data, size_t size, mtx_matrix &A,
+      const mtx_read_options &opt, std::string &error)
+{
+    const char *p = data;
+    const char *end = data + size;
+
+    error.clear();
+    A = mtx_matrix();
+    if (!read_mtx_header(p, end, A.header, error))
+      return false;
+    const mtx_header &h = A.header;
+
+#ifdef _OPENMP
+    const unsigned int num_chunks = omp_get_max_threads();
+#else
+    const unsigned int num_chunks = 1;
+#endif
+
+    std::vector<const char *> start = line_chunks(p, end - p, num_chunks);
+
+    std::vector<mtx_chunk> chunks(num_chunks);
+    {
+      stats::scoped_phase phase("parse");
+#ifdef _OPENMP
+      #pragma omp parallel for schedule(static, 1)
+#endif
+      for (int t=0; t<(int) num_chunks; t++)
+      {
+        parse_mtx_chunk(start[t], start[t+1], h, opt, chunks[t]);
+      }
+    }
+
+    size_t entries = 0;
+    size_t total = 0;
+    std::vector<size_t> first(num_chunks + 1, 0);
+    for (unsigned int t=0; t<num_chunks; t++)
+    {
+      if (!chunks[t].error.empty())
+      {
+        size_t line = 1 + std::count(data, chunks[t].error_pos, '\n');
+        std::ostringstream msg;
+        msg << chunks[t].error << " on line " << line;
+        error = msg.str();
+        return false;
+      }
+      entries += chunks[t].entries;
+      total += chunks[t].row.size();
+      first[t+1] = total;
+    }
+    if (entries != h.entries)
+    {
+      std::ostringstream msg;
+      msg << "expected " << h.entries << " entries, found " << entries;
+      error = msg.str();
+      return false;
+    }
+    stats::edges_read() += entries;
+
+    const bool keep_value = opt.values && h.field != mtx_pattern;
+    const bool keep_imag = keep_value && h.field == mtx_complex;
+    if (opt.expand_symmetry)
+      A.header.symmetry = mtx_general;
+
+    std::vector<unsigned int> row(total), col(total);
+    std::vector<double> val(keep_value ? total : 0);
+    std::vector<double> imag(keep_imag ? total : 0);
+    {
+      stats::scoped_phase phase("gather");
+#ifdef _OPENMP
+      #pragma omp parallel for schedule(static, 1)
+#endif
+      for (int t=0; t<(int) num_chunks; t++)
+      {
+        mtx_chunk &C = chunks[t];
+        std::copy(C.row.begin(), C.row.end(), row.begin() + first[t]);
+        std::copy(C.col.begin(), C.col.end(), col.begin() + first[t]);
+        if (keep_value)
+          std::copy(C.val.begin(), C.val.end(), val.begin() + first[t]);
+        if (keep_imag)
+          std::copy(C.imag.begin(), C.imag.end(), imag.begin() + first[t]);
+        std::vector<unsigned int>().swap(C.row);
+        std::vector<unsigned int>().swap(C.col);
+        std::vector<double>().swap(C.val);
+        std::vector<double>().swap(C.imag);
+      }
+    }
+
+    stats::scoped_phase phase("build");
+    if (!keep_value)
+    {
+      build_csr(h.rows, row, col, A.offsets, A.columns);
+      return true;
+    }
+
+    std::vector<size_t> perm;
+    build_csr(h.rows, row, col, A.offsets, A.columns, &perm);
+    const long m = total;
+    A.values.resize(total);
+    if (keep_imag)
+      A.imag_values.resize(total);
+#ifdef _OPENMP
+    #pragma omp parallel for
+#endif
+    for (long k=0; k<m; k++)
+    {
+      A.values[k] = val[perm[k]];
+      if (keep_imag)
+        A.imag_values[k] = imag[perm[k]];
+    }
+    return true;
+}
+
+
+/**
+    Read a MatrixMarket coordinate file ("-" for stdin) into CSR form.
+*/
+inline bool read_mtx(const char *filename, mtx_matrix &A,
+      const mtx_read_options &opt, std::string &error)
+{
+    stats::scoped_phase phase("read");
+    mapped_file F(filename);
+    if (!F.good())
+    {
+      error = F.error();
+      return false;
+    }
+    return read_mtx(F.data(), F.size(), A, opt, error);
+}
+
+
+/**
+    Read a MatrixMarket coordinate file as a static graph: entry (i,j)
+    becomes edge (i-1, j-1), and values are ignored.  A non-square matrix
+    gives a graph on max(rows, cols) vertices.
+*/
+template <typename T>
+bool read_mtx(const char *filename, static_tGraph<T> &G,
+      const mtx_read_options &opt, std::string &error)
+{
+    mtx_matrix A;
+    mtx_read_options pattern = opt;
+    pattern.values = false;
+    if (!read_mtx(filename, A, pattern, error))
+      return false;
+
+    size_t n = std::max(A.num_rows(), A.num_cols());
+    A.offsets.resize(n + 1, A.offsets.back());
+
+    std::vector<T> targets(A.columns.begin(), A.columns.end());
+    std::vector<unsigned int>().swap(A.columns);
+    G.assign(n, A.offsets, targets);
+    return true;
+}
+
+
+// ---------------------------------------------------------------------
+//  writing
+// ---------------------------------------------------------------------
+
+/**
+    Streaming MatrixMarket coordinate writer.  The header (with the
+    number of entries) is written by the constructor, so the count must
+    be known in advance.  Indices are written as given, i.e. callers
+    pass 1-based indices.
+*/
+class mtx_writer
+{
+  private:
+    FILE *f_;
+    mtx_header h_;
+    std::vector<char> buffer_;
+    size_t len_;
+    size_t count_;
+    std::string error_;
+
+    mtx_writer(const mtx_writer &);
+    mtx_writer & operator=(const mtx_writer &);
+
+    // room for two indices and two values
+    static size_t max_entry() { return 2 * 21 + 2 * 32 + 4; }
+
+    void reserve()
+    {
+        if (len_ + max_entry() > buffer_.size())
+          flush();
+    }
+
+    void put_double(double v)
+    {
+        buffer_[len_++] = ' ';
+        len_ += snprintf(&buffer_[len_], 32, "%.17g", v);
+    }
+
+  public:
+
+    mtx_writer(FILE *f, const mtx_header &h, size_t buffer_bytes = 1 << 20) :
+        f_(f), h_(h), buffer_(buffer_bytes > max_entry() ? buffer_bytes :
+        max_entry()), len_(0), count_(0), error_()
+    {
+        static const char *fields[] =
+              { "pattern", "real", "integer", "complex" };
+        static const char *symmetries[] =
+              { "general", "symmetric", "skew-symmetric", "hermitian" };
+
+        fprintf(f_, "%%%%MatrixMarket matrix coordinate %s %s\n",
+              fields[h.field], symmetries[h.symmetry]);
+        fprintf(f_, "%lu %lu %lu\n", (unsigned long) h.rows,
+              (unsigned long) h.cols, (unsigned long) h.entries);
+    }
+
+    ~mtx_writer()
+    {
+        flush();
+    }
+
+    bool good() const { return error_.empty(); }
+    const std::string &error() const { return error_; }
+    size_t count() const { return count_; }
+
+    void put(uint64_t i, uint64_t j)
+    {
+        reserve();
+        char *p = &buffer_[len_];
+        char *q = format_uint(p, i);
+        *q++ = ' ';
+        q = format_uint(q, j);
+        len_ += q - p;
+        if (h_.field == mtx_pattern)
+          buffer_[len_++] = '\n';
+        count_++;
+    }
+
+    void put(uint64_t i, uint64_t j, double v)
+    {
+        put(i, j);
+        if (h_.field == mtx_integer)
+        {
+          buffer_[len_++] = ' ';
+          len_ += snprintf(&buffer_[len_], 32, "%.0f", v);
+        }
+        else
+          put_double(v);
+        if (h_.field != mtx_complex)
+          buffer_[len_++] = '\n';
+    }
+
+    void put(uint64_t i, uint64_t j, double re, double im)
+    {
+        put(i, j, re);
+        put_double(im);
+        buffer_[len_++] = '\n';
+    }
+
+    void flush()
+    {
+        if (len_ > 0 && fwrite(&buffer_[0], 1, len_, f_) != len_)
+          error_ = "write failed";
+        len_ = 0;
+        fflush(f_);
+    }
+
+    /** @return true if exactly the promised number of entries was put */
+    bool complete() const { return count_ == h_.entries; }
+};
+
+
+/**
+    Write a CSR matrix as a MatrixMarket coordinate file (with values, if
+    it has them).  A matrix read without expanding its symmetry is
+    written with its original symmetry type.
+*/
+inline bool write_mtx(FILE *f, const mtx_matrix &A, std::string &error)
+{
+    stats::scoped_phase phase("write");
+    mtx_header h;
+    h.field = (!A.imag_values.empty() ? mtx_complex :
+          !A.values.empty() ? mtx_real : mtx_pattern);
+    h.symmetry = A.header.symmetry;
+    h.rows = A.num_rows();
+    h.cols = A.num_cols();
+    h.entries = A.num_entries();
+
+    mtx_writer W(f, h);
+    for (size_t i=0; i<A.num_rows(); i++)
+      for (size_t k=A.offsets[i]; k<A.offsets[i+1]; k++)
+      {
+        if (h.field == mtx_complex)
+          W.put(i+1, A.columns[k]+1, A.values[k], A.imag_values[k]);
+        else if (h.field == mtx_real)
+          W.put(i+1, A.columns[k]+1, A.values[k]);
+        else
+          W.put(i+1, A.columns[k]+1);
+      }
+    W.flush();
+    stats::edges_written() += W.count();
+    error = W.error();
+    return W.good();
+}
+
+
+/**
+    Write a static graph as a general pattern MatrixMarket file (vertex
+    v is row/column v+1).
+*/
+template <typename T>
+bool write_mtx(FILE *f, const static_tGraph<T> &G, std::string &error)
+{
+    stats::scoped_phase phase("write");
+    mtx_header h;
+    h.rows = h.cols = G.num_vertices();
+    h.entries = G.num_edges();
+
+    mtx_writer W(f, h);
+    for (T v=0; v<G.num_vertices(); v++)
+      for (typename static_tGraph<T>::const_iterator q =
+                G.out_neighbors_begin(v); q != G.out_neighbors_end(v); q++)
+        W.put((uint64_t) v + 1, (uint64_t) *q + 1);
+    W.flush();
+    stats::edges_written() += W.count();
+    error = W.error();
+    return W.good();
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_MTX_IO_H_
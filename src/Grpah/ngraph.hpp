@@ -38,6 +38,13 @@
 #include <algorithm>
 #include <sstream>      // for I/O << and >> operators
 #include "set_ops.hpp"
+#include "ngraph_stats.hpp"
+#include "ngraph_alloc.hpp"
+#include "ngraph_write.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 /** version history
 *
@@ -87,7 +94,25 @@
 namespace NGraph
 {
 
-template <typename T>
+/**
+    Effective changes made by a batch update (tGraph::update(),
+    static_tGraph::update()): edges and vertices that were not already
+    present, or not already absent.
+*/
+struct update_counts
+{
+    size_t edges_inserted;
+    size_t edges_removed;
+    size_t vertices_inserted;
+    size_t vertices_removed;
+};
+
+
+//
+// Alloc is the allocator of the neighbor sets and the vertex map (rebound to
+// their node types); see ngraph_alloc.hpp for pool and arena allocators.
+//
+template <typename T, typename Alloc = std::allocator<T> >
 class tGraph
 {
 
@@ -95,11 +120,15 @@ class tGraph
 
     typedef T vertex;
     typedef T value_type;
+    typedef Alloc allocator_type;
     typedef std::pair<vertex,vertex> edge;
-    typedef std::set<vertex> vertex_set;
-    typedef std::set<edge> edge_set;
+    typedef std::set<vertex, std::less<vertex>, Alloc> vertex_set;
+    typedef std::set<edge, std::less<edge>,
+          typename Alloc::template rebind<edge>::other> edge_set;
     typedef std::pair<vertex_set, vertex_set> in_out_edge_sets;
-    typedef std::map<vertex, in_out_edge_sets>  adj_graph;
+    typedef std::map<vertex, in_out_edge_sets, std::less<vertex>,
+          typename Alloc::template rebind<std::pair<const vertex,
+                in_out_edge_sets> >::other>  adj_graph;
 
     typedef typename edge_set::iterator edge_iterator;
     typedef typename edge_set::const_iterator const_edge_iterator;
@@ -309,6 +338,7 @@ class tGraph
       {
           insert_vertex(a);
           pa = find(a);
+          stats::sets_allocated() += 2;
       }
 
       iterator pb = find(b);
@@ -316,6 +346,7 @@ class tGraph
       {
           insert_vertex(b);
           pb = find(b);
+          stats::sets_allocated() += 2;
       }
       
       insert_edge( pa, pb );
@@ -356,10 +387,10 @@ class tGraph
     void remove_edge(const vertex &a, const vertex& b)
     {
       iterator pa = find(a);
-      if (pa != end())
+      if (pa == end())
         return;
       iterator pb = find(b);
-      if (pb != end())
+      if (pb == end())
         return;
       remove_edge( pa, pb );
     }
@@ -409,8 +440,7 @@ class tGraph
 
     void remove_vertex_set(const vertex_set &V)
     {
-        for (typename vertex_set::const_iterator p=V.begin(); p!=V.end(); p++)
-          remove_vertex(*p);
+        remove_vertices(V);
     }
 
 
@@ -422,6 +452,181 @@ class tGraph
 
     }
 
+  private:
+
+    // sort (a copy of) an edge list if it is not already sorted
+    //
+    static const std::vector<edge> &sorted_edges(const std::vector<edge> &E,
+          std::vector<edge> &copy)
+    {
+        for (size_t i=1; i<E.size(); i++)
+          if (E[i] < E[i-1])
+          {
+            copy = E;
+            std::sort(copy.begin(), copy.end());
+            return copy;
+          }
+        return E;
+    }
+
+    // start of each run of equal E[i].first
+    //
+    static std::vector<size_t> edge_groups(const std::vector<edge> &E)
+    {
+        std::vector<size_t> start;
+        for (size_t i=0; i<E.size(); i++)
+          if (i == 0 || E[i].first != E[i-1].first)
+            start.push_back(i);
+        start.push_back(E.size());
+        return start;
+    }
+
+    // insert (or erase) b into the out-sets of a, for each (a,b) of
+    // sorted E, and a into the in-sets of b; one thread per vertex set
+    //
+    size_t update_sets(const std::vector<edge> &E, bool insert)
+    {
+        if (E.empty())
+          return 0;
+        std::vector<edge> R(E.size());
+        for (size_t i=0; i<E.size(); i++)
+          R[i] = edge(E[i].second, E[i].first);
+        std::sort(R.begin(), R.end());
+
+        const std::vector<size_t> out_groups = edge_groups(E);
+        const std::vector<size_t> in_groups = edge_groups(R);
+        size_t changed = 0;
+
+        // the map itself is only read here; each set is written by the
+        // one thread that owns its group
+#ifdef _OPENMP
+        #pragma omp parallel
+#endif
+        {
+#ifdef _OPENMP
+          #pragma omp for schedule(dynamic, 64) reduction(+:changed) nowait
+#endif
+          for (long g=0; g<(long) out_groups.size() - 1; g++)
+          {
+            iterator pa = find(E[out_groups[g]].first);
+            if (pa == end())
+              continue;
+            vertex_set &out = out_neighbors(pa);
+            for (size_t i=out_groups[g]; i<out_groups[g+1]; i++)
+            {
+              if (insert)
+                changed += out.insert(E[i].second).second;
+              else
+                changed += out.erase(E[i].second);
+            }
+          }
+
+#ifdef _OPENMP
+          #pragma omp for schedule(dynamic, 64)
+#endif
+          for (long g=0; g<(long) in_groups.size() - 1; g++)
+          {
+            iterator pb = find(R[in_groups[g]].first);
+            if (pb == end())
+              continue;
+            vertex_set &in = in_neighbors(pb);
+            for (size_t i=in_groups[g]; i<in_groups[g+1]; i++)
+            {
+              if (insert)
+                in.insert(R[i].second);
+              else
+                in.erase(R[i].second);
+            }
+          }
+        }
+        return changed;
+    }
+
+  public:
+
+  /**
+        Apply a batch of edge deletions, then insertions.  The lists are
+        expected sorted (they are sorted here otherwise); updates are
+        grouped by vertex and the groups applied in parallel, each
+        adjacency set by a single thread.  Endpoints of inserted edges
+        are added as vertices if needed; deletions of edges not in the
+        graph are ignored.
+
+        @return the number of edges (and vertices) actually changed
+  */
+    update_counts update(const std::vector<edge> &insertions,
+          const std::vector<edge> &deletions)
+    {
+        update_counts C = {0, 0, 0, 0};
+        std::vector<edge> ins_copy, del_copy;
+        if (is_undirected())
+        {
+          ins_copy = insertions;
+          del_copy = deletions;
+          for (size_t i=0; i<ins_copy.size(); i++)
+            if (ins_copy[i].second < ins_copy[i].first)
+              std::swap(ins_copy[i].first, ins_copy[i].second);
+          for (size_t i=0; i<del_copy.size(); i++)
+            if (del_copy[i].second < del_copy[i].first)
+              std::swap(del_copy[i].first, del_copy[i].second);
+          std::sort(ins_copy.begin(), ins_copy.end());
+          std::sort(del_copy.begin(), del_copy.end());
+        }
+        const std::vector<edge> &I = (is_undirected() ? ins_copy :
+              sorted_edges(insertions, ins_copy));
+        const std::vector<edge> &D = (is_undirected() ? del_copy :
+              sorted_edges(deletions, del_copy));
+
+        C.edges_removed = update_sets(D, false);
+        num_edges_ -= C.edges_removed;
+
+        // new vertices (this changes the map, so it is done serially)
+        const size_t old_size = G_.size();
+        for (size_t i=0; i<I.size(); i++)
+        {
+          if (i == 0 || I[i].first != I[i-1].first)
+            G_[I[i].first];
+          G_[I[i].second];
+        }
+        C.vertices_inserted = G_.size() - old_size;
+        stats::sets_allocated() += 2 * C.vertices_inserted;
+
+        C.edges_inserted = update_sets(I, true);
+        num_edges_ += C.edges_inserted;
+        return C;
+    }
+
+
+  /**
+        Remove a set of vertices and all their edges, as a batch: the
+        edges are collected first and removed by update().
+  */
+    update_counts remove_vertices(const vertex_set &V)
+    {
+        std::vector<edge> D;
+        for (typename vertex_set::const_iterator v=V.begin(); v!=V.end(); v++)
+        {
+          const_iterator p = find(*v);
+          if (p == end())
+            continue;
+          const vertex_set &out = out_neighbors(p);
+          const vertex_set &in = in_neighbors(p);
+          for (const_vertex_iterator w = out.begin(); w != out.end(); w++)
+            D.push_back(edge(*v, *w));
+          for (const_vertex_iterator w = in.begin(); w != in.end(); w++)
+            if (!includes_elm(V, *w))       // else listed as its out-edge
+              D.push_back(edge(*w, *v));
+        }
+        std::sort(D.begin(), D.end());
+
+        update_counts C = update(std::vector<edge>(), D);
+
+        for (typename vertex_set::const_iterator v=V.begin(); v!=V.end(); v++)
+          C.vertices_removed += G_.erase(*v);
+        return C;
+    }
+
+
   /**
         Is vertex 'a' included in graph?
 
@@ -926,7 +1131,7 @@ static std::istream &read_line(std::istream &s, T &v1, T &v2,
 }
 
 };
-// end tGraph<T>
+// end tGraph<T,Alloc>
 
 // global functions
 //
@@ -935,13 +1140,14 @@ static std::istream &read_line(std::istream &s, T &v1, T &v2,
 typedef tGraph<unsigned int> Graph;
 typedef tGraph<int> iGraph;
 typedef tGraph<std::string> sGraph;
+typedef tGraph<unsigned int, pool_allocator<unsigned int> > pool_Graph;
 
 
-template <class T>
-std::vector<typename tGraph<T>::edge> tGraph<T>::edge_list() const
+template <class T, class Alloc>
+std::vector<typename tGraph<T,Alloc>::edge> tGraph<T,Alloc>::edge_list() const
     {
         //std::vector<tGraph::edge> E(num_edges());
-        std::vector<typename tGraph<T>::edge> E;
+        std::vector<typename tGraph<T,Alloc>::edge> E;
 
         for (typename tGraph::const_iterator p = begin(); p!=end(); p++)
         {
@@ -959,59 +1165,156 @@ std::vector<typename tGraph<T>::edge> tGraph<T>::edge_list() const
 
 
 
-template <typename T>
-std::istream & operator>>(std::istream &s, tGraph<T> &G)
+//
+// Input is parsed in blocks of lines, which are then inserted into the
+// graph, so that parsing ("read") and graph construction ("build") can
+// be timed separately by the stats layer.
+//
+template <typename T, typename Alloc>
+std::istream & operator>>(std::istream &s, tGraph<T,Alloc> &G)
 {
-    std::string line;
+    const unsigned int block_size = 65536;
 
-    while (getline(s, line))
+    std::string line;
+    std::vector<T> V1, V2;
+    std::vector<bool> vertex_only;
+    V1.reserve(block_size);
+    V2.reserve(block_size);
+    vertex_only.reserve(block_size);
+
+    bool more = true;
+    while (more)
     {
-      T v1, v2;
+      {
+        stats::scoped_phase phase("read");
 
-      if (line[0] == '%' || line[0] == '#')
-        continue;
+        V1.clear();
+        V2.clear();
+        vertex_only.clear();
+        while (V1.size() < block_size &&
+                (more = !getline(s, line).fail()))
+        {
+          T v1, v2;
 
-      std::istringstream L(line);
-      L >> v1;
-      if (L.eof())
-      {
-          G.insert_vertex(v1);
+          if (line[0] == '%' || line[0] == '#')
+            continue;
+
+          std::istringstream L(line);
+          L >> v1;
+          if (L.eof())
+          {
+              V1.push_back(v1);
+              V2.push_back(v1);
+              vertex_only.push_back(true);
+          }
+          else
+          {
+            L >> v2;
+            V1.push_back(v1);
+            V2.push_back(v2);
+            vertex_only.push_back(false);
+          }
+        }
+        stats::edges_read() += V1.size();
       }
-      else
+
       {
-        L >> v2;
-        G.insert_edge(v1, v2);
+        stats::scoped_phase phase("build");
+
+        for (unsigned int i=0; i<V1.size(); i++)
+        {
+          if (vertex_only[i])
+            G.insert_vertex(V1[i]);
+          else
+            G.insert_edge(V1[i], V2[i]);
+        }
       }
     }
     return s;
 
 }
 
-template <typename T>
-std::ostream & operator<<(std::ostream &s, const tGraph<T> &G)
+/**
+    The rows of a tGraph, for graph_writer (ngraph_write.hpp): one per
+    vertex, in increasing order.
+*/
+template <typename T, typename Alloc>
+class tGraph_rows
 {
-  for (typename tGraph<T>::const_node_iterator p=G.begin(); p != G.end(); p++)
-  {
-    const typename tGraph<T>::vertex_set &out = tGraph<T>::out_neighbors(p);
-    typename tGraph<T>::vertex v = p->first;
-    if (out.size() == 0 && tGraph<T>::in_neighbors(p).size() == 0)
+  private:
+    typedef tGraph<T,Alloc> graph;
+
+    std::vector<typename graph::const_node_iterator> rows_;
+    std::vector<T> nodes_;
+    size_t num_edges_;
+
+  public:
+    typedef T vertex;
+    typedef typename graph::vertex_set::const_iterator const_iterator;
+
+    explicit tGraph_rows(const graph &G) : rows_(), nodes_(),
+        num_edges_(G.num_edges())
     {
-      // v is an isolated node
-      s << v << "\n";
+        rows_.reserve(G.num_vertices());
+        nodes_.reserve(G.num_vertices());
+        for (typename graph::const_node_iterator p=G.begin(); p!=G.end(); p++)
+        {
+          rows_.push_back(p);
+          nodes_.push_back(p->first);
+        }
     }
-    else
+
+    size_t size() const { return rows_.size(); }
+    vertex node(size_t i) const { return nodes_[i]; }
+    bool isolated(size_t i) const
     {
-       for ( typename tGraph<T>::vertex_set::const_iterator q=out.begin(); 
-                q!=out.end(); q++)
-           s << v << " " << *q << "\n";
+        return graph::out_neighbors(rows_[i]).empty() &&
+              graph::in_neighbors(rows_[i]).empty();
     }
-  }
+    const_iterator out_begin(size_t i) const
+    {
+        return graph::out_neighbors(rows_[i]).begin();
+    }
+    const_iterator out_end(size_t i) const
+    {
+        return graph::out_neighbors(rows_[i]).end();
+    }
+    size_t position(vertex v) const
+    {
+        return std::lower_bound(nodes_.begin(), nodes_.end(), v) -
+              nodes_.begin();
+    }
+    size_t num_edges() const { return num_edges_; }
+};
+
+
+/**
+    Write G in the format given by opt (see ngraph_write.hpp), to a FILE
+    or an ostream.  T must be an unsigned integral type; operator<<
+    writes a tGraph of any vertex type.
+*/
+template <typename T, typename Alloc>
+bool write_graph(graph_sink out, const tGraph<T,Alloc> &G,
+      const write_options &opt, std::string &error)
+{
+  stats::scoped_phase phase("write");
+  stats::edges_written() += G.num_edges();
+  return write_rows(out, tGraph_rows<T,Alloc>(G), opt, error);
+}
+
+
+template <typename T, typename Alloc>
+std::ostream & operator<<(std::ostream &s, const tGraph<T,Alloc> &G)
+{
+  stats::scoped_phase phase("write");
+  stats::edges_written() += G.num_edges();
+  write_g(s, tGraph_rows<T,Alloc>(G));
   return s;
 }
 
 
-template <typename T>
-void tGraph<T>::print() const 
+template <typename T, typename Alloc>
+void tGraph<T,Alloc>::print() const 
     {
 
        std::cerr << "# vertices: " <<  num_vertices()  << "\n";
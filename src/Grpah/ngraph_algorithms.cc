@@ -67,6 +67,7 @@ Graph &operator+=(Graph &A, const Graph &B)
       return A;
 }
 
+#if 0
 #ifndef for_iterator
 #define for_iterator(p,C)  for (p=C.begin(); c!=C.end(); (p)++)
 #endif
@@ -107,16 +108,16 @@ tGraph<T> operator+(const tGraph<T> &A, const tGraph<T> &B)
        // start with the largest graph
 
        tGraph<T>  U(A);
-       std::vector<typename tGraph<T>::edge> b = B.edge_list();
+       std::vector<Graph::edge> b = B.edge_list();
        
        for (std::vector<Graph::edge>::const_iterator t = b.begin(); 
                     t < b.end(); t++)
        {
-            U.insert_edge(*t);
+            A.insert_edge(*t);
        };
 
     
-      return U;
+      return A;
        
 }
 
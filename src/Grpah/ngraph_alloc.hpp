@@ -0,0 +1,326 @@
+#ifndef NGRAPH_ALLOC_H_
+#define NGRAPH_ALLOC_H_
+
+/*
+   Allocators for the node-based containers (std::set, std::map) behind
+   tGraph and equivalence, which otherwise make one malloc() call per
+   edge end and per class element.
+
+        pool_allocator<T>    size-class pool: nodes of each size (in
+                             steps of 16 bytes, up to 256) are carved
+                             out of large chunks and recycled through a
+                             free list when released
+        arena_allocator<T>   monotonic arena: memory is never given back
+                             (deallocate() does nothing), for graphs
+                             that are built once and kept until exit
+
+    e.g.
+
+        tGraph<unsigned int, pool_allocator<unsigned int> > G;
+        equivalence<unsigned int, arena_allocator<unsigned int> > E;
+
+   Both draw from one process-wide node_pool, which keeps a chunk arena
+   and free lists per thread (indexed as in ngraph_stats.hpp, each
+   behind its own spin lock, so that threads beyond the slots, and
+   blocks freed by another thread, are still safe).  Chunks are only
+   returned to the system at exit, and then all at once.
+
+   The allocators have no state, so any two compare equal and
+   containers using them may be swapped and spliced freely.
+
+   The arena class may also be used on its own, as a bump allocator
+   with a single release().
+*/
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include "ngraph_stats.hpp"
+
+namespace NGraph
+{
+
+/**
+    A monotonic (bump) allocator: allocate() hands out 16-byte aligned
+    blocks from large chunks; nothing is freed until release().
+*/
+class arena
+{
+  private:
+    std::vector<char *> chunks_;
+    char *next_;
+    char *end_;
+    size_t chunk_size_;
+    size_t reserved_;
+
+    arena(const arena &);
+    arena &operator=(const arena &);
+
+  public:
+    explicit arena(size_t chunk_size = 1 << 20) : chunks_(), next_(0),
+        end_(0), chunk_size_(chunk_size), reserved_(0) {}
+
+    ~arena() { release(); }
+
+    void *allocate(size_t n)
+    {
+        n = (n + 15) & ~(size_t) 15;
+        if (next_ == 0 || (size_t) (end_ - next_) < n)
+        {
+          const size_t size = (n > chunk_size_ / 4 ? n : chunk_size_);
+          char *c = (char *) malloc(size);
+          if (c == 0)
+            throw std::bad_alloc();
+          chunks_.push_back(c);
+          reserved_ += size;
+          if (size != chunk_size_)
+            return c;                   // a large block gets its own chunk
+          next_ = c;
+          end_ = c + size;
+        }
+        void *p = next_;
+        next_ += n;
+        return p;
+    }
+
+    /** free all the memory handed out */
+    void release()
+    {
+        for (size_t i=0; i<chunks_.size(); i++)
+          free(chunks_[i]);
+        std::vector<char *>().swap(chunks_);
+        next_ = end_ = 0;
+        reserved_ = 0;
+    }
+
+    /** bytes taken from the system */
+    size_t bytes_reserved() const { return reserved_; }
+};
+
+
+/**
+    The process-wide pool behind pool_allocator and arena_allocator.
+*/
+class node_pool
+{
+  public:
+    enum { granularity = 16, num_classes = 16,
+           max_size = granularity * num_classes };
+
+  private:
+    struct free_node
+    {
+        free_node *next;
+    };
+
+    struct slot
+    {
+        volatile int lock;
+        arena memory;
+        free_node *free_list[num_classes];
+        char pad[64];
+    };
+
+    slot slots_[stats::max_threads];
+
+    node_pool()
+    {
+        for (unsigned int t=0; t<stats::max_threads; t++)
+        {
+          slots_[t].lock = 0;
+          for (unsigned int c=0; c<num_classes; c++)
+            slots_[t].free_list[c] = 0;
+        }
+    }
+
+    node_pool(const node_pool &);
+    node_pool &operator=(const node_pool &);
+
+    static slot &lock()
+    {
+        slot &s = instance().slots_[stats::thread_id()];
+        while (__sync_lock_test_and_set(&s.lock, 1))
+          while (s.lock)
+            ;
+        return s;
+    }
+
+    static void unlock(slot &s)
+    {
+        __sync_lock_release(&s.lock);
+    }
+
+    static unsigned int size_class(size_t n)
+    {
+        return (n == 0 ? 0 : (n - 1) / granularity);
+    }
+
+  public:
+
+    // never destroyed: its memory goes back to the system with the
+    // process, after the containers that use it are gone
+    //
+    static node_pool &instance()
+    {
+        static node_pool *P = new node_pool;
+        return *P;
+    }
+
+    void *allocate(size_t n)
+    {
+        if (n > (size_t) max_size)
+        {
+          void *p = malloc(n);
+          if (p == 0)
+            throw std::bad_alloc();
+          return p;
+        }
+        const unsigned int c = size_class(n);
+        slot &s = lock();
+        free_node *p = s.free_list[c];
+        if (p)
+          s.free_list[c] = p->next;
+        void *q = (p ? (void *) p : s.memory.allocate((c + 1) * granularity));
+        unlock(s);
+        return q;
+    }
+
+    void deallocate(void *p, size_t n)
+    {
+        if (p == 0)
+          return;
+        if (n > (size_t) max_size)
+        {
+          free(p);
+          return;
+        }
+        const unsigned int c = size_class(n);
+        slot &s = lock();
+        free_node *f = (free_node *) p;
+        f->next = s.free_list[c];
+        s.free_list[c] = f;
+        unlock(s);
+    }
+
+    /** memory that is never freed (see arena_allocator) */
+    void *allocate_forever(size_t n)
+    {
+        slot &s = lock();
+        void *p = s.memory.allocate(n);
+        unlock(s);
+        return p;
+    }
+
+    /** bytes taken from the system for small blocks */
+    size_t bytes_reserved() const
+    {
+        size_t sum = 0;
+        for (unsigned int t=0; t<stats::max_threads; t++)
+          sum += slots_[t].memory.bytes_reserved();
+        return sum;
+    }
+};
+
+
+// the parts of a (C++98) standard allocator common to both kinds; the
+// Derived class supplies allocate() and deallocate()
+//
+template <typename T>
+struct allocator_base
+{
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    typedef T *pointer;
+    typedef const T *const_pointer;
+    typedef T &reference;
+    typedef const T &const_reference;
+    typedef T value_type;
+
+    pointer address(reference x) const { return &x; }
+    const_pointer address(const_reference x) const { return &x; }
+
+    size_type max_size() const { return ((size_t) -1) / sizeof(T); }
+
+    void construct(pointer p, const T &x) { new ((void *) p) T(x); }
+    void destroy(pointer p) { p->~T(); }
+};
+
+
+template <typename T>
+class pool_allocator : public allocator_base<T>
+{
+  public:
+    typedef T *pointer;
+    typedef size_t size_type;
+
+    template <typename U>
+    struct rebind { typedef pool_allocator<U> other; };
+
+    pool_allocator() {}
+    template <typename U>
+    pool_allocator(const pool_allocator<U> &) {}
+
+    pointer allocate(size_type n, const void * = 0)
+    {
+        return (pointer) node_pool::instance().allocate(n * sizeof(T));
+    }
+
+    void deallocate(pointer p, size_type n)
+    {
+        node_pool::instance().deallocate(p, n * sizeof(T));
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const pool_allocator<T> &, const pool_allocator<U> &)
+{
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const pool_allocator<T> &, const pool_allocator<U> &)
+{
+    return false;
+}
+
+
+template <typename T>
+class arena_allocator : public allocator_base<T>
+{
+  public:
+    typedef T *pointer;
+    typedef size_t size_type;
+
+    template <typename U>
+    struct rebind { typedef arena_allocator<U> other; };
+
+    arena_allocator() {}
+    template <typename U>
+    arena_allocator(const arena_allocator<U> &) {}
+
+    pointer allocate(size_type n, const void * = 0)
+    {
+        return (pointer) node_pool::instance().allocate_forever(n * sizeof(T));
+    }
+
+    void deallocate(pointer, size_type) {}
+};
+
+template <typename T, typename U>
+bool operator==(const arena_allocator<T> &, const arena_allocator<U> &)
+{
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const arena_allocator<T> &, const arena_allocator<U> &)
+{
+    return false;
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_ALLOC_H_
@@ -0,0 +1,388 @@
+#ifndef NGRAPH_BFS_H_
+#define NGRAPH_BFS_H_
+
+/*
+   Direction-optimizing breadth-first search on static (CSR) graphs
+   (Beamer, Asanovic and Patterson, 2012).
+
+   Each level is expanded either
+
+        top-down    every frontier vertex (kept in a queue) claims its
+                    unvisited out-neighbors, or
+        bottom-up   every unvisited vertex looks for a parent among its
+                    in-neighbors in the frontier (kept as a bitmap), and
+                    stops at the first one found.
+
+   Top-down is cheap for small frontiers; bottom-up wins when the
+   frontier is a large part of the graph, since most of its edges would
+   only find visited vertices.  The search switches to bottom-up when
+   the edges to check from the frontier exceed 1/alpha of the edges of
+   the unvisited vertices, and back to top-down once the frontier has
+   fewer than n/beta vertices and is shrinking.
+
+   Both directions run in parallel (OpenMP).  Top-down claims vertices
+   with an atomic OR on the visited bitmap; bottom-up splits vertices by
+   64-bit bitmap word, so that no two threads write the same word.
+
+   A bfs_engine keeps its arrays between runs.  run() searches from one
+   or more sources, recording, as requested, the parent (the source for
+   a source) and/or the depth of every vertex reached; with neither it
+   only tracks reachability.  With reset = false the vertices visited by
+   earlier runs stay visited, which is how components are enumerated
+   one search at a time.
+
+   For an undirected search of a directed graph, run the engine on
+   undirected_graph(G).
+
+   Graph is static_tGraph<T> by default, or any graph with its interface
+   (vertices 0 .. num_vertices()-1, out/in_neighbors_begin() and _end(),
+   out_degree(), num_edges()), such as compressed_tGraph<T>.
+*/
+
+#include <vector>
+#include <stdint.h>
+#include "ngraph_static.hpp"
+#include "ngraph_stats.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+
+const unsigned int bfs_parents = 1;
+const unsigned int bfs_depths = 2;
+
+
+template <typename T, typename Graph = static_tGraph<T> >
+class bfs_engine
+{
+  public:
+    static T unreached() { return (T) -1; }
+
+  private:
+    typedef typename Graph::const_iterator neighbor_iterator;
+
+    const Graph &G_;
+    double alpha_;
+    double beta_;
+
+    std::vector<uint64_t> visited_;
+    std::vector<uint64_t> frontier_bits_;
+    std::vector<uint64_t> next_bits_;
+    std::vector<T> queue_;
+    std::vector<T> parent_;
+    std::vector<T> depth_;
+    size_t num_reached_;        // by the last run
+    size_t unexplored_edges_;   // out-edges of unvisited vertices
+    unsigned int num_levels_;
+    unsigned int bottom_up_steps_;
+
+    static bool test(const std::vector<uint64_t> &B, T v)
+    {
+        return (B[v >> 6] >> (v & 63)) & 1;
+    }
+
+    static void set(std::vector<uint64_t> &B, T v)
+    {
+        B[v >> 6] |= (uint64_t) 1 << (v & 63);
+    }
+
+    // true if this call set the bit
+    static bool claim(std::vector<uint64_t> &B, T v)
+    {
+        const uint64_t bit = (uint64_t) 1 << (v & 63);
+        if (B[v >> 6] & bit)
+          return false;
+        return !(__sync_fetch_and_or(&B[v >> 6], bit) & bit);
+    }
+
+    void visit(T v, T parent, T depth, unsigned int mode)
+    {
+        if (mode & bfs_parents)
+          parent_[v] = parent;
+        if (mode & bfs_depths)
+          depth_[v] = depth;
+    }
+
+    // one top-down level: queue_ -> queue_; returns edges checked
+    //
+    size_t top_down(T depth, unsigned int mode)
+    {
+        std::vector<T> next;
+        size_t scanned = 0;
+
+#ifdef _OPENMP
+        #pragma omp parallel
+#endif
+        {
+          std::vector<T> local;
+          size_t my_scanned = 0;
+#ifdef _OPENMP
+          #pragma omp for schedule(dynamic, 64) nowait
+#endif
+          for (long i=0; i<(long) queue_.size(); i++)
+          {
+            const T u = queue_[i];
+            my_scanned += G_.out_degree(u);
+            const neighbor_iterator end = G_.out_neighbors_end(u);
+            for (neighbor_iterator v = G_.out_neighbors_begin(u);
+                    v != end; ++v)
+              if (claim(visited_, *v))
+              {
+                visit(*v, u, depth, mode);
+                local.push_back(*v);
+              }
+          }
+#ifdef _OPENMP
+          #pragma omp critical
+#endif
+          {
+            next.insert(next.end(), local.begin(), local.end());
+            scanned += my_scanned;
+          }
+        }
+        queue_.swap(next);
+        return scanned;
+    }
+
+    // one bottom-up level: frontier_bits_ -> next_bits_; returns the
+    // number of vertices visited
+    //
+    size_t bottom_up(T depth, unsigned int mode, size_t &scanned)
+    {
+        const long num_words = visited_.size();
+        const T n = G_.num_vertices();
+        size_t found = 0;
+        size_t checked = 0;
+        std::fill(next_bits_.begin(), next_bits_.end(), 0);
+
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 64) \
+              reduction(+:found) reduction(+:checked)
+#endif
+        for (long w=0; w<num_words; w++)
+        {
+          uint64_t unvisited = ~visited_[w];
+          while (unvisited != 0)
+          {
+            const unsigned int b = __builtin_ctzll(unvisited);
+            unvisited &= unvisited - 1;
+            const T v = (T) (w * 64 + b);
+            if (v >= n)
+              break;
+            const neighbor_iterator end = G_.in_neighbors_end(v);
+            for (neighbor_iterator u = G_.in_neighbors_begin(v);
+                    u != end; ++u)
+            {
+              checked++;
+              if (test(frontier_bits_, *u))
+              {
+                visit(v, *u, depth, mode);
+                visited_[w] |= (uint64_t) 1 << b;
+                next_bits_[w] |= (uint64_t) 1 << b;
+                found++;
+                break;
+              }
+            }
+          }
+        }
+        frontier_bits_.swap(next_bits_);
+        scanned = checked;
+        return found;
+    }
+
+    void queue_to_bits()
+    {
+        std::fill(frontier_bits_.begin(), frontier_bits_.end(), 0);
+        for (size_t i=0; i<queue_.size(); i++)
+          set(frontier_bits_, queue_[i]);
+    }
+
+    void bits_to_queue()
+    {
+        queue_.clear();
+        for (size_t w=0; w<frontier_bits_.size(); w++)
+          for (uint64_t x = frontier_bits_[w]; x != 0; x &= x - 1)
+            queue_.push_back((T) (w * 64 + __builtin_ctzll(x)));
+    }
+
+    size_t frontier_edges() const
+    {
+        size_t m = 0;
+        for (size_t i=0; i<queue_.size(); i++)
+          m += G_.out_degree(queue_[i]);
+        return m;
+    }
+
+  public:
+
+    bfs_engine(const Graph &G, double alpha = 15.0,
+          double beta = 18.0) : G_(G), alpha_(alpha), beta_(beta),
+        visited_((G.num_vertices() + 63) / 64, 0),
+        frontier_bits_(visited_.size()), next_bits_(visited_.size()),
+        queue_(), parent_(), depth_(), num_reached_(0),
+        unexplored_edges_(G.num_edges()), num_levels_(0), bottom_up_steps_(0)
+    {}
+
+    /**
+        Forget all earlier runs.
+    */
+    void reset()
+    {
+        std::fill(visited_.begin(), visited_.end(), 0);
+        parent_.clear();
+        depth_.clear();
+        unexplored_edges_ = G_.num_edges();
+    }
+
+    /**
+        Search from sources.
+
+        @param mode   bfs_parents and/or bfs_depths, or 0 for
+                      reachability only
+        @param reset  forget the vertices visited by earlier runs
+        @return the number of vertices reached (by this run)
+    */
+    size_t run(const std::vector<T> &sources, unsigned int mode,
+          bool reset = true)
+    {
+        const T n = G_.num_vertices();
+        if (reset)
+          this->reset();
+        if ((mode & bfs_parents) && parent_.size() != n)
+          parent_.assign(n, unreached());
+        if ((mode & bfs_depths) && depth_.size() != n)
+          depth_.assign(n, unreached());
+
+        stats::scoped_phase phase("bfs");
+
+        queue_.clear();
+        for (size_t i=0; i<sources.size(); i++)
+          if (sources[i] < n && claim(visited_, sources[i]))
+          {
+            visit(sources[i], sources[i], 0, mode);
+            queue_.push_back(sources[i]);
+          }
+        num_reached_ = queue_.size();
+        num_levels_ = 0;
+        bottom_up_steps_ = 0;
+
+        bool bottom_up_mode = false;
+        size_t frontier_size = queue_.size();
+        size_t edges_to_check = frontier_edges();
+        T depth = 0;
+
+        while (frontier_size > 0)
+        {
+          num_levels_++;
+          depth++;
+          if (!bottom_up_mode)
+          {
+            unexplored_edges_ -= std::min(unexplored_edges_, edges_to_check);
+            if (edges_to_check > unexplored_edges_ / alpha_)
+            {
+              bottom_up_mode = true;
+              queue_to_bits();
+            }
+          }
+
+          if (bottom_up_mode)
+          {
+            size_t scanned = 0;
+            const size_t old_size = frontier_size;
+            frontier_size = bottom_up(depth, mode, scanned);
+            stats::edges_scanned() += scanned;
+            bottom_up_steps_++;
+            if (frontier_size < old_size && frontier_size < n / beta_)
+            {
+              bottom_up_mode = false;
+              bits_to_queue();
+              edges_to_check = frontier_edges();
+            }
+          }
+          else
+          {
+            stats::edges_scanned() += top_down(depth, mode);
+            frontier_size = queue_.size();
+            edges_to_check = frontier_edges();
+          }
+          num_reached_ += frontier_size;
+        }
+        return num_reached_;
+    }
+
+    size_t run(T source, unsigned int mode, bool reset = true)
+    {
+        return run(std::vector<T>(1, source), mode, reset);
+    }
+
+    /** vertices reached by the last run */
+    size_t num_reached() const { return num_reached_; }
+
+    /** number of levels (the largest depth) of the last run */
+    unsigned int num_levels() const
+    {
+        return (num_levels_ > 0 ? num_levels_ - 1 : 0);
+    }
+
+    /** levels of the last run that were expanded bottom-up */
+    unsigned int bottom_up_steps() const { return bottom_up_steps_; }
+
+    /** true if v was reached (by any run since the last reset) */
+    bool reached(T v) const { return test(visited_, v); }
+
+    /** parent of each vertex (unreached() if not reached) */
+    const std::vector<T> &parents() const { return parent_; }
+
+    /** depth of each vertex (unreached() if not reached) */
+    const std::vector<T> &depths() const { return depth_; }
+};
+
+
+/**
+    Weakly connected components by repeated search of the undirected
+    graph U (see undirected_graph()).  component[v] is the index of the
+    component of v, components numbered in order of their smallest
+    vertex; the sizes are returned.
+*/
+template <typename T>
+std::vector<size_t> bfs_components(const static_tGraph<T> &U,
+      std::vector<T> &component)
+{
+    const T n = U.num_vertices();
+    bfs_engine<T> B(U);
+    component.assign(n, bfs_engine<T>::unreached());
+    std::vector<size_t> sizes;
+
+    B.run(std::vector<T>(), bfs_parents);     // allocate the parent array
+    for (T v=0; v<n; v++)
+    {
+      if (B.reached(v))
+        continue;
+      const T c = (T) sizes.size();
+      sizes.push_back(B.run(v, bfs_parents, false));
+
+      // label the new component, by following parents up to v
+      component[v] = c;
+    }
+
+    const std::vector<T> &parent = B.parents();
+    for (T v=0; v<n; v++)
+    {
+      T r = v;
+      while (component[r] == bfs_engine<T>::unreached())
+        r = parent[r];
+      const T c = component[r];
+      for (T u = v; component[u] == bfs_engine<T>::unreached(); u = parent[u])
+        component[u] = c;
+    }
+    return sizes;
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_BFS_H_
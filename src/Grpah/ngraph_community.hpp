@@ -0,0 +1,447 @@
+#ifndef NGRAPH_COMMUNITY_H_
+#define NGRAPH_COMMUNITY_H_
+
+/*
+   Community detection on undirected graphs:
+
+        label_propagation   each vertex repeatedly takes the label that
+                            carries the most edge weight among its
+                            neighbors, until labels stop changing
+        louvain             multilevel modularity optimization: vertices
+                            move to the neighboring community with the
+                            largest modularity gain until none improves,
+                            then each community becomes a vertex of the
+                            next level, until modularity stops improving
+        modularity          of a partition
+
+   Both take a symmetric weighted graph (nwGraph, each edge {u,v} stored
+   as u->v and v->u); community_graph() makes one from a static graph.
+   In the aggregated graphs of louvain, the edges inside a community
+   become a self-loop u->u carrying their total (arc) weight, so that
+   the strength of a vertex, and modularity, are those of the partition
+   of the original graph.
+
+   Vertices are processed in parallel, in place: a vertex sees the moves
+   its neighbors have made so far (as in the sequential algorithms), and
+   community totals are updated atomically.  Neighbor weights per
+   community are gathered in a dense array per thread, indexed by
+   community, and cleared through the list of communities touched.
+   With one thread the results are those of the sequential algorithms;
+   with more, they may differ from run to run (by as much as runs of
+   the sequential algorithms in different vertex orders).
+
+   Communities are returned as community[v], numbered 0, 1, ... in the
+   order of their smallest vertex (see renumber_communities()).
+*/
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include "ngraph_static.hpp"
+#include "nwgraph.hpp"
+#include "ngraph_stats.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+
+struct community_options
+{
+    double resolution;              // gamma: > 1 for smaller communities
+    unsigned int max_sweeps;        // over all vertices, per level
+    unsigned int max_levels;
+    double min_sweep_gain;          // in modularity, for another sweep
+    double min_improvement;         // in modularity, for another level
+
+    community_options() : resolution(1.0), max_sweeps(32), max_levels(32),
+        min_sweep_gain(1e-4), min_improvement(1e-6) {}
+};
+
+
+/**
+    The undirected, unit-weight version of G (without self-loops).
+*/
+template <typename T>
+nwGraph<T> community_graph(const static_tGraph<T> &G)
+{
+    return nwGraph<T>(undirected_graph(G));
+}
+
+
+/**
+    Renumber community ids to 0 .. k-1, in the order of their smallest
+    vertex; if present is given, only those v with present[v] set count
+    (the others are left as they are).
+
+    @return k, the number of communities
+*/
+template <typename T>
+T renumber_communities(std::vector<T> &community,
+      const std::vector<char> *present = 0)
+{
+    const T none = (T) -1;
+    std::vector<T> id(community.size(), none);
+    T k = 0;
+    for (size_t v=0; v<community.size(); v++)
+    {
+      if (present && !(*present)[v])
+        continue;
+      T &c = id[community[v]];
+      if (c == none)
+        c = k++;
+      community[v] = c;
+    }
+    return k;
+}
+
+
+/**
+    Modularity of the partition community[] of a symmetric weighted
+    graph,
+
+        Q = sum over communities c of  in(c)/2m - gamma (tot(c)/2m)^2
+
+    where in(c) is the weight of the arcs inside c, tot(c) the total
+    strength of its vertices, and 2m that of all vertices.
+*/
+template <typename T, typename EW, typename NW>
+double modularity(const nwGraph<T, EW, NW> &G, const std::vector<T> &community,
+      double resolution = 1.0)
+{
+    const long n = G.num_vertices();
+    std::vector<double> strength(n);
+    double inside = 0.0;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(+:inside)
+#endif
+    for (long v=0; v<n; v++)
+    {
+      typename nwGraph<T, EW, NW>::const_weight_iterator w =
+            G.out_weights_begin((T) v);
+      double s = 0.0;
+      for (typename nwGraph<T, EW, NW>::const_iterator q =
+                G.out_neighbors_begin((T) v); q != G.out_neighbors_end((T) v);
+                q++, w++)
+      {
+        s += *w;
+        if (community[*q] == community[v])
+          inside += *w;
+      }
+      strength[v] = s;
+    }
+
+    std::vector<double> tot(n, 0.0);
+    double two_m = 0.0;
+    for (long v=0; v<n; v++)
+    {
+      tot[community[v]] += strength[v];
+      two_m += strength[v];
+    }
+    if (two_m == 0.0)
+      return 0.0;
+    double spread = 0.0;
+    for (long c=0; c<n; c++)
+      spread += (tot[c] / two_m) * (tot[c] / two_m);
+    return inside / two_m - resolution * spread;
+}
+
+
+// the weights from one vertex to each neighboring community, in a dense
+// array (one per thread) cleared through the list of communities touched
+//
+template <typename T>
+class community_weights
+{
+  private:
+    std::vector<double> weight_;
+    std::vector<T> touched_;
+
+  public:
+    explicit community_weights(size_t n) : weight_(n, 0.0), touched_() {}
+
+    void add(T c, double w)
+    {
+        if (weight_[c] == 0.0)
+          touched_.push_back(c);
+        weight_[c] += w;
+    }
+
+    double operator[](T c) const { return weight_[c]; }
+    const std::vector<T> &touched() const { return touched_; }
+
+    void clear()
+    {
+        for (size_t i=0; i<touched_.size(); i++)
+          weight_[touched_[i]] = 0.0;
+        touched_.clear();
+    }
+};
+
+
+template <typename T>
+inline T load_label(const std::vector<T> &label, T v)
+{
+    return __atomic_load_n(&label[v], __ATOMIC_RELAXED);
+}
+
+
+// ties between labels are broken by a hash of (vertex, label, pass), the
+// same for any number of threads; breaking them by smallest label would
+// let the small labels sweep the whole graph
+//
+inline uint64_t tie_key(uint64_t v, uint64_t c, unsigned int pass)
+{
+    uint64_t x = (v << 32) ^ c ^ ((uint64_t) pass << 56);
+    x = (x ^ (x >> 33)) * 0xff51afd7ed558ccdUL;
+    x = (x ^ (x >> 33)) * 0xc4ceb9fe1a85ec53UL;
+    return x ^ (x >> 33);
+}
+
+
+/**
+    Label propagation: starting from a label per vertex, each vertex in
+    turn takes the label of most weight among its neighbors (keeping its
+    own on a tie, else choosing by tie_key()), for up to max_iterations
+    passes or until no label changes.
+
+    @return the number of passes made
+*/
+template <typename T, typename EW, typename NW>
+unsigned int label_propagation(const nwGraph<T, EW, NW> &G,
+      std::vector<T> &label, unsigned int max_iterations = 100)
+{
+    stats::scoped_phase phase("label propagation");
+    const long n = G.num_vertices();
+    label.resize(n);
+    for (long v=0; v<n; v++)
+      label[v] = (T) v;
+
+    unsigned int pass = 0;
+    for (size_t changed = 1; changed > 0 && pass < max_iterations; pass++)
+    {
+      changed = 0;
+#ifdef _OPENMP
+      #pragma omp parallel reduction(+:changed)
+#endif
+      {
+        community_weights<T> W(n);
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 256)
+#endif
+        for (long v=0; v<n; v++)
+        {
+          typename nwGraph<T, EW, NW>::const_weight_iterator w =
+                G.out_weights_begin((T) v);
+          for (typename nwGraph<T, EW, NW>::const_iterator q =
+                    G.out_neighbors_begin((T) v);
+                    q != G.out_neighbors_end((T) v); q++, w++)
+            if (*q != (T) v)
+              W.add(load_label(label, *q), *w);
+          if (W.touched().empty())
+            continue;
+
+          const T own = label[v];
+          T best = own;
+          double best_weight = W[own];
+          uint64_t best_key = 0;
+          for (size_t i=0; i<W.touched().size(); i++)
+          {
+            const T c = W.touched()[i];
+            if (c == own || W[c] < best_weight)
+              continue;
+            const uint64_t key = tie_key(v, c, pass);
+            if (W[c] > best_weight || (best != own && key < best_key))
+            {
+              best = c;
+              best_weight = W[c];
+              best_key = key;
+            }
+          }
+          W.clear();
+          if (best != own)
+          {
+            __atomic_store_n(&label[v], best, __ATOMIC_RELAXED);
+            changed++;
+          }
+        }
+      }
+      stats::edges_scanned() += G.num_edges();
+    }
+    renumber_communities(label);
+    return pass;
+}
+
+
+// one level of louvain: move vertices between communities (starting as
+// singletons) while that improves modularity; true if any moved
+//
+template <typename T, typename EW, typename NW>
+bool louvain_local_moving(const nwGraph<T, EW, NW> &G,
+      const community_options &opt, std::vector<T> &community)
+{
+    const long n = G.num_vertices();
+    std::vector<double> strength(n), tot(n);
+    double two_m = 0.0;
+    for (long v=0; v<n; v++)
+    {
+      community[v] = (T) v;
+      tot[v] = strength[v] = G.out_strength((T) v);
+      two_m += strength[v];
+    }
+    if (two_m == 0.0)
+      return false;
+    const double scale = opt.resolution / two_m;
+
+    // sweeps stop when they no longer improve modularity by at least
+    // min_sweep_gain (the gain of a move, as below, is m times the
+    // change in modularity): the last few moves of a level gain little,
+    // and are mostly made anyway at the next level
+    bool any = false;
+    size_t moved = 1;
+    double gained = 0.0;
+    for (unsigned int sweep=0; moved > 0 && sweep < opt.max_sweeps; sweep++)
+    {
+      moved = 0;
+      gained = 0.0;
+#ifdef _OPENMP
+      #pragma omp parallel reduction(+:moved, gained)
+#endif
+      {
+        community_weights<T> W(n);
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 256)
+#endif
+        for (long v=0; v<n; v++)
+        {
+          typename nwGraph<T, EW, NW>::const_weight_iterator w =
+                G.out_weights_begin((T) v);
+          for (typename nwGraph<T, EW, NW>::const_iterator q =
+                    G.out_neighbors_begin((T) v);
+                    q != G.out_neighbors_end((T) v); q++, w++)
+            if (*q != (T) v)
+              W.add(load_label(community, *q), *w);
+
+          // gain of joining c, once v is taken out of its own community:
+          // weight(v, c) - gamma strength(v) tot(c) / 2m
+          const T own = community[v];
+          const double k = strength[v];
+          T best = own;
+          const double own_gain = W[own] - scale * k * (tot[own] - k);
+          double best_gain = own_gain;
+          for (size_t i=0; i<W.touched().size(); i++)
+          {
+            const T c = W.touched()[i];
+            if (c == own)
+              continue;
+            const double gain = W[c] - scale * k * tot[c];
+            if (gain > best_gain || (gain == best_gain && best != own &&
+                  c < best))
+            {
+              best = c;
+              best_gain = gain;
+            }
+          }
+          W.clear();
+          if (best != own)
+          {
+#ifdef _OPENMP
+            #pragma omp atomic
+#endif
+            tot[own] -= k;
+#ifdef _OPENMP
+            #pragma omp atomic
+#endif
+            tot[best] += k;
+            __atomic_store_n(&community[v], best, __ATOMIC_RELAXED);
+            gained += best_gain - own_gain;
+            moved++;
+          }
+        }
+      }
+      stats::edges_scanned() += G.num_edges();
+      if (moved > 0)
+        any = true;
+      if (2.0 * gained / two_m < opt.min_sweep_gain)
+        break;
+    }
+    return any;
+}
+
+
+/**
+    The graph of communities: one vertex per community (0 .. k-1), with
+    the arcs between two communities combined into one, and those inside
+    a community into a self-loop.
+*/
+template <typename T, typename EW, typename NW>
+nwGraph<T> community_quotient(const nwGraph<T, EW, NW> &G,
+      const std::vector<T> &community, T k)
+{
+    const long n = G.num_vertices();
+    std::vector<T> from(G.num_edges()), to(G.num_edges());
+    std::vector<double> weight(G.num_edges());
+    const std::vector<size_t> &rows = G.out_offsets();
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 1024)
+#endif
+    for (long v=0; v<n; v++)
+      for (size_t e=rows[v]; e<rows[v+1]; e++)
+      {
+        from[e] = community[v];
+        to[e] = community[G.out_targets()[e]];
+        weight[e] = G.out_weights()[e];
+      }
+    return nwGraph<T>(k, from, to, weight, sum_parallel_edges);
+}
+
+
+/**
+    Louvain modularity optimization of a symmetric weighted graph.
+
+    @return the modularity of the communities found
+*/
+template <typename T, typename EW, typename NW>
+double louvain(const nwGraph<T, EW, NW> &G, std::vector<T> &community,
+      const community_options &opt = community_options())
+{
+    stats::scoped_phase phase("louvain");
+    const long n = G.num_vertices();
+    community.resize(n);
+    for (long v=0; v<n; v++)
+      community[v] = (T) v;
+    double Q = modularity(G, community, opt.resolution);
+
+    // level 0 works on G itself, later levels on quotient graphs
+    nwGraph<T> H;
+    std::vector<T> C(n);
+    for (unsigned int level=0; level<opt.max_levels; level++)
+    {
+      const bool moved = (level == 0 ?
+            louvain_local_moving(G, opt, C) : louvain_local_moving(H, opt, C));
+      if (!moved)
+        break;
+      const T k = renumber_communities(C);
+      for (long v=0; v<n; v++)
+        community[v] = C[community[v]];
+
+      const double Q_level = (level == 0 ? modularity(G, C, opt.resolution) :
+            modularity(H, C, opt.resolution));
+      const bool improved = (Q_level - Q >= opt.min_improvement);
+      Q = Q_level;
+      if (!improved)
+        break;
+      H = (level == 0 ? community_quotient(G, C, k) :
+            community_quotient(H, C, k));
+      C.resize(k);
+    }
+    return Q;
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_COMMUNITY_H_
@@ -11,12 +11,14 @@ template <typename T>
 equivalence<T> components(const  tGraph<T> &G)
 {
     equivalence<T> E;
+    stats::scoped_phase phase("components");
 
    for (typename tGraph<T>::const_iterator pv = G.begin();  pv != G.end(); pv++)
    {
       const typename tGraph<T>::vertex &v = tGraph<T>::node(pv);
       const typename tGraph<T>::vertex_set &in = tGraph<T>:: in_neighbors(pv);
       const typename tGraph<T>::vertex_set &out = tGraph<T>::out_neighbors(pv);
+      stats::edges_scanned() += in.size() + out.size();
         
       if (in.size() == 0 && out.size() == 0)
       {     
@@ -0,0 +1,573 @@
+#ifndef NGRAPH_COMPRESSED_H_
+#define NGRAPH_COMPRESSED_H_
+
+/*
+   Compressed static graphs: a CSR whose neighbor lists are stored as
+   gaps, in stream-vbyte code (Lemire, Kurz and Rupp, 2017), for graphs
+   too large for 4 bytes per edge end.
+
+   Each row (the sorted out- or in-neighbors t[0] < t[1] < ... of a
+   vertex v) is stored as
+
+        degree    LEB128 varint
+        control   2 bits per value, the byte length (1-4) less one,
+                  four values per byte
+        data      the values, in as few little-endian bytes as each needs
+
+   where the values are the zigzag-coded difference t[0] - v, then the
+   gaps t[i] - t[i-1] - 1.  Rows start at a 64-bit offset for each block
+   of 64 vertices plus a 32-bit offset for each vertex, so a row costs
+   about 5 bytes plus 1.25 bytes per neighbor whose gap is below 2^8;
+   with the vertices numbered for locality (reorder.hpp), most are.
+
+   Rows are read with a forward const_iterator, which decodes one value
+   per step, so a compressed_tGraph can stand in for a static_tGraph in
+   the algorithms written for either (bfs_engine, ms_bfs, ...).  To
+   decode a whole row at once, decode_out() and decode_in() use SSSE3
+   shuffles (compile with -mssse3 or -march=native), or plain code
+   otherwise.
+
+   Vertices are 32-bit unsigned integers.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <stdint.h>
+#include "ngraph_static.hpp"
+#include "ngraph_stats.hpp"
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+
+const char cgr_magic[8] = { 'N', 'G', 'C', 'G', 'R', '0', '1', 0 };
+
+
+// the encoded rows of one direction (out- or in-edges)
+//
+struct compressed_rows
+{
+    std::vector<uint64_t> base;     // per block of 64 vertices
+    std::vector<uint32_t> offset;   // per vertex, from its block's base
+    std::vector<uint8_t> bytes;     // padded with 16 bytes, for decoding
+
+    const uint8_t *row(size_t v) const
+    {
+        return &bytes[0] + base[v >> 6] + offset[v];
+    }
+
+    size_t memory() const
+    {
+        return base.size() * sizeof(uint64_t) +
+              offset.size() * sizeof(uint32_t) + bytes.size();
+    }
+};
+
+
+namespace cgr
+{
+
+inline uint32_t zigzag(int32_t x)
+{
+    return ((uint32_t) x << 1) ^ (uint32_t) (x >> 31);
+}
+
+inline int32_t unzigzag(uint32_t x)
+{
+    return (int32_t) (x >> 1) ^ -(int32_t) (x & 1);
+}
+
+inline unsigned int byte_length(uint32_t x)
+{
+    return (x < (1u << 8) ? 1 : x < (1u << 16) ? 2 : x < (1u << 24) ? 3 : 4);
+}
+
+inline size_t varint_length(size_t x)
+{
+    size_t k = 1;
+    for (; x >= 128; x >>= 7)
+      k++;
+    return k;
+}
+
+inline uint8_t *put_varint(uint8_t *p, size_t x)
+{
+    for (; x >= 128; x >>= 7)
+      *p++ = (uint8_t) (x | 128);
+    *p++ = (uint8_t) x;
+    return p;
+}
+
+inline const uint8_t *get_varint(const uint8_t *p, size_t &x)
+{
+    x = 0;
+    for (unsigned int shift = 0; ; shift += 7)
+    {
+      const uint8_t b = *p++;
+      x |= (size_t) (b & 127) << shift;
+      if (b < 128)
+        return p;
+    }
+}
+
+// value i of a row: its length code, from the control bytes, and the
+// value, from a 4-byte load masked to that length (rows are padded, so
+// the load never runs off the buffer)
+//
+inline uint32_t get_value(const uint8_t *control, size_t i,
+      const uint8_t *&data)
+{
+    static const uint32_t mask[4] = { 0xFFu, 0xFFFFu, 0xFFFFFFu, 0xFFFFFFFFu };
+    const unsigned int code = (control[i >> 2] >> ((i & 3) * 2)) & 3;
+    uint32_t x;
+    memcpy(&x, data, sizeof(x));
+    data += code + 1;
+    return x & mask[code];
+}
+
+// encoded size of a row; values[] gets its stream-vbyte values
+//
+template <typename T>
+size_t row_size(T v, const T *begin, const T *end,
+      std::vector<uint32_t> &values)
+{
+    const size_t d = end - begin;
+    values.resize(d);
+    size_t size = varint_length(d) + (d + 3) / 4;
+    for (size_t i=0; i<d; i++)
+    {
+      values[i] = (i == 0 ? zigzag((int32_t) ((uint32_t) begin[0] - v)) :
+            (uint32_t) (begin[i] - begin[i-1] - 1));
+      size += byte_length(values[i]);
+    }
+    return size;
+}
+
+inline void put_row(uint8_t *p, const std::vector<uint32_t> &values)
+{
+    const size_t d = values.size();
+    p = put_varint(p, d);
+    uint8_t *control = p;
+    uint8_t *data = p + (d + 3) / 4;
+    memset(control, 0, (d + 3) / 4);
+    for (size_t i=0; i<d; i++)
+    {
+      const unsigned int k = byte_length(values[i]);
+      control[i >> 2] |= (k - 1) << ((i & 3) * 2);
+      uint32_t x = values[i];
+      for (unsigned int b=0; b<k; b++, x >>= 8)
+        *data++ = (uint8_t) x;
+    }
+}
+
+#ifdef __SSSE3__
+
+// shuffle masks and data lengths for each control byte
+//
+struct shuffle_table
+{
+    uint8_t mask[256][16];
+    uint8_t length[256];
+
+    shuffle_table()
+    {
+        for (unsigned int c=0; c<256; c++)
+        {
+          unsigned int in = 0;
+          for (unsigned int j=0; j<4; j++)
+          {
+            const unsigned int k = ((c >> (2 * j)) & 3) + 1;
+            for (unsigned int b=0; b<4; b++)
+              mask[c][4*j + b] = (b < k ? (uint8_t) (in + b) : 0x80);
+            in += k;
+          }
+          length[c] = (uint8_t) in;
+        }
+    }
+
+    static const shuffle_table &instance()
+    {
+        static const shuffle_table S;
+        return S;
+    }
+};
+
+#endif
+
+// decode a row starting at p into out[] (as raw values, before the
+// gaps are summed); returns the degree
+//
+inline size_t get_raw_row(const uint8_t *p, uint32_t *out)
+{
+    size_t d = 0;
+    p = get_varint(p, d);
+    const uint8_t *control = p;
+    const uint8_t *data = p + (d + 3) / 4;
+    size_t i = 0;
+#ifdef __SSSE3__
+    const shuffle_table &S = shuffle_table::instance();
+    for (; i + 4 <= d; i += 4)
+    {
+      const uint8_t c = control[i >> 2];
+      const __m128i x = _mm_loadu_si128((const __m128i *) data);
+      _mm_storeu_si128((__m128i *) (out + i),
+            _mm_shuffle_epi8(x, _mm_loadu_si128((const __m128i *) S.mask[c])));
+      data += S.length[c];
+    }
+#endif
+    for (; i < d; i++)
+      out[i] = get_value(control, i, data);
+    return d;
+}
+
+}
+// namespace cgr
+
+
+template <typename T>
+class compressed_tGraph
+{
+  public:
+
+    typedef T vertex;
+    typedef T value_type;
+    typedef std::pair<vertex,vertex> edge;
+
+    /**
+        Iterates over the (sorted) neighbors of one vertex, decoding as
+        it goes.  Any two iterators that have the same number of
+        neighbors left compare equal, so the end iterator is free to
+        make.
+    */
+    class const_iterator
+    {
+      private:
+        const uint8_t *control_;
+        const uint8_t *data_;
+        size_t i_;
+        size_t n_;
+        T value_;
+
+      public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const T *pointer;
+        typedef const T &reference;
+
+        const_iterator() : control_(0), data_(0), i_(0), n_(0), value_(0) {}
+
+        const_iterator(T v, const uint8_t *p) : control_(0), data_(0),
+            i_(0), n_(0), value_(0)
+        {
+            p = cgr::get_varint(p, n_);
+            control_ = p;
+            data_ = p + (n_ + 3) / 4;
+            if (n_ > 0)
+              value_ = (T) (v + cgr::unzigzag(cgr::get_value(control_, 0,
+                    data_)));
+        }
+
+        const T &operator*() const { return value_; }
+        const T *operator->() const { return &value_; }
+
+        const_iterator &operator++()
+        {
+            if (++i_ < n_)
+              value_ += cgr::get_value(control_, i_, data_) + 1;
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator p(*this);
+            ++*this;
+            return p;
+        }
+
+        bool operator==(const const_iterator &p) const
+        {
+            return n_ - i_ == p.n_ - p.i_;
+        }
+
+        bool operator!=(const const_iterator &p) const
+        {
+            return !(*this == p);
+        }
+    };
+
+  private:
+
+    T num_vertices_;
+    size_t num_edges_;
+    compressed_rows out_;
+    compressed_rows in_;
+
+    static void encode(const static_tGraph<T> &G, bool out,
+          compressed_rows &R)
+    {
+        const long n = G.num_vertices();
+        std::vector<size_t> size(n);
+
+#ifdef _OPENMP
+        #pragma omp parallel
+#endif
+        {
+          std::vector<uint32_t> values;
+#ifdef _OPENMP
+          #pragma omp for schedule(dynamic, 1024)
+#endif
+          for (long v=0; v<n; v++)
+            size[v] = (out ?
+                cgr::row_size((T) v, G.out_neighbors_begin(v),
+                      G.out_neighbors_end(v), values) :
+                cgr::row_size((T) v, G.in_neighbors_begin(v),
+                      G.in_neighbors_end(v), values));
+        }
+
+        R.base.assign((n + 63) / 64, 0);
+        R.offset.assign(n, 0);
+        uint64_t pos = 0;
+        for (long v=0; v<n; v++)
+        {
+          if ((v & 63) == 0)
+            R.base[v >> 6] = pos;
+          R.offset[v] = (uint32_t) (pos - R.base[v >> 6]);
+          pos += size[v];
+        }
+        R.bytes.assign(pos + 16, 0);
+
+#ifdef _OPENMP
+        #pragma omp parallel
+#endif
+        {
+          std::vector<uint32_t> values;
+#ifdef _OPENMP
+          #pragma omp for schedule(dynamic, 1024)
+#endif
+          for (long v=0; v<n; v++)
+          {
+            if (out)
+              cgr::row_size((T) v, G.out_neighbors_begin(v),
+                    G.out_neighbors_end(v), values);
+            else
+              cgr::row_size((T) v, G.in_neighbors_begin(v),
+                    G.in_neighbors_end(v), values);
+            cgr::put_row(&R.bytes[0] + R.base[v >> 6] + R.offset[v], values);
+          }
+        }
+    }
+
+    static size_t decode(const compressed_rows &R, T v, std::vector<T> &row)
+    {
+        const uint8_t *p = R.row(v);
+        size_t d = 0;
+        cgr::get_varint(p, d);
+        row.resize(d);
+        if (d == 0)
+          return 0;
+        uint32_t *x = (uint32_t *) &row[0];
+        cgr::get_raw_row(p, x);
+        uint32_t t = (uint32_t) v + (uint32_t) cgr::unzigzag(x[0]);
+        x[0] = t;
+        for (size_t i=1; i<d; i++)
+          x[i] = t = t + x[i] + 1;
+        return d;
+    }
+
+    static size_t degree(const compressed_rows &R, T v)
+    {
+        size_t d = 0;
+        cgr::get_varint(R.row(v), d);
+        return d;
+    }
+
+    static bool write_rows(FILE *f, const compressed_rows &R)
+    {
+        const uint64_t size = R.bytes.size();
+        return fwrite(&size, sizeof(size), 1, f) == 1 &&
+            (R.base.empty() || fwrite(&R.base[0], sizeof(uint64_t),
+                  R.base.size(), f) == R.base.size()) &&
+            (R.offset.empty() || fwrite(&R.offset[0], sizeof(uint32_t),
+                  R.offset.size(), f) == R.offset.size()) &&
+            fwrite(&R.bytes[0], 1, size, f) == size;
+    }
+
+    static bool read_rows(FILE *f, size_t n, compressed_rows &R)
+    {
+        uint64_t size = 0;
+        if (fread(&size, sizeof(size), 1, f) != 1 || size < 16)
+          return false;
+        R.base.resize((n + 63) / 64);
+        R.offset.resize(n);
+        R.bytes.resize(size);
+        return (R.base.empty() || fread(&R.base[0], sizeof(uint64_t),
+                  R.base.size(), f) == R.base.size()) &&
+            (R.offset.empty() || fread(&R.offset[0], sizeof(uint32_t),
+                  R.offset.size(), f) == R.offset.size()) &&
+            fread(&R.bytes[0], 1, size, f) == size;
+    }
+
+  public:
+
+    compressed_tGraph() : num_vertices_(0), num_edges_(0), out_(), in_()
+    {
+        out_.bytes.assign(16, 0);
+        in_.bytes.assign(16, 0);
+    }
+
+    explicit compressed_tGraph(const static_tGraph<T> &G) :
+        num_vertices_(G.num_vertices()), num_edges_(G.num_edges()),
+        out_(), in_()
+    {
+        stats::scoped_phase phase("compress");
+        encode(G, true, out_);
+        encode(G, false, in_);
+    }
+
+    /** the uncompressed graph */
+    static_tGraph<T> to_static() const
+    {
+        std::vector<size_t> offsets(num_vertices_ + 1, 0);
+        for (T v=0; v<num_vertices_; v++)
+          offsets[v+1] = offsets[v] + out_degree(v);
+        std::vector<T> targets(num_edges_), row;
+        for (T v=0; v<num_vertices_; v++)
+          if (decode_out(v, row) > 0)
+            std::copy(row.begin(), row.end(), targets.begin() + offsets[v]);
+        static_tGraph<T> G;
+        G.assign(num_vertices_, offsets, targets);
+        return G;
+    }
+
+    T num_vertices() const { return num_vertices_; }
+    size_t num_edges() const { return num_edges_; }
+
+    size_t out_degree(T v) const { return degree(out_, v); }
+    size_t in_degree(T v) const { return degree(in_, v); }
+    size_t degree(T v) const { return out_degree(v); }
+
+    bool isolated(T v) const
+    {
+        return out_degree(v) == 0 && in_degree(v) == 0;
+    }
+
+    const_iterator out_neighbors_begin(T v) const
+    {
+        return const_iterator(v, out_.row(v));
+    }
+    const_iterator out_neighbors_end(T) const { return const_iterator(); }
+
+    const_iterator in_neighbors_begin(T v) const
+    {
+        return const_iterator(v, in_.row(v));
+    }
+    const_iterator in_neighbors_end(T) const { return const_iterator(); }
+
+    /** the out-neighbors of v, decoded all at once; returns the degree */
+    size_t decode_out(T v, std::vector<T> &row) const
+    {
+        return decode(out_, v, row);
+    }
+
+    size_t decode_in(T v, std::vector<T> &row) const
+    {
+        return decode(in_, v, row);
+    }
+
+    bool includes_vertex(T a) const { return a < num_vertices_; }
+
+    bool includes_edge(T a, T b) const
+    {
+        if (!includes_vertex(a))
+          return false;
+        for (const_iterator p = out_neighbors_begin(a);
+                p != out_neighbors_end(a) && *p <= b; p++)
+          if (*p == b)
+            return true;
+        return false;
+    }
+
+    /** bytes used by the graph (both directions) */
+    size_t memory() const { return out_.memory() + in_.memory(); }
+
+    /** bytes of the out-edge rows, per edge */
+    double out_bytes_per_edge() const
+    {
+        return (num_edges_ == 0 ? 0.0 :
+              (double) out_.memory() / num_edges_);
+    }
+
+    /**
+        Save as a binary .cgr file: a csr_file_header (with the .cgr
+        magic), then the out- and in-rows, each as the size of its
+        bytes, its block and vertex offsets, and its bytes.
+    */
+    bool save(FILE *f) const
+    {
+        csr_file_header h;
+        memcpy(h.magic, cgr_magic, sizeof(h.magic));
+        h.vertex_bytes = sizeof(T);
+        h.flags = 0;
+        h.num_vertices = num_vertices_;
+        h.num_edges = num_edges_;
+        return fwrite(&h, sizeof(h), 1, f) == 1 && write_rows(f, out_) &&
+            write_rows(f, in_) && fflush(f) == 0;
+    }
+
+    bool load(FILE *f, std::string &error)
+    {
+        csr_file_header h;
+        if (fread(&h, sizeof(h), 1, f) != 1 ||
+              memcmp(h.magic, cgr_magic, sizeof(h.magic)) != 0)
+        {
+          error = "not a compressed graph (.cgr) file";
+          return false;
+        }
+        if (h.vertex_bytes != sizeof(T))
+        {
+          error = "compressed graph has a different vertex size";
+          return false;
+        }
+        num_vertices_ = h.num_vertices;
+        num_edges_ = h.num_edges;
+        if (!read_rows(f, num_vertices_, out_) ||
+            !read_rows(f, num_vertices_, in_))
+        {
+          error = "compressed graph file is truncated";
+          return false;
+        }
+        return true;
+    }
+};
+
+
+/**
+    Write G in the format given by opt (see ngraph_write.hpp), decoding
+    each row as it is formatted.
+*/
+template <typename T>
+bool write_graph(graph_sink out, const compressed_tGraph<T> &G,
+      const write_options &opt, std::string &error)
+{
+    stats::scoped_phase phase("write");
+    stats::edges_written() += G.num_edges();
+    return write_rows(out, indexed_rows<compressed_tGraph<T> >(G), opt,
+          error);
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_COMPRESSED_H_
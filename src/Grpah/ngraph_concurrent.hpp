@@ -0,0 +1,406 @@
+#ifndef NGRAPH_CONCURRENT_H_
+#define NGRAPH_CONCURRENT_H_
+
+/*
+   A graph that can be queried while it is being loaded: edges are
+   inserted by any number of threads at once, and read, at the same
+   time, by any number of others.
+
+   Each vertex has an out- and an in-neighbor array, which only grow.
+   A writer appends to an array under a lock (one of num_stripes spin
+   locks, chosen by vertex), storing the neighbor before publishing the
+   new size; a full array is copied into one twice its size, which is
+   then published in place of the old.  Readers take no locks and never
+   wait: they load the array, then its size, and see the neighbors
+   stored up to then.  Replaced arrays are kept until reclaim(), called
+   when no thread is using the graph, so that a reader may still be
+   looking at one.
+
+   So the neighbors and degree of a vertex are always consistent with
+   each other, as of some moment during the call; between vertices
+   they need not be (an edge a->b may be in the out-neighbors of a a
+   moment before it is in the in-neighbors of b).  to_static() takes a
+   CSR copy, per vertex as of the moment it reaches that vertex, so
+   every row is a set of whole edges.
+
+   Edges are a set, as in tGraph: inserting an edge twice has no effect
+   (each stripe keeps a hash of the edges from its vertices).  There is
+   no removal; use tGraph, or static_tGraph::update(), for that.
+
+   Vertices are unsigned integers below 2^32.
+*/
+
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include "ngraph_static.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+
+template <typename T>
+class concurrent_graph
+{
+  public:
+
+    typedef T vertex;
+
+    /** a consistent view of the neighbors of a vertex */
+    struct neighbor_range
+    {
+        const T *begin;
+        const T *end;
+
+        size_t size() const { return end - begin; }
+    };
+
+  private:
+
+    enum { chunk_bits = 16, chunk_size = 1 << chunk_bits,
+           num_chunks = 1 << 16, num_stripes = 4096 };
+
+    struct neighbors
+    {
+        size_t size;
+        size_t capacity;
+        T data[1];
+    };
+
+    struct slot
+    {
+        neighbors *out;
+        neighbors *in;
+        int present;
+    };
+
+    struct stripe
+    {
+        volatile int lock;
+        size_t num_keys;
+        std::vector<uint64_t> keys;     // open addressing, ~0 is empty
+        std::vector<neighbors *> retired;
+        char pad[64];                   // one cache line per lock
+
+        stripe() : lock(0), num_keys(0), keys(), retired(), pad() {}
+    };
+
+    std::vector<slot *> chunks_;
+    std::vector<stripe> stripes_;
+    size_t num_vertices_;
+    size_t num_edges_;
+    size_t vertex_range_;
+
+    // not copyable
+    concurrent_graph(const concurrent_graph &);
+    concurrent_graph &operator=(const concurrent_graph &);
+
+    static uint64_t empty_key() { return ~(uint64_t) 0; }
+
+    static unsigned int stripe_of(T v)
+    {
+        return ((uint32_t) v * 2654435761u) >> 20;     // top 12 bits
+    }
+
+    static void lock(stripe &s)
+    {
+        while (__sync_lock_test_and_set(&s.lock, 1))
+          while (s.lock)
+            ;
+    }
+
+    static void unlock(stripe &s)
+    {
+        __sync_lock_release(&s.lock);
+    }
+
+    const slot *find_slot(T v) const
+    {
+        if ((size_t) v >> chunk_bits >= (size_t) num_chunks)
+          return 0;
+        const slot *c = __atomic_load_n(&chunks_[v >> chunk_bits],
+              __ATOMIC_ACQUIRE);
+        return (c ? &c[v & (chunk_size - 1)] : 0);
+    }
+
+    slot &make_slot(T v)
+    {
+        slot **c = &chunks_[v >> chunk_bits];
+        slot *p = __atomic_load_n(c, __ATOMIC_ACQUIRE);
+        if (p == 0)
+        {
+          slot *q = (slot *) calloc(chunk_size, sizeof(slot));
+          if (__sync_bool_compare_and_swap(c, (slot *) 0, q))
+            p = q;
+          else
+          {
+            free(q);                    // another thread got there first
+            p = __atomic_load_n(c, __ATOMIC_ACQUIRE);
+          }
+        }
+        return p[v & (chunk_size - 1)];
+    }
+
+    static neighbor_range range(const neighbors *A)
+    {
+        neighbor_range r;
+        if (A == 0)
+          r.begin = r.end = 0;
+        else
+        {
+          r.begin = A->data;
+          r.end = A->data + __atomic_load_n(&A->size, __ATOMIC_ACQUIRE);
+        }
+        return r;
+    }
+
+    // with the stripe of the list's vertex locked
+    static void append(neighbors *&list, T x, stripe &s)
+    {
+        neighbors *A = list;
+        if (A != 0 && A->size < A->capacity)
+        {
+          A->data[A->size] = x;
+          __atomic_store_n(&A->size, A->size + 1, __ATOMIC_RELEASE);
+          return;
+        }
+        const size_t size = (A ? A->size : 0);
+        const size_t capacity = (A ? 2 * A->capacity : 4);
+        neighbors *B = (neighbors *) malloc(sizeof(neighbors) +
+              (capacity - 1) * sizeof(T));
+        if (size > 0)
+          memcpy(B->data, A->data, size * sizeof(T));
+        B->data[size] = x;
+        B->size = size + 1;
+        B->capacity = capacity;
+        __atomic_store_n(&list, B, __ATOMIC_RELEASE);
+        if (A)
+          s.retired.push_back(A);
+    }
+
+    static size_t key_hash(uint64_t key, size_t mask)
+    {
+        return (size_t) ((key * 0x9E3779B97F4A7C15UL) >> 32) & mask;
+    }
+
+    // with s locked: true if key was not in s already
+    static bool insert_key(stripe &s, uint64_t key)
+    {
+        if (2 * (s.num_keys + 1) > s.keys.size())
+        {
+          std::vector<uint64_t> old(std::max((size_t) 16, 2 * s.keys.size()),
+                empty_key());
+          old.swap(s.keys);
+          const size_t mask = s.keys.size() - 1;
+          for (size_t i=0; i<old.size(); i++)
+            if (old[i] != empty_key())
+            {
+              size_t h = key_hash(old[i], mask);
+              while (s.keys[h] != empty_key())
+                h = (h + 1) & mask;
+              s.keys[h] = old[i];
+            }
+        }
+        const size_t mask = s.keys.size() - 1;
+        size_t h = key_hash(key, mask);
+        for (; s.keys[h] != empty_key(); h = (h + 1) & mask)
+          if (s.keys[h] == key)
+            return false;
+        s.keys[h] = key;
+        s.num_keys++;
+        return true;
+    }
+
+    void grow_range(T v)
+    {
+        size_t r = vertex_range_;
+        while ((size_t) v >= r)
+        {
+          if (__sync_bool_compare_and_swap(&vertex_range_, r, (size_t) v + 1))
+            break;
+          r = vertex_range_;
+        }
+    }
+
+  public:
+
+    concurrent_graph() : chunks_(num_chunks, (slot *) 0),
+        stripes_(num_stripes), num_vertices_(0), num_edges_(0),
+        vertex_range_(0)
+    {}
+
+    ~concurrent_graph()
+    {
+        reclaim();
+        for (size_t c=0; c<chunks_.size(); c++)
+          if (chunks_[c])
+          {
+            for (size_t i=0; i<chunk_size; i++)
+            {
+              free(chunks_[c][i].out);
+              free(chunks_[c][i].in);
+            }
+            free(chunks_[c]);
+          }
+    }
+
+    // ----- readers (wait-free, safe during inserts) -----
+
+    size_t num_vertices() const
+    {
+        return __atomic_load_n(&num_vertices_, __ATOMIC_ACQUIRE);
+    }
+
+    size_t num_edges() const
+    {
+        return __atomic_load_n(&num_edges_, __ATOMIC_ACQUIRE);
+    }
+
+    /** one more than the largest vertex inserted */
+    size_t vertex_range() const
+    {
+        return __atomic_load_n(&vertex_range_, __ATOMIC_ACQUIRE);
+    }
+
+    bool includes_vertex(T v) const
+    {
+        const slot *s = find_slot(v);
+        return s && __atomic_load_n(&s->present, __ATOMIC_ACQUIRE);
+    }
+
+    neighbor_range out_neighbors(T v) const
+    {
+        const slot *s = find_slot(v);
+        return range(s ? __atomic_load_n(&s->out, __ATOMIC_ACQUIRE) : 0);
+    }
+
+    neighbor_range in_neighbors(T v) const
+    {
+        const slot *s = find_slot(v);
+        return range(s ? __atomic_load_n(&s->in, __ATOMIC_ACQUIRE) : 0);
+    }
+
+    size_t out_degree(T v) const { return out_neighbors(v).size(); }
+    size_t in_degree(T v) const { return in_neighbors(v).size(); }
+
+    /** a linear search of the out-neighbors of a */
+    bool includes_edge(T a, T b) const
+    {
+        const neighbor_range r = out_neighbors(a);
+        return std::find(r.begin, r.end, b) != r.end;
+    }
+
+    // ----- writers (any number of threads at once) -----
+
+    void insert_vertex(T v)
+    {
+        slot &s = make_slot(v);
+        if (__atomic_load_n(&s.present, __ATOMIC_ACQUIRE) == 0 &&
+              __sync_bool_compare_and_swap(&s.present, 0, 1))
+          __sync_fetch_and_add(&num_vertices_, 1);
+        grow_range(v);
+    }
+
+    /**
+        @return true if the edge is new
+    */
+    bool insert_edge(T a, T b)
+    {
+        insert_vertex(a);
+        insert_vertex(b);
+
+        stripe &sa = stripes_[stripe_of(a)];
+        lock(sa);
+        const bool is_new = insert_key(sa, ((uint64_t) a << 32) | b);
+        if (is_new)
+          append(make_slot(a).out, b, sa);
+        unlock(sa);
+        if (!is_new)
+          return false;
+
+        stripe &sb = stripes_[stripe_of(b)];
+        lock(sb);
+        append(make_slot(b).in, a, sb);
+        unlock(sb);
+        __sync_fetch_and_add(&num_edges_, 1);
+        return true;
+    }
+
+    /**
+        Insert the edges from[i] -> to[i], in parallel.
+    */
+    void insert_edges(const std::vector<T> &from, const std::vector<T> &to)
+    {
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 1024)
+#endif
+        for (long i=0; i<(long) from.size(); i++)
+          insert_edge(from[i], to[i]);
+    }
+
+    /**
+        Free the neighbor arrays replaced since the last call; only when
+        no other thread is using the graph.
+    */
+    void reclaim()
+    {
+        for (size_t i=0; i<stripes_.size(); i++)
+        {
+          for (size_t k=0; k<stripes_[i].retired.size(); k++)
+            free(stripes_[i].retired[k]);
+          std::vector<neighbors *>().swap(stripes_[i].retired);
+        }
+    }
+
+    /**
+        A CSR copy of the graph (on vertices 0 .. vertex_range()-1); may
+        be taken while edges are being inserted, in which case each row
+        is the out-neighbors of its vertex at some moment of the call.
+        If present is not 0, (*present)[v] is set for the vertices of
+        the graph (as opposed to the gaps in the numbering).
+    */
+    void to_static(static_tGraph<T> &G, std::vector<char> *present = 0) const
+    {
+        const long n = vertex_range();
+        std::vector<neighbor_range> rows(n);
+        std::vector<size_t> offsets(n + 1, 0);
+        if (present)
+          present->assign(n, 0);
+
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 1024)
+#endif
+        for (long v=0; v<n; v++)
+        {
+          rows[v] = out_neighbors((T) v);
+          offsets[v+1] = rows[v].size();
+          if (present)
+            (*present)[v] = includes_vertex((T) v);
+        }
+        for (long v=0; v<n; v++)
+          offsets[v+1] += offsets[v];
+
+        std::vector<T> targets(offsets[n]);
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 1024)
+#endif
+        for (long v=0; v<n; v++)
+        {
+          T *row = targets.empty() ? 0 : &targets[0] + offsets[v];
+          std::copy(rows[v].begin, rows[v].end, row);
+          std::sort(row, row + rows[v].size());
+        }
+        G.assign((T) n, offsets, targets);
+    }
+};
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_CONCURRENT_H_
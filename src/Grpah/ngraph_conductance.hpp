@@ -1,5 +1,5 @@
-#ifndef CLUSTER_COEFF_H
-#define CLUSTER_COEFF_H
+#ifndef NGRAPH_CONDUCTANCE_H
+#define NGRAPH_CONDUCTANCE_H
 
 #include "ngraph.hpp"
 #include "set_ops.hpp"
@@ -113,4 +113,4 @@ double alignment(const tGraph<T> &G,
 // namespace NGraph
 
 #endif
-// CLUSTER_COEFF_H
+// NGRAPH_CONDUCTANCE_H
@@ -0,0 +1,447 @@
+#ifndef NGRAPH_DISTANCE_H_
+#define NGRAPH_DISTANCE_H_
+
+/*
+   Distance statistics of static (CSR) graphs:
+
+        ms_bfs              distances from a batch of 64*W sources at once
+                            (multi-source BFS, Then et al., 2014)
+        distance_sample     hop plot, average path length and effective
+                            diameter estimated from sampled sources, with
+                            confidence intervals
+        double_sweep        lower bound on the diameter from two searches
+        ifub_diameter       exact diameter, or bounds on it, by iFUB
+                            (Crescenzi et al., 2013)
+
+   They take a static_tGraph or a compressed_tGraph (or any graph with
+   their interface; see ngraph_bfs.hpp).
+
+   Path lengths are in hops along out-edges.  The diameter functions are
+   for undirected graphs (both directions of every edge present; see
+   undirected_graph()), and work on the component of the start vertex.
+*/
+
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <stdint.h>
+#include "ngraph_static.hpp"
+#include "ngraph_bfs.hpp"
+#include "ngraph_stats.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+
+/**
+    Multi-source BFS: one search from each of sources[0..num_sources),
+    num_sources <= 64 * W, run together.  Every vertex keeps W 64-bit
+    words with one bit per source for the searches that have seen it
+    and for those that reached it in the last level, so one pass over
+    the edges advances all searches by one level: a vertex is reached
+    by the searches that reached any of its in-neighbors, less those
+    that have already seen it.  The W-word loops are simple enough for
+    the compiler to vectorize.
+
+    Each level is a pull over all vertices (in parallel, without
+    atomics), skipping the vertices every search has seen.
+
+    hops[i][d] is set to the number of vertices at distance d from
+    sources[i] (hops[i][0] = 1).
+*/
+template <unsigned int W, typename Graph, typename T>
+void ms_bfs(const Graph &G, const T *sources, size_t num_sources,
+      std::vector<std::vector<size_t> > &hops)
+{
+    const long n = G.num_vertices();
+    const unsigned int B = 64 * W;
+    hops.assign(num_sources, std::vector<size_t>(1, 1));
+    if (num_sources == 0)
+      return;
+
+    std::vector<uint64_t> seen(n * W, 0), visit(n * W, 0), next(n * W, 0);
+    uint64_t all[W];
+    for (unsigned int k=0; k<W; k++)
+      all[k] = 0;
+    for (size_t i=0; i<num_sources && i<B; i++)
+    {
+      const uint64_t bit = (uint64_t) 1 << (i & 63);
+      all[i >> 6] |= bit;
+      seen[(size_t) sources[i] * W + (i >> 6)] |= bit;
+      visit[(size_t) sources[i] * W + (i >> 6)] |= bit;
+    }
+
+    stats::scoped_phase phase("ms-bfs");
+
+    for (size_t depth = 1; ; depth++)
+    {
+      std::vector<size_t> count(B, 0);
+      bool any = false;
+
+#ifdef _OPENMP
+      #pragma omp parallel
+#endif
+      {
+        std::vector<size_t> my_count(B, 0);
+        bool my_any = false;
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 1024)
+#endif
+        for (long v=0; v<n; v++)
+        {
+          uint64_t *nv = &next[v * W];
+          uint64_t *sv = &seen[v * W];
+          bool full = true;
+          for (unsigned int k=0; k<W; k++)
+          {
+            nv[k] = 0;
+            full &= (sv[k] == all[k]);
+          }
+          if (full)
+            continue;
+
+          const typename Graph::const_iterator end = G.in_neighbors_end(v);
+          for (typename Graph::const_iterator u = G.in_neighbors_begin(v);
+                  u != end; ++u)
+          {
+            const uint64_t *vu = &visit[(size_t) *u * W];
+            for (unsigned int k=0; k<W; k++)
+              nv[k] |= vu[k];
+          }
+
+          for (unsigned int k=0; k<W; k++)
+          {
+            nv[k] &= ~sv[k];
+            sv[k] |= nv[k];
+            for (uint64_t x = nv[k]; x != 0; x &= x - 1)
+              my_count[k * 64 + __builtin_ctzll(x)]++;
+            my_any |= (nv[k] != 0);
+          }
+        }
+#ifdef _OPENMP
+        #pragma omp critical
+#endif
+        {
+          for (unsigned int i=0; i<B; i++)
+            count[i] += my_count[i];
+          any |= my_any;
+        }
+      }
+      stats::edges_scanned() += G.num_edges();
+
+      if (!any)
+        break;
+      for (size_t i=0; i<num_sources; i++)
+        if (count[i] > 0)
+        {
+          hops[i].resize(depth + 1, 0);
+          hops[i][depth] = count[i];
+        }
+      visit.swap(next);
+    }
+}
+
+
+/**
+    Sampled distance statistics.  pairs[d] is the (estimated) number of
+    ordered pairs of vertices at distance d >= 1, scaled from the sample
+    to all sources (vertices with out-edges, as in sample_sources()); the errors are half-widths of 95%
+    confidence intervals, by the jackknife over the sources.
+*/
+struct distance_profile
+{
+    size_t num_sources;
+    std::vector<double> pairs;
+    double average_path_length;
+    double average_path_length_error;
+    double effective_diameter;          // see effective_diameter()
+    double effective_diameter_error;
+    size_t max_distance;                // largest distance seen (a lower
+                                        // bound on the diameter)
+};
+
+
+/**
+    Effective diameter: the (linearly interpolated) number of hops within
+    which a fraction q of the connected pairs lie; pairs[d] counts the
+    pairs at distance d (pairs[0] is ignored).
+*/
+inline double effective_diameter(const std::vector<double> &pairs,
+      double q = 0.9)
+{
+    double total = 0.0;
+    for (size_t d=1; d<pairs.size(); d++)
+      total += pairs[d];
+    if (total <= 0.0)
+      return 0.0;
+
+    const double target = q * total;
+    double within = 0.0;
+    for (size_t d=1; d<pairs.size(); d++)
+    {
+      if (within + pairs[d] >= target)
+        return (d - 1) + (target - within) / pairs[d];
+      within += pairs[d];
+    }
+    return (double) (pairs.size() - 1);
+}
+
+
+/**
+    Distance statistics from BFSs out of the given sources, run 256 at a
+    time by ms_bfs().
+
+    @param q  fraction of pairs for the effective diameter
+*/
+template <typename Graph>
+distance_profile distance_sample(const Graph &G,
+      const std::vector<typename Graph::vertex> &sources, double q = 0.9)
+{
+    const unsigned int W = 4;
+    const size_t k = sources.size();
+
+    std::vector<std::vector<size_t> > hops, batch;
+    for (size_t i=0; i<k; i += 64 * W)
+    {
+      const size_t b = std::min((size_t) 64 * W, k - i);
+      ms_bfs<W>(G, &sources[i], b, batch);
+      hops.insert(hops.end(), batch.begin(), batch.end());
+    }
+
+    distance_profile P;
+    P.num_sources = k;
+    P.max_distance = 0;
+    P.average_path_length = P.average_path_length_error = 0.0;
+    P.effective_diameter = P.effective_diameter_error = 0.0;
+    for (size_t i=0; i<k; i++)
+      P.max_distance = std::max(P.max_distance, hops[i].size() - 1);
+    if (k == 0)
+      return P;
+
+    // totals over all sources, and the sums of distances
+
+    std::vector<double> total(P.max_distance + 1, 0.0);
+    std::vector<double> source_pairs(k, 0.0), source_length(k, 0.0);
+    for (size_t i=0; i<k; i++)
+      for (size_t d=1; d<hops[i].size(); d++)
+      {
+        total[d] += hops[i][d];
+        source_pairs[i] += hops[i][d];
+        source_length[i] += (double) d * hops[i][d];
+      }
+    double all_pairs = 0.0, all_length = 0.0;
+    for (size_t i=0; i<k; i++)
+    {
+      all_pairs += source_pairs[i];
+      all_length += source_length[i];
+    }
+
+    size_t population = 0;
+    for (typename Graph::vertex v=0; v<G.num_vertices(); v++)
+      population += (G.out_degree(v) > 0);
+    const double scale = (double) population / k;
+    P.pairs.resize(total.size());
+    for (size_t d=0; d<total.size(); d++)
+      P.pairs[d] = total[d] * scale;
+    P.average_path_length = (all_pairs > 0.0 ? all_length / all_pairs : 0.0);
+    P.effective_diameter = effective_diameter(total, q);
+    if (k < 2)
+      return P;
+
+    // jackknife: the statistics with each source left out in turn
+
+    std::vector<double> apl(k), eff(k);
+    std::vector<double> rest(total.size());
+    double apl_mean = 0.0, eff_mean = 0.0;
+    for (size_t i=0; i<k; i++)
+    {
+      const double pairs = all_pairs - source_pairs[i];
+      apl[i] = (pairs > 0.0 ? (all_length - source_length[i]) / pairs : 0.0);
+      for (size_t d=0; d<rest.size(); d++)
+        rest[d] = total[d] - (d < hops[i].size() ? hops[i][d] : 0);
+      eff[i] = effective_diameter(rest, q);
+      apl_mean += apl[i];
+      eff_mean += eff[i];
+    }
+    apl_mean /= k;
+    eff_mean /= k;
+
+    double apl_var = 0.0, eff_var = 0.0;
+    for (size_t i=0; i<k; i++)
+    {
+      apl_var += (apl[i] - apl_mean) * (apl[i] - apl_mean);
+      eff_var += (eff[i] - eff_mean) * (eff[i] - eff_mean);
+    }
+    apl_var *= (double) (k - 1) / k;
+    eff_var *= (double) (k - 1) / k;
+    P.average_path_length_error = 1.96 * std::sqrt(apl_var);
+    P.effective_diameter_error = 1.96 * std::sqrt(eff_var);
+    return P;
+}
+
+
+/**
+    Up to k distinct vertices with out-edges, chosen at random (by
+    rand(); seed with srand() first).
+*/
+template <typename Graph>
+std::vector<typename Graph::vertex> sample_sources(const Graph &G, size_t k)
+{
+    typedef typename Graph::vertex T;
+    std::vector<T> V;
+    for (T v=0; v<G.num_vertices(); v++)
+      if (G.out_degree(v) > 0)
+        V.push_back(v);
+    if (k > V.size())
+      k = V.size();
+    for (size_t i=0; i<k; i++)
+    {
+      size_t r = i + (size_t) ((V.size() - i) * (rand() / (RAND_MAX + 1.0)));
+      std::swap(V[i], V[r]);
+    }
+    V.resize(k);
+    return V;
+}
+
+
+/**
+    Bounds on the diameter; exact when lower == upper.
+*/
+struct diameter_bounds
+{
+    size_t lower;
+    size_t upper;
+    unsigned int num_bfs;       // searches used
+
+    bool exact() const { return lower == upper; }
+};
+
+
+// a vertex at the largest depth of the last (depths) run of B
+//
+template <typename T, typename Graph>
+T farthest_vertex(const bfs_engine<T,Graph> &B, T n)
+{
+    const std::vector<T> &depth = B.depths();
+    T far = 0;
+    T far_depth = 0;
+    for (T v=0; v<n; v++)
+      if (depth[v] != bfs_engine<T>::unreached() && depth[v] >= far_depth)
+      {
+        far = v;
+        far_depth = depth[v];
+      }
+    return far;
+}
+
+
+/**
+    Double sweep: search from start, then from a vertex farthest from
+    it; the eccentricity of the latter is a lower bound on the diameter,
+    and twice that of start an upper bound.
+*/
+template <typename Graph>
+diameter_bounds double_sweep(const Graph &G, typename Graph::vertex start)
+{
+    typedef typename Graph::vertex T;
+    const T n = G.num_vertices();
+    bfs_engine<T,Graph> B(G);
+    diameter_bounds D;
+
+    B.run(start, bfs_depths);
+    D.upper = 2 * B.num_levels();
+    D.lower = B.num_levels();
+    B.run(farthest_vertex(B, n), 0);
+    D.lower = std::max(D.lower, (size_t) B.num_levels());
+    D.upper = std::max(D.upper, D.lower);
+    D.num_bfs = 2;
+    return D;
+}
+
+
+/**
+    Diameter by iFUB (iterative fringe upper bound).  A double sweep
+    from start picks u, the middle of a long shortest path; the search
+    from u puts every vertex at some depth i <= ecc(u).  Any two vertices
+    at depth <= i are at most 2i apart, so once the vertices at depths
+    above i are done (their eccentricities taken into the lower bound),
+    the diameter is at most max(lower, 2i).  The fringes are processed
+    from the deepest, until the bounds meet.
+
+    Few searches are needed on most real graphs; if max_bfs is reached
+    first, the bounds found so far are returned.
+*/
+template <typename Graph>
+diameter_bounds ifub_diameter(const Graph &G, typename Graph::vertex start,
+      unsigned int max_bfs = 1000)
+{
+    typedef typename Graph::vertex T;
+    const T n = G.num_vertices();
+    bfs_engine<T,Graph> B(G);
+    diameter_bounds D;
+    D.lower = D.upper = 0;
+    D.num_bfs = 0;
+    if (start >= n)
+      return D;
+
+    stats::scoped_phase phase("ifub");
+
+    // double sweep, then the middle of the path found
+
+    B.run(start, bfs_depths);
+    D.lower = B.num_levels();
+    const T a = farthest_vertex(B, n);
+    B.run(a, bfs_depths | bfs_parents);
+    D.lower = std::max(D.lower, (size_t) B.num_levels());
+    T u = farthest_vertex(B, n);
+    for (size_t s = 0; s < B.num_levels() / 2; s++)
+      u = B.parents()[u];
+
+    B.run(u, bfs_depths);
+    D.num_bfs = 3;
+    const size_t ecc = B.num_levels();
+    D.lower = std::max(D.lower, ecc);
+    D.upper = 2 * ecc;
+
+    // the fringes: vertices by depth from u
+
+    std::vector<size_t> level(ecc + 2, 0);
+    const std::vector<T> &depth = B.depths();
+    for (T v=0; v<n; v++)
+      if (depth[v] != bfs_engine<T>::unreached())
+        level[depth[v] + 1]++;
+    for (size_t i=0; i<=ecc; i++)
+      level[i+1] += level[i];
+    std::vector<T> fringe(level[ecc + 1]);
+    {
+      std::vector<size_t> pos(level.begin(), level.end() - 1);
+      for (T v=0; v<n; v++)
+        if (depth[v] != bfs_engine<T>::unreached())
+          fringe[pos[depth[v]]++] = v;
+    }
+
+    for (size_t i = ecc; i > 0 && D.upper > D.lower; i--)
+    {
+      for (size_t j = level[i]; j < level[i+1]; j++)
+      {
+        if (D.num_bfs >= max_bfs)
+          return D;
+        B.run(fringe[j], 0);
+        D.num_bfs++;
+        D.lower = std::max(D.lower, (size_t) B.num_levels());
+      }
+      D.upper = std::max(D.lower, 2 * (i - 1));
+    }
+    D.upper = std::max(D.upper, D.lower);
+    return D;
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_DISTANCE_H_
@@ -0,0 +1,275 @@
+#ifndef NGRAPH_PAGERANK_INCREMENTAL_H_
+#define NGRAPH_PAGERANK_INCREMENTAL_H_
+
+/*
+   PageRank on static (CSR) graphs that is kept up to date as the graph
+   changes, instead of being recomputed.
+
+   The scores are those of pagerank() (pagerank.hpp): the solution of
+
+        P[v] = (1 - d) + d * sum over in-neighbors u of P[u] / outdeg(u)
+
+   found here by pushing residuals (Gauss-Southwell).  Each vertex keeps
+   a score P[v] and a residual r[v], the amount by which P[v] falls
+   short of the right-hand side.  Pushing v moves r[v] into P[v] and
+   adds d * r[v] / outdeg(v) to the residual of each out-neighbor, and
+   is repeated, from a work queue, for every vertex whose residual
+   exceeds the tolerance.
+
+   After a batch of edge changes the scores and residuals are kept; only
+   the residuals of the out-neighbors (old and new) of the vertices whose
+   out-edges changed are corrected, and pushing starts from them, so the
+   work is proportional to the part of the graph the change affects.
+
+   Either way, when compute() or update() returns, every |r[v]| is at
+   most the tolerance, and the scores differ from the exact solution by
+   at most sum |r[v]| / (1 - d) in total (residual_norm()), so that an
+   update is exactly as accurate as a recompute.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include "ngraph_static.hpp"
+#include "ngraph_stats.hpp"
+
+namespace NGraph
+{
+
+template <typename T>
+class incremental_pagerank
+{
+  public:
+    typedef typename static_tGraph<T>::edge edge;
+
+  private:
+    double damping_;
+    double tolerance_;
+    std::vector<double> score_;
+    std::vector<double> residual_;
+    std::vector<char> queued_;
+    std::vector<T> queue_;
+    size_t pushes_;
+
+    void enqueue(T v)
+    {
+        if (!queued_[v] && fabs(residual_[v]) > tolerance_)
+        {
+          queued_[v] = 1;
+          queue_.push_back(v);
+        }
+    }
+
+    // new vertices start at score 0, residual 1 - d
+    void grow(T n)
+    {
+        const T old_n = score_.size();
+        if (n <= old_n)
+          return;
+        score_.resize(n, 0.0);
+        residual_.resize(n, 1.0 - damping_);
+        queued_.resize(n, 0);
+        for (T v=old_n; v<n; v++)
+          enqueue(v);
+    }
+
+    void push(const static_tGraph<T> &G)
+    {
+        stats::scoped_phase phase("pagerank");
+        pushes_ = 0;
+        size_t scanned = 0;
+        for (size_t head = 0; head < queue_.size(); head++)
+        {
+          const T u = queue_[head];
+          queued_[u] = 0;
+          const double r = residual_[u];
+          score_[u] += r;
+          residual_[u] = 0.0;
+          pushes_++;
+
+          const size_t deg = G.out_degree(u);
+          if (deg == 0)
+            continue;
+          const double share = damping_ * r / deg;
+          for (const T *w = G.out_neighbors_begin(u);
+                  w != G.out_neighbors_end(u); w++)
+          {
+            residual_[*w] += share;
+            enqueue(*w);
+          }
+          scanned += deg;
+
+          if (head > (1u << 20) && 2 * head > queue_.size())
+          {
+            queue_.erase(queue_.begin(), queue_.begin() + head + 1);
+            head = (size_t) -1;
+          }
+        }
+        queue_.clear();
+        stats::edges_scanned() += scanned;
+    }
+
+  public:
+
+    incremental_pagerank(double damping = 0.85, double tolerance = 1e-8) :
+        damping_(damping), tolerance_(tolerance), score_(), residual_(),
+        queued_(), queue_(), pushes_(0)
+    {}
+
+    double damping() const { return damping_; }
+    double tolerance() const { return tolerance_; }
+
+    /**
+        Compute the scores of G from scratch.
+
+        @return the number of pushes
+    */
+    size_t compute(const static_tGraph<T> &G)
+    {
+        score_.clear();
+        residual_.clear();
+        queued_.clear();
+        queue_.clear();
+        grow(G.num_vertices());
+        push(G);
+        return pushes_;
+    }
+
+    /**
+        Apply a batch of edge deletions, then insertions, to G (see
+        static_tGraph::update()) and bring the scores up to date.  The
+        scores must be those of G, from compute(), update() or load().
+    */
+    update_counts update(static_tGraph<T> &G,
+          const std::vector<edge> &insertions,
+          const std::vector<edge> &deletions)
+    {
+        // the vertices whose out-edges change, and their old rows
+        std::vector<T> sources;
+        for (size_t i=0; i<insertions.size(); i++)
+          sources.push_back(insertions[i].first);
+        for (size_t i=0; i<deletions.size(); i++)
+          sources.push_back(deletions[i].first);
+        std::sort(sources.begin(), sources.end());
+        sources.erase(std::unique(sources.begin(), sources.end()),
+              sources.end());
+
+        std::vector<size_t> old_rows(1, 0);
+        std::vector<T> old_edges;
+        for (size_t i=0; i<sources.size(); i++)
+        {
+          const T u = sources[i];
+          if (u < G.num_vertices())
+            old_edges.insert(old_edges.end(), G.out_neighbors_begin(u),
+                  G.out_neighbors_end(u));
+          old_rows.push_back(old_edges.size());
+        }
+
+        update_counts C = G.update(insertions, deletions);
+        grow(G.num_vertices());
+
+        // replace the old contributions of each source by the new ones
+        for (size_t i=0; i<sources.size(); i++)
+        {
+          const T u = sources[i];
+          const double p = damping_ * score_[u];
+          const size_t old_deg = old_rows[i+1] - old_rows[i];
+          const size_t new_deg = G.out_degree(u);
+          if (old_deg > 0)
+            for (size_t k = old_rows[i]; k < old_rows[i+1]; k++)
+              residual_[old_edges[k]] -= p / old_deg;
+          if (new_deg > 0)
+            for (const T *w = G.out_neighbors_begin(u);
+                    w != G.out_neighbors_end(u); w++)
+              residual_[*w] += p / new_deg;
+        }
+        for (size_t i=0; i<sources.size(); i++)
+        {
+          for (size_t k = old_rows[i]; k < old_rows[i+1]; k++)
+            enqueue(old_edges[k]);
+          for (const T *w = G.out_neighbors_begin(sources[i]);
+                  w != G.out_neighbors_end(sources[i]); w++)
+            enqueue(*w);
+        }
+        push(G);
+        return C;
+    }
+
+    /** pushes done by the last compute() or update() */
+    size_t pushes() const { return pushes_; }
+
+    const std::vector<double> &scores() const { return score_; }
+    const std::vector<double> &residuals() const { return residual_; }
+
+    /**
+        sum |r[v]|; the scores are within residual_norm() / (1 - d) of
+        the exact ones, in total
+    */
+    double residual_norm() const
+    {
+        double s = 0.0;
+        for (size_t v=0; v<residual_.size(); v++)
+          s += fabs(residual_[v]);
+        return s;
+    }
+
+    /**
+        Save the scores and residuals (in binary), to be picked up by
+        load() after the graph next changes.
+    */
+    bool save(FILE *f) const
+    {
+        const uint64_t n = score_.size();
+        bool ok = fwrite("NGPRANK1", 8, 1, f) == 1 &&
+              fwrite(&n, sizeof(n), 1, f) == 1 &&
+              fwrite(&damping_, sizeof(double), 1, f) == 1;
+        if (ok && n > 0)
+          ok = fwrite(&score_[0], sizeof(double), n, f) == n &&
+               fwrite(&residual_[0], sizeof(double), n, f) == n;
+        return ok && fflush(f) == 0;
+    }
+
+    /**
+        Load scores saved by save(); the damping factor is that of the
+        saved scores.  The tolerance is kept, and any residuals above it
+        are pushed by the next update().
+    */
+    bool load(FILE *f, std::string &error)
+    {
+        char magic[8];
+        uint64_t n = 0;
+        double damping = 0.0;
+        if (fread(magic, 8, 1, f) != 1 || memcmp(magic, "NGPRANK1", 8) != 0 ||
+            fread(&n, sizeof(n), 1, f) != 1 ||
+            fread(&damping, sizeof(double), 1, f) != 1)
+        {
+          error = "not a saved pagerank";
+          return false;
+        }
+        std::vector<double> score(n), residual(n);
+        if (n > 0 && (fread(&score[0], sizeof(double), n, f) != n ||
+              fread(&residual[0], sizeof(double), n, f) != n))
+        {
+          error = "saved pagerank is truncated";
+          return false;
+        }
+        damping_ = damping;
+        score_.swap(score);
+        residual_.swap(residual);
+        queued_.assign(n, 0);
+        queue_.clear();
+        for (T v=0; v<(T) n; v++)
+          enqueue(v);
+        return true;
+    }
+};
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_PAGERANK_INCREMENTAL_H_
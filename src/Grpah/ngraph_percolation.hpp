@@ -0,0 +1,390 @@
+#ifndef NGRAPH_PERCOLATION_H_
+#define NGRAPH_PERCOLATION_H_
+
+/*
+   Percolation averaged over many random orders (Newman & Ziff, "Fast
+   Monte Carlo algorithm for site or bond percolation", 2001).
+
+   Each trial adds the vertices (site percolation) or the edges (bond
+   percolation) of an undirected graph one at a time, in a random order,
+   and keeps the clusters with a union-find, so that a whole trial costs
+   about as much as one pass over the graph.  After every step (or at the
+   points asked for) it records
+
+        largest         size of the largest cluster, as a fraction of n
+        susceptibility  sum of s^2 over the other clusters, divided by n
+                        (the mean size of the cluster of a random vertex,
+                        the largest not counted; it peaks at the
+                        percolation threshold)
+        clusters        number of clusters (of occupied vertices, for
+                        site percolation)
+
+   and these are averaged, with their variance, over the trials.
+
+   The trials run in parallel, one per thread at a time.  Each trial has
+   its own random number generator, seeded from the seed and the trial
+   number, and starts from the same initial order, so that the results
+   depend only on the seed, and not on the number of threads (up to the
+   rounding of the sums).
+
+   g2Pmetric reports the same quantities for the one order (by degree) it
+   is given; see gpercolate for the command-line version of this one.
+*/
+
+#include <climits>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include "ngraph_static.hpp"
+#include "ngraph_stats.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+
+struct percolation_options
+{
+    unsigned int trials;            // random orders
+    uint64_t seed;
+    bool bond;                      // add edges, rather than vertices
+    size_t points;                  // steps reported (0 for every step)
+
+    percolation_options() : trials(100), seed(1), bond(false), points(0) {}
+};
+
+
+/**
+    Mean and (sample) variance over the trials of each quantity, at each
+    of the recorded steps: step[i] vertices (or edges) occupied.
+*/
+struct percolation_curve
+{
+    size_t num_vertices;
+    size_t num_steps;               // vertices or edges, in a full trial
+    unsigned int trials;
+
+    std::vector<size_t> step;
+    std::vector<double> largest_mean, largest_var;
+    std::vector<double> susceptibility_mean, susceptibility_var;
+    std::vector<double> clusters_mean, clusters_var;
+
+    percolation_curve() : num_vertices(0), num_steps(0), trials(0), step(),
+        largest_mean(), largest_var(), susceptibility_mean(),
+        susceptibility_var(), clusters_mean(), clusters_var() {}
+};
+
+
+/**
+    A small, fast generator (xorshift64*), seeded through splitmix64 so
+    that nearby seeds give unrelated sequences.
+*/
+class percolation_rng
+{
+    uint64_t x_;
+
+  public:
+    static uint64_t mix(uint64_t z)
+    {
+        z += 0x9E3779B97F4A7C15UL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9UL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBUL;
+        return z ^ (z >> 31);
+    }
+
+    explicit percolation_rng(uint64_t seed = 1) : x_(mix(seed) | 1) {}
+
+    uint64_t next()
+    {
+        x_ ^= x_ >> 12;
+        x_ ^= x_ << 25;
+        x_ ^= x_ >> 27;
+        return x_ * 0x2545F4914F6CDD1DUL;
+    }
+
+    /** uniform in 0 .. n-1 */
+    size_t below(size_t n)
+    {
+        return (size_t) ((next() >> 11) * (1.0 / 9007199254740992.0) * n);
+    }
+};
+
+
+/**
+    The steps at which a curve of num_steps steps is recorded: every one
+    (0 .. num_steps) if points is 0, or else about points of them, evenly
+    spaced, always including the first and last.
+*/
+inline std::vector<size_t> percolation_steps(size_t num_steps, size_t points)
+{
+    std::vector<size_t> s;
+    if (points == 0 || points >= num_steps)
+    {
+      for (size_t k=0; k<=num_steps; k++)
+        s.push_back(k);
+      return s;
+    }
+    for (size_t j=0; j<=points; j++)
+    {
+      const size_t k = (size_t) ((double) j * num_steps / points + 0.5);
+      if (s.empty() || k != s.back())
+        s.push_back(k);
+    }
+    return s;
+}
+
+
+/**
+    One thread's union-find and running sums.  parent_[v] is the parent
+    of v, or -(size) for a root, or unoccupied() for a vertex not yet
+    added (site percolation).
+*/
+template <typename T>
+class percolation_engine
+{
+  public:
+    typedef std::pair<T,T> edge;
+
+  private:
+    const static_tGraph<T> &U_;
+    const std::vector<T> &vertices_;
+    const std::vector<edge> &edges_;
+    const std::vector<size_t> &steps_;
+    const double n_;
+
+    std::vector<long> parent_;
+    std::vector<T> vertex_order_;
+    std::vector<size_t> edge_order_;
+
+    size_t clusters_;
+    size_t largest_;
+    uint64_t sum_squares_;          // of the cluster sizes
+    size_t scanned_;
+
+    static long unoccupied() { return LONG_MIN; }
+
+    T find(T v)
+    {
+        // path halving
+        while (parent_[v] >= 0 && parent_[parent_[v]] >= 0)
+        {
+          parent_[v] = parent_[parent_[v]];
+          v = (T) parent_[v];
+        }
+        return (parent_[v] >= 0 ? (T) parent_[v] : v);
+    }
+
+    void join(T a, T b)
+    {
+        T ra = find(a);
+        T rb = find(b);
+        if (ra == rb)
+          return;
+        if (parent_[ra] < parent_[rb])        // ra the smaller
+          std::swap(ra, rb);
+        const uint64_t sa = -parent_[ra];
+        const uint64_t sb = -parent_[rb];
+        parent_[rb] -= sa;
+        parent_[ra] = rb;
+        sum_squares_ += 2 * sa * sb;
+        clusters_--;
+        if (sa + sb > largest_)
+          largest_ = sa + sb;
+    }
+
+    void record(size_t i, std::vector<double> &sum, std::vector<double> &sq)
+    {
+        const double x[3] = { largest_ / n_,
+              (double) (sum_squares_ - (uint64_t) largest_ * largest_) / n_,
+              (double) clusters_ };
+        for (int q=0; q<3; q++)
+        {
+          sum[3*i+q] += x[q];
+          sq[3*i+q] += x[q] * x[q];
+        }
+    }
+
+  public:
+
+    percolation_engine(const static_tGraph<T> &U,
+          const std::vector<T> &vertices, const std::vector<edge> &edges,
+          const std::vector<size_t> &steps) :
+        U_(U), vertices_(vertices), edges_(edges), steps_(steps),
+        n_(vertices.empty() ? 1.0 : (double) vertices.size()),
+        parent_(U.num_vertices(), unoccupied()), vertex_order_(),
+        edge_order_(), clusters_(0), largest_(0), sum_squares_(0),
+        scanned_(0) {}
+
+    size_t edges_scanned() const { return scanned_; }
+
+    /**
+        One trial of site percolation, added to sum (and sq, the sums of
+        squares): three entries (largest, susceptibility, clusters) per
+        recorded step.
+    */
+    void site_trial(percolation_rng &R, std::vector<double> &sum,
+          std::vector<double> &sq)
+    {
+        const size_t n = vertices_.size();
+        vertex_order_.assign(vertices_.begin(), vertices_.end());
+        for (size_t i=0; i<n; i++)
+          parent_[vertices_[i]] = unoccupied();
+        clusters_ = 0;
+        largest_ = 0;
+        sum_squares_ = 0;
+
+        size_t next = 0;
+        if (next < steps_.size() && steps_[next] == 0)
+          record(next++, sum, sq);
+        for (size_t i=0; i<n; i++)
+        {
+          // Fisher-Yates, one step at a time
+          std::swap(vertex_order_[i], vertex_order_[i + R.below(n - i)]);
+          const T v = vertex_order_[i];
+          parent_[v] = -1;
+          clusters_++;
+          sum_squares_++;
+          if (largest_ == 0)
+            largest_ = 1;
+
+          for (typename static_tGraph<T>::const_iterator
+                p = U_.out_neighbors_begin(v); p < U_.out_neighbors_end(v); p++)
+            if (parent_[*p] != unoccupied())
+              join(v, *p);
+          scanned_ += U_.out_degree(v);
+
+          if (next < steps_.size() && steps_[next] == i+1)
+            record(next++, sum, sq);
+        }
+    }
+
+    /** One trial of bond percolation (see site_trial()). */
+    void bond_trial(percolation_rng &R, std::vector<double> &sum,
+          std::vector<double> &sq)
+    {
+        const size_t m = edges_.size();
+        edge_order_.resize(m);
+        for (size_t k=0; k<m; k++)
+          edge_order_[k] = k;
+        for (size_t i=0; i<vertices_.size(); i++)
+          parent_[vertices_[i]] = -1;
+        clusters_ = vertices_.size();
+        largest_ = (clusters_ > 0 ? 1 : 0);
+        sum_squares_ = clusters_;
+
+        size_t next = 0;
+        if (next < steps_.size() && steps_[next] == 0)
+          record(next++, sum, sq);
+        for (size_t i=0; i<m; i++)
+        {
+          std::swap(edge_order_[i], edge_order_[i + R.below(m - i)]);
+          const edge &e = edges_[edge_order_[i]];
+          join(e.first, e.second);
+          if (next < steps_.size() && steps_[next] == i+1)
+            record(next++, sum, sq);
+        }
+        scanned_ += m;
+    }
+};
+
+
+/**
+    Percolation on U, an undirected graph as from undirected_graph()
+    (every edge in both directions), over opt.trials random orders of its
+    vertices (or, with opt.bond, its edges).  If present is given, only
+    the vertices v with present[v] set are part of the graph (the others
+    are gaps in the numbering, see read_static_graph()).
+*/
+template <typename T>
+void percolation(const static_tGraph<T> &U, const std::vector<char> *present,
+      const percolation_options &opt, percolation_curve &curve)
+{
+    typedef typename percolation_engine<T>::edge edge;
+
+    stats::scoped_phase phase("percolation");
+
+    const T n = U.num_vertices();
+    std::vector<T> vertices;
+    for (T v=0; v<n; v++)
+      if (present == 0 || v >= present->size() || (*present)[v])
+        vertices.push_back(v);
+
+    std::vector<edge> edges;
+    if (opt.bond)
+    {
+      edges.reserve(U.num_edges() / 2);
+      for (T v=0; v<n; v++)
+        for (typename static_tGraph<T>::const_iterator
+              p = U.out_neighbors_begin(v); p < U.out_neighbors_end(v); p++)
+          if (v < *p)
+            edges.push_back(edge(v, *p));
+    }
+
+    curve = percolation_curve();
+    curve.num_vertices = vertices.size();
+    curve.num_steps = (opt.bond ? edges.size() : vertices.size());
+    curve.trials = opt.trials;
+    curve.step = percolation_steps(curve.num_steps, opt.points);
+
+    const size_t num_points = curve.step.size();
+    std::vector<double> sum(3 * num_points, 0.0);
+    std::vector<double> sq(3 * num_points, 0.0);
+
+    #ifdef _OPENMP
+    #pragma omp parallel
+    #endif
+    {
+      percolation_engine<T> E(U, vertices, edges, curve.step);
+      std::vector<double> my_sum(3 * num_points, 0.0);
+      std::vector<double> my_sq(3 * num_points, 0.0);
+
+      #ifdef _OPENMP
+      #pragma omp for schedule(dynamic, 1)
+      #endif
+      for (long t=0; t<(long) opt.trials; t++)
+      {
+        percolation_rng R(percolation_rng::mix(opt.seed) + (uint64_t) t);
+        if (opt.bond)
+          E.bond_trial(R, my_sum, my_sq);
+        else
+          E.site_trial(R, my_sum, my_sq);
+      }
+      stats::edges_scanned() += E.edges_scanned();
+
+      #ifdef _OPENMP
+      #pragma omp critical (percolation_sums)
+      #endif
+      for (size_t i=0; i<sum.size(); i++)
+      {
+        sum[i] += my_sum[i];
+        sq[i] += my_sq[i];
+      }
+    }
+
+    std::vector<double> *mean[3] = { &curve.largest_mean,
+          &curve.susceptibility_mean, &curve.clusters_mean };
+    std::vector<double> *var[3] = { &curve.largest_var,
+          &curve.susceptibility_var, &curve.clusters_var };
+    const double k = (opt.trials > 0 ? opt.trials : 1);
+    for (int q=0; q<3; q++)
+    {
+      mean[q]->resize(num_points);
+      var[q]->resize(num_points);
+      for (size_t i=0; i<num_points; i++)
+      {
+        const double m = sum[3*i+q] / k;
+        const double v = (opt.trials > 1 ?
+              (sq[3*i+q] - k * m * m) / (k - 1) : 0.0);
+        (*mean[q])[i] = m;
+        (*var[q])[i] = (v > 0.0 ? v : 0.0);
+      }
+    }
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_PERCOLATION_H_
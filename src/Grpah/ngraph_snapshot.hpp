@@ -0,0 +1,439 @@
+#ifndef NGRAPH_SNAPSHOT_H_
+#define NGRAPH_SNAPSHOT_H_
+
+/*
+   Graphs with cheap snapshots, for "what if" analyses that change a
+   graph many different ways (remove these vertices, re-measure; try
+   the next set ...).
+
+   A snapshot_graph keeps the neighbor lists of each block of 64
+   vertices together, in a three-level tree
+
+        root  ->  directories (64 blocks each)  ->  blocks (64 vertices)
+
+   whose nodes are shared between copies and reference counted.  Copying
+   a snapshot_graph (or calling snapshot()) shares the root, so it takes
+   O(1) time and memory.  A change to a vertex first copies whatever it
+   shares along the path to that vertex's block (the root's directory
+   list, one directory, one block), so that a snapshot costs only the
+   blocks it has changed.
+
+   Reference counts are updated atomically, so snapshots sharing blocks
+   may be used, and changed, by different threads; a single snapshot
+   must not be used by two threads at once if either changes it.
+
+   Vertices are unsigned integers.  Neighbor lists are sorted vectors.
+*/
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include "ngraph.hpp"
+#include "ngraph_static.hpp"
+
+namespace NGraph
+{
+
+template <typename T>
+class snapshot_graph
+{
+  public:
+
+    typedef T vertex;
+    typedef std::pair<vertex,vertex> edge;
+    typedef std::vector<T> neighbor_list;
+
+  private:
+
+    enum { block_bits = 6, block_size = 1 << block_bits,
+           dir_bits = 6, dir_size = 1 << dir_bits };
+
+    struct block
+    {
+        int refs;
+        uint64_t present;
+        neighbor_list out[block_size];
+        neighbor_list in[block_size];
+
+        block() : refs(1), present(0) {}
+        block(const block &b) : refs(1), present(b.present)
+        {
+            for (int i=0; i<block_size; i++)
+            {
+              out[i] = b.out[i];
+              in[i] = b.in[i];
+            }
+        }
+    };
+
+    struct directory
+    {
+        int refs;
+        block *blocks[dir_size];
+
+        directory() : refs(1)
+        {
+            for (int i=0; i<dir_size; i++)
+              blocks[i] = 0;
+        }
+        directory(const directory &d) : refs(1)
+        {
+            for (int i=0; i<dir_size; i++)
+              acquire(blocks[i] = d.blocks[i]);
+        }
+        ~directory()
+        {
+            for (int i=0; i<dir_size; i++)
+              if (release(blocks[i]))
+                delete blocks[i];
+        }
+    };
+
+    struct root
+    {
+        int refs;
+        std::vector<directory *> dirs;
+
+        root() : refs(1), dirs() {}
+        root(const root &r) : refs(1), dirs(r.dirs)
+        {
+            for (size_t i=0; i<dirs.size(); i++)
+              acquire(dirs[i]);
+        }
+        ~root()
+        {
+            for (size_t i=0; i<dirs.size(); i++)
+              if (release(dirs[i]))
+                delete dirs[i];
+        }
+    };
+
+    template <class Node>
+    static void acquire(Node *p)
+    {
+        if (p)
+          __sync_fetch_and_add(&p->refs, 1);
+    }
+
+    // true if p is to be deleted
+    template <class Node>
+    static bool release(Node *p)
+    {
+        return p && __sync_sub_and_fetch(&p->refs, 1) == 0;
+    }
+
+    // make p (shared) this graph's own
+    template <class Node>
+    static void unshare(Node *&p)
+    {
+        if (p == 0)
+          p = new Node;
+        else if (p->refs > 1)
+        {
+          Node *q = new Node(*p);
+          if (release(p))
+            delete p;               // the other owner let go meanwhile
+          p = q;
+        }
+    }
+
+    root *root_;
+    size_t num_vertices_;
+    size_t num_edges_;
+
+    static const neighbor_list &empty_list()
+    {
+        static const neighbor_list empty;
+        return empty;
+    }
+
+    const block *find_block(T v) const
+    {
+        const size_t d = (size_t) v >> (block_bits + dir_bits);
+        if (root_ == 0 || d >= root_->dirs.size() || root_->dirs[d] == 0)
+          return 0;
+        return root_->dirs[d]->blocks[(v >> block_bits) & (dir_size - 1)];
+    }
+
+    block &writable_block(T v)
+    {
+        const size_t d = (size_t) v >> (block_bits + dir_bits);
+        unshare(root_);
+        if (d >= root_->dirs.size())
+          root_->dirs.resize(d + 1, (directory *) 0);
+        unshare(root_->dirs[d]);
+        block *&b = root_->dirs[d]->blocks[(v >> block_bits) & (dir_size - 1)];
+        unshare(b);
+        return *b;
+    }
+
+    static bool sorted_insert(neighbor_list &L, T x)
+    {
+        typename neighbor_list::iterator p = std::lower_bound(L.begin(),
+              L.end(), x);
+        if (p != L.end() && *p == x)
+          return false;
+        L.insert(p, x);
+        return true;
+    }
+
+    static bool sorted_erase(neighbor_list &L, T x)
+    {
+        typename neighbor_list::iterator p = std::lower_bound(L.begin(),
+              L.end(), x);
+        if (p == L.end() || *p != x)
+          return false;
+        L.erase(p);
+        return true;
+    }
+
+  public:
+
+    snapshot_graph() : root_(0), num_vertices_(0), num_edges_(0) {}
+
+    /**
+        From a static graph; if present is given, only the vertices v
+        with present[v] set (and the endpoints of edges) are vertices of
+        the graph, otherwise all of 0 .. num_vertices()-1 are.
+    */
+    explicit snapshot_graph(const static_tGraph<T> &G,
+          const std::vector<char> *present = 0) : root_(0), num_vertices_(0),
+        num_edges_(G.num_edges())
+    {
+        for (T v=0; v<G.num_vertices(); v++)
+        {
+          if (G.isolated(v) && present != 0 && !(*present)[v])
+            continue;
+          block &b = writable_block(v);
+          const unsigned int i = v & (block_size - 1);
+          b.present |= (uint64_t) 1 << i;
+          b.out[i].assign(G.out_neighbors_begin(v), G.out_neighbors_end(v));
+          b.in[i].assign(G.in_neighbors_begin(v), G.in_neighbors_end(v));
+          num_vertices_++;
+        }
+    }
+
+    snapshot_graph(const snapshot_graph &S) : root_(S.root_),
+        num_vertices_(S.num_vertices_), num_edges_(S.num_edges_)
+    {
+        acquire(root_);
+    }
+
+    snapshot_graph &operator=(const snapshot_graph &S)
+    {
+        acquire(S.root_);
+        if (release(root_))
+          delete root_;
+        root_ = S.root_;
+        num_vertices_ = S.num_vertices_;
+        num_edges_ = S.num_edges_;
+        return *this;
+    }
+
+    ~snapshot_graph()
+    {
+        if (release(root_))
+          delete root_;
+    }
+
+    /**
+        An O(1) copy, sharing all blocks until either graph changes.
+    */
+    snapshot_graph snapshot() const { return *this; }
+
+    size_t num_vertices() const { return num_vertices_; }
+    size_t num_edges() const { return num_edges_; }
+
+    /** one more than the largest vertex number the graph has room for */
+    size_t vertex_range() const
+    {
+        return (root_ == 0 ? 0 :
+            root_->dirs.size() << (block_bits + dir_bits));
+    }
+
+    bool includes_vertex(T v) const
+    {
+        const block *b = find_block(v);
+        return b && ((b->present >> (v & (block_size - 1))) & 1);
+    }
+
+    const neighbor_list &out_neighbors(T v) const
+    {
+        const block *b = find_block(v);
+        return (b ? b->out[v & (block_size - 1)] : empty_list());
+    }
+
+    const neighbor_list &in_neighbors(T v) const
+    {
+        const block *b = find_block(v);
+        return (b ? b->in[v & (block_size - 1)] : empty_list());
+    }
+
+    size_t out_degree(T v) const { return out_neighbors(v).size(); }
+    size_t in_degree(T v) const { return in_neighbors(v).size(); }
+
+    bool includes_edge(T a, T b) const
+    {
+        const neighbor_list &L = out_neighbors(a);
+        return std::binary_search(L.begin(), L.end(), b);
+    }
+
+    void insert_vertex(T v)
+    {
+        if (includes_vertex(v))
+          return;
+        writable_block(v).present |= (uint64_t) 1 << (v & (block_size - 1));
+        num_vertices_++;
+    }
+
+    void insert_edge(T a, T b)
+    {
+        insert_vertex(a);
+        insert_vertex(b);
+        if (includes_edge(a, b))
+          return;
+        sorted_insert(writable_block(a).out[a & (block_size - 1)], b);
+        sorted_insert(writable_block(b).in[b & (block_size - 1)], a);
+        num_edges_++;
+    }
+
+    void remove_edge(T a, T b)
+    {
+        if (!includes_edge(a, b))
+          return;
+        sorted_erase(writable_block(a).out[a & (block_size - 1)], b);
+        sorted_erase(writable_block(b).in[b & (block_size - 1)], a);
+        num_edges_--;
+    }
+
+    /**
+        Remove v and its edges; this copies the blocks of v and of its
+        neighbors, if shared.
+    */
+    void remove_vertex(T v)
+    {
+        if (!includes_vertex(v))
+          return;
+        const neighbor_list out = out_neighbors(v);
+        const neighbor_list in = in_neighbors(v);
+        for (size_t i=0; i<out.size(); i++)
+          if (out[i] != v)
+            sorted_erase(writable_block(out[i]).in[out[i] & (block_size - 1)], v);
+        for (size_t i=0; i<in.size(); i++)
+          if (in[i] != v)
+            sorted_erase(writable_block(in[i]).out[in[i] & (block_size - 1)], v);
+
+        block &b = writable_block(v);
+        const unsigned int i = v & (block_size - 1);
+        num_edges_ -= out.size() + in.size();
+        if (std::binary_search(out.begin(), out.end(), v))
+          num_edges_++;             // the self-loop was counted twice
+        neighbor_list().swap(b.out[i]);
+        neighbor_list().swap(b.in[i]);
+        b.present &= ~((uint64_t) 1 << i);
+        num_vertices_--;
+    }
+
+    template <class Iterator>
+    void remove_vertices(Iterator begin, Iterator end)
+    {
+        for (; begin != end; begin++)
+          remove_vertex(*begin);
+    }
+
+    /**
+        Blocks (of 64 vertices) this graph shares with other snapshots,
+        and all blocks it refers to.
+    */
+    void block_counts(size_t &shared, size_t &total) const
+    {
+        shared = total = 0;
+        if (root_ == 0)
+          return;
+        for (size_t d=0; d<root_->dirs.size(); d++)
+        {
+          const directory *dir = root_->dirs[d];
+          if (dir == 0)
+            continue;
+          for (int k=0; k<dir_size; k++)
+            if (dir->blocks[k])
+            {
+              total++;
+              if (root_->refs > 1 || dir->refs > 1 || dir->blocks[k]->refs > 1)
+                shared++;
+            }
+        }
+    }
+};
+
+
+/**
+    Weakly connected components of a snapshot_graph, by union-find over
+    its edges: the number of components and their sizes (min, mean,
+    max) over the vertices of the graph.
+*/
+struct component_summary
+{
+    size_t num_components;
+    size_t min;
+    size_t max;
+    double mean;
+};
+
+
+template <typename T>
+component_summary component_sizes(const snapshot_graph<T> &G)
+{
+    const size_t n = G.vertex_range();
+    std::vector<T> parent(n);
+    for (size_t v=0; v<n; v++)
+      parent[v] = (T) v;
+
+    for (size_t v=0; v<n; v++)
+    {
+      const typename snapshot_graph<T>::neighbor_list &out =
+            G.out_neighbors((T) v);
+      for (size_t i=0; i<out.size(); i++)
+      {
+        T a = (T) v, b = out[i];
+        while (parent[a] != a)
+          a = parent[a] = parent[parent[a]];
+        while (parent[b] != b)
+          b = parent[b] = parent[parent[b]];
+        if (a != b)
+          parent[std::max(a, b)] = std::min(a, b);
+      }
+    }
+
+    std::vector<size_t> size(n, 0);
+    for (size_t v=0; v<n; v++)
+      if (G.includes_vertex((T) v))
+      {
+        T r = (T) v;
+        while (parent[r] != r)
+          r = parent[r];
+        size[r]++;
+      }
+
+    component_summary C;
+    C.num_components = C.max = 0;
+    C.min = 0;
+    C.mean = 0.0;
+    for (size_t v=0; v<n; v++)
+      if (size[v] > 0)
+      {
+        if (C.num_components == 0 || size[v] < C.min)
+          C.min = size[v];
+        C.max = std::max(C.max, size[v]);
+        C.num_components++;
+      }
+    if (C.num_components > 0)
+      C.mean = (double) G.num_vertices() / C.num_components;
+    return C;
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_SNAPSHOT_H_
@@ -19,25 +19,25 @@
 
 
 
+#ifndef NGRAPH_STATIC_H_
+#define NGRAPH_STATIC_H_
 
 
-#ifndef NGRAPH_H_
-#define NGRAPH_H_
-
-
-// DIRECTED GRAPH (with in-out adjacency list)
+// STATIC DIRECTED GRAPH (compressed sparse row, with in-out adjacency)
 //
 
-#include <iostream>
-#include <set>
-#include <map>
-#include <utility>      // for std::pair
-#include <iterator>     // for inserter()
-#include <vector>       // for exporting edge_list
+#include <cstdio>
+#include <cstring>
 #include <string>
-#include <sstream>      // for I/O << and >> operators
-#include "set_ops.hpp"
-#include "ngraph_version.h"
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdint.h>
+#include "ngraph.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 //
@@ -48,787 +48,610 @@
 // a more general tGraph, which allows for insertion and removal nodes.
 //
 // Given a general Graph G, this class creates a compact represenation
-// using a linear array (much like a compressed sparse row matrix), rather 
+// using a linear array (much like a compressed sparse row matrix), rather
 // than a std::set for faster access.
 //
-// The node types may be an integer type (or least an ordered type) and
-// is typically an unsinged int.  In fact, static_Graph is a shorthand
-// for static_tGraph<unsigned int>.
+// The node types must be an unsigned integer type, and vertices are
+// numbered 0..num_vertices()-1; ids missing from the source graph become
+// isolated vertices.  static_Graph is a shorthand for
+// static_tGraph<unsigned int>.
 //
+// The out-neighbors of each vertex are sorted.  Parallel edges are kept
+// if the edge list they were built from contains them (a tGraph never
+// does).
 //
 
-
-
-*/
 namespace NGraph
 {
 
-template <typename T>
-class static_tGraph
-{
-
-    
-  private:
-
-    vector<T> in_edges_rows_;  // size num_nodes+1
-    vector<T> in_edges_;  // size num_edges+1
-    vector<T> out_edges_rows_;  // size num_nodes+1
-    vector<T> out_edges_;  // size num_edges+1
-
-  public:
-
-    typedef T vertex;
-    typedef T value_type;
-    typedef std::pair<vertex,vertex> edge;
-
-    typedef typename vector<T>::const_iterator const_iterator;
-    const_iterator in_edges_begin(unsigned int i) const { return &nodes_[i]; }
-    const_iterator in_edges_end(unsigned int i) const { return &nodes_[i+1]; }
-
-
-    unsinged int in_degree(unsigned int i) const { return in_edges_rows_[i+1] - in_edges_rows_[i]; }
-    unsinged int degree(unsigned int i) const { return nodes_[i+1] - nodes_[i]; }
-
-
-    unsigned int num_edges() const { return edges_.size() + out_edges_.size() ; }
-    unsigned int num_vertices() const { return nodes_.size(); }
-
+/**
+    Build compressed sparse row arrays from a coordinate (edge) list.
 
+    On return, the targets of row i are targets[offsets[i]..offsets[i+1]),
+    sorted.  If perm is not 0, (*perm)[k] is the index in (from, to) of
+    the edge stored at targets[k], so that edge values can be permuted
+    into the same order.
 
+    Rows are filled in parallel (with OpenMP), and then sorted
+    independently.
+*/
+template <typename T>
+void build_csr(size_t num_rows, const std::vector<T> &from,
+      const std::vector<T> &to, std::vector<size_t> &offsets,
+      std::vector<T> &targets, std::vector<size_t> *perm = 0)
+{
+    const long m = from.size();
 
+    offsets.assign(num_rows + 1, 0);
+    targets.resize(m);
+    if (perm)
+      perm->resize(m);
 
-typedef typename adj_graph::iterator iterator;
-    typedef typename adj_graph::const_iterator const_iterator;
+#ifdef _OPENMP
+    #pragma omp parallel for
+#endif
+    for (long k=0; k<m; k++)
+      __sync_fetch_and_add(&offsets[from[k] + 1], 1);
 
-    typedef iterator node_iterator;
-    typedef const_iterator const_node_iterator;
+    for (size_t i=0; i<num_rows; i++)
+      offsets[i+1] += offsets[i];
 
-    unsigned int num_vertices() const { return G_.size(); }
-    unsigned int num_nodes() const { return G_.size(); }
-    unsigned int num_edges() const { return num_edges_; }
+    std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
 
-    iterator begin() { return G_.begin(); }
-    const_iterator begin() const { return G_.begin(); }
-    iterator end() { return G_.end(); }
-    const_iterator end() const { return G_.end(); }
-    
-    
-    tGraph(): G_(), num_edges_(0){};
-    tGraph(const tGraph &B) : G_(B.G_), num_edges_(B.num_edges_){}
-    tGraph(const edge_set &E)
+#ifdef _OPENMP
+    #pragma omp parallel for
+#endif
+    for (long k=0; k<m; k++)
     {
-      for (typename edge_set::const_iterator p = E.begin(); p != E.end(); p++)
-        insert_edge(*p);
+      size_t pos = __sync_fetch_and_add(&cursor[from[k]], 1);
+      targets[pos] = to[k];
+      if (perm)
+        (*perm)[pos] = k;
     }
+    std::vector<size_t>().swap(cursor);
 
+    // sort each row; the (target, index) pairs keep the permutation
+    // deterministic
+    const long n = num_rows;
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+      std::vector<std::pair<T, size_t> > row;
+#ifdef _OPENMP
+      #pragma omp for schedule(dynamic, 1024)
+#endif
+      for (long i=0; i<n; i++)
+      {
+        const size_t b = offsets[i];
+        const size_t e = offsets[i+1];
+        if (perm == 0)
+        {
+          std::sort(targets.begin() + b, targets.begin() + e);
+          continue;
+        }
+        row.clear();
+        for (size_t k=b; k<e; k++)
+          row.push_back(std::make_pair(targets[k], (*perm)[k]));
+        std::sort(row.begin(), row.end());
+        for (size_t k=b; k<e; k++)
+        {
+          targets[k] = row[k-b].first;
+          (*perm)[k] = row[k-b].second;
+        }
+      }
+    }
+}
 
 
+/*
+   Binary CSR file (.csr) layout, in host byte order:
+
+        char     magic[8]         "NGCSR01\0"
+        uint32   vertex_bytes     sizeof(T)
+        uint32   flags            csr_has_values, csr_has_imag_values
+        uint64   num_vertices
+        uint64   num_edges
+        uint64   offsets[num_vertices+1]
+        T        targets[num_edges]
+        double   values[num_edges]          (if csr_has_values)
+        double   imag_values[num_edges]     (if csr_has_imag_values)
+
+   Only out-edges are stored; in-edges are rebuilt on loading.
+*/
 
-     iterator find(const vertex &a)
-     {
-        return G_.find(a);
-     }
-
-     const_iterator find(const vertex  &a) const
-     {
-        return G_.find(a);
-     }
-
-    const vertex_set &in_neighbors(const vertex &a) const
-              { return (find(a))->second.first;}
-          vertex_set &in_neighbors(const vertex &a)      
-              { return (G_[a]).first; }
+const char csr_magic[8] = { 'N', 'G', 'C', 'S', 'R', '0', '1', 0 };
+const unsigned int csr_has_values = 1;
+const unsigned int csr_has_imag_values = 2;
 
-    const vertex_set &out_neighbors(const vertex &a)const
-                {return find(a)->second.second;}
-          vertex_set &out_neighbors(const vertex &a)      
-                {return G_[a].second; }
+struct csr_file_header
+{
+    char magic[8];
+    uint32_t vertex_bytes;
+    uint32_t flags;
+    uint64_t num_vertices;
+    uint64_t num_edges;
+};
 
 
-     unsigned int in_degree(const vertex &a) const
-     {
-        return in_neighbors(a).size();
-     }
+/**
+    Write CSR arrays (and optional edge values) as a binary .csr file.
 
-     unsigned int out_degree(const vertex &a) const
-     {
-        return out_neighbors(a).size();
-     }
+    @return true on success
+*/
+template <typename T>
+bool write_csr_file(FILE *f, size_t num_vertices,
+      const std::vector<size_t> &offsets, const std::vector<T> &targets,
+      const std::vector<double> *values = 0,
+      const std::vector<double> *imag_values = 0)
+{
+    csr_file_header h;
+    memcpy(h.magic, csr_magic, sizeof(h.magic));
+    h.vertex_bytes = sizeof(T);
+    h.flags = (values && !values->empty() ? csr_has_values : 0) |
+          (imag_values && !imag_values->empty() ? csr_has_imag_values : 0);
+    h.num_vertices = num_vertices;
+    h.num_edges = targets.size();
+
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    for (size_t i=0; i<=num_vertices && ok; i++)
+    {
+      uint64_t o = offsets[i];
+      ok = fwrite(&o, sizeof(o), 1, f) == 1;
+    }
+    if (ok && !targets.empty())
+      ok = fwrite(&targets[0], sizeof(T), targets.size(), f) == targets.size();
+    if (ok && (h.flags & csr_has_values))
+      ok = fwrite(&(*values)[0], sizeof(double), values->size(), f)
+              == values->size();
+    if (ok && (h.flags & csr_has_imag_values))
+      ok = fwrite(&(*imag_values)[0], sizeof(double), imag_values->size(), f)
+              == imag_values->size();
+    return ok && fflush(f) == 0;
+}
 
-     unsigned int degree(const vertex &a) const
-     {
-        return out_neighbors(a).size();
-     }
 
-    bool isolated(const vertex &a) const
-    {
-        const_iterator p = find(a);
-        if ( p != end() )
-          return (  (out_degree(p) == 0) && (in_degree(p) == 0));
-        else
-            return false;
-    }
+/**
+    Read a binary .csr file.  Edge values are read only if values (or
+    imag_values) is not 0, and are otherwise skipped.
 
-    void insert_vertex(const vertex &a)
+    @return true on success; otherwise error describes the problem.
+*/
+template <typename T>
+bool read_csr_file(FILE *f, size_t &num_vertices, std::vector<size_t> &offsets,
+      std::vector<T> &targets, std::string &error,
+      std::vector<double> *values = 0, std::vector<double> *imag_values = 0)
+{
+    csr_file_header h;
+    if (fread(&h, sizeof(h), 1, f) != 1 ||
+          memcmp(h.magic, csr_magic, sizeof(h.magic)) != 0)
     {
-      G_[a];
+      error = "not a CSR file";
+      return false;
     }
-
-    void insert_new_vertex_inout_list(const vertex &a, const vertex_set &IN,
-              const vertex_set &OUT)
+    if (h.vertex_bytes != sizeof(T))
     {
-      typename adj_graph::iterator p = find(a);
-
-      // exit if "a" already in graph
-      if (p != G_.end())
-      {
-            // remove the old number of OUT vertices
-            num_edges_ -= p->second.second.size();
-      }
-
-      G_[a] = make_pair(IN, OUT);
-      num_edges_ += OUT.size();
+      error = "CSR file has a different vertex size";
+      return false;
     }
 
+    num_vertices = h.num_vertices;
+    offsets.resize(num_vertices + 1);
+    targets.resize(h.num_edges);
 
-
-    void insert_edge_noloop(iterator pa, iterator pb)
+    bool ok = true;
+    for (size_t i=0; i<=num_vertices && ok; i++)
     {
-      if (pa==pb) return;
-      insert_edge(pa, pb);
+      uint64_t o = 0;
+      ok = fread(&o, sizeof(o), 1, f) == 1;
+      offsets[i] = o;
     }
+    if (ok && h.num_edges > 0)
+      ok = fread(&targets[0], sizeof(T), h.num_edges, f) == h.num_edges;
 
-    void insert_edge(iterator pa, iterator pb)
+    std::vector<double> skip;
+    std::vector<double> *v[2] = { values, imag_values };
+    const unsigned int flag[2] = { csr_has_values, csr_has_imag_values };
+    for (unsigned int j=0; j<2 && ok; j++)
     {
-      vertex a = node(pa);
-      vertex b = node(pb);
-
-      unsigned int old_size = out_neighbors(pa).size();
-
-      out_neighbors(pa).insert(b);
-      in_neighbors(pb).insert(a);
-
-      unsigned int new_size = out_neighbors(a).size();
-      if (new_size > old_size)
+      if (!(h.flags & flag[j]))
       {
-          num_edges_++;
+        if (v[j])
+          v[j]->clear();
+        continue;
       }
-
+      std::vector<double> &dst = (v[j] ? *v[j] : skip);
+      dst.resize(h.num_edges);
+      if (h.num_edges > 0)
+        ok = fread(&dst[0], sizeof(double), h.num_edges, f) == h.num_edges;
     }
 
-    void insert_edge_noloop(const vertex &a, const vertex &b)
+    if (!ok || offsets[num_vertices] != h.num_edges)
     {
-      if (a==b) return;
-      insert_edge(a, b);
-    }
-
-
-    void insert_edge(const vertex &a, const vertex& b)
-    {
-      iterator pa = find(a);
-      if (pa == G_.end())
-      {
-          insert_vertex(a);
-          pa = find(a);
-      }
-
-      iterator pb = find(b);
-      if (pb == G_.end())
-      {
-          insert_vertex(b);
-          pb = find(b);
-      }
-      
-      insert_edge( pa, pb );
+      error = "CSR file is truncated or corrupt";
+      return false;
     }
-
-   void insert_undirected_edge(const vertex &a, const vertex &b)
-   {
-      (a < b ) ?  insert_edge(a,b) : insert_edge(b,a);
-   }
+    return true;
+}
 
 
-    void insert_edge(const edge &E)
-    {
-        insert_edge(E.first, E.second);
-    }
-
-    void insert_undirected_edge(const edge &E)
-    {
-      insert_undirected_edge(E.first, E.second);
-    }
+template <typename T>
+class static_tGraph
+{
+  public:
 
-   
+    typedef T vertex;
+    typedef T value_type;
+    typedef std::pair<vertex,vertex> edge;
 
-    void remove_edge(iterator pa, iterator pb)
-    {
-      if (pa == end() || pb == end())
-        return;
+    // iterates over the (sorted) neighbors of one vertex
+    typedef const T * const_iterator;
 
-      unsigned int old_size = out_neighbors(pa).size();
-      out_neighbors(pa).erase(node(pb));
-      in_neighbors(pb).erase(node(pa));
-      if (out_neighbors(pa).size() < old_size)
-        num_edges_ --;
+  private:
 
-    }
-   
+    T num_vertices_;
+    std::vector<size_t> out_rows_;      // size num_vertices+1
+    std::vector<T> out_edges_;          // size num_edges
+    std::vector<size_t> in_rows_;       // size num_vertices+1
+    std::vector<T> in_edges_;           // size num_edges
 
-    void remove_edge(const vertex &a, const vertex& b)
+    static const T *data(const std::vector<T> &v)
     {
-      iterator pa = find(a);
-      if (pa != end())
-        return;
-      iterator pb = find(b);
-      if (pb != end())
-        return;
-      remove_edge( pa, pb );
+        return (v.empty() ? 0 : &v[0]);
     }
 
-    void remove_edge(const edge &E)
+    // in-edges are the transpose of the out-edges
+    //
+    void build_in_edges()
     {
-        remove_edge(E.first, E.second);
+        std::vector<T> from(out_edges_.size());
+        for (T i=0; i<num_vertices_; i++)
+          for (size_t k=out_rows_[i]; k<out_rows_[i+1]; k++)
+            from[k] = i;
+        build_csr(num_vertices_, out_edges_, from, in_rows_, in_edges_);
     }
 
-    void remove_undirected_edge(const vertex &a, const vertex& b)
-    {
-      (a < b) ? remove_edge(a,b) : remove_edge(b,a);
-    }
+  public:
 
-    void remove_undirected_edge(const edge &e)
-    {
-      remove_undirected_edge(e.first, e.second);
-    }
+    static_tGraph() : num_vertices_(0), out_rows_(1, 0), out_edges_(),
+        in_rows_(1, 0), in_edges_() {}
 
-    void remove_vertex(iterator pa)
+    /**
+        Compact a tGraph; vertex ids must be (unsigned) integers.
+    */
+    explicit static_tGraph(const tGraph<T> &G) : num_vertices_(0),
+        out_rows_(), out_edges_(), in_rows_(), in_edges_()
     {
-      vertex_set  out_edges = out_neighbors(pa);
-      vertex_set  in_edges =  in_neighbors(pa);
+        typedef typename tGraph<T>::const_iterator node_iterator;
+        typedef typename tGraph<T>::vertex_set vertex_set;
 
-      //vertex_set & out_edges = out_neighbors(pa);
-      //vertex_set & in_edges =  in_neighbors(pa);
+        num_vertices_ = (G.num_vertices() == 0 ? 0 :
+                tGraph<T>::node(--G.end()) + 1);
+        out_rows_.assign(num_vertices_ + 1, 0);
+        out_edges_.reserve(G.num_edges());
 
-      // remove out-going edges
-      for (typename vertex_set::iterator p = out_edges.begin(); 
-                  p!=out_edges.end(); p++)
-      {
-          remove_edge(pa, find(*p));
-      }
+        for (node_iterator p = G.begin(); p != G.end(); p++)
+          out_rows_[tGraph<T>::node(p) + 1] = tGraph<T>::out_degree(p);
+        for (T i=0; i<num_vertices_; i++)
+          out_rows_[i+1] += out_rows_[i];
 
-
-      // remove in-coming edges
-      for (typename vertex_set::iterator p = in_edges.begin(); 
-                  p!=in_edges.end(); p++)
-      {
-          remove_edge(find(*p), pa);
-      }
-
-
-      G_.erase(node(pa));
+        // std::set neighbors are already sorted
+        for (node_iterator p = G.begin(); p != G.end(); p++)
+        {
+          const vertex_set &out = tGraph<T>::out_neighbors(p);
+          out_edges_.insert(out_edges_.end(), out.begin(), out.end());
+        }
+        build_in_edges();
     }
 
-
-    void remove_vertex_set(const vertex_set &V)
+    /**
+        Build from an edge list, given as parallel from/to arrays.
+    */
+    static_tGraph(T num_vertices, const std::vector<T> &from,
+        const std::vector<T> &to) : num_vertices_(num_vertices),
+        out_rows_(), out_edges_(), in_rows_(), in_edges_()
     {
-        for (typename vertex_set::const_iterator p=V.begin(); p!=V.end(); p++)
-          remove_vertex(*p);
+        build_csr(num_vertices_, from, to, out_rows_, out_edges_);
+        build_csr(num_vertices_, to, from, in_rows_, in_edges_);
     }
 
-
-    void remove_vertex(const vertex &a)
+    /**
+        Take over existing CSR arrays (which are left empty); each row of
+        targets must be sorted.
+    */
+    void assign(T num_vertices, std::vector<size_t> &offsets,
+          std::vector<T> &targets)
     {
-        iterator pa = find(a);
-        if (pa != G_.end())
-            remove_vertex( pa);
-
+        num_vertices_ = num_vertices;
+        out_rows_.swap(offsets);
+        out_edges_.swap(targets);
+        std::vector<size_t>(1, 0).swap(offsets);
+        std::vector<T>().swap(targets);
+        build_in_edges();
     }
 
-  /**
-        Is vertex 'a' included in graph?
-
-        @return true, if vertex a is present; false, otherwise.
-  */
-   bool includes_vertex(const vertex &a) const
-   {
-        return  (find(a) != G_.end());
-   }
-
-
-   /**
-        Is edge (a,b) included in graph?
-
-        @return true, if edge is present; false, otherwise.
-
-   */
-   bool includes_edge(const vertex &a, const vertex &b) const
-   {
-      return (includes_vertex(a)) ? 
-          includes_elm(out_neighbors(a),b): false;
-      
-      //const vertex_set &out = out_neighbors(a);
-      // return ( out.find(b) != out.end());
-
-   }
-
-  
-  bool includes_edge(const edge& e) const
-  {
-    return includes_edge(e.first, e.second);
-  }
-
-    // convert to a simple edge list for exporting
-    //
     /**
-        Create a new representation of graph as a list
-        of vertex pairs (a,b).
-
-        @return std::vector<edge> a vector (list) of vertex pairs
+        Apply a batch of edge deletions, then insertions, each sorted by
+        (from, to) without repeats (see sort_edge_keys() for building
+        such lists quickly).  Each row is merged with its updates in
+        parallel, into new CSR arrays; the in-edges are then rebuilt.
+        The vertex range grows to cover inserted edges; deletions of
+        edges not in the graph are ignored.
+
+        @return the number of edges (and vertices) actually changed
     */
-    std::vector<edge> edge_list() const;
-
-/*
-    graph unions
-*/
-
-    tGraph & plus_eq(const tGraph &B) 
-    {
-
-        for (const_iterator p=B.begin(); p != B.end(); p++)
+    update_counts update(const std::vector<edge> &insertions,
+          const std::vector<edge> &deletions)
+    {
+        update_counts C = {0, 0, 0, 0};
+        T n = num_vertices_;
+        for (size_t i=0; i<insertions.size(); i++)
+          n = std::max(n, (T) (std::max(insertions[i].first,
+                insertions[i].second) + 1));
+        C.vertices_inserted = n - num_vertices_;
+        out_rows_.resize(n + 1, out_rows_[num_vertices_]);
+
+        // range of each row in the update lists
+        std::vector<size_t> ins_rows(n + 1, 0), del_rows(n + 1, 0);
+        for (size_t i=0; i<insertions.size(); i++)
+          ins_rows[insertions[i].first + 1]++;
+        for (size_t i=0; i<deletions.size(); i++)
+          if (deletions[i].first < n)
+            del_rows[deletions[i].first + 1]++;
+        for (T v=0; v<n; v++)
         {
-            const vertex &this_node = node(p);
-            insert_vertex(this_node);
-            const vertex_set &out = out_neighbors(p);
-            for (typename vertex_set::const_iterator q= out.begin(); q != out.end(); q++)
-            {
-                insert_edge(this_node, *q); 
-            }
+          ins_rows[v+1] += ins_rows[v];
+          del_rows[v+1] += del_rows[v];
         }
-        return *this;
-    }
 
-    tGraph intersect(const tGraph &B) const  
-    {
-        tGraph G;
-        for (const_iterator p=begin(); p != end(); p++)
+        // two passes: row sizes, then the rows themselves
+        std::vector<size_t> rows(n + 1, 0);
+        std::vector<T> edges;
+        size_t inserted = 0, removed = 0;
+        for (int pass=0; pass<2; pass++)
         {
-            const vertex &this_node = node(p);
-            if (B.includes_vertex(this_node))
-                 G.insert_vertex(this_node);
+#ifdef _OPENMP
+          #pragma omp parallel for schedule(dynamic, 1024) \
+                reduction(+:inserted) reduction(+:removed)
+#endif
+          for (long v=0; v<(long) n; v++)
+          {
+            const T *a = data(out_edges_) + out_rows_[v];
+            const T *ae = data(out_edges_) + out_rows_[v+1];
+            size_t d = del_rows[v], de = del_rows[v+1];
+            size_t i = ins_rows[v], ie = ins_rows[v+1];
+            T *out = (pass == 0 || edges.empty() ? 0 : &edges[0] + rows[v]);
+            size_t k = 0;
+
+            while (a != ae || i != ie)
             {
-               const vertex_set &out = out_neighbors(p);
-               for (typename vertex_set::const_iterator q= out.begin(); 
-                          q != out.end(); q++)
-               {
-                   if (B.includes_edge(this_node, *q))
-                    G.insert_edge(this_node, *q);
-               }
+              T x;
+              bool from_graph = (i == ie ||
+                    (a != ae && *a <= insertions[i].second));
+              if (from_graph)
+              {
+                x = *a++;
+                const bool reinserted = (i != ie && insertions[i].second == x);
+                if (reinserted)
+                  i++;
+                while (d != de && deletions[d].second < x)
+                  d++;
+                if (d != de && deletions[d].second == x)
+                {
+                  removed++;
+                  if (!reinserted)
+                    continue;
+                  inserted++;
+                }
+              }
+              else
+              {
+                x = insertions[i++].second;
+                inserted++;
+              }
+              if (out)
+                out[k] = x;
+              k++;
             }
+            if (pass == 0)
+              rows[v+1] = k;
           }
-          return G;
-    }
 
-    tGraph operator*(const tGraph &B) const
-    {
-      return intersect(B);
+          if (pass == 0)
+          {
+            for (T v=0; v<n; v++)
+              rows[v+1] += rows[v];
+            edges.resize(rows[n]);
+            C.edges_inserted = inserted;
+            C.edges_removed = removed;
+            inserted = removed = 0;
+          }
+        }
+
+        num_vertices_ = n;
+        out_rows_.swap(rows);
+        out_edges_.swap(edges);
+        build_in_edges();
+        return C;
     }
 
+    unsigned int num_vertices() const { return num_vertices_; }
+    unsigned int num_nodes() const { return num_vertices_; }
+    size_t num_edges() const { return out_edges_.size(); }
 
-    tGraph minus(const tGraph &B) const
-    {
-        tGraph G;
-        for (const_iterator p=begin(); p != end(); p++)
-        {
-            const vertex &this_vertex = node(p);
-            if (isolated(p)) 
-            {
-              if (! B.isolated(this_vertex))
-                  G.insert_vertex(this_vertex);\
-            }
-            else
-            {
-               const vertex_set &out = out_neighbors(p);
-               for (typename vertex_set::const_iterator q= out.begin(); 
-                        q != out.end(); q++)
-               {
-                   if (!B.includes_edge(this_vertex, *q))
-                    G.insert_edge(this_vertex, *q);
-               }
-            }
-          }
-          return G;
-      }
+    size_t out_degree(T i) const { return out_rows_[i+1] - out_rows_[i]; }
+    size_t in_degree(T i) const { return in_rows_[i+1] - in_rows_[i]; }
+    size_t degree(T i) const { return out_degree(i); }
 
-    tGraph operator-(const tGraph &B) const
+    bool isolated(T i) const
     {
-      return minus(B);
+        return out_degree(i) == 0 && in_degree(i) == 0;
     }
 
-
-    tGraph plus(const tGraph &B) const  
+    const_iterator out_neighbors_begin(T i) const
     {
-        tGraph U(*this);
-
-        U.plus_eq(B);
-        return U;
+        return data(out_edges_) + out_rows_[i];
     }
-
-    tGraph operator+(const tGraph &B) const
+    const_iterator out_neighbors_end(T i) const
     {
-      return plus(B);
+        return data(out_edges_) + out_rows_[i+1];
     }
-
-    tGraph & operator+=(const tGraph &B) 
+    const_iterator in_neighbors_begin(T i) const
     {
-      return plus_eq(B);
+        return data(in_edges_) + in_rows_[i];
+    }
+    const_iterator in_neighbors_end(T i) const
+    {
+        return data(in_edges_) + in_rows_[i+1];
     }
 
+    /** raw CSR arrays (out-edges), e.g. for indexing edge values */
+    const std::vector<size_t> &out_offsets() const { return out_rows_; }
+    const std::vector<T> &out_targets() const { return out_edges_; }
 
+    bool includes_vertex(T a) const { return a < num_vertices_; }
 
-#if 0
-/*
-   union of two graphs
-*/
-    tGraph Union(const tGraph &B) const  
+    bool includes_edge(T a, T b) const
     {
-        tGraph U(B);
-        typedef std::vector<edge> VE;
-
-        VE b = B.edge_list();
-        for (typename VE::cosnt_iterator e = b.begin(); e != b.end(); e++)
-        {
-            U.insert_edge(*e);
-        }
-        return U;
+        return includes_vertex(a) && std::binary_search(
+              out_neighbors_begin(a), out_neighbors_end(a), b);
     }
 
-/*
-   intersection of two graphs
-*/
-    tGraph intersect(const tGraph &B) const  
+    bool includes_edge(const edge &e) const
     {
-        tGraph I;
-        typedef std::vector<tGraph::edge> VE;
-
-        VE b = B.edge_list();
-        for (typename VE::const_iterator e = b.begin(); e != b.end(); e++)
-        {
-          if (includes_edge(*e))
-          {
-              I.insert_edge(*e);
-          }
-        }
-
-        for (typename tGraph::const_iterator p = B.begin(); p!=B.end();p++)
-        {
-          if (includes_vertex( node(p) ))
-                  I.insert_vertex( node(p) );
-        }
-        return I;
+        return includes_edge(e.first, e.second);
     }
 
-#endif
-
-
-
-  
-/**
-    @param A vertex set of nodes (subset of G)
-    @return a new subgraph containing all nodes of A
-*/
-    tGraph subgraph(const vertex_set &A) const  
+    /**
+        Save as a binary .csr file (see write_csr_file()).
+    */
+    bool save(FILE *f) const
     {
-        tGraph G;
-
-        for (typename vertex_set::const_iterator p = A.begin(); p!=A.end(); p++)
-        {
-            const_iterator t = find(*p);
-            if (t != end())
-            {
-              vertex_set new_in =  (A * in_neighbors(t));
-              vertex_set new_out = (A * out_neighbors(t));
-
-              G.insert_new_vertex_inout_list(*p, new_in, new_out);
-            }
-        }
-        return G;
+        return write_csr_file(f, num_vertices_, out_rows_, out_edges_);
     }
 
-    
-    unsigned int subgraph_size(const vertex_set &A) const  
+    /**
+        Load a binary .csr file (edge values, if present, are skipped).
+    */
+    bool load(FILE *f, std::string &error)
     {
-        unsigned int num_edges = 0;
-        for (typename vertex_set::const_iterator p = A.begin(); p!=A.end(); p++)
-        {
-            num_edges +=  intersection_size(A, out_neighbors(*p) );
-        }
-        return num_edges;
+        size_t n = 0;
+        std::vector<size_t> offsets;
+        std::vector<T> targets;
+        if (!read_csr_file(f, n, offsets, targets, error))
+          return false;
+        assign(n, offsets, targets);
+        return true;
     }
+};
+// end static_tGraph<T>
 
-     
-
-  void print() const;
-
-
-/* tGraph iterator methods */
-
-/**
-    @param p tGraph::const_iterator
-*/
-static const vertex &node(const_iterator p) 
-{
-    return p->first;
-}
-
-static const vertex &node(iterator p) 
-{
-    return p->first;
-}
 
-static const vertex_set & in_neighbors(const_iterator p)
-    { return (p->second).first; }
-
-static    vertex_set & in_neighbors(iterator p)      
-      { return (p->second).first; }
-
-static const vertex_set& out_neighbors(const_iterator p) 
-      { return (p->second).second; }
-
-static     vertex_set& out_neighbors(iterator p) 
-      { return (p->second).second; }
-
-static  unsigned int num_edges(const_iterator p)  
-  {
-     return out_neighbors(p).size();
-  }
-    
-static  unsigned int degree(const_iterator p)  
-  {
-     return out_neighbors(p).size();
-  }
-    
-inline static  unsigned int num_edges(iterator p)  
-  {
-     return out_neighbors(p).size();
-  }
-    
-/**
-    @param p tGraph::const_iterator
-    @return number of edges going out (out-degree) at node pointed to by p.
-*/
-inline static  unsigned int out_degree(const_iterator p) 
-  {
-    return (p->second).second.size();
-  }
+typedef static_tGraph<unsigned int> static_Graph;
 
-inline static  unsigned int out_degree(iterator p) 
-  {
-    return (p->second).second.size();
-  }
 
 /**
-    @param p tGraph::const_iterator
-    @return number of edges going out (out-degree) at node pointed to by p.
+    The undirected view of G: row v holds the sorted, distinct union of
+    the in- and out-neighbors of v (without v itself).
 */
-inline static  unsigned int in_degree(const_iterator p) 
-  {
-    return (p->second).first.size();
-  }
-
-inline static  unsigned int in_degree(iterator p) 
-  {
-    return (p->second).first.size();
-  }
-
-
-inline static bool isolated(const_iterator p)
-{
-    return (in_degree(p) == 0 && out_degree(p) == 0 );
-}
-
-static bool isolated(iterator p)
-{
-    return (in_degree(p) == 0 && out_degree(p) == 0 );
-}
-
-
-
-/**
-      abosrb(a,b):   'a' absorbs 'b', b gets removed from graph
-*/
-void absorb(iterator pa, iterator pb)
+template <typename T>
+void undirected_adjacency(const static_tGraph<T> &G,
+      std::vector<size_t> &offsets, std::vector<T> &targets)
 {
+    const long n = G.num_vertices();
+    std::vector<size_t> degree(n + 1, 0);
 
-    //std::cerr << "Graph::absorb(" << node(pa) << ", " << node(pb) << ")\n";
-
-    if (pa == pb)
-      return;
-
-    
-    // first remove edge (a,b) to avoid self-loops
-    remove_edge(pa, pb);
-
-    // chnage edges (b,i) to a(i,j)
+    // sizes first (merging twice keeps the rows in one array)
     //
-    {
-    vertex_set b_out = out_neighbors(pb);
-    for (typename vertex_set::iterator p = b_out.begin(); 
-              p!=b_out.end(); p++)
-    {
-      iterator pi = find(*p);
-      remove_edge(pb, pi);
-      //std::cerr<<"\t remove_edge("<<node(pb)<< ", " << node(pi) <<")\n";
-      insert_edge(pa, pi);
-      //std::cerr<<"\t insert_edge("<<node(pa)<< ", " << node(pi) <<")\n";
-    }
-    }
-
-    // change edges (i,b) to (i,a)
-    {
-    vertex_set b_in = in_neighbors(pb);
-    for (typename vertex_set::iterator p = b_in.begin(); 
-              p!=b_in.end(); p++)
-    {
-      iterator pi = find(*p);
-      remove_edge(pi, pb);
-      //std::cerr<<"\t remove_edge("<<node(pi)<< ", " << node(pb) <<")\n";
-      insert_edge(pi, pa);
-      //std::cerr<<"\t insert_edge("<<node(pi)<< ", " << node(pa) <<")\n";
-    }
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 1024)
+#endif
+    for (long v=0; v<n; v++)
+    {
+      const T *a = G.out_neighbors_begin(v), *ae = G.out_neighbors_end(v);
+      const T *b = G.in_neighbors_begin(v), *be = G.in_neighbors_end(v);
+      size_t d = 0;
+      T last = 0;
+      bool have_last = false;
+      while (a != ae || b != be)
+      {
+        T x = (b == be || (a != ae && *a < *b) ? *a++ : *b++);
+        if (x != (T) v && (!have_last || x != last))
+          d++;
+        last = x;
+        have_last = true;
+      }
+      degree[v+1] = d;
     }
 
+    offsets.assign(n + 1, 0);
+    for (long v=0; v<n; v++)
+      offsets[v+1] = offsets[v] + degree[v+1];
+    targets.resize(offsets[n]);
 
-    //std::cout<<"\t about to remove vertex: "<< node(pb) << "\n";
-    
-    remove_vertex(pb);
-    //G_.erase( node(pb) );
-
-    //std::cout<<"\t removed_vertex.\n";
-
-
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 1024)
+#endif
+    for (long v=0; v<n; v++)
+    {
+      const T *a = G.out_neighbors_begin(v), *ae = G.out_neighbors_end(v);
+      const T *b = G.in_neighbors_begin(v), *be = G.in_neighbors_end(v);
+      size_t k = offsets[v];
+      T last = 0;
+      bool have_last = false;
+      while (a != ae || b != be)
+      {
+        T x = (b == be || (a != ae && *a < *b) ? *a++ : *b++);
+        if (x != (T) v && (!have_last || x != last))
+          targets[k++] = x;
+        last = x;
+        have_last = true;
+      }
+    }
 }
 
 
-void absorb(vertex a, vertex b)
+/**
+    The undirected version of G, as a symmetric static graph (every edge
+    in both directions, without self-loops).
+*/
+template <typename T>
+static_tGraph<T> undirected_graph(const static_tGraph<T> &G)
 {
-    if (a == b)
-      return ;
-
-   iterator pa = find(a);
-   if (pa == end())
-      return;
-
-   iterator pb = find(b);
-   if (pb == end())
-      return;
-
-    absorb( pa, pb );
-
-
+    std::vector<size_t> offsets;
+    std::vector<T> targets;
+    undirected_adjacency(G, offsets, targets);
+    static_tGraph<T> U;
+    U.assign(G.num_vertices(), offsets, targets);
+    return U;
 }
 
 
-};
-// end tGraph<T>
-
-
-typedef tGraph<unsigned int> Graph;
-typedef tGraph<int> iGraph;
-typedef tGraph<std::string> sGraph;
-
-
-template <class T>
-std::vector<typename tGraph<T>::edge> tGraph<T>::edge_list() const
-    {
-        //std::vector<tGraph::edge> E(num_edges());
-        std::vector<typename tGraph<T>::edge> E;
-
-        for (typename tGraph::const_iterator p = begin(); p!=end(); p++)
-        {
-            const vertex &a = tGraph::node(p);
-            const vertex_set &out = tGraph::out_neighbors(p);
-            for (typename vertex_set::const_iterator t = out.begin(); 
-                        t != out.end(); t++)
-            {
-                E.push_back( edge(a, *t));
-            }
-        }
-        return E;
-    }
-
-// global functions
-//
-
+/**
+    Write G in the format given by opt (see ngraph_write.hpp); vertices
+    0 .. num_vertices()-1 with no edges are written as isolated.
+*/
 template <typename T>
-std::istream & operator>>(std::istream &s, tGraph<T> &G)
+bool write_graph(graph_sink out, const static_tGraph<T> &G,
+      const write_options &opt, std::string &error)
 {
-    std::string line;
-
-    while (getline(s, line))
-    {
-      T v1, v2;
-      std::istringstream L(line);
-      L >> v1;
-      if (L.eof())
-      {
-          G.insert_vertex(v1);
-      }
-      else
-      {
-        L >> v2;
-        G.insert_edge(v1, v2);
-      }
-    }
-    return s;
-
+  stats::scoped_phase phase("write");
+  stats::edges_written() += G.num_edges();
+  return write_rows(out, indexed_rows<static_tGraph<T> >(G), opt, error);
 }
 
+
 template <typename T>
-std::ostream & operator<<(std::ostream &s, const tGraph<T> &G)
+std::ostream & operator<<(std::ostream &s, const static_tGraph<T> &G)
 {
-  for (typename tGraph<T>::const_node_iterator p=G.begin(); p != G.end(); p++)
-  {
-    const typename tGraph<T>::vertex_set &out = tGraph<T>::out_neighbors(p);
-    typename tGraph<T>::vertex v = p->first;
-    if (out.size() == 0 && tGraph<T>::in_neighbors(p).size() == 0)
-    {
-      // v is an isolated node
-      s << v << "\n";
-    }
-    else
-    {
-       for ( typename tGraph<T>::vertex_set::const_iterator q=out.begin(); 
-                q!=out.end(); q++)
-           s << v << " " << *q << "\n";
-    }
-  }
+  write_g(s, indexed_rows<static_tGraph<T> >(G));
   return s;
 }
 
-
-template <typename T>
-void tGraph<T>::print() const 
-    {
-
-       std::cerr << "# vertices: " <<  num_vertices()  << "\n";
-       std::cerr << "# edges:    " <<  num_edges()  << "\n";
-
-        for (const_iterator p=G_.begin(); 
-              p != G_.end(); p++)
-        {
-          const vertex_set   &out =  out_neighbors(p);
-
-          for (typename vertex_set::const_iterator q=out.begin(); 
-                          q!=out.end(); q++)
-              std::cerr << p->first << "  -->  " << *q << "\n";
-        }
-        std::cerr << std::endl;
-
-    }
-
 }
 // namespace NGraph
 
 
 
 #endif
-// NGRAPH_H_
+// NGRAPH_STATIC_H_
@@ -0,0 +1,281 @@
+#ifndef NGRAPH_STATIC_IO_H_
+#define NGRAPH_STATIC_IO_H_
+
+/*
+   Loading static (CSR) graphs for the tools that work on them, in any of
+   the formats the tools exchange:
+
+        .csr    binary CSR file (ngraph_static.hpp)
+        .mtx    MatrixMarket coordinate file (mtx_io.hpp)
+        other   .g edge list ("from to" lines, or a single vertex; lines
+                starting with '%' or '#' are comments)
+
+   .g files are parsed in parallel straight into edge arrays, which are
+   radix-sorted and deduplicated (a .g file is a set of edges, as when
+   read into a tGraph), without building a tGraph first.
+*/
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "ngraph_static.hpp"
+#include "mapped_file.hpp"
+#include "mtx_io.hpp"
+#include "edge_sort.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+
+/**
+    Parse a .g edge list from data[0..size) into 64-bit keys
+    (from << 32 | to), in order, repeated edges kept; vertices gets the
+    vertices of the vertex-only lines.  This is the raw edge stream that
+    parse_edge_list() and the statistics of graph_stats.hpp start from.
+
+    @return false (with error) on a malformed line
+*/
+inline bool parse_edge_keys(const char *data, size_t size,
+      std::vector<uint64_t> &keys, std::vector<uint64_t> &vertices,
+      std::string &error)
+{
+#ifdef _OPENMP
+    const unsigned int num_chunks = omp_get_max_threads();
+#else
+    const unsigned int num_chunks = 1;
+#endif
+    std::vector<const char *> bounds = line_chunks(data, size, num_chunks);
+    std::vector<std::vector<uint64_t> > E(num_chunks), V(num_chunks);
+    std::vector<const char *> bad(num_chunks, (const char *) 0);
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1)
+#endif
+    for (int c=0; c<(int) num_chunks; c++)
+    {
+      const char *p = bounds[c];
+      const char *end = bounds[c+1];
+      while (p < end)
+      {
+        const char *line = p;
+        mtx_skip_blanks(p, end);
+        if (p == end || *p == '\n' || *p == '%' || *p == '#')
+        {
+          mtx_skip_line(p, end);
+          continue;
+        }
+        uint64_t a, b;
+        if (!mtx_parse_uint(p, end, a) || a >= 0xFFFFFFFFUL)
+        {
+          bad[c] = line;
+          break;
+        }
+        mtx_skip_blanks(p, end);
+        if (p == end || *p == '\n')
+          V[c].push_back(a);
+        else if (mtx_parse_uint(p, end, b) && b < 0xFFFFFFFFUL)
+          E[c].push_back((a << 32) | b);
+        else
+        {
+          bad[c] = line;
+          break;
+        }
+        mtx_skip_line(p, end);
+      }
+    }
+
+    for (unsigned int c=0; c<num_chunks; c++)
+      if (bad[c] != 0)
+      {
+        size_t line = 1 + std::count(data, bad[c], '\n');
+        char buf[32];
+        sprintf(buf, "%lu", (unsigned long) line);
+        error = std::string("line ") + buf + " is not an edge";
+        return false;
+      }
+
+    keys.clear();
+    vertices.clear();
+    for (unsigned int c=0; c<num_chunks; c++)
+    {
+      keys.insert(keys.end(), E[c].begin(), E[c].end());
+      vertices.insert(vertices.end(), V[c].begin(), V[c].end());
+      std::vector<uint64_t>().swap(E[c]);
+      std::vector<uint64_t>().swap(V[c]);
+    }
+    stats::edges_read() += keys.size();
+    return true;
+}
+
+
+/**
+    Sort edge keys (see parse_edge_keys()) and remove the repeats.
+*/
+inline void sort_edge_keys(std::vector<uint64_t> &keys)
+{
+    std::vector<uint64_t> tmp(keys.size());
+    if (!keys.empty())
+      radix_sort(&keys[0], &tmp[0], keys.size());
+    std::vector<uint64_t>().swap(tmp);
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+
+/**
+    Split sorted, distinct edge keys into (from, to) arrays;
+    num_vertices is one more than the largest vertex among the edges and
+    the vertex-only lines.  See parse_edge_list() for present.
+*/
+template <typename T>
+void edge_keys_to_list(const std::vector<uint64_t> &keys,
+      const std::vector<uint64_t> &vertices, T &num_vertices,
+      std::vector<T> &from, std::vector<T> &to,
+      std::vector<char> *present = 0)
+{
+    uint64_t max_vertex = 0;
+    bool any = !vertices.empty();
+    for (size_t i=0; i<vertices.size(); i++)
+      if (vertices[i] > max_vertex)
+        max_vertex = vertices[i];
+    from.resize(keys.size());
+    to.resize(keys.size());
+    for (size_t i=0; i<keys.size(); i++)
+    {
+      from[i] = (T) (keys[i] >> 32);
+      to[i] = (T) (keys[i] & 0xFFFFFFFFUL);
+      if (from[i] > max_vertex)
+        max_vertex = from[i];
+      if (to[i] > max_vertex)
+        max_vertex = to[i];
+      any = true;
+    }
+    num_vertices = (any ? (T) (max_vertex + 1) : 0);
+
+    if (present)
+    {
+      present->assign(num_vertices, 0);
+      for (size_t i=0; i<vertices.size(); i++)
+        (*present)[vertices[i]] = 1;
+      for (size_t i=0; i<keys.size(); i++)
+        (*present)[from[i]] = (*present)[to[i]] = 1;
+    }
+}
+
+
+/**
+    Parse a .g edge list from data[0..size) into (from, to) arrays,
+    sorted and without repeats.  num_vertices is one more than the
+    largest vertex seen.  If present is not 0, (*present)[v] is set for
+    the vertices that occur in the file (as opposed to the gaps in the
+    numbering).
+
+    @return false (with error) on a malformed line
+*/
+template <typename T>
+bool parse_edge_list(const char *data, size_t size, T &num_vertices,
+      std::vector<T> &from, std::vector<T> &to, std::string &error,
+      std::vector<char> *present = 0)
+{
+    std::vector<uint64_t> keys, vertices;
+    if (!parse_edge_keys(data, size, keys, vertices, error))
+      return false;
+    sort_edge_keys(keys);
+    edge_keys_to_list(keys, vertices, num_vertices, from, to, present);
+    return true;
+}
+
+
+/**
+    Read a .g file as a sorted list of distinct edges, such as the
+    batches of static_tGraph::update(); no filename (0) is no edges.
+*/
+template <typename T>
+bool read_edge_set(const char *filename,
+      std::vector<std::pair<T,T> > &E, std::string &error)
+{
+    E.clear();
+    if (filename == 0)
+      return true;
+    mapped_file in(filename);
+    if (!in.good())
+    {
+      error = in.error();
+      return false;
+    }
+    std::vector<uint64_t> keys, vertices;
+    if (!parse_edge_keys(in.data(), in.size(), keys, vertices, error))
+    {
+      error = "[" + std::string(filename) + "] " + error;
+      return false;
+    }
+    sort_edge_keys(keys);
+    E.resize(keys.size());
+    for (size_t i=0; i<keys.size(); i++)
+      E[i] = std::pair<T,T>((T) (keys[i] >> 32), (T) (keys[i] & 0xFFFFFFFFUL));
+    return true;
+}
+
+
+/**
+    Read a static graph from a .csr, .mtx or .g file (by its suffix;
+    "-" is a .g file on stdin).  See parse_edge_list() for present.
+*/
+template <typename T>
+bool read_static_graph(const char *filename, static_tGraph<T> &G,
+      std::string &error, std::vector<char> *present = 0)
+{
+    const std::string name(filename);
+    const bool csr = name.size() > 4 &&
+          name.compare(name.size() - 4, 4, ".csr") == 0;
+    const bool mtx = name.size() > 4 &&
+          name.compare(name.size() - 4, 4, ".mtx") == 0;
+
+    if (csr || mtx)
+    {
+      bool ok = false;
+      if (mtx)
+        ok = read_mtx(filename, G, mtx_read_options(), error);
+      else
+      {
+        FILE *f = fopen(filename, "rb");
+        if (f == 0)
+          error = "could not be opened";
+        else
+        {
+          ok = G.load(f, error);
+          fclose(f);
+        }
+      }
+      if (!ok)
+        error = "[" + name + "] " + error;
+      else if (present)
+        present->assign(G.num_vertices(), 1);
+      return ok;
+    }
+
+    mapped_file in(filename);
+    if (!in.good())
+    {
+      error = in.error();
+      return false;
+    }
+    T n = 0;
+    std::vector<T> from, to;
+    if (!parse_edge_list(in.data(), in.size(), n, from, to, error, present))
+    {
+      error = "[" + name + "] " + error;
+      return false;
+    }
+    G = static_tGraph<T>(n, from, to);
+    return true;
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_STATIC_IO_H_
@@ -0,0 +1,486 @@
+#ifndef NGRAPH_STATS_H_
+#define NGRAPH_STATS_H_
+
+/*
+   Lightweight run-time instrumentation for NGraph tools: nested phase
+   timers and named event counters, kept per thread and aggregated when
+   reported.
+
+   Instrumentation is off by default, and then costs a single flag test
+   per event.  A tool turns it on from the command line with
+
+        NGraph::stats::parse_options(argc, argv);
+
+   at the top of main().  This recognizes (and removes from argv) the
+   common options
+
+        --stats         print a phase/counter breakdown to stderr at exit
+        --stats=json    same, as a JSON object
+        --fast-exit     end the tool without destroying its graphs (see
+                        finish())
+
+   Phases are timed with scoped (RAII) timers, which nest:
+
+        {
+            stats::scoped_phase p("compute");
+            ...
+            {
+               stats::scoped_phase q("merge");   // reported as compute/merge
+               ...
+            }
+        }
+
+   The graph I/O operators record "read", "build" and "write" phases, so
+   every tool that uses them gets that breakdown for free; time not
+   covered by any phase is reported as "(other)".
+
+   Counters are declared once (usually as function-local statics, see
+   the ones below) and incremented from any thread:
+
+        stats::edges_scanned() += G.out_degree(p);
+
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdlib>
+#include <cstring>
+#include "tnt_stopwatch.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+namespace stats
+{
+
+// per-thread slots are statically sized, so no locking is needed on the
+// fast path; threads beyond this share the last slot.
+//
+const unsigned int max_threads = 256;
+
+inline unsigned int thread_id()
+{
+#ifdef _OPENMP
+    unsigned int t = omp_get_thread_num();
+    return (t < max_threads ? t : max_threads-1);
+#else
+    return 0;
+#endif
+}
+
+
+// global on/off switch and output format
+//
+inline bool &enabled_flag()
+{
+    static bool enabled = false;
+    return enabled;
+}
+
+inline bool enabled()
+{
+    return enabled_flag();
+}
+
+inline bool &json_flag()
+{
+    static bool json = false;
+    return json;
+}
+
+
+// one counter value per thread, padded to avoid false sharing
+//
+struct counter_slot
+{
+    size_t value;
+    char pad[64 - sizeof(size_t)];
+};
+
+
+/**
+    A named event counter, with one slot per thread.  The slots belong
+    to the registry, so a counter may be destroyed before the report is
+    printed at exit.
+*/
+class counter
+{
+  private:
+    counter_slot *slots_;
+
+    counter(const counter &);               // not copyable
+    counter & operator=(const counter &);
+
+  public:
+
+    inline counter(const std::string &name);
+
+    counter & operator+=(size_t n)
+    {
+        if (enabled())
+          slots_[thread_id()].value += n;
+        return *this;
+    }
+
+    counter & operator++()
+    {
+        return (*this += 1);
+    }
+};
+
+
+// per-thread record of phase timings, keyed by nested path ("a/b/c"),
+// in order of first appearance
+//
+struct phase_record
+{
+    double seconds;
+    size_t calls;
+
+    phase_record() : seconds(0.0), calls(0) {}
+};
+
+struct thread_state
+{
+    std::vector<std::string> stack;           // current nesting
+    std::vector<std::string> order;           // paths, first-seen order
+    std::map<std::string, phase_record> phases;
+
+    phase_record &record(const std::string &path)
+    {
+        std::map<std::string, phase_record>::iterator p = phases.find(path);
+        if (p == phases.end())
+        {
+          order.push_back(path);
+          p = phases.insert(std::make_pair(path, phase_record())).first;
+        }
+        return p->second;
+    }
+};
+
+
+class registry
+{
+  private:
+    std::vector<thread_state> threads_;
+    std::vector<std::string> counter_names_;
+    std::vector<counter_slot *> counters_;
+    double start_time_;
+
+    registry(const registry &);
+    registry & operator=(const registry &);
+
+    size_t counter_total(unsigned int i) const
+    {
+        size_t sum = 0;
+        for (unsigned int t=0; t<max_threads; t++)
+          sum += counters_[i][t].value;
+        return sum;
+    }
+
+  public:
+    registry() : threads_(max_threads), counter_names_(), counters_(),
+        start_time_(TNT::wall_seconds()) {}
+
+    ~registry()
+    {
+        for (unsigned int i=0; i<counters_.size(); i++)
+          delete [] counters_[i];
+    }
+
+    static registry &instance()
+    {
+        static registry R;
+        return R;
+    }
+
+    thread_state &thread(unsigned int t) { return threads_[t]; }
+
+    counter_slot *add_counter(const std::string &name)
+    {
+        counter_slot *slots = new counter_slot[max_threads];
+        for (unsigned int t=0; t<max_threads; t++)
+          slots[t].value = 0;
+
+        // counters are function-local statics, and may first be reached
+        // by several threads at once (inside a parallel region)
+#ifdef _OPENMP
+        #pragma omp critical (ngraph_stats_registry)
+#endif
+        {
+          counter_names_.push_back(name);
+          counters_.push_back(slots);
+        }
+        return slots;
+    }
+
+    void restart() { start_time_ = TNT::wall_seconds(); }
+
+    void report(std::ostream &s, bool json) const;
+};
+
+
+inline counter::counter(const std::string &name) :
+          slots_(registry::instance().add_counter(name))
+{
+}
+
+
+/**
+    Times the enclosing scope as a (nested) phase of the current thread.
+*/
+class scoped_phase
+{
+  private:
+    bool active_;
+    double start_;
+    unsigned int thread_;
+    phase_record *record_;
+
+    scoped_phase(const scoped_phase &);
+    scoped_phase & operator=(const scoped_phase &);
+
+  public:
+    scoped_phase(const char *name) : active_(enabled()), start_(0.0),
+          thread_(0), record_(0)
+    {
+        if (!active_)
+          return;
+        thread_ = thread_id();
+        thread_state &t = registry::instance().thread(thread_);
+        t.stack.push_back(t.stack.empty() ? std::string(name) :
+                t.stack.back() + "/" + name);
+
+        // created on entry, so that parents are listed before children
+        record_ = &t.record(t.stack.back());
+        start_ = TNT::wall_seconds();
+    }
+
+    ~scoped_phase()
+    {
+        if (!active_)
+          return;
+        record_->seconds += TNT::wall_seconds() - start_;
+        record_->calls++;
+        registry::instance().thread(thread_).stack.pop_back();
+    }
+};
+
+
+inline void registry::report(std::ostream &s, bool json) const
+{
+    double total = TNT::wall_seconds() - start_time_;
+
+    // merge phases over threads, in first-seen order
+    std::vector<std::string> order;
+    std::map<std::string, phase_record> phases;
+    std::map<std::string, unsigned int> phase_threads;
+
+    for (unsigned int t=0; t<max_threads; t++)
+    {
+      const thread_state &T = threads_[t];
+      for (unsigned int i=0; i<T.order.size(); i++)
+      {
+        const std::string &path = T.order[i];
+        const phase_record &r = T.phases.find(path)->second;
+        if (phases.find(path) == phases.end())
+          order.push_back(path);
+        phases[path].seconds += r.seconds;
+        phases[path].calls += r.calls;
+        phase_threads[path]++;
+      }
+    }
+
+    // time not covered by any top-level phase (averaged over the threads
+    // that ran it)
+    double covered = 0.0;
+    for (unsigned int i=0; i<order.size(); i++)
+      if (order[i].find('/') == std::string::npos)
+      {
+        std::map<std::string, unsigned int>::const_iterator p =
+                phase_threads.find(order[i]);
+        covered += phases[order[i]].seconds / p->second;
+      }
+    double other = (total > covered ? total - covered : 0.0);
+
+    if (json)
+    {
+      s << "{\"total_seconds\": " << total << ", \"phases\": [";
+      for (unsigned int i=0; i<order.size(); i++)
+      {
+        const phase_record &r = phases[order[i]];
+        s << (i ? ", " : "") << "{\"phase\": \"" << order[i]
+          << "\", \"seconds\": " << r.seconds << ", \"calls\": " << r.calls
+          << ", \"threads\": " << phase_threads[order[i]] << "}";
+      }
+      s << (order.empty() ? "" : ", ") << "{\"phase\": \"(other)\", "
+        << "\"seconds\": " << other << ", \"calls\": 1, \"threads\": 1}";
+      s << "], \"counters\": {";
+      for (unsigned int i=0; i<counters_.size(); i++)
+      {
+        s << (i ? ", " : "") << "\"" << counter_names_[i] << "\": "
+          << counter_total(i);
+      }
+      s << "}}\n";
+      return;
+    }
+
+    s << "# phase" << std::setw(28) << "seconds" << std::setw(8) << "%"
+      << std::setw(10) << "calls" << std::setw(9) << "threads\n";
+    for (unsigned int i=0; i<order.size(); i++)
+    {
+      const std::string &path = order[i];
+      const phase_record &r = phases[path];
+
+      // indent by nesting depth, print only the last path component
+      unsigned int depth = 0;
+      for (unsigned int k=0; k<path.size(); k++)
+        if (path[k] == '/') depth++;
+      std::string label = std::string(2*depth, ' ') +
+            path.substr(path.rfind('/') == std::string::npos ? 0 :
+                    path.rfind('/') + 1);
+
+      s << "  " << std::left << std::setw(26) << label << std::right
+        << std::setw(10) << std::fixed << std::setprecision(4) << r.seconds
+        << std::setw(8) << std::setprecision(1)
+        << (total > 0.0 ? 100.0 * r.seconds / total : 0.0)
+        << std::setw(10) << r.calls << std::setw(8)
+        << phase_threads[path] << "\n";
+    }
+    s << "  " << std::left << std::setw(26) << "(other)" << std::right
+      << std::setw(10) << std::setprecision(4) << other << std::setw(8)
+      << std::setprecision(1) << (total > 0.0 ? 100.0 * other / total : 0.0)
+      << "\n";
+    s << "  " << std::left << std::setw(26) << "total" << std::right
+      << std::setw(10) << std::setprecision(4) << total << "\n";
+
+    if (!counters_.empty())
+    {
+      s << "# counter\n";
+      for (unsigned int i=0; i<counters_.size(); i++)
+        s << "  " << std::left << std::setw(26) << counter_names_[i]
+          << std::right << std::setw(16) << counter_total(i) << "\n";
+    }
+    s.unsetf(std::ios::fixed);
+}
+
+
+inline void report_at_exit()
+{
+    registry::instance().report(std::cerr, json_flag());
+}
+
+
+/**
+    Turn instrumentation on or off explicitly (parse_options() does
+    this for command-line tools).
+*/
+inline void enable(bool json = false)
+{
+    if (!enabled_flag())
+    {
+      registry::instance().restart();
+      atexit(report_at_exit);
+    }
+    enabled_flag() = true;
+    json_flag() = json;
+}
+
+
+inline bool &fast_exit_flag()
+{
+    static bool fast_exit = false;
+    return fast_exit;
+}
+
+
+/**
+    Scan the command line for --stats, --stats=json and --fast-exit,
+    act on them, and remove them from argv (so that the tool's own
+    positional argument handling is unaffected).
+*/
+inline void parse_options(int &argc, char *argv[])
+{
+    int j = 1;
+    for (int i=1; i<argc; i++)
+    {
+      if (strcmp(argv[i], "--stats") == 0)
+        enable(false);
+      else if (strcmp(argv[i], "--stats=json") == 0)
+        enable(true);
+      else if (strcmp(argv[i], "--fast-exit") == 0)
+        fast_exit_flag() = true;
+      else
+        argv[j++] = argv[i];
+    }
+    argc = j;
+    argv[argc] = 0;
+}
+
+
+/**
+    End a tool with the given status, as
+
+        return stats::finish(0);
+
+    at the end of main().  With --fast-exit the process exits at once,
+    leaving its graphs to the system instead of freeing them one node
+    at a time (which can take minutes for graphs of 10^8 edges); output
+    streams are still flushed and the --stats report printed.
+*/
+inline int finish(int status)
+{
+    if (fast_exit_flag())
+    {
+      std::cout.flush();
+      exit(status);
+    }
+    return status;
+}
+
+
+// counters shared by the library
+//
+inline counter &edges_read()
+{
+    static counter c("edges read");
+    return c;
+}
+
+inline counter &edges_written()
+{
+    static counter c("edges written");
+    return c;
+}
+
+inline counter &edges_scanned()
+{
+    static counter c("edges scanned");
+    return c;
+}
+
+inline counter &sets_allocated()
+{
+    static counter c("sets allocated");
+    return c;
+}
+
+inline counter &merges_performed()
+{
+    static counter c("merges performed");
+    return c;
+}
+
+}
+// namespace stats
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_STATS_H_
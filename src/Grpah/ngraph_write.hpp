@@ -0,0 +1,502 @@
+#ifndef NGRAPH_WRITE_H_
+#define NGRAPH_WRITE_H_
+
+/*
+   Writing graphs as text, in any of the formats the tools produce:
+
+        g_format       .g edge list: "from to" lines, and a line with
+                       just the vertex for each isolated one
+        mtx_format     MatrixMarket general pattern matrix
+        tgf_format     Trivial Graph Format: "v label" lines, "#", then
+                       "from to" lines
+        dot_format     GraphViz digraph ("from->to ;")
+        udot_format    GraphViz graph, each edge once ("from--to ;",
+                       from <= to)
+        pajek_format   Pajek .net: "*Vertices n", "i \"label\"" lines,
+                       "*Arcs", then "i j" lines, with vertices numbered
+                       1 .. n in order
+
+   The vertices (rows) are split into chunks, which the threads format in
+   parallel, each into its own buffer (with hand-rolled integer
+   formatting, rather than through iostreams); the buffers are then
+   written, in order, to a FILE or an ostream.  The output is the same as
+   a serial write, whatever the number of threads.
+
+   The writer works on any graph given as a sequence of rows through a
+   small adapter (see indexed_rows below, for graphs on 0 .. n-1); the
+   write_graph() overloads for tGraph, static_tGraph and compressed_tGraph
+   are in ngraph.hpp, ngraph_static.hpp and ngraph_compressed.hpp.  The
+   vertices must be of an unsigned integral type (see buffered_format);
+   write_g() writes a .g edge list of any other type (such as an iGraph
+   or sGraph) through iostreams instead.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <stdint.h>
+#include "format_uint.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+
+enum graph_format
+{
+    g_format,
+    mtx_format,
+    tgf_format,
+    dot_format,
+    udot_format,
+    pajek_format
+};
+
+
+/**
+    The format named "g", "mtx", "tgf", "dot", "udot" or "pajek" (or
+    "net").
+
+    @return false if the name is unknown
+*/
+inline bool parse_graph_format(const std::string &name, graph_format &f)
+{
+    if (name == "g")
+      f = g_format;
+    else if (name == "mtx")
+      f = mtx_format;
+    else if (name == "tgf")
+      f = tgf_format;
+    else if (name == "dot")
+      f = dot_format;
+    else if (name == "udot")
+      f = udot_format;
+    else if (name == "pajek" || name == "net")
+      f = pajek_format;
+    else
+      return false;
+    return true;
+}
+
+
+typedef std::map<unsigned long, std::string> vertex_labels;
+
+struct write_options
+{
+    graph_format format;
+    const vertex_labels *labels;    // for tgf and pajek; may be 0
+    size_t chunk_rows;              // rows per thread per round
+
+    write_options(graph_format f = g_format, const vertex_labels *L = 0) :
+        format(f), labels(L), chunk_rows(4096) {}
+};
+
+
+/**
+    A growable character buffer, appended to through a pointer:
+
+        char *p = b.reserve(64);
+        p = format_uint(p, v);
+        *p++ = '\n';
+        b.commit(p);
+*/
+class text_buffer
+{
+  private:
+    std::vector<char> data_;
+    size_t len_;
+
+  public:
+    text_buffer() : data_(1 << 16), len_(0) {}
+
+    /** room for n more characters */
+    char *reserve(size_t n)
+    {
+        if (len_ + n > data_.size())
+          data_.resize(std::max(2 * data_.size(), len_ + n));
+        return &data_[len_];
+    }
+
+    void commit(const char *end) { len_ = end - &data_[0]; }
+
+    void put(const char *s, size_t n)
+    {
+        memcpy(reserve(n), s, n);
+        len_ += n;
+    }
+
+    void put(const std::string &s) { put(s.data(), s.size()); }
+
+    void clear() { len_ = 0; }
+    const char *data() const { return &data_[0]; }
+    size_t size() const { return len_; }
+};
+
+
+/**
+    Where the text goes: a FILE or an ostream.
+*/
+class graph_sink
+{
+  private:
+    FILE *f_;
+    std::ostream *s_;
+
+  public:
+    graph_sink(FILE *f) : f_(f), s_(0) {}
+    graph_sink(std::ostream &s) : f_(0), s_(&s) {}
+
+    bool write(const char *p, size_t n)
+    {
+        if (n == 0)
+          return true;
+        if (f_)
+          return fwrite(p, 1, n, f_) == n;
+        s_->write(p, n);
+        return s_->good();
+    }
+
+    bool write(const text_buffer &b) { return write(b.data(), b.size()); }
+
+    bool flush()
+    {
+        if (f_)
+          return fflush(f_) == 0;
+        s_->flush();
+        return s_->good();
+    }
+};
+
+
+/**
+    The rows of a graph on vertices 0 .. num_vertices()-1, such as a
+    static_tGraph or compressed_tGraph.  A row adapter provides
+
+        vertex, const_iterator
+        size()              number of rows
+        node(i)             the vertex of row i (rows in increasing order)
+        isolated(i)         row i has no in- or out-neighbors
+        out_begin(i), out_end(i)
+        position(v)         the row of vertex v
+        num_edges()
+*/
+template <class Graph>
+class indexed_rows
+{
+  private:
+    const Graph &G_;
+
+  public:
+    typedef typename Graph::vertex vertex;
+    typedef typename Graph::const_iterator const_iterator;
+
+    explicit indexed_rows(const Graph &G) : G_(G) {}
+
+    size_t size() const { return G_.num_vertices(); }
+    vertex node(size_t i) const { return (vertex) i; }
+    bool isolated(size_t i) const { return G_.isolated((vertex) i); }
+    const_iterator out_begin(size_t i) const
+    {
+        return G_.out_neighbors_begin((vertex) i);
+    }
+    const_iterator out_end(size_t i) const
+    {
+        return G_.out_neighbors_end((vertex) i);
+    }
+    size_t position(vertex v) const { return v; }
+    size_t num_edges() const { return G_.num_edges(); }
+};
+
+
+template <class Rows>
+class graph_writer
+{
+  private:
+    typedef typename Rows::vertex vertex;
+    typedef typename Rows::const_iterator const_iterator;
+
+    enum { max_line = 2 * 20 + 8 };     // two numbers and punctuation
+
+    const Rows &R_;
+    const write_options &opt_;
+    uint64_t mtx_shift_;
+
+    const std::string *label(vertex v) const
+    {
+        if (opt_.labels == 0)
+          return 0;
+        vertex_labels::const_iterator p = opt_.labels->find(v);
+        return (p == opt_.labels->end() ? 0 : &p->second);
+    }
+
+    void vertex_line(size_t i, text_buffer &b) const
+    {
+        const vertex v = R_.node(i);
+        if (opt_.format == tgf_format)
+        {
+          const std::string *L = label(v);
+          char *p = format_uint(b.reserve(max_line), v);
+          if (opt_.labels == 0)
+          {
+            *p++ = ' ';
+            p = format_uint(p, v);
+          }
+          b.commit(p);
+          if (L)
+          {
+            b.put(" ", 1);
+            b.put(*L);
+          }
+          b.put("\n", 1);
+        }
+        else if (opt_.format == pajek_format)
+        {
+          const std::string *L = label(v);
+          char *p = format_uint(b.reserve(max_line), i + 1);
+          *p++ = ' ';
+          *p++ = '"';
+          if (L == 0)
+            p = format_uint(p, v);
+          b.commit(p);
+          if (L)
+            b.put(*L);
+          b.put("\"\n", 2);
+        }
+        else if (R_.isolated(i))                // dot, udot
+        {
+          b.commit(format_uint(b.reserve(max_line), v));
+          b.put(";\n", 2);
+        }
+    }
+
+    void edge_lines(size_t i, text_buffer &b) const
+    {
+        const vertex v = R_.node(i);
+        if (opt_.format == g_format && R_.isolated(i))
+        {
+          char *p = format_uint(b.reserve(max_line), v);
+          *p++ = '\n';
+          b.commit(p);
+          return;
+        }
+
+        // the part of each line before the neighbor, formatted once
+        char prefix[max_line];
+        char *e = prefix;
+        const char *suffix = "\n";
+        if (opt_.format == mtx_format)
+          e = format_uint(e, v + mtx_shift_);
+        else if (opt_.format == pajek_format)
+          e = format_uint(e, i + 1);
+        else
+          e = format_uint(e, v);
+        if (opt_.format == dot_format)
+        {
+          memcpy(e, "->", 2);
+          e += 2;
+          suffix = " ;\n";
+        }
+        else if (opt_.format == udot_format)
+        {
+          memcpy(e, "--", 2);
+          e += 2;
+          suffix = " ;\n";
+        }
+        else
+          *e++ = ' ';
+        const size_t prefix_len = e - prefix;
+        const size_t suffix_len = strlen(suffix);
+
+        for (const_iterator q = R_.out_begin(i); q != R_.out_end(i); q++)
+        {
+          if (opt_.format == udot_format && *q < v)
+            continue;
+          uint64_t w = *q;
+          if (opt_.format == mtx_format)
+            w += mtx_shift_;
+          else if (opt_.format == pajek_format)
+            w = R_.position(*q) + 1;
+          char *p = b.reserve(max_line);
+          memcpy(p, prefix, prefix_len);
+          p = format_uint(p + prefix_len, w);
+          memcpy(p, suffix, suffix_len);
+          b.commit(p + suffix_len);
+        }
+    }
+
+    // one line (or set of lines) per row, formatted in parallel chunks
+    // and written in order
+    bool write_rows(graph_sink &out, bool vertices) const
+    {
+        const size_t n = R_.size();
+        const size_t chunk = std::max((size_t) 1, opt_.chunk_rows);
+        int num_threads = 1;
+#ifdef _OPENMP
+        num_threads = omp_get_max_threads();
+#endif
+        std::vector<text_buffer> B(num_threads);
+
+        for (size_t first=0; first<n; first += num_threads * chunk)
+        {
+#ifdef _OPENMP
+          #pragma omp parallel for schedule(static, 1)
+#endif
+          for (int c=0; c<num_threads; c++)
+          {
+            B[c].clear();
+            const size_t lo = std::min(n, first + c * chunk);
+            const size_t hi = std::min(n, lo + chunk);
+            for (size_t i=lo; i<hi; i++)
+              if (vertices)
+                vertex_line(i, B[c]);
+              else
+                edge_lines(i, B[c]);
+          }
+          for (int c=0; c<num_threads; c++)
+            if (!out.write(B[c]))
+              return false;
+        }
+        return true;
+    }
+
+    bool put(graph_sink &out, const char *s) const
+    {
+        return out.write(s, strlen(s));
+    }
+
+  public:
+
+    graph_writer(const Rows &R, const write_options &opt) : R_(R), opt_(opt),
+        mtx_shift_(0)
+    {
+        // MatrixMarket indices are 1-based: vertex ids are used as they
+        // are, unless there is a vertex 0 (see g2mtx)
+        if (R_.size() > 0 && R_.node(0) == 0)
+          mtx_shift_ = 1;
+    }
+
+    bool write(graph_sink out) const
+    {
+        char line[3 * 20 + 8];
+        bool ok = true;
+        switch (opt_.format)
+        {
+          case g_format:
+            ok = write_rows(out, false);
+            break;
+
+          case mtx_format:
+          {
+            const uint64_t rows = (R_.size() == 0 ? 0 :
+                  R_.node(R_.size() - 1) + mtx_shift_);
+            char *p = format_uint(line, rows);
+            *p++ = ' ';
+            p = format_uint(p, rows);
+            *p++ = ' ';
+            p = format_uint(p, R_.num_edges());
+            *p++ = '\n';
+            ok = put(out, "%%MatrixMarket matrix coordinate pattern general\n")
+                  && out.write(line, p - line) && write_rows(out, false);
+            break;
+          }
+
+          case tgf_format:
+            ok = write_rows(out, true) && put(out, "#\n") &&
+                  write_rows(out, false);
+            break;
+
+          case dot_format:
+          case udot_format:
+            ok = put(out, opt_.format == dot_format ? "digraph G{\n" :
+                  "graph G{\n") && write_rows(out, true) &&
+                  write_rows(out, false) && put(out, "}\n");
+            break;
+
+          case pajek_format:
+          {
+            char *p = format_uint(line, R_.size());
+            *p++ = '\n';
+            ok = put(out, "*Vertices ") && out.write(line, p - line) &&
+                  write_rows(out, true) && put(out, "*Arcs\n") &&
+                  write_rows(out, false);
+            break;
+          }
+        }
+        return out.flush() && ok;
+    }
+};
+
+
+/**
+    Write the graph given by the row adapter R (see indexed_rows).
+*/
+template <class Rows>
+bool write_rows(graph_sink out, const Rows &R, const write_options &opt,
+      std::string &error)
+{
+    if (!graph_writer<Rows>(R, opt).write(out))
+    {
+      error = "write failed";
+      return false;
+    }
+    return true;
+}
+
+
+/**
+    Vertex types that graph_writer formats itself (with format_uint):
+    the unsigned integral ones.  Others, such as negative ints or
+    strings, are written through their operator<<.
+*/
+template <typename T>
+struct buffered_format { enum { value = 0 }; };
+
+template <> struct buffered_format<unsigned short> { enum { value = 1 }; };
+template <> struct buffered_format<unsigned int> { enum { value = 1 }; };
+template <> struct buffered_format<unsigned long> { enum { value = 1 }; };
+
+template <int> struct format_tag {};
+
+template <class Rows>
+void write_g(std::ostream &s, const Rows &R, format_tag<1>)
+{
+    std::string error;
+    write_rows(s, R, write_options(g_format), error);
+}
+
+template <class Rows>
+void write_g(std::ostream &s, const Rows &R, format_tag<0>)
+{
+    for (size_t i=0; i<R.size(); i++)
+    {
+      const typename Rows::vertex &v = R.node(i);
+      if (R.isolated(i))
+        s << v << "\n";
+      else
+        for (typename Rows::const_iterator q = R.out_begin(i);
+                q != R.out_end(i); q++)
+          s << v << " " << *q << "\n";
+    }
+}
+
+/**
+    Write the graph given by R as a .g edge list: buffered, in parallel,
+    when its vertices are unsigned integers, and line by line otherwise.
+*/
+template <class Rows>
+void write_g(std::ostream &s, const Rows &R)
+{
+    write_g(s, R, format_tag<buffered_format<typename Rows::vertex>::value>());
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_WRITE_H_
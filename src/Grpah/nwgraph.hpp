@@ -25,937 +25,515 @@
 #define NWGRAPH_H_
 
 
-// DIRECTED WEIGHTED GRAPH (both node and edge, with in-out adjacency list)
+// STATIC DIRECTED WEIGHTED GRAPH (both node and edge, with in-out adjacency)
 //
 
+#include <cstdio>
 #include <iostream>
-#include <set>
-#include <map>
-#include <utility>      // for std::pair
-#include <iterator>     // for inserter()
-#include <vector>       // for exporting edge_list
 #include <string>
+#include <vector>
+#include <utility>
 #include <algorithm>
-#include <sstream>      // for I/O << and >> operators
-#include "set_ops.hpp"
-#include "ngraph_version.h"
+#include <stdint.h>
+#include "ngraph_static.hpp"
+#include "mapped_file.hpp"
+#include "mtx_io.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 //
-// T is the vertex type
+// T is the vertex type, EW the edge weight and NW the node weight type.
 //
-//  An adjacency graph format lists for each vertex, a set of neighbors
-//  the it connects to (outlinks) and optionally another set of neighbors
-//  which connect to it.  (The second set provides a quick way to find
-//  out who is pointing to you.)
+// nwGraph is the weighted counterpart of static_tGraph: vertices are
+// 0..num_vertices()-1, out- and in-edges are kept in compressed sparse
+// row form, and edge weights are stored in arrays parallel to the CSR
+// targets (structure of arrays), so that
 //
-//     vertex  {out-neighbors}  {in-neighbors}
+//      out_neighbors_begin(v)[k]  has weight  out_weights_begin(v)[k]
+//
+// Node weights are a dense array (default 1).
+//
+// Weighted graphs are usually built from edge lists with repeats (e.g.
+// co-purchases, or the edges between two clusters of a coarsened
+// graph); by default, parallel edges are combined into one, with the
+// sum of their weights, so that the multiplicity of an unweighted edge
+// becomes its weight.  Where weights are lengths (shortest paths), they
+// are instead combined by their minimum, or all kept (see
+// parallel_edges below).
+//
+// Text form (.wg): one "from to weight" line per edge, where a missing
+// weight means 1 and a line with a single vertex is an isolated vertex,
+// as in .g files.  Binary form: a .csr file with a values section (see
+// ngraph_static.hpp); node weights are not stored.
 //
 
-/**
-
-    @brief A mathematical graph object: a simple, directed, connected graph, 
-    where nodes are of arbitrary type (colores, cities, names, etc.)  
-    Operations for adding and removing edges and vertices, together with
-    functions for finding neighbors, subgraphs, and other properties are
-    included.
-
-   Example:
-
-
-<pre>
-    enum color {blue, green, red, yellow, pink, black};
-    tGraph<color> A;
-
-    A.insert_edge(blue, red);
-    A.insert_edge(yellow, blue);
-    A.insert_edge(blue, black);
-
-    tGraph<color> B(A), S=A.subgraph(blue);
-
-</pre>
-
-
-*/
 namespace NGraph
 {
 
-template <typename node_T, w_node_T, w_edge_T>
-class tGraph
+// what becomes of parallel edges (i,j) when building an nwGraph
+//
+enum parallel_edges
 {
+    keep_parallel_edges,        // all kept, as separate edges
+    sum_parallel_edges,         // one edge, with the sum of the weights
+    min_parallel_edges          // one edge, with the smallest weight
+};
+
 
+template <typename T, typename EW = double, typename NW = double>
+class nwGraph
+{
   public:
 
-    typedef node_T vertex;
-    typedef struct { vertex node_id; w_node_T node_weight } weighted_vertex;
+    typedef T vertex;
+    typedef EW edge_weight;
+    typedef NW node_weight;
     typedef std::pair<vertex,vertex> edge;
-    typdef struct { vertex node_id; w_edge_T edge_weight } weighted_edge;
-    typedef std::set<vertex> vertex_set;
-    typedef std::set<weighted_edge> weighted_edge_set;
-    typedef struct { weighted_edge_set in; weighted_edge_set out } 
-          in_out_weighted_edge_sets;
-    typedef std::map<vertex, in_out_weighted_edge_sets>  adj_graph;
-
-    typedef typename weighted_edge_set::iterator edge_iterator;
-    typedef typename weighted_edge_set::const_iterator const_edge_iterator;
-
-    typedef typename vertex_set::iterator vertex_iterator;
-    typedef typename vertex_set::const_iterator const_vertex_iterator;
 
-    typedef typename vertex_set::iterator vertex_neighbor_iterator;
-    typedef typename vertex_set::const_iterator vertex_neighbor_const_iterator;
+    // iterate over the (sorted) neighbors of one vertex, and over their
+    // edge weights in the same order
+    typedef const T * const_iterator;
+    typedef const EW * const_weight_iterator;
 
   private:
-  
-    adj_graph G_;
-    unsigned int num_edges_;
-    bool undirected_;
 
-  public:
-
-    // 
-    //
-
-    /**
-      tGraph::iterator refers to pair<const vertex, in_out_edge_sets> .
-
-<pre>
-      tGraph::const_iterator p = G.begin();
-      
-      tGraph::vertex a = node(p);
-      tGraph::vertex_set  &in_edges = in_neighbors(p);
-      tGraph::vertex_set  &out_edges = out_neighbors(p);
-
-</pre>
-    */
-
-    typedef typename adj_graph::iterator iterator;
-    typedef typename adj_graph::const_iterator const_iterator;
-
-    typedef iterator node_iterator;
-    typedef const_iterator const_node_iterator;
-
-    unsigned int num_vertices() const { return G_.size(); }
-    unsigned int num_nodes() const { return G_.size(); }
-    unsigned int num_edges() const { return num_edges_; }
+    T num_vertices_;
+    std::vector<size_t> out_rows_;
+    std::vector<T> out_edges_;
+    std::vector<EW> out_weights_;
+    std::vector<size_t> in_rows_;
+    std::vector<T> in_edges_;
+    std::vector<EW> in_weights_;
+    std::vector<NW> node_weights_;
 
-    iterator begin() { return G_.begin(); }
-    const_iterator begin() const { return G_.begin(); }
-    iterator end() { return G_.end(); }
-    const_iterator end() const { return G_.end(); }
-   
-    weighted_edge_iterator out_neighbors_begin(const vertex &a)
+    template <typename V>
+    static const V *data(const std::vector<V> &v)
     {
-      return in_neighbors(a).begin();
+        return (v.empty() ? 0 : &v[0]);
     }
 
-    weighted_edge_const_iterator out_neighbors_begin(const vertex &a) const
-    {
-      return in_neighbors(a).begin();
-    }
-
-    vertex_neighbor_iterator out_neighbors_end(const vertex &a)
-    {
-      return out_neighbors(a).end();
-    }
+    // CSR arrays from coordinate lists; unless combine is
+    // keep_parallel_edges, repeated (i,j) become one edge with the sum
+    // (or minimum) of their weights
+    //
+    static void build_rows(size_t n, const std::vector<T> &from,
+          const std::vector<T> &to, const std::vector<EW> &w,
+          parallel_edges combine,
+          std::vector<size_t> &rows, std::vector<T> &edges,
+          std::vector<EW> &weights)
+    {
+        std::vector<size_t> perm;
+        build_csr(n, from, to, rows, edges, &perm);
+        weights.resize(perm.size());
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+#endif
+        for (long k=0; k<(long) perm.size(); k++)
+          weights[k] = (w.empty() ? EW(1) : w[perm[k]]);
+        std::vector<size_t>().swap(perm);
 
-    vertex_neighbor_const_iterator out_neighbors_end(const vertex &a) const
-    {
-      return out_neighbors(a).end();
-    }
-    
-    
-    tGraph(): G_(), num_edges_(0), undirected_(false){}
-    tGraph(const tGraph &B) : G_(B.G_), num_edges_(B.num_edges_), 
-          undirected_(B.undirected_){}
-    tGraph(const edge_set &E)
-    {
-      for (typename edge_set::const_iterator p = E.begin(); p != E.end(); p++)
-        insert_edge(*p);
-    }
+        if (combine == keep_parallel_edges)
+          return;
 
-    bool is_undirected() const
-    {
-       return undirected_;
+        std::vector<size_t> degree(n + 1, 0);
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 1024)
+#endif
+        for (long i=0; i<(long) n; i++)
+          for (size_t k=rows[i]; k<rows[i+1]; k++)
+            if (k == rows[i] || edges[k] != edges[k-1])
+              degree[i+1]++;
+        for (size_t i=0; i<n; i++)
+          degree[i+1] += degree[i];
+        if (degree[n] == edges.size())
+          return;
+
+        std::vector<T> new_edges(degree[n]);
+        std::vector<EW> new_weights(degree[n]);
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 1024)
+#endif
+        for (long i=0; i<(long) n; i++)
+        {
+          size_t j = degree[i];
+          for (size_t k=rows[i]; k<rows[i+1]; k++)
+          {
+            if (k == rows[i] || edges[k] != edges[k-1])
+            {
+              new_edges[j] = edges[k];
+              new_weights[j++] = weights[k];
+            }
+            else if (combine == sum_parallel_edges)
+              new_weights[j-1] += weights[k];
+            else if (weights[k] < new_weights[j-1])
+              new_weights[j-1] = weights[k];
+          }
+        }
+        rows.swap(degree);
+        edges.swap(new_edges);
+        weights.swap(new_weights);
     }
 
-
-    bool is_directed() const
+    // in-edges (and their weights) are the transpose of the out-edges
+    //
+    void build_in_edges()
     {
-        return !undirected_;
+        std::vector<T> from(out_edges_.size());
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 1024)
+#endif
+        for (long i=0; i<(long) num_vertices_; i++)
+          for (size_t k=out_rows_[i]; k<out_rows_[i+1]; k++)
+            from[k] = (T) i;
+        build_rows(num_vertices_, out_edges_, from, out_weights_,
+              keep_parallel_edges, in_rows_, in_edges_, in_weights_);
     }
 
-     iterator find(const vertex &a)
-     {
-        return G_.find(a);
-     }
-
-     const_iterator find(const vertex  &a) const
-     {
-        return G_.find(a);
-     }
-
-    const vertex_set &in_neighbors(const vertex &a) const
-              { return (find(a))->second.in;}
-          vertex_set &in_neighbors(const vertex &a)      
-              { return (G_[a]).in; }
-
-    const vertex_set &out_neighbors(const vertex &a)const
-                {return find(a)->second.out;}
-          vertex_set &out_neighbors(const vertex &a)      
-                {return G_[a].out; }
-
-
-     unsigned int in_degree(const vertex &a) const
-     {
-        return in_neighbors(a).size();
-     }
-
-     unsigned int out_degree(const vertex &a) const
-     {
-        return out_neighbors(a).size();
-     }
-
-     unsigned int degree(const vertex &a) const
-     {
-        return out_neighbors(a).size();
-     }
+  public:
 
+    nwGraph() : num_vertices_(0), out_rows_(1, 0), out_edges_(),
+        out_weights_(), in_rows_(1, 0), in_edges_(), in_weights_(),
+        node_weights_() {}
 
-    bool isolated(const vertex &a) const
-    {
-        const_iterator p = find(a);
-        if ( p != end() )
-          return  isolated(p) ;
-        else
-            return false;
-    }
+    /**
+        Build from an edge list, given as parallel from/to/weight arrays
+        (an empty weight array means weight 1 for every edge).
 
-    void insert_vertex(const vertex &a)
+        @param combine  merge parallel edges, adding up their weights
+                        (or taking the smallest), or keep them all
+    */
+    nwGraph(T num_vertices, const std::vector<T> &from,
+        const std::vector<T> &to, const std::vector<EW> &weights,
+        parallel_edges combine = sum_parallel_edges) :
+        num_vertices_(num_vertices), out_rows_(),
+        out_edges_(), out_weights_(), in_rows_(), in_edges_(), in_weights_(),
+        node_weights_(num_vertices, NW(1))
     {
-      G_[a];
+        build_rows(num_vertices_, from, to, weights, combine, out_rows_,
+              out_edges_, out_weights_);
+        build_in_edges();
     }
 
-    void insert_new_vertex_inout_list(const vertex &a, const vertex_set &IN,
-              const vertex_set &OUT)
+    /**
+        An unweighted graph, with all weights 1.
+    */
+    explicit nwGraph(const static_tGraph<T> &G) :
+        num_vertices_(G.num_vertices()), out_rows_(G.out_offsets()),
+        out_edges_(G.out_targets()), out_weights_(G.num_edges(), EW(1)),
+        in_rows_(), in_edges_(), in_weights_(),
+        node_weights_(G.num_vertices(), NW(1))
     {
-      typename adj_graph::iterator p = find(a);
-
-      // exit if "a" already in graph
-      if (p != G_.end())
-      {
-            // remove the old number of OUT vertices
-            num_edges_ -= p->second.second.size();
-      }
-
-      G_[a] = make_pair(IN, OUT);
-      num_edges_ += OUT.size();
+        build_in_edges();
     }
 
-
-
-    void insert_edge_noloop(iterator pa, iterator pb)
+    /**
+        Take over existing CSR arrays (which are left empty); each row of
+        targets must be sorted, and weights parallel to targets.
+    */
+    void assign(T num_vertices, std::vector<size_t> &offsets,
+          std::vector<T> &targets, std::vector<EW> &weights)
     {
-      if (pa==pb) return;
-      insert_edge(pa, pb);
+        num_vertices_ = num_vertices;
+        out_rows_.swap(offsets);
+        out_edges_.swap(targets);
+        out_weights_.swap(weights);
+        if (out_weights_.size() != out_edges_.size())
+          out_weights_.assign(out_edges_.size(), EW(1));
+        std::vector<size_t>(1, 0).swap(offsets);
+        std::vector<T>().swap(targets);
+        std::vector<EW>().swap(weights);
+        node_weights_.assign(num_vertices_, NW(1));
+        build_in_edges();
     }
 
-    void insert_edge(iterator pa, iterator pb)
-    {
-      vertex a = node(pa);
-      vertex b = node(pb);
-
-      if (is_undirected())
-      {
-          vertex smallest = ( a < b ? a : b);
-          //vertex biggest =  ( a < b ? b : a);
-
-          if (smallest == b)
-          {
-              std::swap(a,b);
-              std::swap(pa, pb);
-          }
-      }
-      unsigned int old_size = out_neighbors(pa).size();
-
-      out_neighbors(pa).insert(b);
-      in_neighbors(pb).insert(a);
-
-      unsigned int new_size = out_neighbors(a).size();
-      if (new_size > old_size)
-      {
-          num_edges_++;
-      }
+    unsigned int num_vertices() const { return num_vertices_; }
+    unsigned int num_nodes() const { return num_vertices_; }
+    size_t num_edges() const { return out_edges_.size(); }
 
-    }
+    size_t out_degree(T i) const { return out_rows_[i+1] - out_rows_[i]; }
+    size_t in_degree(T i) const { return in_rows_[i+1] - in_rows_[i]; }
+    size_t degree(T i) const { return out_degree(i); }
 
-    void insert_edge_noloop(const vertex &a, const vertex &b)
+    bool isolated(T i) const
     {
-      if (a==b) return;
-      insert_edge(a, b);
+        return out_degree(i) == 0 && in_degree(i) == 0;
     }
 
-
-    void insert_edge(const vertex &a, const vertex& b)
+    const_iterator out_neighbors_begin(T i) const
     {
-      iterator pa = find(a);
-      if (pa == G_.end())
-      {
-          insert_vertex(a);
-          pa = find(a);
-      }
-
-      iterator pb = find(b);
-      if (pb == G_.end())
-      {
-          insert_vertex(b);
-          pb = find(b);
-      }
-      
-      insert_edge( pa, pb );
+        return data(out_edges_) + out_rows_[i];
     }
-
-   void insert_undirected_edge(const vertex &a, const vertex &b)
-   {
-      (a < b ) ?  insert_edge(a,b) : insert_edge(b,a);
-   }
-
-
-    void insert_edge(const edge &E)
+    const_iterator out_neighbors_end(T i) const
     {
-        insert_edge(E.first, E.second);
+        return data(out_edges_) + out_rows_[i+1];
     }
-
-    void insert_undirected_edge(const edge &E)
+    const_weight_iterator out_weights_begin(T i) const
     {
-      insert_undirected_edge(E.first, E.second);
+        return data(out_weights_) + out_rows_[i];
     }
 
-   
-
-    void remove_edge(iterator pa, iterator pb)
+    const_iterator in_neighbors_begin(T i) const
     {
-      if (pa == end() || pb == end())
-        return;
-
-      unsigned int old_size = out_neighbors(pa).size();
-      out_neighbors(pa).erase(node(pb));
-      in_neighbors(pb).erase(node(pa));
-      if (out_neighbors(pa).size() < old_size)
-        num_edges_ --;
-
+        return data(in_edges_) + in_rows_[i];
     }
-   
-
-    void remove_edge(const vertex &a, const vertex& b)
+    const_iterator in_neighbors_end(T i) const
     {
-      iterator pa = find(a);
-      if (pa != end())
-        return;
-      iterator pb = find(b);
-      if (pb != end())
-        return;
-      remove_edge( pa, pb );
+        return data(in_edges_) + in_rows_[i+1];
     }
-
-    void remove_edge(const edge &E)
+    const_weight_iterator in_weights_begin(T i) const
     {
-        remove_edge(E.first, E.second);
+        return data(in_weights_) + in_rows_[i];
     }
 
-    void remove_undirected_edge(const vertex &a, const vertex& b)
-    {
-      (a < b) ? remove_edge(a,b) : remove_edge(b,a);
-    }
+    /** raw CSR arrays (out-edges) */
+    const std::vector<size_t> &out_offsets() const { return out_rows_; }
+    const std::vector<T> &out_targets() const { return out_edges_; }
+    const std::vector<EW> &out_weights() const { return out_weights_; }
 
-    void remove_undirected_edge(const edge &e)
-    {
-      remove_undirected_edge(e.first, e.second);
-    }
+    const NW &weight(T i) const { return node_weights_[i]; }
+    void set_weight(T i, const NW &w) { node_weights_[i] = w; }
+    const std::vector<NW> &node_weights() const { return node_weights_; }
+    std::vector<NW> &node_weights() { return node_weights_; }
 
-    void remove_vertex(iterator pa)
+    /** sum of the weights of the out-edges of i */
+    EW out_strength(T i) const
     {
-      vertex_set  out_edges = out_neighbors(pa);
-      vertex_set  in_edges =  in_neighbors(pa);
-
-      //vertex_set & out_edges = out_neighbors(pa);
-      //vertex_set & in_edges =  in_neighbors(pa);
-
-      // remove out-going edges
-      for (typename vertex_set::iterator p = out_edges.begin(); 
-                  p!=out_edges.end(); p++)
-      {
-          remove_edge(pa, find(*p));
-      }
-
-
-      // remove in-coming edges
-      for (typename vertex_set::iterator p = in_edges.begin(); 
-                  p!=in_edges.end(); p++)
-      {
-          remove_edge(find(*p), pa);
-      }
-
-
-      G_.erase(node(pa));
+        EW s = EW(0);
+        for (size_t k=out_rows_[i]; k<out_rows_[i+1]; k++)
+          s += out_weights_[k];
+        return s;
     }
 
-
-    void remove_vertex_set(const vertex_set &V)
+    /** sum of the weights of the in-edges of i */
+    EW in_strength(T i) const
     {
-        for (typename vertex_set::const_iterator p=V.begin(); p!=V.end(); p++)
-          remove_vertex(*p);
+        EW s = EW(0);
+        for (size_t k=in_rows_[i]; k<in_rows_[i+1]; k++)
+          s += in_weights_[k];
+        return s;
     }
 
+    bool includes_vertex(T a) const { return a < num_vertices_; }
 
-    void remove_vertex(const vertex &a)
+    bool includes_edge(T a, T b) const
     {
-        iterator pa = find(a);
-        if (pa != G_.end())
-            remove_vertex( pa);
-
+        return includes_vertex(a) && std::binary_search(
+              out_neighbors_begin(a), out_neighbors_end(a), b);
     }
 
-  /**
-        Is vertex 'a' included in graph?
-
-        @return true, if vertex a is present; false, otherwise.
-  */
-   bool includes_vertex(const vertex &a) const
-   {
-        return  (find(a) != G_.end());
-   }
-
-
-   /**
-        Is edge (a,b) included in graph?
-
-        @return true, if edge is present; false, otherwise.
-
-   */
-   bool includes_edge(const vertex &a, const vertex &b) const
-   {
-      return (includes_vertex(a)) ? 
-          includes_elm(out_neighbors(a),b): false;
-      
-      //const vertex_set &out = out_neighbors(a);
-      // return ( out.find(b) != out.end());
-
-   }
-
-  
-  bool includes_edge(const edge& e) const
-  {
-    return includes_edge(e.first, e.second);
-  }
-
-    // convert to a simple edge list for exporting
-    //
     /**
-        Create a new representation of graph as a list
-        of vertex pairs (a,b).
-
-        @return std::vector<edge> a vector (list) of vertex pairs
+        @return true (and w) if edge (a,b) is present.
     */
-    std::vector<edge> edge_list() const;
-
-/*
-    graph unions
-*/
-
-    tGraph & plus_eq(const tGraph &B) 
-    {
-
-        for (const_iterator p=B.begin(); p != B.end(); p++)
-        {
-            const vertex &this_node = node(p);
-            insert_vertex(this_node);
-            const vertex_set &out = out_neighbors(p);
-            for (typename vertex_set::const_iterator q= out.begin(); q != out.end(); q++)
-            {
-                insert_edge(this_node, *q); 
-            }
-        }
-        return *this;
-    }
-
-    tGraph intersect(const tGraph &B) const  
-    {
-        tGraph G;
-        for (const_iterator p=begin(); p != end(); p++)
-        {
-            const vertex &this_node = node(p);
-            if (B.includes_vertex(this_node))
-                 G.insert_vertex(this_node);
-            {
-               const vertex_set &out = out_neighbors(p);
-               for (typename vertex_set::const_iterator q= out.begin(); 
-                          q != out.end(); q++)
-               {
-                   if (B.includes_edge(this_node, *q))
-                    G.insert_edge(this_node, *q);
-               }
-            }
-          }
-          return G;
-    }
-
-    tGraph operator*(const tGraph &B) const
-    {
-      return intersect(B);
-    }
-
-
-    tGraph minus(const tGraph &B) const
-    {
-        tGraph G;
-        for (const_iterator p=begin(); p != end(); p++)
-        {
-            const vertex &this_vertex = node(p);
-            if (isolated(p)) 
-            {
-              if (! B.isolated(this_vertex))
-                  G.insert_vertex(this_vertex);\
-            }
-            else
-            {
-               const vertex_set &out = out_neighbors(p);
-               for (typename vertex_set::const_iterator q= out.begin(); 
-                        q != out.end(); q++)
-               {
-                   if (!B.includes_edge(this_vertex, *q))
-                    G.insert_edge(this_vertex, *q);
-               }
-            }
-          }
-          return G;
-      }
-
-    tGraph operator-(const tGraph &B) const
+    bool find_edge(T a, T b, EW &w) const
     {
-      return minus(B);
+        if (!includes_vertex(a))
+          return false;
+        const_iterator p = std::lower_bound(out_neighbors_begin(a),
+              out_neighbors_end(a), b);
+        if (p == out_neighbors_end(a) || *p != b)
+          return false;
+        w = out_weights_begin(a)[p - out_neighbors_begin(a)];
+        return true;
     }
 
-
-    tGraph plus(const tGraph &B) const  
-    {
-        tGraph U(*this);
-
-        U.plus_eq(B);
-        return U;
-    }
-
-    tGraph operator+(const tGraph &B) const
+    /**
+        Save as a binary .csr file, with the edge weights as values.
+    */
+    bool save(FILE *f) const
     {
-      return plus(B);
+        std::vector<double> values(out_weights_.begin(), out_weights_.end());
+        return write_csr_file(f, num_vertices_, out_rows_, out_edges_,
+              &values);
     }
 
-    tGraph & operator+=(const tGraph &B) 
-    {
-      return plus_eq(B);
+    /**
+        Load a binary .csr file; its values (if any) are the edge
+        weights, otherwise all weights are 1.
+    */
+    bool load(FILE *f, std::string &error)
+    {
+        size_t n = 0;
+        std::vector<size_t> offsets;
+        std::vector<T> targets;
+        std::vector<double> values;
+        if (!read_csr_file(f, n, offsets, targets, error, &values))
+          return false;
+        std::vector<EW> weights(values.begin(), values.end());
+        assign(n, offsets, targets, weights);
+        return true;
     }
+};
+// end nwGraph<T, EW, NW>
 
 
+typedef nwGraph<unsigned int, double, double> nwGraph_d;
 
-#if 0
-/*
-   union of two graphs
-*/
-    tGraph Union(const tGraph &B) const  
-    {
-        tGraph U(B);
-        typedef std::vector<edge> VE;
 
-        VE b = B.edge_list();
-        for (typename VE::cosnt_iterator e = b.begin(); e != b.end(); e++)
-        {
-            U.insert_edge(*e);
-        }
-        return U;
-    }
+/**
+    Parse a weighted edge list ("from to [weight]" lines; see above)
+    from data[0..size), in parallel.  num_vertices is set to one more
+    than the largest vertex seen.
 
-/*
-   intersection of two graphs
+    @return false (with error) on a malformed line
 */
-    tGraph intersect(const tGraph &B) const  
+template <typename T, typename EW>
+bool parse_weighted_edges(const char *data, size_t size, T &num_vertices,
+      std::vector<T> &from, std::vector<T> &to, std::vector<EW> &weights,
+      std::string &error)
+{
+#ifdef _OPENMP
+    const unsigned int num_chunks = omp_get_max_threads();
+#else
+    const unsigned int num_chunks = 1;
+#endif
+    std::vector<const char *> bounds = line_chunks(data, size, num_chunks);
+    std::vector<std::vector<T> > F(num_chunks), To(num_chunks);
+    std::vector<std::vector<EW> > W(num_chunks);
+    std::vector<uint64_t> max_vertex(num_chunks, 0);
+    std::vector<char> any(num_chunks, 0);
+    std::vector<const char *> bad(num_chunks, (const char *) 0);
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1)
+#endif
+    for (int c=0; c<(int) num_chunks; c++)
     {
-        tGraph I;
-        typedef std::vector<tGraph::edge> VE;
-
-        VE b = B.edge_list();
-        for (typename VE::const_iterator e = b.begin(); e != b.end(); e++)
+      const char *p = bounds[c];
+      const char *end = bounds[c+1];
+      while (p < end && bad[c] == 0)
+      {
+        const char *line = p;
+        mtx_skip_blanks(p, end);
+        if (p == end || *p == '\n' || *p == '%' || *p == '#')
         {
-          if (includes_edge(*e))
-          {
-              I.insert_edge(*e);
-          }
+          mtx_skip_line(p, end);
+          continue;
         }
-
-        for (typename tGraph::const_iterator p = B.begin(); p!=B.end();p++)
+        uint64_t a, b;
+        double w = 1.0;
+        if (!mtx_parse_uint(p, end, a))
         {
-          if (includes_vertex( node(p) ))
-                  I.insert_vertex( node(p) );
+          bad[c] = line;
+          break;
         }
-        return I;
-    }
-
-#endif
-
-
-
-  
-/**
-    @param A vertex set of nodes (subset of G)
-    @return a new subgraph containing all nodes of A
-*/
-    tGraph subgraph(const vertex_set &A) const  
-    {
-        tGraph G;
-
-        for (typename vertex_set::const_iterator p = A.begin(); p!=A.end(); p++)
+        any[c] = 1;
+        if (a > max_vertex[c])
+          max_vertex[c] = a;
+        mtx_skip_blanks(p, end);
+        if (p < end && *p != '\n')
         {
-            const_iterator t = find(*p);
-            if (t != end())
-            {
-              vertex_set new_in =  (A * in_neighbors(t));
-              vertex_set new_out = (A * out_neighbors(t));
-
-              G.insert_new_vertex_inout_list(*p, new_in, new_out);
-            }
+          if (!mtx_parse_uint(p, end, b))
+          {
+            bad[c] = line;
+            break;
+          }
+          mtx_skip_blanks(p, end);
+          if (p < end && *p != '\n' && !mtx_parse_double(p, end, w))
+          {
+            bad[c] = line;
+            break;
+          }
+          if (b > max_vertex[c])
+            max_vertex[c] = b;
+          F[c].push_back((T) a);
+          To[c].push_back((T) b);
+          W[c].push_back((EW) w);
         }
-        return G;
+        mtx_skip_line(p, end);
+      }
     }
 
-    
-    unsigned int subgraph_size(const vertex_set &A) const  
-    {
-        unsigned int num_edges = 0;
-        for (typename vertex_set::const_iterator p = A.begin(); p!=A.end(); p++)
-        {
-            num_edges +=  intersection_size(A, out_neighbors(*p) );
-        }
-        return num_edges;
-    }
+    for (unsigned int c=0; c<num_chunks; c++)
+      if (bad[c] != 0)
+      {
+        size_t line = 1 + std::count(data, bad[c], '\n');
+        char buf[32];
+        sprintf(buf, "%lu", (unsigned long) line);
+        error = std::string("line ") + buf + " is not a weighted edge";
+        return false;
+      }
 
-   
-    // we don't need to divide by two since  we are only couting out-edges in subgraph_size()
-    double subgraph_sparsity(const vertex_set &A) const
+    num_vertices = 0;
+    from.clear();
+    to.clear();
+    weights.clear();
+    for (unsigned int c=0; c<num_chunks; c++)
     {
-       double N  = A.size();
-      
-       double sparsity =  (A.size() ==1 ? 0.0 : subgraph_size(A)/(N * (N-1)));
-       if (is_undirected())
-       {
-          sparsity *= 2.0;
-       }
-       return sparsity;
+      if (any[c] && max_vertex[c] + 1 > num_vertices)
+        num_vertices = (T) (max_vertex[c] + 1);
+      from.insert(from.end(), F[c].begin(), F[c].end());
+      to.insert(to.end(), To[c].begin(), To[c].end());
+      weights.insert(weights.end(), W[c].begin(), W[c].end());
     }
-
-  void print() const;
-
-
-/* tGraph iterator methods */
-
-/**
-    @param p tGraph::const_iterator
-*/
-static const vertex &node(const_iterator p) 
-{
-    return p->first;
-}
-
-static const vertex &node(iterator p) 
-{
-    return p->first;
-}
-
-static const vertex &node( const_vertex_iterator p)
-{
-  return *p;
-}
-
-#if 0
-static vertex &node( vertex_iterator p)
-{
-  return *p;
-}
-#endif
-
-static const vertex_set & in_neighbors(const_iterator p)
-    { return (p->second).first; }
-
-static    vertex_set & in_neighbors(iterator p)      
-      { return (p->second).first; }
-
-static const_vertex_iterator in_begin(const_iterator p)
-{
-    return in_neighbors(p).begin();
-}
-
-
-static const_vertex_iterator in_end(const_iterator p)
-{
-    return in_neighbors(p).end();
-}
-
-
-static const vertex_set& out_neighbors(const_iterator p) 
-      { return (p->second).second; }
-
-static const_vertex_iterator out_begin(const_iterator p)
-{
-    return out_neighbors(p).begin();
-}
-
-
-static const_vertex_iterator out_end(const_iterator p)
-{
-    return out_neighbors(p).end();
-}
-
-
-static     vertex_set& out_neighbors(iterator p) 
-      { return (p->second).second; }
-
-static vertex_iterator out_begin(iterator p)
-{
-    return out_neighbors(p).begin();
-}
-
-
-static  unsigned int num_edges(const_iterator p)  
-  {
-     return out_neighbors(p).size();
-  }
-    
-inline static  unsigned int num_edges(iterator p)  
-  {
-     return out_neighbors(p).size();
-  }
-    
-/**
-    @param p tGraph::const_iterator
-    @return number of edges going out (out-degree) at node pointed to by p.
-*/
-inline static  unsigned int out_degree(const_iterator p) 
-  {
-    return (p->second).second.size();
-  }
-
-inline static  unsigned int out_degree(iterator p) 
-  {
-    return (p->second).second.size();
-  }
-
-/**
-    @param p tGraph::const_iterator
-    @return number of edges going out (out-degree) at node pointed to by p.
-*/
-inline static  unsigned int in_degree(const_iterator p) 
-  {
-    return (p->second).first.size();
-  }
-
-inline static  unsigned int in_degree(iterator p) 
-  {
-    return (p->second).first.size();
-  }
-
-static  unsigned int degree(const_iterator p)  
-  {
-     return out_neighbors(p).size();
-  }
-    
-
-inline static bool isolated(const_iterator p)
-{
-    return (in_degree(p) == 0 && out_degree(p) == 0 );
-}
-
-static bool isolated(iterator p)
-{
-    return (in_degree(p) == 0 && out_degree(p) == 0 );
+    return true;
 }
 
 
-
 /**
-      abosrb(a,b):   'a' absorbs 'b', b gets removed from graph
+    Read a weighted graph: a binary .csr file if filename ends in
+    ".csr", otherwise a weighted edge list ("-" is stdin), whose parallel
+    edges are combined as given.  (A .csr file is taken as it is.)
 */
-void absorb(iterator pa, iterator pb)
+template <typename T, typename EW, typename NW>
+bool read_nwgraph(const char *filename, nwGraph<T, EW, NW> &G,
+      std::string &error, parallel_edges combine = sum_parallel_edges)
 {
-
-    //std::cerr << "Graph::absorb(" << node(pa) << ", " << node(pb) << ")\n";
-
-    if (pa == pb)
-      return;
-
-    
-    // first remove edge (a,b) to avoid self-loops
-    remove_edge(pa, pb);
-
-    // chnage edges (b,i) to a(i,j)
-    //
-    {
-    vertex_set b_out = out_neighbors(pb);
-    for (typename vertex_set::iterator p = b_out.begin(); 
-              p!=b_out.end(); p++)
-    {
-      iterator pi = find(*p);
-      remove_edge(pb, pi);
-      //std::cerr<<"\t remove_edge("<<node(pb)<< ", " << node(pi) <<")\n";
-      insert_edge(pa, pi);
-      //std::cerr<<"\t insert_edge("<<node(pa)<< ", " << node(pi) <<")\n";
-    }
-    }
-
-    // change edges (i,b) to (i,a)
+    const std::string name(filename);
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".csr") == 0)
     {
-    vertex_set b_in = in_neighbors(pb);
-    for (typename vertex_set::iterator p = b_in.begin(); 
-              p!=b_in.end(); p++)
-    {
-      iterator pi = find(*p);
-      remove_edge(pi, pb);
-      //std::cerr<<"\t remove_edge("<<node(pi)<< ", " << node(pb) <<")\n";
-      insert_edge(pi, pa);
-      //std::cerr<<"\t insert_edge("<<node(pi)<< ", " << node(pa) <<")\n";
-    }
+      FILE *f = fopen(filename, "rb");
+      if (f == 0)
+      {
+        error = "[" + name + "] could not be opened";
+        return false;
+      }
+      bool ok = G.load(f, error);
+      fclose(f);
+      return ok;
     }
 
-
-    //std::cout<<"\t about to remove vertex: "<< node(pb) << "\n";
-    
-    remove_vertex(pb);
-    //G_.erase( node(pb) );
-
-    //std::cout<<"\t removed_vertex.\n";
-
-
-}
-
-
-void absorb(vertex a, vertex b)
-{
-    if (a == b)
-      return ;
-
-   iterator pa = find(a);
-   if (pa == end())
-      return;
-
-   iterator pb = find(b);
-   if (pb == end())
-      return;
-
-    absorb( pa, pb );
-
-
-}
-
-
-};
-// end tGraph<T>
-
-
-typedef tGraph<unsigned int> Graph;
-typedef tGraph<int> iGraph;
-typedef tGraph<std::string> sGraph;
-
-
-template <class T>
-std::vector<typename tGraph<T>::edge> tGraph<T>::edge_list() const
+    mapped_file in(filename);
+    if (!in.good())
     {
-        //std::vector<tGraph::edge> E(num_edges());
-        std::vector<typename tGraph<T>::edge> E;
-
-        for (typename tGraph::const_iterator p = begin(); p!=end(); p++)
-        {
-            const vertex &a = tGraph::node(p);
-            const vertex_set &out = tGraph::out_neighbors(p);
-            for (typename vertex_set::const_iterator t = out.begin(); 
-                        t != out.end(); t++)
-            {
-                E.push_back( edge(a, *t));
-            }
-        }
-        return E;
+      error = in.error();
+      return false;
     }
-
-// global functions
-//
-
-template <typename T>
-std::istream & operator>>(std::istream &s, tGraph<T> &G)
-{
-    std::string line;
-
-    while (getline(s, line))
+    T n = 0;
+    std::vector<T> from, to;
+    std::vector<EW> weights;
+    if (!parse_weighted_edges(in.data(), in.size(), n, from, to, weights,
+          error))
     {
-      T v1, v2;
-
-      if (line[0] == '%' || line[0] == '#')
-        continue;
-
-      std::istringstream L(line);
-      L >> v1;
-      if (L.eof())
-      {
-          G.insert_vertex(v1);
-      }
-      else
-      {
-        L >> v2;
-        G.insert_edge(v1, v2);
-      }
+      error = "[" + name + "] " + error;
+      return false;
     }
-    return s;
-
+    G = nwGraph<T, EW, NW>(n, from, to, weights, combine);
+    return true;
 }
 
-template <typename T>
-std::ostream & operator<<(std::ostream &s, const tGraph<T> &G)
+
+template <typename T, typename EW, typename NW>
+std::ostream & operator<<(std::ostream &s, const nwGraph<T, EW, NW> &G)
 {
-  for (typename tGraph<T>::const_node_iterator p=G.begin(); p != G.end(); p++)
+  for (T v=0; v<G.num_vertices(); v++)
   {
-    const typename tGraph<T>::vertex_set &out = tGraph<T>::out_neighbors(p);
-    typename tGraph<T>::vertex v = p->first;
-    if (out.size() == 0 && tGraph<T>::in_neighbors(p).size() == 0)
+    if (G.isolated(v))
     {
-      // v is an isolated node
       s << v << "\n";
+      continue;
     }
-    else
-    {
-       for ( typename tGraph<T>::vertex_set::const_iterator q=out.begin(); 
-                q!=out.end(); q++)
-           s << v << " " << *q << "\n";
-    }
+    typename nwGraph<T, EW, NW>::const_weight_iterator w =
+          G.out_weights_begin(v);
+    for (typename nwGraph<T, EW, NW>::const_iterator q =
+            G.out_neighbors_begin(v); q != G.out_neighbors_end(v); q++, w++)
+      s << v << " " << *q << " " << *w << "\n";
   }
   return s;
 }
 
-
-template <typename T>
-void tGraph<T>::print() const 
-    {
-
-       std::cerr << "# vertices: " <<  num_vertices()  << "\n";
-       std::cerr << "# edges:    " <<  num_edges()  << "\n";
-
-        for (const_iterator p=G_.begin(); 
-              p != G_.end(); p++)
-        {
-          const vertex_set   &out =  out_neighbors(p);
-
-          for (typename vertex_set::const_iterator q=out.begin(); 
-                          q!=out.end(); q++)
-              std::cerr << p->first << "  -->  " << *q << "\n";
-        }
-        std::cerr << std::endl;
-
-    }
-
 }
 // namespace NGraph
 
@@ -0,0 +1,336 @@
+#ifndef NWGRAPH_ALGORITHMS_H_
+#define NWGRAPH_ALGORITHMS_H_
+
+/*
+   Algorithms on weighted graphs (nwGraph, see nwgraph.hpp):
+
+        delta_stepping      single-source shortest paths (non-negative
+                            weights), parallel
+        weighted_pagerank   pagerank where each vertex splits its rank
+                            among its out-edges in proportion to their
+                            weights
+        strength_stats      weighted degree (strength) summary
+*/
+
+#include <vector>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <stdint.h>
+#include "nwgraph.hpp"
+#include "ngraph_stats.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+
+// distances are relaxed with a compare-and-swap on their bit patterns,
+// which order like the values themselves for non-negative doubles
+//
+inline uint64_t sssp_bits(double d)
+{
+    uint64_t b;
+    memcpy(&b, &d, sizeof(b));
+    return b;
+}
+
+inline double sssp_value(uint64_t b)
+{
+    double d;
+    memcpy(&d, &b, sizeof(d));
+    return d;
+}
+
+
+/**
+    Single-source shortest paths by delta-stepping (Meyer and Sanders).
+
+    Vertices are kept in buckets of width delta by tentative distance.
+    The lowest non-empty bucket is the frontier: its vertices relax all
+    their out-edges in parallel (each thread collecting the vertices it
+    improved into its own buckets), and the next frontier is the lowest
+    bucket that is non-empty on any thread.  A vertex may be queued more
+    than once; stale entries (whose distance has since dropped below the
+    bucket) are skipped.
+
+    Edge weights must be non-negative.
+
+    @param delta  bucket width; 0 uses the mean edge weight
+    @return the distance to every vertex, infinity for unreachable ones
+*/
+template <typename T, typename EW, typename NW>
+std::vector<double> delta_stepping(const nwGraph<T, EW, NW> &G, T source,
+      double delta = 0.0)
+{
+    const size_t n = G.num_vertices();
+    const double infinity = std::numeric_limits<double>::infinity();
+    std::vector<double> dist(n, infinity);
+    if (source >= n)
+      return dist;
+
+    if (delta <= 0.0)
+    {
+      double total = 0.0;
+      for (size_t k=0; k<G.num_edges(); k++)
+        total += G.out_weights()[k];
+      delta = (G.num_edges() > 0 && total > 0.0 ? total / G.num_edges() : 1.0);
+    }
+
+    std::vector<uint64_t> D(n, sssp_bits(infinity));
+    D[source] = sssp_bits(0.0);
+
+    const size_t no_bucket = (size_t) -1;
+    std::vector<T> frontier(1, source);
+    size_t bucket = 0;
+    size_t next_bucket = no_bucket;
+
+#ifdef _OPENMP
+    const unsigned int num_threads = omp_get_max_threads();
+#else
+    const unsigned int num_threads = 1;
+#endif
+    std::vector<size_t> sizes(num_threads + 1);
+
+    stats::scoped_phase phase("sssp");
+
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(num_threads)
+#endif
+    {
+#ifdef _OPENMP
+      const unsigned int t = omp_get_thread_num();
+#else
+      const unsigned int t = 0;
+#endif
+      std::vector<std::vector<T> > bins;
+
+      while (bucket != no_bucket)
+      {
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 64)
+#endif
+        for (long i=0; i<(long) frontier.size(); i++)
+        {
+          const T u = frontier[i];
+          const double du = sssp_value(D[u]);
+          // settled in an earlier bucket (compared as bucket indices,
+          // computed as when queued: delta * bucket may round past du)
+          if ((size_t) (du / delta) < bucket)
+            continue;
+          stats::edges_scanned() += G.out_degree(u);
+          typename nwGraph<T, EW, NW>::const_weight_iterator w =
+                G.out_weights_begin(u);
+          for (const T *v = G.out_neighbors_begin(u);
+                  v != G.out_neighbors_end(u); v++, w++)
+          {
+            const double nd = du + *w;
+            uint64_t old = D[*v];
+            while (nd < sssp_value(old))
+            {
+              if (__sync_bool_compare_and_swap(&D[*v], old, sssp_bits(nd)))
+              {
+                size_t b = (size_t) (nd / delta);
+                if (b < bucket)
+                  b = bucket;
+                if (b >= bins.size())
+                  bins.resize(b + 1);
+                bins[b].push_back(*v);
+                break;
+              }
+              old = D[*v];
+            }
+          }
+        }
+
+        // lowest non-empty bucket over all threads
+        size_t mine = no_bucket;
+        for (size_t b=bucket; b<bins.size(); b++)
+          if (!bins[b].empty())
+          {
+            mine = b;
+            break;
+          }
+#ifdef _OPENMP
+        #pragma omp critical
+#endif
+        {
+          if (mine < next_bucket)
+            next_bucket = mine;
+        }
+#ifdef _OPENMP
+        #pragma omp barrier
+#endif
+
+        const size_t b = next_bucket;
+        sizes[t+1] = (b != no_bucket && b < bins.size() ? bins[b].size() : 0);
+#ifdef _OPENMP
+        #pragma omp barrier
+        #pragma omp single
+#endif
+        {
+          sizes[0] = 0;
+          for (unsigned int k=0; k<num_threads; k++)
+            sizes[k+1] += sizes[k];
+          frontier.resize(sizes[num_threads]);
+          bucket = next_bucket;
+          next_bucket = no_bucket;
+        }
+
+        if (b != no_bucket && b < bins.size())
+        {
+          std::copy(bins[b].begin(), bins[b].end(), frontier.begin() + sizes[t]);
+          bins[b].clear();
+        }
+#ifdef _OPENMP
+        #pragma omp barrier
+#endif
+      }
+    }
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (long v=0; v<(long) n; v++)
+      dist[v] = sssp_value(D[v]);
+    return dist;
+}
+
+
+/**
+    Weighted pagerank: vertex u passes damping * P[u] to its
+    out-neighbors in proportion to the weights of the edges, so that
+
+        P[v] = (1 - damping) + damping * sum_u P[u] w(u,v) / strength(u)
+
+    (with all weights 1 this is the iteration of pagerank.hpp).  Each
+    iteration updates all vertices from the previous one, in parallel.
+
+    @param iterations_used  set to the number of iterations performed
+    @return P, indexed by vertex
+*/
+template <typename T, typename EW, typename NW>
+std::vector<double> weighted_pagerank(const nwGraph<T, EW, NW> &G,
+      unsigned int &iterations_used, unsigned int max_iterations = 100,
+      double max_delta = 0.01, double damping = 0.85)
+{
+    const long n = G.num_vertices();
+    std::vector<double> P(n, 1.0), Q(n);
+    std::vector<double> inv_strength(n);
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 1024)
+#endif
+    for (long v=0; v<n; v++)
+    {
+      double s = G.out_strength(v);
+      inv_strength[v] = (s > 0.0 ? 1.0 / s : 0.0);
+    }
+
+    stats::scoped_phase phase("pagerank");
+
+    unsigned int i=0;
+    for (; i<max_iterations; i++)
+    {
+      double delta = 0.0;
+
+#ifdef _OPENMP
+      #pragma omp parallel
+#endif
+      {
+        double my_delta = 0.0;
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 1024)
+#endif
+        for (long v=0; v<n; v++)
+        {
+          double sum = 0.0;
+          typename nwGraph<T, EW, NW>::const_weight_iterator w =
+                G.in_weights_begin(v);
+          for (const T *u = G.in_neighbors_begin(v);
+                  u != G.in_neighbors_end(v); u++, w++)
+            sum += P[*u] * (*w) * inv_strength[*u];
+          Q[v] = (1 - damping) + damping * sum;
+          double d = std::fabs((P[v] - Q[v]) / P[v]);
+          if (d > my_delta)
+            my_delta = d;
+        }
+#ifdef _OPENMP
+        #pragma omp critical
+#endif
+        {
+          if (my_delta > delta)
+            delta = my_delta;
+        }
+      }
+      stats::edges_scanned() += G.num_edges();
+
+      P.swap(Q);
+      if (delta <= max_delta)
+        break;
+    }
+    iterations_used = i;
+    return P;
+}
+
+
+/**
+    Summary of the out-strengths (sums of out-edge weights) of a graph.
+*/
+struct strength_summary
+{
+    double total;           // sum of all edge weights
+    double min;
+    double max;
+    double mean;
+    double stddev;
+    size_t max_vertex;      // a vertex of maximum strength
+};
+
+
+template <typename T, typename EW, typename NW>
+strength_summary strength_stats(const nwGraph<T, EW, NW> &G,
+      std::vector<double> &strength)
+{
+    const long n = G.num_vertices();
+    strength.resize(n);
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 1024)
+#endif
+    for (long v=0; v<n; v++)
+      strength[v] = G.out_strength(v);
+
+    strength_summary S;
+    S.total = S.min = S.max = S.mean = S.stddev = 0.0;
+    S.max_vertex = 0;
+    if (n == 0)
+      return S;
+
+    S.min = S.max = strength[0];
+    double sum_sq = 0.0;
+    for (long v=0; v<n; v++)
+    {
+      S.total += strength[v];
+      sum_sq += strength[v] * strength[v];
+      if (strength[v] < S.min)
+        S.min = strength[v];
+      if (strength[v] > S.max)
+      {
+        S.max = strength[v];
+        S.max_vertex = v;
+      }
+    }
+    S.mean = S.total / n;
+    double var = sum_sq / n - S.mean * S.mean;
+    S.stddev = (var > 0.0 ? std::sqrt(var) : 0.0);
+    return S;
+}
+
+}
+// namespace NGraph
+
+#endif
+// NWGRAPH_ALGORITHMS_H_
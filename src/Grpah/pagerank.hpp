@@ -26,6 +26,7 @@ double pagerank_one_iteration(const Graph &G,
        double old_pagerank = P[Graph::node(v)];
 
         const vertex_set &E = Graph::in_neighbors(v);
+        stats::edges_scanned() += E.size();
         for (typename vertex_set::const_iterator e = E.begin(); e!=E.end(); e++)
         {
            sum += P[*e] / G.out_degree(*e);
@@ -64,6 +65,8 @@ map<typename Graph::vertex, double>
          P[Graph::node(i)] = 1;
     }
 
+    stats::scoped_phase phase("pagerank");
+
     unsigned int i=0;    
     for (; i<max_iterations; i++)
     {
@@ -61,211 +61,277 @@ where
      found the review to be helpful)
 
 
+Usage:
+
+    process_amazon [-f category|title|similar|none] [-g graph.g]
+                   [-m products.tsv] [-c categories.tsv] [amazon-meta.txt]
+
+The input (stdin if not given) is parsed in parallel, into columns (see
+amazon_meta.hpp), and then written as
+
+    stdout          one line per product, as chosen by -f:
+                      category:  ASIN "title" [first category]  (default)
+                      title:     ASIN title
+                      similar:   ASIN  similar ASINs...
+    -g graph.g      the co-purchase graph, "Id Id" for each similar
+                    product that is itself listed
+    -m products     Id, ASIN, group, salesrank, category ids (comma-
+                    separated) and title, tab-separated, per product
+    -c categories   category id, number of products and category path,
+                    tab-separated, per category
+
+The header of the file (before the first "Id:") is not a product.
+
+
 */
 
 
-#include <sstream>
-#include <fstream>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <string>
-#include <map>
-#include <set>
 #include <vector>
+#include "mapped_file.hpp"
+#include "amazon_meta.hpp"
+#include "ngraph_write.hpp"
+#include "ngraph_stats.hpp"
 
 using namespace std;
+using namespace NGraph;
 typedef unsigned int Uint;
 
-typedef struct
-{
-  string date;
-  string customer;
-  Uint rating;
-  Uint votes;
-  Uint helpful;
-} amazon_review;
-
-class amazon_record
+
+static void put(text_buffer &b, const str_ref &s)
 {
- public:
-  Uint Id;
-  string ASIN;
-  string title;
-  Uint salesrank;
-  vector<string> similar;
-  vector<string> category;
-  vector<amazon_review> reviews;
-
-  amazon_record(): Id(0), ASIN(), title(), salesrank(0), similar(), reviews() {}
-};
+    b.put(s.data, s.size);
+}
 
-void print_amazon_title(std::ostream &s, const amazon_record &R)
+void print_amazon_title(text_buffer &b, const amazon_products &P, size_t i)
 {
-    s << R.ASIN << " " << R.title << "\n";
+    put(b, P.asin[i]);
+    b.put(" ", 1);
+    put(b, P.title[i]);
+    b.put("\n", 1);
 }
 
-void print_amazon_title_and_category(std::ostream &s, const amazon_record &R)
+void print_amazon_title_and_category(text_buffer &b, const amazon_products &P,
+      size_t i)
 {
-    s << R.ASIN ;
-    if (R.title.size() > 0)
+    put(b, P.asin[i]);
+    if (P.title[i].size > 0)
     {
-      s << " \"" << R.title << "\" ";
+      b.put(" \"", 2);
+      put(b, P.title[i]);
+      b.put("\" ", 2);
     }
-    if (R.category.size() > 0)
+    if (P.num_categories(i) > 0)
     {
-      s << "[" << R.category[0] << "]";
+      b.put("[", 1);
+      put(b, P.categories[P.category[P.category_offset[i]]]);
+      b.put("]", 1);
     }
-    s << "\n";
+    b.put("\n", 1);
 }
 
-void print_amazon_similar(std::ostream &s, const amazon_record &R)
+void print_amazon_similar(text_buffer &b, const amazon_products &P, size_t i)
 {
-    s << R.ASIN << "  ";
-    for (Uint i=0; i< R.similar.size(); i++)
+    put(b, P.asin[i]);
+    b.put("  ", 2);
+    for (size_t k=0; k<P.num_similar(i); k++)
     {
-      s << R.similar[i] << " ";
+      put(b, P.similar_asin(i, k));
+      b.put(" ", 1);
     }
-    s << "\n";
+    b.put("\n", 1);
 }
 
-
-std::ostream & operator<<(std::ostream &s, const amazon_record &R)
+void print_amazon_product(text_buffer &b, const amazon_products &P, size_t i)
 {
-    print_amazon_title_and_category(s, R);
-    return s;
+    char *p = b.reserve(3 * 20 + 4);
+    p = format_uint(p, P.id[i]);
+    *p++ = '\t';
+    b.commit(p);
+    put(b, P.asin[i]);
+    b.put("\t", 1);
+    if (P.group[i] != amazon_products::no_group)
+      put(b, P.groups[P.group[i]]);
+    p = b.reserve(20 + 2);
+    *p++ = '\t';
+    p = format_uint(p, P.salesrank[i]);
+    *p++ = '\t';
+    b.commit(p);
+    for (size_t k=0; k<P.num_categories(i); k++)
+    {
+      p = b.reserve(20 + 1);
+      if (k > 0)
+        *p++ = ',';
+      p = format_uint(p, P.category[P.category_offset[i] + k]);
+      b.commit(p);
+    }
+    b.put("\t", 1);
+    put(b, P.title[i]);
+    b.put("\n", 1);
 }
 
-amazon_record process_amazon_record(istream &f)
+void print_amazon_category(text_buffer &b, const amazon_products &P, size_t k)
 {
-   amazon_record R;
-
-   static const string Id_s = "Id:";
-   static const string ASIN_s = "ASIN:";
-   static const string title_s = "title:";
-   static const string group_s = "group:";
-   static const string salesrank_s = "salesrank:";
-   static const string similar_s = "similar:";
-   static const string categories_s = "categories:";
-   static const string reviews_s = "reviews:";
-
-   bool read_Id = false;
-   bool read_ASIN = false;
-   bool read_title = false;
-   bool read_similar = false;
-   bool read_category = false;
-   
-
-  //cerr << "Inside process_amazon_record(): \n";
-
-   string line;
-
-   /* eat up blank lines, until first non-blank or EOF */
-
-   while (getline(f, line))
-   {
-      //cerr << "line length  = " << line.length() << ": ["<< line << "] \n";
-      if (line.length() > 1)
-                break;
-      //cerr << "ate blank line.\n";
-   }
-  
-   do 
-   {
-      string key;
-
-      if (line.length() <= 1)
-         break;
-
-      stringstream s(line);
-      s >> key;
-
-      if (key == Id_s)
-      {
-          s >> R.Id;
-          read_Id = true;
-      }
-      else if (key == ASIN_s)
-      {
-          s >> R.ASIN;
-          read_ASIN = true;
-      }
+    char *p = b.reserve(2 * 20 + 2);
+    p = format_uint(p, k);
+    *p++ = '\t';
+    p = format_uint(p, P.category_count[k]);
+    *p++ = '\t';
+    b.commit(p);
+    put(b, P.categories[k]);
+    b.put("\n", 1);
+}
 
-      else if (key == title_s)
-      {
-          getline(s, R.title);
-          // trim any leading or whitespace
-          size_t start_pos = R.title.find_first_not_of(" \t\n\r");
-          size_t end_pos =   R.title.find_last_not_of(" \t\n\r");
-          R.title = R.title.substr(start_pos, end_pos);
-          read_title = true;
-      }
-      else if (key == similar_s)
-      {
-        Uint N = 0;
-        s >>  N;
+void print_amazon_edge(text_buffer &b, const amazon_products::edge &e)
+{
+    char *p = b.reserve(2 * 20 + 2);
+    p = format_uint(p, e.first);
+    *p++ = ' ';
+    p = format_uint(p, e.second);
+    *p++ = '\n';
+    b.commit(p);
+}
 
 
-        string item_code;
-        for (Uint i=0; i<N; i++)
-        {
-            s >> item_code;
-            R.similar.push_back(item_code);
-        }
-        read_similar = true;
-      }
-      else if (key == categories_s)
+// write n items with print(b, i), in buffered blocks
+//
+template <class Print>
+bool write_table(graph_sink out, size_t n, Print print)
+{
+    text_buffer b;
+    for (size_t i=0; i<n; i++)
+    {
+      print(b, i);
+      if (b.size() > (1 << 20))
       {
-        Uint N = 0;
-        string category_code;
-
-        s >>  N;
-        
-        //cerr << "\t #category = " << N << ":\n";
-        for (Uint i=0; i<N; i++)
-        {
-            // s >> category_code;
-            // cerr << "\t(" << category_code << ")\n";
-            // R.category.push_back(category_code);
-
-            getline(f, category_code);
-            // trim any leading or whitespace
-            size_t start_pos = category_code.find_first_not_of(" \t\n\r");
-            size_t end_pos =   category_code.find_last_not_of(" \t\n\r");
-            if (start_pos < end_pos)
-              category_code = category_code.substr(start_pos, end_pos);
-            R.category.push_back(category_code);
-
-        }
-        read_category = true;
+        if (!out.write(b))
+          return false;
+        b.clear();
       }
     }
+    return out.write(b) && out.flush();
+}
 
-    while (getline(f, line));
-   
-   //cerr << "Inisde: read R.\n";
-   //cerr << "Inside: " << R;
+// print() adapters for write_table
+//
+struct product_line
+{
+    typedef void (*print_function)(text_buffer &, const amazon_products &,
+          size_t);
+    const amazon_products &P;
+    print_function f;
+    product_line(const amazon_products &p, print_function g) : P(p), f(g) {}
+    void operator()(text_buffer &b, size_t i) const { f(b, P, i); }
+};
 
-   return R;
-}
+struct edge_line
+{
+    const amazon_products &P;
+    edge_line(const amazon_products &p) : P(p) {}
+    void operator()(text_buffer &b, size_t i) const
+    {
+        print_amazon_edge(b, P.edges[i]);
+    }
+};
 
-std::istream & operator>>(std::istream &s, amazon_record &R)
+
+template <class Print>
+bool write_file(const char *filename, size_t n, Print print)
 {
-    //cerr << "inside opeator >> : \n";
-    R = process_amazon_record(s);
-    return s;
+    FILE *f = fopen(filename, "w");
+    if (f == 0)
+      return false;
+    const bool ok = write_table(f, n, print);
+    return (fclose(f) == 0) && ok;
 }
 
 
 int main(int argc, char *argv[])
 {
-  amazon_record R;
+  NGraph::stats::parse_options(argc, argv);
+
+  string format = "category";
+  const char *graph_filename = 0;
+  const char *products_filename = 0;
+  const char *categories_filename = 0;
+  const char *filename = "-";
+  bool usage = false;
 
-  while (cin >> R)
+  for (int i=1; i<argc; i++)
   {
-    cout << R;
+    string a(argv[i]);
+    if (a == "-f" && i+1 < argc)
+      format = argv[++i];
+    else if (a == "-g" && i+1 < argc)
+      graph_filename = argv[++i];
+    else if (a == "-m" && i+1 < argc)
+      products_filename = argv[++i];
+    else if (a == "-c" && i+1 < argc)
+      categories_filename = argv[++i];
+    else if (a[0] != '-' || a == "-")
+      filename = argv[i];
+    else
+      usage = true;
   }
 
+  product_line::print_function print = 0;
+  if (format == "category")
+    print = print_amazon_title_and_category;
+  else if (format == "title")
+    print = print_amazon_title;
+  else if (format == "similar")
+    print = print_amazon_similar;
+  else if (format != "none")
+    usage = true;
+
+  if (usage)
+  {
+    cerr << "Usage: " << argv[0] << " [-f category|title|similar|none] "
+         << "[-g graph.g] [-m products.tsv] [-c categories.tsv] "
+         << "[amazon-meta.txt]\n";
+    return 1;
+  }
 
-  return 0;
-}
+  mapped_file in(filename);
+  if (!in.good())
+  {
+    cerr << "Error: " << in.error() << "\n";
+    return 1;
+  }
 
+  amazon_products P;
+  parse_amazon_meta(in.data(), in.size(), P);
 
+  stats::scoped_phase phase("write");
+  if (print && !write_table(stdout, P.size(), product_line(P, print)))
+  {
+    cerr << "Error: write failed\n";
+    return 1;
+  }
+  if (graph_filename)
+  {
+    if (!write_file(graph_filename, P.edges.size(), edge_line(P)))
+    {
+      cerr << "Error: [" << graph_filename << "] could not be written\n";
+      return 1;
+    }
+    stats::edges_written() += P.edges.size();
+  }
+  if (products_filename && !write_file(products_filename, P.size(),
+        product_line(P, print_amazon_product)))
+  {
+    cerr << "Error: [" << products_filename << "] could not be written\n";
+    return 1;
+  }
+  if (categories_filename && !write_file(categories_filename,
+        P.categories.size(), product_line(P, print_amazon_category)))
+  {
+    cerr << "Error: [" << categories_filename << "] could not be written\n";
+    return 1;
+  }
+
+  return NGraph::stats::finish(0);
+}
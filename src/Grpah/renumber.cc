@@ -1,61 +1,80 @@
-// Given a one-to-one mapping of integers (list of (i,j) pairs, map every i
-// into j from standard input.
+// Given a mapping of integers (list of (i,j) pairs), map every i into j
+// from standard input.
 //
-//  It is assumed the the input file ONLY contains (posivite) integers.
+// Usage:  renumber [-k | -d | -z] [-c column] map_file < input > output
 //
-//  Note: stringstream is needed so that the program respects newlines.  
-//        That is, it can distinguish between .g and .t files.
+//   -k   copy vertices not in the map unchanged
+//   -d   drop lines with vertices not in the map
+//   -z   map vertices not in the map to 0
+//   -c   only renumber the given column (1-based); e.g. -c 2 for the
+//        vertices of a .mi file
+//
+// Without -k, -d or -z, a vertex not in the map is an error.  The map
+// file is a text file of pairs or a binary map (see vertex_map.hpp).
+//
+// Input lines (of a .g, .v, .t, ...) are kept as lines, so it can
+// distinguish between .g and .t files.
 //
 
 #include <string>
-#include <set>
-#include <map>
 #include <iostream>
-#include <sstream>
-#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include "vertex_map.hpp"
+#include "ngraph_stats.hpp"
 
 using namespace std;
+using namespace NGraph;
 
 int main(int argc, char *argv[])
 {
-    typedef unsigned int Int;
+    NGraph::stats::parse_options(argc, argv);
+
+    remap_options opt;
+    parse_unmapped_option(argc, argv, opt);
 
-    if (argc <= 1)
+    const char *filename = 0;
+    bool usage = false;
+    for (int i=1; i<argc; i++)
     {
-        cerr << "Usage: map_filename " << "\n";
+      string a(argv[i]);
+      if (a == "-c" && i+1 < argc)
+      {
+        opt.column = atoi(argv[++i]) - 1;
+        usage = usage || (opt.column < 0);
+      }
+      else if ((a[0] != '-' || a == "-") && filename == 0)
+        filename = argv[i];
+      else
+        usage = true;
     }
 
-    const char *filename = argv[1];
-
-
-    map<Int, Int> M;
-
-    ifstream F;
-    F.open(filename);
-    Int from, to;
-    while (F)
+    if (usage || filename == 0)
     {
-        F >> from >> to;
-        M[from] = to;
+        cerr << "Usage: " << argv[0] << " [-k | -d | -z] [-c column] "
+             << "map_filename < input > output\n";
+        return 1;
     }
-    F.close();
 
-    string line;
-    while (getline(cin,line))
+    vertex_map M;
+    string error;
     {
-        stringstream s(line);
-        while (!s.eof())
-        {
-            Int i;
-            s >> i;
-            cout << M[i] << " ";
-        }
-        cout << "\n";
+      stats::scoped_phase phase("read map");
+      if (!M.read(filename, error))
+      {
+        cerr << "Error: " << error << "\n";
+        return 1;
+      }
     }
 
+    mapped_file in("-");
+    stats::scoped_phase phase("remap");
+    if (!remap_lines(in.data(), in.size(), vertex_mapper(M), opt, stdout,
+            error))
+    {
+        cerr << "Error: " << error << "\n";
+        return 1;
+    }
 
     return 0;
 }
-      
-
-
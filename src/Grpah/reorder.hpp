@@ -0,0 +1,585 @@
+#ifndef NGRAPH_REORDER_H_
+#define NGRAPH_REORDER_H_
+
+/*
+   Vertex reordering for static (CSR) graphs.
+
+   Iterative kernels (pagerank, BFS, triangle counting) touch the
+   neighbors of each vertex, so their memory traffic depends on how
+   close neighboring vertices are numbered.  The orderings here compute
+   a permutation new_id[old] that improves that locality:
+
+        degree_order    by decreasing total degree (hubs first, so that
+                        their data shares a few cache lines)
+        bfs_order       breadth-first, from the highest-degree vertex of
+                        each component
+        rcm_order       reverse Cuthill-McKee, from a pseudo-peripheral
+                        vertex of each component (small bandwidth)
+        gorder          Gorder's window greedy: repeatedly place the
+                        vertex sharing the most neighbors and edges with
+                        the last w placed vertices (Wei et al., 2016)
+
+   BFS and RCM treat the graph as undirected.  A vertex_permutation
+   keeps both directions of the map, and applies it (in parallel) to a
+   static_tGraph, raw CSR arrays (with their edge values) and vertex
+   property arrays; restore() brings results back to the original ids.
+
+   average_log_gap() measures the locality of an ordering: the mean of
+   log2(1 + |gap|) over the sorted neighbor lists (the first gap is taken
+   from the vertex itself), i.e. roughly the number of bits a gap
+   encoding would need per edge.  Lower is better.
+*/
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+#include "ngraph_static.hpp"
+#include "edge_sort.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+
+/**
+    A vertex permutation: new_id(v) for original vertex v, and its
+    inverse old_id(i).
+*/
+template <typename T>
+class vertex_permutation
+{
+  private:
+    std::vector<T> new_id_;
+    std::vector<T> old_id_;
+
+  public:
+
+    vertex_permutation() : new_id_(), old_id_() {}
+
+    /** new_id must be a permutation of 0..new_id.size()-1 */
+    explicit vertex_permutation(const std::vector<T> &new_id) :
+        new_id_(new_id), old_id_(new_id.size())
+    {
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+#endif
+        for (long v=0; v<(long) new_id_.size(); v++)
+          old_id_[new_id_[v]] = (T) v;
+    }
+
+    size_t size() const { return new_id_.size(); }
+
+    T new_id(T v) const { return new_id_[v]; }
+    T old_id(T i) const { return old_id_[i]; }
+
+    const std::vector<T> &new_ids() const { return new_id_; }
+    const std::vector<T> &old_ids() const { return old_id_; }
+
+    /** the inverse permutation */
+    vertex_permutation inverse() const
+    {
+        return vertex_permutation(old_id_);
+    }
+
+    /**
+        Reorder a vertex property array: out[new_id(v)] = in[v].
+    */
+    template <typename V>
+    void apply(const std::vector<V> &in, std::vector<V> &out) const
+    {
+        out.resize(in.size());
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+#endif
+        for (long i=0; i<(long) old_id_.size(); i++)
+          out[i] = in[old_id_[i]];
+    }
+
+    /**
+        Bring a property array indexed by new ids back to the original
+        ones: out[v] = in[new_id(v)].
+    */
+    template <typename V>
+    void restore(const std::vector<V> &in, std::vector<V> &out) const
+    {
+        out.resize(in.size());
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+#endif
+        for (long v=0; v<(long) new_id_.size(); v++)
+          out[v] = in[new_id_[v]];
+    }
+
+    /**
+        Renumber CSR arrays.  Rows are moved to their new positions and
+        targets renumbered and re-sorted, in parallel.  If perm is not 0,
+        (*perm)[k] is the index in the old targets of the edge now stored
+        at new_targets[k], for permuting edge values.
+    */
+    void apply(const std::vector<size_t> &offsets,
+          const std::vector<T> &targets, std::vector<size_t> &new_offsets,
+          std::vector<T> &new_targets, std::vector<size_t> *perm = 0) const
+    {
+        const size_t n = old_id_.size();
+        new_offsets.assign(n + 1, 0);
+        for (size_t i=0; i<n; i++)
+          new_offsets[i+1] = new_offsets[i] +
+                (offsets[old_id_[i] + 1] - offsets[old_id_[i]]);
+
+        new_targets.resize(targets.size());
+        if (perm)
+          perm->resize(targets.size());
+
+#ifdef _OPENMP
+        #pragma omp parallel
+#endif
+        {
+          std::vector<std::pair<T, size_t> > row;
+
+#ifdef _OPENMP
+          #pragma omp for schedule(dynamic, 1024)
+#endif
+          for (long i=0; i<(long) n; i++)
+          {
+            const size_t b = offsets[old_id_[i]];
+            const size_t e = offsets[old_id_[i] + 1];
+            const size_t nb = new_offsets[i];
+            if (perm == 0)
+            {
+              for (size_t k=b; k<e; k++)
+                new_targets[nb + k - b] = new_id_[targets[k]];
+              std::sort(new_targets.begin() + nb,
+                        new_targets.begin() + nb + (e - b));
+              continue;
+            }
+            row.clear();
+            for (size_t k=b; k<e; k++)
+              row.push_back(std::make_pair(new_id_[targets[k]], k));
+            std::sort(row.begin(), row.end());
+            for (size_t k=0; k<row.size(); k++)
+            {
+              new_targets[nb + k] = row[k].first;
+              (*perm)[nb + k] = row[k].second;
+            }
+          }
+        }
+    }
+
+    /** the graph with vertex v renumbered to new_id(v) */
+    static_tGraph<T> apply(const static_tGraph<T> &G) const
+    {
+        std::vector<size_t> offsets;
+        std::vector<T> targets;
+        apply(G.out_offsets(), G.out_targets(), offsets, targets);
+        static_tGraph<T> H;
+        H.assign(G.num_vertices(), offsets, targets);
+        return H;
+    }
+};
+
+
+/**
+    Mean log2(1 + |gap|) over the out-neighbor lists; see above.
+*/
+template <typename T>
+double average_log_gap(const static_tGraph<T> &G)
+{
+    const long n = G.num_vertices();
+    double sum = 0.0;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(+:sum)
+#endif
+    for (long v=0; v<n; v++)
+    {
+      double prev = (double) v;
+      for (const T *q = G.out_neighbors_begin(v); q != G.out_neighbors_end(v);
+              q++)
+      {
+        sum += std::log(1.0 + std::fabs((double) *q - prev)) / std::log(2.0);
+        prev = (double) *q;
+      }
+    }
+    return (G.num_edges() == 0 ? 0.0 : sum / G.num_edges());
+}
+
+
+// ---------------------------------------------------------------------
+//  orderings
+// ---------------------------------------------------------------------
+
+/**
+    Vertices by decreasing total (in + out) degree; ties keep their
+    order.
+*/
+template <typename T>
+std::vector<T> degree_order(const static_tGraph<T> &G)
+{
+    const size_t n = G.num_vertices();
+    std::vector<uint64_t> keys(n), tmp(n);
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (long v=0; v<(long) n; v++)
+    {
+      uint64_t d = G.out_degree(v) + G.in_degree(v);
+      keys[v] = ((0xFFFFFFFFUL - (d > 0xFFFFFFFFUL ? 0xFFFFFFFFUL : d)) << 32)
+                | (uint64_t) v;
+    }
+    if (n > 0)
+      radix_sort(&keys[0], &tmp[0], n);
+
+    std::vector<T> new_id(n);
+    for (size_t i=0; i<n; i++)
+      new_id[keys[i] & 0xFFFFFFFFUL] = (T) i;
+    return new_id;
+}
+
+
+/**
+    Breadth-first order of the undirected graph; each component is
+    started from its highest-degree vertex, and components are taken in
+    order of those degrees.
+*/
+template <typename T>
+std::vector<T> bfs_order(const static_tGraph<T> &G)
+{
+    const size_t n = G.num_vertices();
+    std::vector<size_t> offsets;
+    std::vector<T> adj;
+    undirected_adjacency(G, offsets, adj);
+
+    // roots: by decreasing degree
+    std::vector<T> by_degree = degree_order(G);
+    std::vector<T> roots(n);
+    for (size_t v=0; v<n; v++)
+      roots[by_degree[v]] = (T) v;
+
+    const T unvisited = (T) -1;
+    std::vector<T> new_id(n, unvisited);
+    std::vector<T> queue;
+    queue.reserve(n);
+    T next = 0;
+
+    for (size_t r=0; r<n; r++)
+    {
+      if (new_id[roots[r]] != unvisited)
+        continue;
+      size_t head = queue.size();
+      queue.push_back(roots[r]);
+      new_id[roots[r]] = next++;
+      while (head < queue.size())
+      {
+        T v = queue[head++];
+        for (size_t k=offsets[v]; k<offsets[v+1]; k++)
+          if (new_id[adj[k]] == unvisited)
+          {
+            new_id[adj[k]] = next++;
+            queue.push_back(adj[k]);
+          }
+      }
+    }
+    return new_id;
+}
+
+
+/**
+    Reverse Cuthill-McKee order of the undirected graph.  Each component
+    is started from a pseudo-peripheral vertex (George-Liu: repeat BFS
+    from a minimum-degree vertex of the last level while the
+    eccentricity grows), and neighbors are visited by increasing
+    degree.
+*/
+template <typename T>
+std::vector<T> rcm_order(const static_tGraph<T> &G)
+{
+    const size_t n = G.num_vertices();
+    std::vector<size_t> offsets;
+    std::vector<T> adj;
+    undirected_adjacency(G, offsets, adj);
+
+    const T none = (T) -1;
+    std::vector<T> level(n, none);      // scratch, for the BFS searches
+    std::vector<char> placed(n, 0);
+    std::vector<T> order;
+    order.reserve(n);
+    std::vector<T> queue;
+    std::vector<std::pair<size_t, T> > children;
+
+    for (size_t s=0; s<n; s++)
+    {
+      if (placed[s])
+        continue;
+
+      // find a pseudo-peripheral vertex in the component of s
+      //
+      T root = (T) s;
+      T eccentricity = 0;
+      for (unsigned int round = 0; round < 8; round++)
+      {
+        queue.clear();
+        queue.push_back(root);
+        level[root] = 0;
+        for (size_t head = 0; head < queue.size(); head++)
+        {
+          T v = queue[head];
+          for (size_t k=offsets[v]; k<offsets[v+1]; k++)
+            if (level[adj[k]] == none)
+            {
+              level[adj[k]] = level[v] + 1;
+              queue.push_back(adj[k]);
+            }
+        }
+
+        const T depth = level[queue.back()];
+        T candidate = queue.back();
+        for (size_t i=queue.size(); i-- > 0 && level[queue[i]] == depth; )
+          if (offsets[queue[i]+1] - offsets[queue[i]] <
+              offsets[candidate+1] - offsets[candidate])
+            candidate = queue[i];
+
+        for (size_t i=0; i<queue.size(); i++)
+          level[queue[i]] = none;
+
+        if (round > 0 && depth <= eccentricity)
+          break;
+        eccentricity = depth;
+        root = candidate;
+      }
+
+      // Cuthill-McKee from root
+      //
+      size_t head = order.size();
+      order.push_back(root);
+      placed[root] = 1;
+      while (head < order.size())
+      {
+        T v = order[head++];
+        children.clear();
+        for (size_t k=offsets[v]; k<offsets[v+1]; k++)
+          if (!placed[adj[k]])
+          {
+            placed[adj[k]] = 1;
+            children.push_back(std::make_pair(
+                  offsets[adj[k]+1] - offsets[adj[k]], adj[k]));
+          }
+        std::sort(children.begin(), children.end());
+        for (size_t i=0; i<children.size(); i++)
+          order.push_back(children[i].second);
+      }
+    }
+
+    std::vector<T> new_id(n);
+    for (size_t i=0; i<n; i++)
+      new_id[order[i]] = (T) (n - 1 - i);
+    return new_id;
+}
+
+
+/**
+    Max-priority queue of vertices whose priorities change by one at a
+    time (Gorder's "unit heap"): a doubly-linked list of vertices per
+    priority, so that every operation is O(1) (amortized, for the
+    maximum).
+*/
+template <typename T>
+class unit_heap
+{
+  private:
+    static T nil() { return (T) -1; }
+
+    std::vector<size_t> key_;
+    std::vector<T> prev_, next_;
+    std::vector<T> head_;           // per priority
+    std::vector<char> in_;
+    size_t top_;
+
+    void link(T v)
+    {
+        size_t k = key_[v];
+        if (k >= head_.size())
+          head_.resize(2 * k + 1, nil());
+        prev_[v] = nil();
+        next_[v] = head_[k];
+        if (head_[k] != nil())
+          prev_[head_[k]] = v;
+        head_[k] = v;
+        if (k > top_)
+          top_ = k;
+    }
+
+    void unlink(T v)
+    {
+        if (prev_[v] != nil())
+          next_[prev_[v]] = next_[v];
+        else
+          head_[key_[v]] = next_[v];
+        if (next_[v] != nil())
+          prev_[next_[v]] = prev_[v];
+    }
+
+  public:
+
+    /** all of 0..n-1 with priority 0, popped in increasing order */
+    explicit unit_heap(size_t n) : key_(n, 0), prev_(n), next_(n), head_(1, nil()),
+        in_(n, 1), top_(0)
+    {
+        for (size_t v=n; v-- > 0; )
+          link((T) v);
+    }
+
+    bool contains(T v) const { return in_[v] != 0; }
+
+    void increment(T v)
+    {
+        if (!in_[v])
+          return;
+        unlink(v);
+        key_[v]++;
+        link(v);
+    }
+
+    void decrement(T v)
+    {
+        if (!in_[v] || key_[v] == 0)
+          return;
+        unlink(v);
+        key_[v]--;
+        link(v);
+    }
+
+    void remove(T v)
+    {
+        if (!in_[v])
+          return;
+        unlink(v);
+        in_[v] = 0;
+    }
+
+    /** remove and return a vertex of maximum priority (nil() if empty) */
+    T pop()
+    {
+        while (top_ > 0 && head_[top_] == nil())
+          top_--;
+        T v = head_[top_];
+        if (v != nil())
+          remove(v);
+        return v;
+    }
+};
+
+
+/**
+    Gorder (window greedy).  The score of a candidate u against the
+    vertices v in the window of the last w placed ones counts the edges
+    between u and v and their common in-neighbors.  In-neighbors with
+    more than hub_degree out-neighbors are not expanded (they would add
+    the same amount to most candidates); 0 uses sqrt(n).
+*/
+template <typename T>
+std::vector<T> gorder(const static_tGraph<T> &G, unsigned int window = 5,
+      size_t hub_degree = 0)
+{
+    const size_t n = G.num_vertices();
+    std::vector<T> new_id(n);
+    if (n == 0)
+      return new_id;
+    if (window < 1)
+      window = 1;
+    if (hub_degree == 0)
+      hub_degree = (size_t) std::sqrt((double) n) + 1;
+
+    unit_heap<T> Q(n);
+    std::vector<T> order;
+    order.reserve(n);
+
+    // start from the vertex of largest in-degree
+    T start = 0;
+    for (size_t v=1; v<n; v++)
+      if (G.in_degree(v) > G.in_degree(start))
+        start = (T) v;
+
+    for (size_t i=0; i<n; i++)
+    {
+      T v = (i == 0 ? start : Q.pop());
+      Q.remove(v);
+      order.push_back(v);
+
+      // v enters the window
+      for (const T *q = G.out_neighbors_begin(v); q != G.out_neighbors_end(v);
+              q++)
+        Q.increment(*q);
+      for (const T *q = G.in_neighbors_begin(v); q != G.in_neighbors_end(v);
+              q++)
+      {
+        Q.increment(*q);
+        if (G.out_degree(*q) <= hub_degree)
+          for (const T *s = G.out_neighbors_begin(*q);
+                  s != G.out_neighbors_end(*q); s++)
+            Q.increment(*s);
+      }
+
+      // the oldest vertex leaves it
+      if (order.size() > window)
+      {
+        T u = order[order.size() - window - 1];
+        for (const T *q = G.out_neighbors_begin(u);
+                q != G.out_neighbors_end(u); q++)
+          Q.decrement(*q);
+        for (const T *q = G.in_neighbors_begin(u);
+                q != G.in_neighbors_end(u); q++)
+        {
+          Q.decrement(*q);
+          if (G.out_degree(*q) <= hub_degree)
+            for (const T *s = G.out_neighbors_begin(*q);
+                    s != G.out_neighbors_end(*q); s++)
+              Q.decrement(*s);
+        }
+      }
+    }
+
+    for (size_t i=0; i<n; i++)
+      new_id[order[i]] = (T) i;
+    return new_id;
+}
+
+
+/**
+    Compute an ordering by name: "degree", "bfs", "rcm", "gorder" or
+    "none" (the identity).
+
+    @return false if the name is unknown
+*/
+template <typename T>
+bool compute_order(const static_tGraph<T> &G, const std::string &name,
+      std::vector<T> &new_id, unsigned int window = 5)
+{
+    if (name == "degree")
+      new_id = degree_order(G);
+    else if (name == "bfs")
+      new_id = bfs_order(G);
+    else if (name == "rcm")
+      new_id = rcm_order(G);
+    else if (name == "gorder")
+      new_id = gorder(G, window);
+    else if (name == "none")
+    {
+      new_id.resize(G.num_vertices());
+      for (size_t v=0; v<new_id.size(); v++)
+        new_id[v] = (T) v;
+    }
+    else
+      return false;
+    return true;
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_REORDER_H_
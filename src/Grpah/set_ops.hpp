@@ -28,10 +28,11 @@ bool operator==(const std::set<T> &A, const std::set<T> &B)
 }
 
 
-template <class  T>
-std::set<T> operator*(const std::set<T> &A, const std::set<T> &B)
+template <class T, class Cmp, class Alloc>
+std::set<T,Cmp,Alloc> operator*(const std::set<T,Cmp,Alloc> &A,
+      const std::set<T,Cmp,Alloc> &B)
 {
-   std::set<T> res;
+   std::set<T,Cmp,Alloc> res;
 
    std::set_intersection(A.begin(), A.end(), B.begin(), B.end(), 
         inserter(res, res.begin()));
@@ -40,21 +41,25 @@ std::set<T> operator*(const std::set<T> &A, const std::set<T> &B)
 }
 
 
-template <class T>
-std::set<T> & operator+=(std::set<T> &A, const std::set<T> &B)
+template <class T, class Cmp, class Alloc>
+std::set<T,Cmp,Alloc> & operator+=(std::set<T,Cmp,Alloc> &A,
+      const std::set<T,Cmp,Alloc> &B)
 {
   // A.insert(B.begin(), B.end());
-  for (typename std::set<T>::const_iterator p=B.begin(); p!=B.end(); p++)
+  for (typename std::set<T,Cmp,Alloc>::const_iterator p=
+        B.begin(); p!=B.end(); p++)
     A.insert(*p);
 
   return A;
 }
 
-template <class T>
-std::set<T> & operator-=(std::set<T> &A, const std::set<T> &B)
+template <class T, class Cmp, class Alloc>
+std::set<T,Cmp,Alloc> & operator-=(std::set<T,Cmp,Alloc> &A,
+      const std::set<T,Cmp,Alloc> &B)
 {
   // A.erase(B.begin(), B.end());
-  for (typename std::set<T>::const_iterator p = B.begin(); p!=B.end(); p++)
+  for (typename std::set<T,Cmp,Alloc>::const_iterator p =
+        B.begin(); p!=B.end(); p++)
     A.erase(*p);
 
   return A;
@@ -64,10 +69,11 @@ std::set<T> & operator-=(std::set<T> &A, const std::set<T> &B)
 /**
     @return a new set, the union of A and B.
 */
-template <class  T>
-std::set<T> operator+(const std::set<T> &A, const std::set<T> &B)
+template <class T, class Cmp, class Alloc>
+std::set<T,Cmp,Alloc> operator+(const std::set<T,Cmp,Alloc> &A,
+      const std::set<T,Cmp,Alloc> &B)
 {
-   std::set<T> res;
+   std::set<T,Cmp,Alloc> res;
 
    std::set_union(A.begin(), A.end(), B.begin(), B.end(), 
         inserter(res, res.begin()));
@@ -79,10 +85,11 @@ std::set<T> operator+(const std::set<T> &A, const std::set<T> &B)
 /**
     @return the A - B: elements in A but not in B.
 */
-template <class  T>
-std::set<T> operator-(const std::set<T> &A, const std::set<T> &B)
+template <class T, class Cmp, class Alloc>
+std::set<T,Cmp,Alloc> operator-(const std::set<T,Cmp,Alloc> &A,
+      const std::set<T,Cmp,Alloc> &B)
 {
-  std::set<T> res;
+  std::set<T,Cmp,Alloc> res;
 
   std::set_difference(A.begin(), A.end(), B.begin(), B.end(),
     inserter(res, res.begin()));
@@ -96,10 +103,11 @@ std::set<T> operator-(const std::set<T> &A, const std::set<T> &B)
     That is, elements in only one set, but not the other.  Mathematically,
     this is  A+B - (A*B)
 */
-template <class  T>
-std::set<T> symm_diff(const std::set<T> &A, const std::set<T> &B)
+template <class T, class Cmp, class Alloc>
+std::set<T,Cmp,Alloc> symm_diff(const std::set<T,Cmp,Alloc> &A,
+      const std::set<T,Cmp,Alloc> &B)
 {
-  std::set<T> res;
+  std::set<T,Cmp,Alloc> res;
 
   std::set_symmetric_difference(A.begin(), A.end(), B.begin(), B.end(),
     inserter(res, res.begin()));
@@ -111,8 +119,8 @@ std::set<T> symm_diff(const std::set<T> &A, const std::set<T> &B)
     @return true, if element a is in set A
 */
 
-template <class T, class constT>
-inline bool includes_elm( const std::set<T> &A, constT & a)
+template <class T, class Cmp, class Alloc, class constT>
+inline bool includes_elm( const std::set<T,Cmp,Alloc> &A, constT & a)
 {
     return  (  (A.find(a) != A.end()) ? 
 							 true : false );
@@ -134,12 +142,13 @@ inline bool includes_elm( const std::set<T> &A, constT & a)
 // then a better approach is to look each element of the smaller
 // set individually.  This runs in O(n log m), where m >> n.
 //
-template <class T>
-int intersection_size( const std::set<T> &A, const std::set<T> &B)
+template <class T, class Cmp, class Alloc>
+int intersection_size( const std::set<T,Cmp,Alloc> &A,
+      const std::set<T,Cmp,Alloc> &B)
 {
   int res = 0;
 
-  typename std::set<T>::const_iterator first1 = A.begin(),
+  typename std::set<T,Cmp,Alloc>::const_iterator first1 = A.begin(),
                         last1  = A.end(),
                         first2 = B.begin(),
                         last2  = B.end();
@@ -167,11 +176,12 @@ int intersection_size( const std::set<T> &A, const std::set<T> &B)
 //
 //  It is assumed that A is the much larger set.
 //
-template <class T>
-int big_small_intersection_size( const std::set<T> &A, const std::set<T> &B)
+template <class T, class Cmp, class Alloc>
+int big_small_intersection_size( const std::set<T,Cmp,Alloc> &A,
+      const std::set<T,Cmp,Alloc> &B)
 {
   int res = 0; 
-  typename std::set<T>::const_iterator first=B.begin(), last=B.end();
+  typename std::set<T,Cmp,Alloc>::const_iterator first=B.begin(), last=B.end();
   for(; first != last; first++)
   {
      if (includes_elm(A, *first)) res++;
@@ -188,12 +198,12 @@ int big_small_intersection_size( const std::set<T> &A, const std::set<T> &B)
 // rather than explicitly create it.  (Saves a lot
 // needless copying of elements.)
 //
-template <class T>
-int union_size( const std::set<T> &A, const std::set<T> &B)
+template <class T, class Cmp, class Alloc>
+int union_size( const std::set<T,Cmp,Alloc> &A, const std::set<T,Cmp,Alloc> &B)
 {
   int res = 0;
 
-  typename std::set<T>::const_iterator first1 = A.begin(),
+  typename std::set<T,Cmp,Alloc>::const_iterator first1 = A.begin(),
                         last1  = A.end(),
                         first2 = B.begin(),
                         last2  = B.end();
@@ -221,8 +231,9 @@ int union_size( const std::set<T> &A, const std::set<T> &B)
   return res;
 }
 
-template <class T>
-int set_difference_size( const std::set<T> &A, const std::set<T> &B)
+template <class T, class Cmp, class Alloc>
+int set_difference_size( const std::set<T,Cmp,Alloc> &A,
+      const std::set<T,Cmp,Alloc> &B)
 {
 
   return (A.size() - intersection_size(A,B)) ;
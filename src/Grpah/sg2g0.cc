@@ -1,8 +1,10 @@
 #include <iostream>
 #include <string>
-#include <sstream>
-#include <map>
+#include <vector>
+#include <cctype>
 #include "ngraph.hpp"
+#include "mapped_file.hpp"
+#include "string_intern.hpp"
 
 /*
     convert a general label (single-word string)graph file into a 
@@ -10,78 +12,97 @@
 
    -t option displays the table (mapping) rather than the graph
 
+   Labels are numbered in the order they are first encountered, using an
+   arena-backed string interner (see string_intern.hpp) rather than a
+   map of strings.
+
 */
 
 using namespace std;
 using namespace NGraph;
 
+
+static inline bool is_blank(char c)
+{
+    return c != '\n' && isspace((unsigned char) c);
+}
+
+
+// next whitespace-separated label on the current line, if any
+//
+static bool next_label(const char *&p, const char *end, str_ref &label)
+{
+    while (p < end && is_blank(*p))
+      p++;
+    if (p == end || *p == '\n')
+      return false;
+    const char *b = p;
+    while (p < end && !isspace((unsigned char) *p))
+      p++;
+    label = str_ref(b, p - b);
+    return true;
+}
+
+
 int main(int argc, char *argv[])
 {
+    NGraph::stats::parse_options(argc, argv);
+
     bool perform_mapping_only = false;
 
 
     if (argc > 1)
       perform_mapping_only = ("-t" == string(argv[1]));
     
-    Graph G;
-
-                /*  old index     0-based index */
-                /*  ---------     ------------- */
-    typedef map<string, Graph::vertex> map_type;
-    map_type M;
-    Graph::vertex vertex_num = 0;
-
-    std::string from, to;
-    bool vertex_only=false;
-
-    while (sGraph::read_line(cin, from, to, vertex_only))
+    mapped_file in("-");
+    if (!in.good())
     {
-        Graph::vertex to0, from0;
-
-        
-        //cout << "processed '" << from <<"' ->  '" << to << "'\n";
-
-
-
-        map_type::iterator from_loc = M.find(from);
-        if (from_loc == M.end())
-        {
-            from0 = M[from] = vertex_num;
-            vertex_num++;
+      cerr << "Error: " << in.error() << "\n";
+      return 1;
+    }
 
-        }
-        else
-          from0 = from_loc->second;
+    Graph G;
+    string_interner M;
 
-      if (!vertex_only)
+    {
+      stats::scoped_phase phase("read");
+      const char *p = in.data();
+      const char *end = p + in.size();
+      while (p < end)
       {
-        map_type::iterator to_loc = M.find(to);
-        if (to_loc == M.end())
+        const char *line = p;
+        while (p < end && *p != '\n')
+          p++;
+        const char *line_end = p;
+        if (p < end)
+          p++;
+
+        if (*line == '%' || *line == '#')
+          continue;
+
+        const char *q = line;
+        str_ref from, to;
+        if (!next_label(q, line_end, from))
+          continue;
+        Graph::vertex from0 = M.intern(from);
+
+        if (next_label(q, line_end, to))
         {
-            to0 = M[to] = vertex_num;
-            vertex_num++;
-
-        }
-        else
-          to0 = to_loc -> second;
-      }      
-            
-
-        if (! perform_mapping_only)        
-        {
-          if (vertex_only)
-             G.insert_vertex(from0);
-          else
+          Graph::vertex to0 = M.intern(to);
+          if (!perform_mapping_only)
             G.insert_edge(from0, to0);
         }
-
+        else if (!perform_mapping_only)
+          G.insert_vertex(from0);
+      }
     }
 
    if (perform_mapping_only)
    {
-     for (map_type::const_iterator p = M.begin(); p!= M.end(); p++)
+     vector<unsigned int> ids = M.sorted_ids();
+     for (unsigned int i=0; i<ids.size(); i++)
      {
-        cout <<  p->second << " " << p->first << "\n";
+        cout <<  ids[i] << " " << M.str(ids[i]) << "\n";
      }
    }
 
@@ -91,4 +112,3 @@ int main(int argc, char *argv[])
 
   return 0;
 }
-
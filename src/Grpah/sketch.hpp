@@ -0,0 +1,702 @@
+#ifndef NGRAPH_SKETCH_H_
+#define NGRAPH_SKETCH_H_
+
+/*
+   Counting the items of a stream (words, vertex numbers, ...) in bounded
+   memory, for tools like freq, ifreq and create_imap whose input may
+   have more distinct items than fit in memory.
+
+        hyperloglog         number of distinct items, with a relative
+                            standard error of 1.04 / sqrt(2^precision)
+        count_min_sketch    the count of any item, over-estimated by at
+                            most epsilon * (total count), with probability
+                            1 - delta
+        heavy_hitters       the k most frequent items: a count_min_sketch
+                            plus the items of highest estimated count (at
+                            least 1 / epsilon of them) as candidates
+        exact_counter       exact counts of 64-bit keys (open addressing),
+                            for when the distinct items do fit
+
+   Items are identified by a 64-bit hash (hash(str_ref) for strings,
+   hash_uint() for numbers), so that the sketches never store or compare
+   the items themselves (heavy_hitters keeps a copy of its k items, for
+   printing).
+
+   Every one of them can be merged with another of the same parameters,
+   with the same result as if it had counted both streams (for
+   heavy_hitters, up to which of the items below its error bound it kept
+   as candidates): tools keep one per thread and merge them at the end,
+   and save() / load() let the sketches of several files (or runs) be
+   merged later.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <stdint.h>
+#include "str_ref.hpp"
+
+namespace NGraph
+{
+
+/**
+    A 64-bit mix of an integer (the splitmix64 finalizer), for hashing
+    numbers into sketches.
+*/
+inline uint64_t hash_uint(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15UL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9UL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBUL;
+    return x ^ (x >> 31);
+}
+
+
+namespace sketch_detail
+{
+
+inline bool write_header(FILE *f, const char *magic, uint64_t a, uint64_t b)
+{
+    return fwrite(magic, 8, 1, f) == 1 && fwrite(&a, sizeof(a), 1, f) == 1 &&
+          fwrite(&b, sizeof(b), 1, f) == 1;
+}
+
+inline bool read_header(FILE *f, const char *magic, uint64_t &a, uint64_t &b,
+      std::string &error)
+{
+    char m[8];
+    if (fread(m, 8, 1, f) != 1 || memcmp(m, magic, 8) != 0 ||
+          fread(&a, sizeof(a), 1, f) != 1 || fread(&b, sizeof(b), 1, f) != 1)
+    {
+      error = "not a saved sketch of this kind";
+      return false;
+    }
+    return true;
+}
+
+template <class V>
+bool write_array(FILE *f, const std::vector<V> &A)
+{
+    return A.empty() || fwrite(&A[0], sizeof(V), A.size(), f) == A.size();
+}
+
+template <class V>
+bool read_array(FILE *f, std::vector<V> &A, size_t n)
+{
+    A.resize(n);
+    return n == 0 || fread(&A[0], sizeof(V), n, f) == n;
+}
+
+}
+// namespace sketch_detail
+
+
+/**
+    HyperLogLog (Flajolet et al. 2007): 2^precision registers, each the
+    largest number of leading zeros (plus one) seen among the hashes that
+    fall in it.
+*/
+class hyperloglog
+{
+  private:
+    unsigned int precision_;
+    std::vector<uint8_t> M_;
+
+    static double sigma(double x)
+    {
+        if (x == 1.0)
+          return HUGE_VAL;
+        double y = 1.0, z = x, z0;
+        do
+        {
+          x *= x;
+          z0 = z;
+          z += x * y;
+          y += y;
+        }
+        while (z != z0);
+        return z;
+    }
+
+    static double tau(double x)
+    {
+        if (x == 0.0 || x == 1.0)
+          return 0.0;
+        double y = 1.0, z = 1.0 - x, z0;
+        do
+        {
+          x = sqrt(x);
+          z0 = z;
+          y *= 0.5;
+          z -= (1.0 - x) * (1.0 - x) * y;
+        }
+        while (z != z0);
+        return z / 3.0;
+    }
+
+  public:
+    static const unsigned int min_precision = 4;
+    static const unsigned int max_precision = 18;
+
+    /** the smallest precision with at most the given relative error */
+    static unsigned int precision_for(double error)
+    {
+        unsigned int p = min_precision;
+        while (p < max_precision && 1.04 / sqrt((double) (1UL << p)) > error)
+          p++;
+        return p;
+    }
+
+    explicit hyperloglog(unsigned int precision = 14) :
+        precision_(precision < min_precision ? min_precision :
+              precision > max_precision ? max_precision : precision),
+        M_(1UL << precision_, 0) {}
+
+    unsigned int precision() const { return precision_; }
+
+    /** relative standard error of estimate() */
+    double error() const { return 1.04 / sqrt((double) M_.size()); }
+
+    void add(uint64_t h)
+    {
+        const size_t i = h >> (64 - precision_);
+        const uint64_t w = h << precision_;
+        const uint8_t rank = (w == 0 ? 64 - precision_ + 1 :
+              __builtin_clzll(w) + 1);
+        if (rank > M_[i])
+          M_[i] = rank;
+    }
+
+    /** @return false if the precisions differ */
+    bool merge(const hyperloglog &H)
+    {
+        if (H.precision_ != precision_)
+          return false;
+        for (size_t i=0; i<M_.size(); i++)
+          if (H.M_[i] > M_[i])
+            M_[i] = H.M_[i];
+        return true;
+    }
+
+    /**
+        The number of distinct items, by Ertl's improved estimator ("New
+        cardinality estimation algorithms for HyperLogLog sketches",
+        2017), which unlike the original needs no separate small-range
+        correction, and has no bias at a few times 2^precision items.
+    */
+    double estimate() const
+    {
+        const unsigned int q = 64 - precision_;
+        const double m = M_.size();
+        std::vector<double> C(q + 2, 0.0);
+        for (size_t i=0; i<M_.size(); i++)
+          C[M_[i]]++;
+
+        double z = m * tau(1.0 - C[q+1] / m);
+        for (unsigned int k=q; k>=1; k--)
+          z = 0.5 * (z + C[k]);
+        z += m * sigma(C[0] / m);
+        return (m / (2.0 * log(2.0))) * m / z;
+    }
+
+    bool save(FILE *f) const
+    {
+        return sketch_detail::write_header(f, "NGHLL001", precision_, 0) &&
+              sketch_detail::write_array(f, M_) && fflush(f) == 0;
+    }
+
+    bool load(FILE *f, std::string &error)
+    {
+        uint64_t p = 0, unused = 0;
+        if (!sketch_detail::read_header(f, "NGHLL001", p, unused, error))
+          return false;
+        if (p < min_precision || p > max_precision)
+        {
+          error = "distinct-count sketch has a bad precision";
+          return false;
+        }
+        precision_ = p;
+        if (!sketch_detail::read_array(f, M_, 1UL << p))
+        {
+          error = "saved sketch is truncated";
+          return false;
+        }
+        return true;
+    }
+};
+
+
+/**
+    Count-Min sketch (Cormode & Muthukrishnan 2005): depth rows of width
+    counters; an item adds its count to one counter per row, and its
+    estimate is the smallest of its counters.  width = e / epsilon and
+    depth = ln(1 / delta).
+*/
+class count_min_sketch
+{
+  private:
+    uint64_t width_;
+    uint64_t depth_;
+    std::vector<uint64_t> C_;
+    uint64_t total_;
+
+    static double e() { return 2.718281828459045; }
+
+    // the counter of row r for hash h (double hashing, the high 32 bits
+    // scaled to the width rather than taken modulo it)
+    size_t cell(uint64_t r, uint64_t h, uint64_t h2) const
+    {
+        return r * width_ + (size_t) ((((h + r * h2) >> 32) * width_) >> 32);
+    }
+
+  public:
+
+    count_min_sketch(double epsilon = 1e-4, double delta = 0.01) :
+        width_((uint64_t) ceil(e() / (epsilon <= 0.0 ? 1e-4 :
+              epsilon < 1e-9 ? 1e-9 : epsilon))),
+        depth_((uint64_t) ceil(log(1.0 / (delta > 0.0 && delta < 1.0 ?
+              delta : 0.01)))),
+        C_(width_ * depth_, 0), total_(0) {}
+
+    size_t width() const { return width_; }
+    size_t depth() const { return depth_; }
+    uint64_t total() const { return total_; }
+    double epsilon() const { return e() / width_; }
+
+    /** @return the new estimate of the item with hash h */
+    uint64_t add(uint64_t h, uint64_t n = 1)
+    {
+        const uint64_t h2 = hash_uint(h) | 1;
+        uint64_t m = ~(uint64_t) 0;
+        for (uint64_t r=0; r<depth_; r++)
+        {
+          uint64_t &c = C_[cell(r, h, h2)];
+          c += n;
+          if (c < m)
+            m = c;
+        }
+        total_ += n;
+        return m;
+    }
+
+    uint64_t estimate(uint64_t h) const
+    {
+        const uint64_t h2 = hash_uint(h) | 1;
+        uint64_t m = ~(uint64_t) 0;
+        for (uint64_t r=0; r<depth_; r++)
+          m = std::min(m, C_[cell(r, h, h2)]);
+        return m;
+    }
+
+    /** @return false if the dimensions differ */
+    bool merge(const count_min_sketch &S)
+    {
+        if (S.width_ != width_ || S.depth_ != depth_)
+          return false;
+        for (size_t i=0; i<C_.size(); i++)
+          C_[i] += S.C_[i];
+        total_ += S.total_;
+        return true;
+    }
+
+    bool save(FILE *f) const
+    {
+        return sketch_detail::write_header(f, "NGCMS001", width_, depth_) &&
+              fwrite(&total_, sizeof(total_), 1, f) == 1 &&
+              sketch_detail::write_array(f, C_);
+    }
+
+    bool load(FILE *f, std::string &error)
+    {
+        if (!sketch_detail::read_header(f, "NGCMS001", width_, depth_, error))
+          return false;
+        if (fread(&total_, sizeof(total_), 1, f) != 1 ||
+              !sketch_detail::read_array(f, C_, width_ * depth_))
+        {
+          error = "saved sketch is truncated";
+          return false;
+        }
+        return true;
+    }
+};
+
+
+// items as kept by heavy_hitters, and their binary form
+//
+inline std::string sketch_key(const str_ref &s) { return s.str(); }
+inline long sketch_key(long x) { return x; }
+
+inline bool write_key(FILE *f, const std::string &s)
+{
+    const uint64_t n = s.size();
+    return fwrite(&n, sizeof(n), 1, f) == 1 &&
+          (n == 0 || fwrite(s.data(), 1, n, f) == n);
+}
+
+inline bool read_key(FILE *f, std::string &s)
+{
+    uint64_t n = 0;
+    if (fread(&n, sizeof(n), 1, f) != 1)
+      return false;
+    std::vector<char> b(n + 1);
+    if (n > 0 && fread(&b[0], 1, n, f) != n)
+      return false;
+    s.assign(&b[0], n);
+    return true;
+}
+
+inline bool write_key(FILE *f, long x)
+{
+    return fwrite(&x, sizeof(x), 1, f) == 1;
+}
+
+inline bool read_key(FILE *f, long &x)
+{
+    return fread(&x, sizeof(x), 1, f) == 1;
+}
+
+
+/**
+    The k items of highest count in a stream (Key: std::string or long),
+    estimated by a count_min_sketch.  An item becomes a candidate when
+    its estimate exceeds a threshold, so the items themselves are only
+    copied (by sketch_key()) when they enter; once there are twice as
+    many candidates as are kept, those of lowest estimate are dropped,
+    and the lowest estimate kept becomes the threshold.
+
+    max(k, 1 / epsilon) candidates are kept, not just k: then (with
+    probability 1 - delta) every item counted more than 2 * epsilon *
+    total() times is among them, however the stream was split into
+    sketches that were merged (an item may be outside the top k of every
+    part, and still in the top k of the whole).  top() ranks them by
+    their estimates in the (merged) sketch, and only then cuts the list
+    to k.
+*/
+template <class Key>
+class heavy_hitters
+{
+  public:
+    typedef std::pair<Key, uint64_t> item;
+
+  private:
+    struct entry
+    {
+        Key key;
+        uint64_t count;
+        entry() : key(), count(0) {}
+        entry(const Key &k, uint64_t c) : key(k), count(c) {}
+    };
+
+    typedef std::map<uint64_t, entry> entry_map;    // by hash
+
+    count_min_sketch S_;
+    size_t k_;
+    size_t capacity_;       // candidates kept (up to twice as many held)
+    uint64_t threshold_;    // estimate needed to become a candidate
+    entry_map top_;
+
+    static size_t capacity_for(size_t k, const count_min_sketch &S)
+    {
+        const size_t c = (size_t) ceil(1.0 / S.epsilon());
+        return (k == 0 ? 0 : std::max(k, c));
+    }
+
+    // keep the capacity_ candidates of highest count (of equal counts,
+    // those of lowest hash)
+    //
+    void prune()
+    {
+        if (top_.size() <= capacity_)
+          return;
+        std::vector<uint64_t> C;
+        C.reserve(top_.size());
+        for (typename entry_map::const_iterator p = top_.begin();
+              p != top_.end(); p++)
+          C.push_back(p->second.count);
+        std::nth_element(C.begin(), C.begin() + (capacity_ - 1), C.end(),
+              std::greater<uint64_t>());
+        const uint64_t v = C[capacity_ - 1];
+
+        size_t ties = capacity_;
+        for (size_t i=0; i<C.size(); i++)
+          if (C[i] > v)
+            ties--;
+        for (typename entry_map::iterator p = top_.begin(); p != top_.end(); )
+          if (p->second.count < v || (p->second.count == v && ties == 0))
+            top_.erase(p++);
+          else
+          {
+            if (p->second.count == v)
+              ties--;
+            p++;
+          }
+        threshold_ = v;
+    }
+
+    void insert(uint64_t h, const Key &key, uint64_t count)
+    {
+        top_.insert(std::make_pair(h, entry(key, count)));
+        if (top_.size() >= 2 * capacity_)
+          prune();
+    }
+
+    void offer(uint64_t h, const Key &key, uint64_t count)
+    {
+        if (capacity_ == 0 || count <= threshold_)
+          return;
+        typename entry_map::iterator p = top_.find(h);
+        if (p != top_.end())
+          p->second.count = count;
+        else
+          insert(h, key, count);
+    }
+
+    struct count_greater
+    {
+        bool operator()(const item &a, const item &b) const
+        {
+            return a.second > b.second ||
+                  (a.second == b.second && a.first < b.first);
+        }
+    };
+
+  public:
+
+    heavy_hitters(size_t k = 100, double epsilon = 1e-4, double delta = 0.01) :
+        S_(epsilon, delta), k_(k), capacity_(capacity_for(k, S_)),
+        threshold_(0), top_() {}
+
+    const count_min_sketch &sketch() const { return S_; }
+    size_t k() const { return k_; }
+
+    /** count an occurrence of x (hash h) */
+    template <class View>
+    void add(uint64_t h, const View &x)
+    {
+        const uint64_t c = S_.add(h);
+        if (capacity_ == 0 || c <= threshold_)
+          return;
+        typename entry_map::iterator p = top_.find(h);
+        if (p != top_.end())
+          p->second.count = c;
+        else
+          insert(h, sketch_key(x), c);
+    }
+
+    /** @return false if the sketch dimensions differ */
+    bool merge(const heavy_hitters &H)
+    {
+        if (!S_.merge(H.S_))
+          return false;
+        if (H.k_ > k_)
+          k_ = H.k_;
+        capacity_ = capacity_for(k_, S_);
+
+        // re-estimate the candidates of both, in the merged sketch
+        std::vector<std::pair<uint64_t, Key> > C;
+        for (typename entry_map::const_iterator p = top_.begin();
+              p != top_.end(); p++)
+          C.push_back(std::make_pair(p->first, p->second.key));
+        for (typename entry_map::const_iterator p = H.top_.begin();
+              p != H.top_.end(); p++)
+          if (top_.find(p->first) == top_.end())
+            C.push_back(std::make_pair(p->first, p->second.key));
+        top_.clear();
+        threshold_ = 0;
+        for (size_t i=0; i<C.size(); i++)
+          offer(C[i].first, C[i].second, S_.estimate(C[i].first));
+        prune();
+        return true;
+    }
+
+    /** the top k items, in decreasing order of (estimated) count */
+    std::vector<item> top() const
+    {
+        std::vector<item> T;
+        for (typename entry_map::const_iterator p = top_.begin();
+              p != top_.end(); p++)
+          T.push_back(item(p->second.key, S_.estimate(p->first)));
+        std::sort(T.begin(), T.end(), count_greater());
+        if (T.size() > k_)
+          T.resize(k_);
+        return T;
+    }
+
+    bool save(FILE *f) const
+    {
+        bool ok = sketch_detail::write_header(f, "NGHHK001", k_, top_.size())
+              && S_.save(f);
+        for (typename entry_map::const_iterator p = top_.begin();
+              ok && p != top_.end(); p++)
+          ok = fwrite(&p->first, sizeof(p->first), 1, f) == 1 &&
+                write_key(f, p->second.key);
+        return ok && fflush(f) == 0;
+    }
+
+    bool load(FILE *f, std::string &error)
+    {
+        uint64_t k = 0, n = 0;
+        if (!sketch_detail::read_header(f, "NGHHK001", k, n, error) ||
+              !S_.load(f, error))
+          return false;
+        k_ = k;
+        capacity_ = capacity_for(k_, S_);
+        threshold_ = 0;
+        top_.clear();
+        for (uint64_t i=0; i<n; i++)
+        {
+          uint64_t h;
+          Key key;
+          if (fread(&h, sizeof(h), 1, f) != 1 || !read_key(f, key))
+          {
+            error = "saved sketch is truncated";
+            return false;
+          }
+          offer(h, key, S_.estimate(h));
+        }
+        prune();
+        return true;
+    }
+};
+
+
+/**
+    Exact counts of 64-bit keys, in an open-addressing table (linear
+    probing, at most half full).
+*/
+class exact_counter
+{
+  private:
+    struct slot
+    {
+        uint64_t key;
+        uint64_t count;     // 0 if empty
+    };
+
+    std::vector<slot> table_;
+    size_t mask_;
+    size_t size_;
+
+    void grow()
+    {
+        std::vector<slot> old;
+        old.swap(table_);
+        slot empty = { 0, 0 };
+        table_.assign(old.empty() ? 1024 : 2 * old.size(), empty);
+        mask_ = table_.size() - 1;
+        for (size_t i=0; i<old.size(); i++)
+          if (old[i].count != 0)
+          {
+            size_t j = hash_uint(old[i].key) & mask_;
+            while (table_[j].count != 0)
+              j = (j + 1) & mask_;
+            table_[j] = old[i];
+          }
+    }
+
+  public:
+    typedef std::pair<uint64_t, uint64_t> item;     // (key, count)
+
+    exact_counter() : table_(), mask_(0), size_(0) { grow(); }
+
+    size_t size() const { return size_; }
+
+    void add(uint64_t key, uint64_t n = 1)
+    {
+        size_t j = hash_uint(key) & mask_;
+        while (table_[j].count != 0 && table_[j].key != key)
+          j = (j + 1) & mask_;
+        if (table_[j].count == 0)
+        {
+          table_[j].key = key;
+          size_++;
+        }
+        table_[j].count += n;
+        if (2 * size_ > table_.size())
+          grow();
+    }
+
+    void merge(const exact_counter &C)
+    {
+        for (size_t i=0; i<C.table_.size(); i++)
+          if (C.table_[i].count != 0)
+            add(C.table_[i].key, C.table_[i].count);
+    }
+
+    /** the (key, count) pairs, in no particular order */
+    std::vector<item> items() const
+    {
+        std::vector<item> I;
+        I.reserve(size_);
+        for (size_t i=0; i<table_.size(); i++)
+          if (table_[i].count != 0)
+            I.push_back(item(table_[i].key, table_[i].count));
+        return I;
+    }
+};
+
+
+
+/** true for the names of saved sketches (*.sketch), by convention */
+inline bool is_sketch_file(const std::string &name)
+{
+    return name.size() > 7 && name.compare(name.size() - 7, 7, ".sketch") == 0;
+}
+
+template <class Sketch>
+bool save_sketch(const char *filename, const Sketch &S)
+{
+    FILE *f = fopen(filename, "wb");
+    if (f == 0)
+      return false;
+    const bool ok = S.save(f);
+    return (fclose(f) == 0) && ok;
+}
+
+template <class Sketch>
+bool load_sketch(const char *filename, Sketch &S, std::string &error)
+{
+    FILE *f = fopen(filename, "rb");
+    if (f == 0)
+    {
+      error = std::string("[") + filename + "] could not be opened";
+      return false;
+    }
+    const bool ok = S.load(f, error);
+    fclose(f);
+    if (!ok)
+      error = std::string("[") + filename + "] " + error;
+    return ok;
+}
+
+/**
+    Load a saved sketch and merge it into S.
+
+    @return false (with error) if it cannot be read, or has other
+            parameters than S
+*/
+template <class Sketch>
+bool merge_sketch(const char *filename, Sketch &S, std::string &error)
+{
+    Sketch L;
+    if (!load_sketch(filename, L, error))
+      return false;
+    if (!S.merge(L))
+    {
+      error = std::string("[") + filename + "] has a different error bound";
+      return false;
+    }
+    return true;
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_SKETCH_H_
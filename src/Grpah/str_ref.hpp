@@ -0,0 +1,92 @@
+#ifndef NGRAPH_STR_REF_H_
+#define NGRAPH_STR_REF_H_
+
+/*
+   A non-owning reference to a run of characters (pointer + length), for
+   handling words and labels without copying them into std::strings.
+   The referenced bytes must outlive the str_ref.
+*/
+
+#include <cstring>
+#include <string>
+#include <iostream>
+#include <stdint.h>
+
+namespace NGraph
+{
+
+struct str_ref
+{
+    const char *data;
+    size_t size;
+
+    str_ref() : data(0), size(0) {}
+    str_ref(const char *d, size_t n) : data(d), size(n) {}
+    str_ref(const char *s) : data(s), size(strlen(s)) {}
+    str_ref(const std::string &s) : data(s.data()), size(s.size()) {}
+
+    bool empty() const { return size == 0; }
+    const char *begin() const { return data; }
+    const char *end() const { return data + size; }
+    char operator[](size_t i) const { return data[i]; }
+
+    std::string str() const { return std::string(data, size); }
+};
+
+
+inline int compare(const str_ref &a, const str_ref &b)
+{
+    size_t n = (a.size < b.size ? a.size : b.size);
+    int c = (n == 0 ? 0 : memcmp(a.data, b.data, n));
+    if (c != 0)
+      return c;
+    return (a.size < b.size ? -1 : a.size > b.size ? 1 : 0);
+}
+
+inline bool operator==(const str_ref &a, const str_ref &b)
+{
+    return a.size == b.size && (a.size == 0 ||
+          memcmp(a.data, b.data, a.size) == 0);
+}
+
+inline bool operator!=(const str_ref &a, const str_ref &b)
+{
+    return !(a == b);
+}
+
+// same order as std::string
+//
+inline bool operator<(const str_ref &a, const str_ref &b)
+{
+    return compare(a, b) < 0;
+}
+
+inline std::ostream & operator<<(std::ostream &s, const str_ref &r)
+{
+    return s.write(r.data, r.size);
+}
+
+
+/**
+    64-bit FNV-1a hash of the bytes, finished with a multiply-xorshift so
+    that the low and high bits are both well mixed.
+*/
+inline uint64_t hash(const str_ref &r)
+{
+    uint64_t h = 14695981039346656037UL;
+    for (size_t i=0; i<r.size; i++)
+    {
+      h ^= (unsigned char) r.data[i];
+      h *= 1099511628211UL;
+    }
+    h ^= h >> 29;
+    h *= 0xbf58476d1ce4e5b9UL;
+    h ^= h >> 32;
+    return h;
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_STR_REF_H_
@@ -0,0 +1,434 @@
+#ifndef NGRAPH_STRING_INTERN_H_
+#define NGRAPH_STRING_INTERN_H_
+
+/*
+   String interning: mapping words, labels, URLs, ... to dense integer
+   ids, for tools that turn text into graphs (word2index, sg2g0, freq).
+
+   Compared with a std::map<string, unsigned int>, which costs a tree
+   node plus a separately allocated string per entry, the interners
+   here keep
+
+        - the bytes of all strings back to back in a string_arena
+          (large blocks, never moved, so str_refs into it stay valid);
+        - an open-addressing hash table of 8-byte slots (32 bits of
+          hash, 32-bit id), with linear probing;
+        - per id: a str_ref, an occurrence count and the position of
+          its first occurrence.
+
+   string_interner is the single-threaded version; ids are assigned in
+   order of first insertion.
+
+   sharded_string_interner splits the strings among a fixed number of
+   shards by hash, each an independent string_interner with its own
+   lock, so that several threads can insert concurrently with little
+   contention.  Since the order in which threads get to a shard is not
+   deterministic, each insertion carries the position (e.g. byte offset)
+   of the occurrence in the input, and final ids are assigned afterwards
+   by finalize(), either in order of first position (the same ids a
+   serial pass would give) or in sorted string order.
+*/
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <stdint.h>
+#include "str_ref.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+
+/**
+    Append-only storage for string bytes, in blocks that are never
+    reallocated.
+*/
+class string_arena
+{
+  private:
+    std::vector<char *> blocks_;
+    size_t block_size_;
+    size_t used_;           // in the current (last) block
+    size_t capacity_;       // of the current block
+    size_t bytes_;
+
+    string_arena(const string_arena &);
+    string_arena & operator=(const string_arena &);
+
+  public:
+    string_arena(size_t block_size = 1 << 20) : blocks_(),
+        block_size_(block_size), used_(0), capacity_(0), bytes_(0) {}
+
+    ~string_arena()
+    {
+        for (size_t i=0; i<blocks_.size(); i++)
+          free(blocks_[i]);
+    }
+
+    /** copy s into the arena, returning a reference to the copy */
+    str_ref store(const str_ref &s)
+    {
+        if (used_ + s.size > capacity_)
+        {
+          // oversized strings get a block of their own
+          capacity_ = (s.size > block_size_ ? s.size : block_size_);
+          char *b = (char *) malloc(capacity_ > 0 ? capacity_ : 1);
+          if (b == 0)
+            throw std::bad_alloc();
+          blocks_.push_back(b);
+          used_ = 0;
+        }
+        char *p = blocks_.back() + used_;
+        if (s.size > 0)
+          memcpy(p, s.data, s.size);
+        used_ += s.size;
+        bytes_ += s.size;
+        return str_ref(p, s.size);
+    }
+
+    /** total string bytes stored */
+    size_t bytes() const { return bytes_; }
+};
+
+
+enum intern_order
+{
+    intern_first_seen,
+    intern_sorted
+};
+
+
+class string_interner
+{
+  public:
+    static const unsigned int no_id = 0xFFFFFFFFu;
+
+  private:
+    struct slot
+    {
+        uint32_t hash;
+        uint32_t id;        // no_id if empty
+    };
+
+    std::vector<slot> table_;
+    size_t mask_;
+    std::vector<str_ref> strings_;
+    std::vector<size_t> counts_;
+    std::vector<uint64_t> first_;
+    string_arena arena_;
+
+    string_interner(const string_interner &);
+    string_interner & operator=(const string_interner &);
+
+    void grow()
+    {
+        std::vector<slot> old;
+        old.swap(table_);
+        slot empty = { 0, no_id };
+        table_.assign(old.empty() ? 1024 : 2 * old.size(), empty);
+        mask_ = table_.size() - 1;
+        for (size_t i=0; i<old.size(); i++)
+          if (old[i].id != no_id)
+          {
+            size_t k = old[i].hash & mask_;
+            while (table_[k].id != no_id)
+              k = (k + 1) & mask_;
+            table_[k] = old[i];
+          }
+    }
+
+    size_t probe(const str_ref &s, uint32_t h) const
+    {
+        size_t k = h & mask_;
+        while (table_[k].id != no_id &&
+              (table_[k].hash != h || strings_[table_[k].id] != s))
+          k = (k + 1) & mask_;
+        return k;
+    }
+
+  public:
+
+    string_interner() : table_(), mask_(0), strings_(), counts_(),
+        first_(), arena_()
+    {
+        grow();
+    }
+
+    size_t size() const { return strings_.size(); }
+
+    const str_ref &str(unsigned int id) const { return strings_[id]; }
+
+    /** number of times id was interned */
+    size_t count(unsigned int id) const { return counts_[id]; }
+
+    /** smallest position id was interned with */
+    uint64_t first_position(unsigned int id) const { return first_[id]; }
+
+    /** bytes used by the strings, the table and the per-id arrays */
+    size_t memory_bytes() const
+    {
+        return arena_.bytes() + table_.size() * sizeof(slot) +
+              strings_.size() * (sizeof(str_ref) + sizeof(size_t) +
+              sizeof(uint64_t));
+    }
+
+    /**
+        @return the id of s, if present, or no_id.
+    */
+    unsigned int find(const str_ref &s) const
+    {
+        return table_[probe(s, (uint32_t) hash(s))].id;
+    }
+
+    /**
+        @param h         hash(s) (passed in, for callers that already
+                         computed it)
+        @param position  position of this occurrence in the input
+        @return the id of s, adding it if new.
+    */
+    unsigned int intern(const str_ref &s, uint64_t h, uint64_t position)
+    {
+        const uint32_t h32 = (uint32_t) h;
+        size_t k = probe(s, h32);
+        unsigned int id = table_[k].id;
+        if (id != no_id)
+        {
+          counts_[id]++;
+          if (position < first_[id])
+            first_[id] = position;
+          return id;
+        }
+
+        id = strings_.size();
+        strings_.push_back(arena_.store(s));
+        counts_.push_back(1);
+        first_.push_back(position);
+        table_[k].hash = h32;
+        table_[k].id = id;
+
+        // keep the load factor at most 1/2
+        if (2 * strings_.size() > table_.size())
+          grow();
+        return id;
+    }
+
+    unsigned int intern(const str_ref &s)
+    {
+        return intern(s, hash(s), strings_.size());
+    }
+
+    /**
+        @return all ids, in sorted order of their strings.
+    */
+    std::vector<unsigned int> sorted_ids() const
+    {
+        std::vector<std::pair<str_ref, unsigned int> > S(strings_.size());
+        for (unsigned int i=0; i<S.size(); i++)
+          S[i] = std::make_pair(strings_[i], i);
+        std::sort(S.begin(), S.end());
+
+        std::vector<unsigned int> ids(S.size());
+        for (unsigned int i=0; i<S.size(); i++)
+          ids[i] = S[i].second;
+        return ids;
+    }
+};
+
+
+/**
+    Thread-safe interner: intern() returns a handle, which is mapped to
+    the final id by id() after finalize().
+*/
+class sharded_string_interner
+{
+  public:
+    typedef unsigned int handle;
+    static const unsigned int no_id = 0xFFFFFFFFu;
+
+    /** never returned by intern(), so callers may use it as a marker */
+    static const handle no_handle = 0xFFFFFFFFu;
+
+  private:
+    static const unsigned int shard_bits = 6;
+    static const unsigned int num_shards = 1 << shard_bits;
+
+    // strings per shard, so that a handle fits in 32 bits and is never
+    // no_handle
+    static const unsigned int max_shard_size = (1u << (32 - shard_bits)) - 1;
+
+    std::vector<string_interner *> shards_;
+#ifdef _OPENMP
+    std::vector<omp_lock_t> locks_;
+#endif
+    std::vector<std::vector<unsigned int> > ids_;     // per shard: final ids
+    std::vector<handle> order_;                       // final id -> handle
+
+    sharded_string_interner(const sharded_string_interner &);
+    sharded_string_interner & operator=(const sharded_string_interner &);
+
+    static unsigned int shard_of(handle h) { return h & (num_shards - 1); }
+    static unsigned int local_of(handle h) { return h >> shard_bits; }
+
+    const string_interner &shard(handle h) const
+    {
+        return *shards_[shard_of(h)];
+    }
+
+    struct first_position_less
+    {
+        const sharded_string_interner &I;
+        first_position_less(const sharded_string_interner &i) : I(i) {}
+        bool operator()(handle a, handle b) const
+        {
+            return I.shard(a).first_position(local_of(a)) <
+                   I.shard(b).first_position(local_of(b));
+        }
+    };
+
+    struct string_less
+    {
+        const sharded_string_interner &I;
+        string_less(const sharded_string_interner &i) : I(i) {}
+        bool operator()(handle a, handle b) const
+        {
+            return I.shard(a).str(local_of(a)) < I.shard(b).str(local_of(b));
+        }
+    };
+
+  public:
+
+    sharded_string_interner() : shards_(num_shards),
+#ifdef _OPENMP
+        locks_(num_shards),
+#endif
+        ids_(num_shards), order_()
+    {
+        for (unsigned int s=0; s<num_shards; s++)
+        {
+          shards_[s] = new string_interner;
+#ifdef _OPENMP
+          omp_init_lock(&locks_[s]);
+#endif
+        }
+    }
+
+    ~sharded_string_interner()
+    {
+        for (unsigned int s=0; s<num_shards; s++)
+        {
+          delete shards_[s];
+#ifdef _OPENMP
+          omp_destroy_lock(&locks_[s]);
+#endif
+        }
+    }
+
+    /**
+        Intern s (from any thread).
+
+        @param position  position of this occurrence in the input; ids
+                         in first-seen order follow the smallest position
+                         of each string.
+
+        Throws std::length_error if s would be the 2^26-th string of its
+        shard (so at around 2^32 distinct strings in all).
+    */
+    handle intern(const str_ref &s, uint64_t position)
+    {
+        uint64_t h = hash(s);
+        unsigned int sh = (unsigned int) (h >> (64 - shard_bits));
+#ifdef _OPENMP
+        omp_set_lock(&locks_[sh]);
+#endif
+        unsigned int local = shards_[sh]->intern(s, h, position);
+#ifdef _OPENMP
+        omp_unset_lock(&locks_[sh]);
+#endif
+        if (local >= max_shard_size)
+          throw std::length_error("sharded_string_interner: too many "
+                "distinct strings");
+        return (local << shard_bits) | sh;
+    }
+
+    /**
+        Assign the final ids (0..size()-1), in the given order.  Call
+        after all insertions.
+    */
+    void finalize(intern_order order)
+    {
+        order_.clear();
+        for (unsigned int s=0; s<num_shards; s++)
+          for (unsigned int i=0; i<shards_[s]->size(); i++)
+            order_.push_back((i << shard_bits) | s);
+
+        if (order == intern_sorted)
+          std::sort(order_.begin(), order_.end(), string_less(*this));
+        else
+          std::sort(order_.begin(), order_.end(), first_position_less(*this));
+
+        for (unsigned int s=0; s<num_shards; s++)
+          ids_[s].assign(shards_[s]->size(), (unsigned int) no_id);
+        for (unsigned int i=0; i<order_.size(); i++)
+          ids_[shard_of(order_[i])][local_of(order_[i])] = i;
+    }
+
+    size_t size() const
+    {
+        size_t n = 0;
+        for (unsigned int s=0; s<num_shards; s++)
+          n += shards_[s]->size();
+        return n;
+    }
+
+    /** final id of a handle (after finalize()) */
+    unsigned int id(handle h) const
+    {
+        return ids_[shard_of(h)][local_of(h)];
+    }
+
+    /** string with final id i (after finalize()) */
+    const str_ref &str(unsigned int i) const
+    {
+        return shard(order_[i]).str(local_of(order_[i]));
+    }
+
+    /** number of occurrences of the string with final id i */
+    size_t count(unsigned int i) const
+    {
+        return shard(order_[i]).count(local_of(order_[i]));
+    }
+
+    size_t memory_bytes() const
+    {
+        size_t n = 0;
+        for (unsigned int s=0; s<num_shards; s++)
+          n += shards_[s]->memory_bytes();
+        return n;
+    }
+
+    /**
+        @return all final ids, in sorted order of their strings.
+    */
+    std::vector<unsigned int> sorted_ids() const
+    {
+        std::vector<handle> H(order_);
+        std::sort(H.begin(), H.end(), string_less(*this));
+        std::vector<unsigned int> ids(H.size());
+        for (unsigned int i=0; i<H.size(); i++)
+          ids[i] = id(H[i]);
+        return ids;
+    }
+};
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_STRING_INTERN_H_
@@ -0,0 +1,107 @@
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include "ngraph.hpp"
+#include "ngraph_static.hpp"
+#include "ngraph_concurrent.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//
+// Usage:  a.out < graph.g
+//
+// Inserts the edges of the graph (each twice, in random order) into a
+// concurrent_graph from all threads but one, while the remaining thread
+// keeps reading neighbor lists and checking that each holds only edges
+// of the graph, without repeats.  Then checks to_static() against the
+// graph.  Prints the number of mismatches found.
+//
+
+using namespace NGraph;
+using namespace std;
+
+typedef concurrent_graph<Graph::vertex> cGraph;
+
+static unsigned int check_row(const Graph &A, Graph::vertex v,
+      cGraph::neighbor_range r, bool out)
+{
+    vector<Graph::vertex> row(r.begin, r.end);
+    sort(row.begin(), row.end());
+    unsigned int errors = (adjacent_find(row.begin(), row.end()) != row.end());
+    for (size_t i=0; i<row.size(); i++)
+      if (!(out ? A.includes_edge(v, row[i]) : A.includes_edge(row[i], v)))
+        errors++;
+    return errors;
+}
+
+int  main()
+{
+    Graph A;
+    cin >> A;
+    srand(1);
+
+    vector<Graph::edge> E = A.edge_list();
+    E.insert(E.end(), E.begin(), E.end());
+    random_shuffle(E.begin(), E.end());
+    const unsigned int n = (A.num_vertices() == 0 ? 1 :
+          Graph::node(--A.end()) + 1);
+
+    cGraph C;
+    volatile int done = 0;
+    unsigned int errors = 0;
+    size_t reads = 0;
+
+#ifdef _OPENMP
+    #pragma omp parallel reduction(+:errors)
+#endif
+    {
+#ifdef _OPENMP
+      const int t = omp_get_thread_num();
+      const int p = omp_get_num_threads();
+#else
+      const int t = 0;
+      const int p = 1;
+#endif
+      if (t > 0 || p == 1)
+      {
+        const int writers = (p == 1 ? 1 : p - 1);
+        for (size_t i = (p == 1 ? 0 : t - 1); i < E.size(); i += writers)
+          C.insert_edge(E[i].first, E[i].second);
+#ifdef _OPENMP
+        #pragma omp atomic
+#endif
+        done++;
+      }
+      if (t == 0)
+      {
+        const int writers = (p == 1 ? 1 : p - 1);
+        unsigned int seed = 7;
+        while (done < writers || reads == 0)
+        {
+          const Graph::vertex v = rand_r(&seed) % n;
+          errors += check_row(A, v, C.out_neighbors(v), true);
+          errors += check_row(A, v, C.in_neighbors(v), false);
+          reads++;
+        }
+      }
+    }
+
+    static_Graph S;
+    C.to_static(S);
+    C.reclaim();
+    static_Graph G(A);
+    errors += (S.num_edges() != G.num_edges()) + (C.num_edges() != A.num_edges())
+          + (C.num_vertices() != A.num_vertices());
+    for (Graph::vertex v=0; v<S.num_vertices(); v++)
+      if (S.out_degree(v) != G.out_degree(v) || S.in_degree(v) != G.in_degree(v)
+          || !equal(S.out_neighbors_begin(v), S.out_neighbors_end(v),
+                G.out_neighbors_begin(v))
+          || !equal(S.in_neighbors_begin(v), S.in_neighbors_end(v),
+                G.in_neighbors_begin(v)))
+        errors++;
+
+    printf("%lu reads, %u errors\n", (unsigned long) reads, errors);
+    return 0;
+}
@@ -0,0 +1,213 @@
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <queue>
+#include <limits>
+#include <cmath>
+#include "nwgraph.hpp"
+#include "nwgraph_algorithms.hpp"
+
+//
+// Usage:  a.out < graph.wg
+//
+// Builds an nwGraph from a weighted edge list, checks its out- and
+// in-edges against the summed weights of the list, and checks that it
+// survives a save/load round trip.  Then checks the graphs whose
+// parallel edges are combined by their minimum, or all kept, and that
+// delta_stepping on either agrees with Dijkstra on the list itself
+// (weights must be non-negative).  Also checks delta_stepping against
+// Dijkstra on random graphs, with bucket widths that do not divide the
+// weights evenly.  Prints the number of mismatches found.
+//
+
+using namespace NGraph;
+using namespace std;
+
+typedef map<pair<unsigned int, unsigned int>, double> weight_map;
+
+// Dijkstra on the edge list, every parallel edge taken as it is
+//
+static vector<double> dijkstra(unsigned int n, const vector<unsigned int> &from,
+      const vector<unsigned int> &to, const vector<double> &w,
+      unsigned int source)
+{
+    vector<vector<pair<unsigned int, double> > > adj(n);
+    for (size_t k=0; k<from.size(); k++)
+      adj[from[k]].push_back(make_pair(to[k], w[k]));
+
+    vector<double> dist(n, numeric_limits<double>::infinity());
+    typedef pair<double, unsigned int> entry;
+    priority_queue<entry, vector<entry>, greater<entry> > Q;
+    dist[source] = 0.0;
+    Q.push(entry(0.0, source));
+    while (!Q.empty())
+    {
+      entry e = Q.top();
+      Q.pop();
+      if (e.first > dist[e.second])
+        continue;
+      for (size_t k=0; k<adj[e.second].size(); k++)
+      {
+        double d = e.first + adj[e.second][k].second;
+        if (d < dist[adj[e.second][k].first])
+        {
+          dist[adj[e.second][k].first] = d;
+          Q.push(entry(d, adj[e.second][k].first));
+        }
+      }
+    }
+    return dist;
+}
+
+// equal, up to rounding (sums along different paths of the same length)
+//
+static bool same_distance(double a, double b)
+{
+    return a == b || fabs(a - b) <= 1e-9 * fabs(b);
+}
+
+// the edges of G that differ from W (in weight, or missing), plus one
+// if the numbers of edges differ
+//
+static unsigned int compare(const nwGraph_d &G, const weight_map &W)
+{
+    unsigned int errors = (G.num_edges() != W.size() ? 1 : 0);
+    for (weight_map::const_iterator p = W.begin(); p != W.end(); p++)
+    {
+      double g = 0.0;
+      if (!G.find_edge(p->first.first, p->first.second, g) || g != p->second)
+        errors++;
+    }
+    return errors;
+}
+
+// delta_stepping against Dijkstra on random graphs with real weights,
+// for several bucket widths, from a random source; and on the path
+// 0 -> 1 -> 2 whose first weight lies just under a bucket boundary
+//
+static unsigned int random_sssp(unsigned int trials)
+{
+    const double deltas[] = { 0.0, 0.1, 0.7, 2.3, 10.0, 1000.0 };
+    const unsigned int num_deltas = sizeof(deltas) / sizeof(deltas[0]);
+    unsigned int errors = 0;
+    srand(1);
+
+    for (unsigned int t=0; t<=trials; t++)
+    {
+      vector<nwGraph_d::vertex> from, to;
+      vector<double> w;
+      unsigned int n = 3;
+      if (t == trials)
+      {
+        from.push_back(0); to.push_back(1); w.push_back(80.49999999999999);
+        from.push_back(1); to.push_back(2); w.push_back(1.0);
+      }
+      else
+      {
+        n = 1 + rand() % 100;
+        const unsigned int m = rand() % (5 * n);
+        for (unsigned int k=0; k<m; k++)
+        {
+          from.push_back(rand() % n);
+          to.push_back(rand() % n);
+          w.push_back(100.0 * rand() / RAND_MAX);
+        }
+      }
+      const unsigned int source = (t == trials ? 0 : rand() % n);
+
+      nwGraph_d G(n, from, to, w, min_parallel_edges);
+      vector<double> D = dijkstra(n, from, to, w, source);
+      for (unsigned int d=0; d<num_deltas; d++)
+      {
+        vector<double> dd = delta_stepping(G, source, deltas[d]);
+        for (unsigned int v=0; v<n; v++)
+          if (!same_distance(dd[v], D[v]))
+            errors++;
+      }
+    }
+    return errors;
+}
+
+int  main()
+{
+    mapped_file in("-");
+    nwGraph_d::vertex n = 0;
+    vector<nwGraph_d::vertex> from, to;
+    vector<double> w;
+    string error;
+    if (!parse_weighted_edges(in.data(), in.size(), n, from, to, w, error))
+    {
+      cout << "parse failed: " << error << "\n";
+      return 1;
+    }
+
+    weight_map W, Wmin;
+    for (size_t k=0; k<from.size(); k++)
+    {
+      W[make_pair(from[k], to[k])] += w[k];
+      weight_map::iterator p = Wmin.find(make_pair(from[k], to[k]));
+      if (p == Wmin.end())
+        Wmin[make_pair(from[k], to[k])] = w[k];
+      else if (w[k] < p->second)
+        p->second = w[k];
+    }
+
+    nwGraph_d G(n, from, to, w);
+
+    FILE *f = tmpfile();
+    G.save(f);
+    rewind(f);
+    nwGraph_d L;
+    if (!L.load(f, error))
+    {
+      cout << "load failed: " << error << "\n";
+      return 1;
+    }
+    fclose(f);
+
+    unsigned int errors = 0;
+    if (G.num_edges() != W.size() || L.num_edges() != W.size())
+      errors++;
+
+    for (weight_map::const_iterator p = W.begin(); p != W.end(); p++)
+    {
+      double g = 0.0, l = 0.0;
+      if (!G.find_edge(p->first.first, p->first.second, g) || g != p->second ||
+          !L.find_edge(p->first.first, p->first.second, l) || l != p->second)
+        errors++;
+    }
+
+    // in-edges carry the same weights
+    for (unsigned int v=0; v<n; v++)
+    {
+      nwGraph_d::const_weight_iterator q = L.in_weights_begin(v);
+      for (nwGraph_d::const_iterator u = L.in_neighbors_begin(v);
+              u != L.in_neighbors_end(v); u++, q++)
+        if (W[make_pair(*u, v)] != *q)
+          errors++;
+    }
+
+    // parallel edges by their minimum, or all kept
+    nwGraph_d M(n, from, to, w, min_parallel_edges);
+    nwGraph_d K(n, from, to, w, keep_parallel_edges);
+    errors += compare(M, Wmin);
+    if (K.num_edges() != from.size())
+      errors++;
+
+    // shortest paths count each pair at its shortest edge
+    if (n > 0)
+    {
+      vector<double> D = dijkstra(n, from, to, w, 0);
+      vector<double> dm = delta_stepping(M, 0u);
+      vector<double> dk = delta_stepping(K, 0u);
+      for (unsigned int v=0; v<n; v++)
+        if (!same_distance(dm[v], D[v]) || !same_distance(dk[v], D[v]))
+          errors++;
+    }
+
+    errors += random_sssp(200);
+
+    cout << n << " vertices, " << W.size() << " edges: " << errors
+         << " mismatches\n";
+    return errors == 0 ? 0 : 1;
+}
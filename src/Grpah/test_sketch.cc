@@ -0,0 +1,112 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <map>
+#include "sketch.hpp"
+
+//
+// Usage:  a.out [k [epsilon]] < numbers
+//
+// Counts the top k integers of the input with heavy_hitters (default
+// k 10, epsilon 1e-4) over the whole input, and over the input split
+// into 2..8 parts (in blocks, and dealt out in turn) whose sketches are
+// merged, and over two halves merged after a save/load round trip.
+// Checks that all of them report the same items and counts (those
+// counted more than 2 * epsilon * n times, that is, which are sure to
+// be kept as candidates), and that the counts are within the sketch's
+// bound of the exact ones.  Prints the number of mismatches found.
+//
+
+using namespace NGraph;
+using namespace std;
+
+typedef heavy_hitters<long> hh;
+
+static void count(hh &H, const vector<long> &X, size_t begin, size_t end,
+      size_t step)
+{
+    for (size_t i=begin; i<end; i+=step)
+      H.add(hash_uint((uint64_t) X[i]), X[i]);
+}
+
+// the items of A and B over the given count that differ
+//
+static unsigned int compare(const vector<hh::item> &A,
+      const vector<hh::item> &B, uint64_t over)
+{
+    unsigned int errors = 0;
+    for (size_t i=0; i<A.size() || i<B.size(); i++)
+    {
+      const bool a = (i < A.size() && A[i].second > over);
+      const bool b = (i < B.size() && B[i].second > over);
+      if (a != b || (a && A[i] != B[i]))
+        errors++;
+    }
+    return errors;
+}
+
+int  main(int argc, char *argv[])
+{
+    const size_t k = (argc > 1 ? atol(argv[1]) : 10);
+    const double epsilon = (argc > 2 ? atof(argv[2]) : 1e-4);
+
+    vector<long> X;
+    map<long, uint64_t> exact;
+    long x;
+    while (cin >> x)
+    {
+      X.push_back(x);
+      exact[x]++;
+    }
+    const size_t n = X.size();
+
+    hh H(k, epsilon);
+    count(H, X, 0, n, 1);
+    const vector<hh::item> T = H.top();
+
+    unsigned int errors = (T.size() != k && T.size() != exact.size());
+    const uint64_t bound = (uint64_t) (H.sketch().epsilon() * n);
+    for (size_t i=0; i<T.size(); i++)
+      if (T[i].second < exact[T[i].first] ||
+            T[i].second > exact[T[i].first] + bound)
+        errors++;
+
+    // as if counted by p threads, in blocks or interleaved
+    for (size_t p=2; p<=8; p++)
+    {
+      hh B(k, epsilon), I(k, epsilon);
+      for (size_t t=0; t<p; t++)
+      {
+        hh Bt(k, epsilon), It(k, epsilon);
+        count(Bt, X, n * t / p, n * (t+1) / p, 1);
+        count(It, X, t, n, p);
+        B.merge(Bt);
+        I.merge(It);
+      }
+      errors += compare(T, B.top(), 2 * bound) +
+            compare(T, I.top(), 2 * bound);
+    }
+
+    // two halves, saved and merged
+    hh A(k, epsilon), B(k, epsilon);
+    count(A, X, 0, n / 2, 1);
+    count(B, X, n / 2, n, 1);
+    FILE *f = tmpfile();
+    A.save(f);
+    B.save(f);
+    rewind(f);
+    hh L, M;
+    string error;
+    if (!L.load(f, error) || !M.load(f, error) || !L.merge(M))
+    {
+      cout << "load failed: " << error << "\n";
+      return 1;
+    }
+    fclose(f);
+    errors += compare(T, L.top(), 2 * bound);
+
+    cout << n << " items, top " << T.size() << ": " << errors
+         << " mismatches\n";
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+#include <cstdio>
+#include "ngraph.hpp"
+#include "ngraph_static.hpp"
+
+//
+// Usage:  a.out < graph.g
+//
+// Compacts the graph into a static_Graph, checks it against the tGraph,
+// and checks that it survives a save/load round trip.  Prints the
+// number of mismatches found.
+//
+
+using namespace NGraph;
+using namespace std;
+
+int  main()
+{
+    Graph A;
+    cin >> A;
+
+    static_Graph S(A);
+
+    FILE *f = tmpfile();
+    S.save(f);
+    rewind(f);
+    static_Graph L;
+    string error;
+    if (!L.load(f, error))
+    {
+      cout << "load failed: " << error << "\n";
+      return 1;
+    }
+    fclose(f);
+
+    unsigned int errors = 0;
+    if (S.num_edges() != A.num_edges() || L.num_edges() != A.num_edges())
+      errors++;
+
+    for (Graph::const_iterator p = A.begin(); p != A.end(); p++)
+    {
+      Graph::vertex v = Graph::node(p);
+      const Graph::vertex_set &out = Graph::out_neighbors(p);
+      const Graph::vertex_set &in = Graph::in_neighbors(p);
+
+      if (!equal(out.begin(), out.end(), S.out_neighbors_begin(v)) ||
+          S.out_degree(v) != out.size() || L.out_degree(v) != out.size() ||
+          !equal(in.begin(), in.end(), L.in_neighbors_begin(v)) ||
+          S.in_degree(v) != in.size())
+        errors++;
+
+      for (Graph::vertex_set::const_iterator q = out.begin();
+              q != out.end(); q++)
+        if (!L.includes_edge(v, *q))
+          errors++;
+    }
+
+    cout << A.num_vertices() << " vertices, " << A.num_edges()
+         << " edges: " << errors << " mismatches\n";
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+#include <cstdio>
+#include <cstdlib>
+#include "ngraph.hpp"
+#include "ngraph_static.hpp"
+
+//
+// Usage:  a.out < graph.g
+//
+// Applies a random batch of edge deletions and insertions to the graph
+// with tGraph::update() and static_tGraph::update(), and a random set of
+// vertex removals with tGraph::remove_vertices(), and checks them
+// against the same changes made one edge (or vertex) at a time.  Prints
+// the number of mismatches found.
+//
+
+using namespace NGraph;
+using namespace std;
+
+static unsigned int compare(const Graph &A, const static_Graph &S)
+{
+    unsigned int errors = (S.num_edges() != A.num_edges());
+    for (Graph::const_iterator p = A.begin(); p != A.end(); p++)
+    {
+      const Graph::vertex_set &out = Graph::out_neighbors(p);
+      const Graph::vertex_set &in = Graph::in_neighbors(p);
+      Graph::vertex v = Graph::node(p);
+      if (out.size() != S.out_degree(v) || in.size() != S.in_degree(v) ||
+          !equal(out.begin(), out.end(), S.out_neighbors_begin(v)) ||
+          !equal(in.begin(), in.end(), S.in_neighbors_begin(v)))
+        errors++;
+    }
+    return errors;
+}
+
+int  main()
+{
+    Graph A;
+    cin >> A;
+    srand(1);
+
+    vector<Graph::edge> E = A.edge_list(), ins, del;
+    const unsigned int n = (A.num_vertices() == 0 ? 1 :
+          Graph::node(--A.end()) + 1);
+    for (size_t i=0; i<E.size() / 10; i++)
+    {
+      del.push_back(E[rand() % E.size()]);
+      del.push_back(Graph::edge(rand() % n, rand() % n));
+      ins.push_back(E[rand() % E.size()]);
+      ins.push_back(Graph::edge(rand() % (n + 10), rand() % (n + 10)));
+    }
+    sort(ins.begin(), ins.end());
+    ins.erase(unique(ins.begin(), ins.end()), ins.end());
+    sort(del.begin(), del.end());
+    del.erase(unique(del.begin(), del.end()), del.end());
+
+    // one at a time
+    Graph R(A);
+    unsigned int removed = 0, inserted = 0;
+    for (size_t i=0; i<del.size(); i++)
+      if (R.includes_edge(del[i]))
+      {
+        R.remove_edge(del[i]);
+        removed++;
+      }
+    for (size_t i=0; i<ins.size(); i++)
+      if (!R.includes_edge(ins[i]))
+      {
+        R.insert_edge(ins[i]);
+        inserted++;
+      }
+
+    unsigned int errors = 0;
+
+    Graph B(A);
+    update_counts C = B.update(ins, del);
+    if (C.edges_removed != removed || C.edges_inserted != inserted ||
+          B.num_vertices() != R.num_vertices())
+      errors++;
+    errors += compare(B, static_Graph(R));
+
+    static_Graph S(A);
+    C = S.update(ins, del);
+    if (C.edges_removed != removed || C.edges_inserted != inserted)
+      errors++;
+    errors += compare(R, S);
+
+    // vertex removal
+    Graph::vertex_set V;
+    for (size_t i=0; i<n / 10; i++)
+      V.insert(rand() % n);
+    Graph Q(R);
+    for (Graph::vertex_set::const_iterator v = V.begin(); v != V.end(); v++)
+      Q.remove_vertex(*v);
+    C = R.remove_vertices(V);
+    if (R.num_vertices() != Q.num_vertices() ||
+          R.num_vertices() + C.vertices_removed != B.num_vertices())
+      errors++;
+    errors += compare(R, static_Graph(Q));
+
+    cout << errors << "\n";
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <sstream>
+#include "ngraph.hpp"
+
+//
+// Usage:  a.out < graph.g
+//
+// Writes the graph with operator<<, and copies of it on negative int
+// vertices (iGraph) and on string vertices (sGraph), and checks each
+// against a line-by-line write through iostreams, and that each reads
+// back as the same graph.  Prints the number of mismatches found.
+//
+
+using namespace NGraph;
+using namespace std;
+
+// G as a .g edge list, one vertex or edge per line
+//
+template <class G>
+static string expected(const G &A)
+{
+    ostringstream s;
+    for (typename G::const_iterator p = A.begin(); p != A.end(); p++)
+    {
+      const typename G::vertex_set &out = G::out_neighbors(p);
+      if (out.empty() && G::in_neighbors(p).empty())
+        s << G::node(p) << "\n";
+      for (typename G::vertex_set::const_iterator q = out.begin();
+              q != out.end(); q++)
+        s << G::node(p) << " " << *q << "\n";
+    }
+    return s.str();
+}
+
+// mismatches between A written, and its expected text, and A read back
+//
+template <class G>
+static unsigned int check(const G &A)
+{
+    ostringstream s;
+    s << A;
+    unsigned int errors = (s.str() != expected(A));
+
+    istringstream in(s.str());
+    G B;
+    in >> B;
+    if (B.num_vertices() != A.num_vertices() ||
+        B.num_edges() != A.num_edges() || expected(B) != expected(A))
+      errors++;
+    return errors;
+}
+
+static string name(Graph::vertex v)
+{
+    ostringstream s;
+    s << "v" << v;
+    return s.str();
+}
+
+int  main()
+{
+    Graph A;
+    cin >> A;
+
+    iGraph I;
+    sGraph S;
+    for (Graph::const_iterator p = A.begin(); p != A.end(); p++)
+    {
+      const Graph::vertex v = Graph::node(p);
+      I.insert_vertex(1000 - (int) v);
+      S.insert_vertex(name(v));
+      const Graph::vertex_set &out = Graph::out_neighbors(p);
+      for (Graph::vertex_set::const_iterator q = out.begin();
+              q != out.end(); q++)
+      {
+        I.insert_edge(1000 - (int) v, 1000 - (int) *q);
+        S.insert_edge(name(v), name(*q));
+      }
+    }
+
+    unsigned int errors = check(A) + check(I) + check(S);
+
+    cout << A.num_vertices() << " vertices, " << A.num_edges()
+         << " edges: " << errors << " mismatches\n";
+    return errors == 0 ? 0 : 1;
+}
@@ -22,6 +22,8 @@
 
 // for clock() and CLOCKS_PER_SEC
 #include <time.h>
+// for gettimeofday()
+#include <sys/time.h>
 
 
 namespace TNT
@@ -33,6 +35,16 @@ inline static double seconds(void)
     return ( (double) clock() ) * secs_per_tick;
 }
 
+// elapsed (wall-clock) seconds; use this rather than seconds() when
+// timing multithreaded code or I/O, where CPU time is misleading.
+//
+inline static double wall_seconds(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return (double) tv.tv_sec + 1.0e-6 * (double) tv.tv_usec;
+}
+
 
 
 class Stopwatch {
@@ -40,9 +52,10 @@ class Stopwatch {
         int running_;
         double start_time_;
         double total_;
+        double (*clock_)(void);
 
     public:
-        inline Stopwatch();
+        inline Stopwatch(double (*clock)(void) = seconds);
         inline void start();
         inline double stop();
 		inline double read();
@@ -50,20 +63,21 @@ class Stopwatch {
 		inline int running();
 };
 
-inline Stopwatch::Stopwatch() : running_(0), start_time_(0.0), total_(0.0) {}
+inline Stopwatch::Stopwatch(double (*clock)(void)) : running_(0), 
+        start_time_(0.0), total_(0.0), clock_(clock) {}
 
 void Stopwatch::start() 
 {
 	running_ = 1;
 	total_ = 0.0;
-	start_time_ = seconds();
+	start_time_ = clock_();
 }
 
 double Stopwatch::stop()  
 {
 	if (running_) 
 	{
-         total_ += (seconds() - start_time_); 
+         total_ += (clock_() - start_time_); 
          running_ = 0;
     }
     return total_; 
@@ -73,7 +87,7 @@ inline void Stopwatch::resume()
 {
 	if (!running_)
 	{
-		start_time_ = seconds();
+		start_time_ = clock_();
 		running_ = 1;
 	}
 }
@@ -1,6 +1,17 @@
+#ifndef NGRAPH_TOKEN_H_
+#define NGRAPH_TOKEN_H_
+
 
 
 #include <string>
+#include <vector>
+#include "str_ref.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 using namespace std;
 
@@ -101,3 +112,236 @@ void  Tokenize(const string &S,
 
 };
 
+
+/*
+   Zero-copy tokenizing.
+
+   Tokenize() and Tokenizer above copy every token into a new string.
+   The classes below instead return str_refs into the caller's buffer
+   (typically a whole file, see mapped_file.hpp), so tokenizing
+   allocates nothing:
+
+        str_tokenizer T(line, " \t:,");
+        str_ref word;
+        while (T.next(word))
+            ...
+
+        line_scanner L(in.data(), in.size());
+        str_ref line;
+        while (L.next(line))
+            ...
+
+   Delimiter scanning compares 16 (SSE2) or 32 (AVX2, if the compiler
+   targets it, e.g. with -march=native) bytes at a time against each
+   delimiter, for sets of up to max_simd delimiters; larger sets use a
+   lookup table a byte at a time.
+*/
+
+namespace NGraph
+{
+
+class delimiter_set
+{
+  public:
+    static const unsigned int max_simd = 8;
+
+  private:
+    bool is_delim_[256];
+    char chars_[max_simd];
+    unsigned int num_chars_;
+    bool simd_;
+
+#if defined(__AVX2__) || defined(__SSE2__)
+    // block primitives; bit i of mask() is set if byte i compared equal
+    //
+#if defined(__AVX2__)
+    typedef __m256i block;
+    static const int block_size = 32;
+    static block load(const char *p)
+        { return _mm256_loadu_si256((const __m256i *) p); }
+    static block splat(char c) { return _mm256_set1_epi8(c); }
+    static block eq(block a, block b) { return _mm256_cmpeq_epi8(a, b); }
+    static block either(block a, block b) { return _mm256_or_si256(a, b); }
+    static unsigned int mask(block a)
+        { return (unsigned int) _mm256_movemask_epi8(a); }
+    static unsigned int all_bits() { return 0xFFFFFFFFu; }
+#else
+    typedef __m128i block;
+    static const int block_size = 16;
+    static block load(const char *p)
+        { return _mm_loadu_si128((const __m128i *) p); }
+    static block splat(char c) { return _mm_set1_epi8(c); }
+    static block eq(block a, block b) { return _mm_cmpeq_epi8(a, b); }
+    static block either(block a, block b) { return _mm_or_si128(a, b); }
+    static unsigned int mask(block a)
+        { return (unsigned int) _mm_movemask_epi8(a); }
+    static unsigned int all_bits() { return 0xFFFFu; }
+#endif
+
+    // first position in [p, end) whose delimiter status is want, scanning
+    // whole blocks; returns where the (shorter) tail starts if none
+    //
+    const char *scan_blocks(const char *p, const char *end, bool want) const
+    {
+        block d[max_simd];
+        for (unsigned int k=0; k<num_chars_; k++)
+          d[k] = splat(chars_[k]);
+
+        while (end - p >= block_size)
+        {
+          block v = load(p);
+          block m = eq(v, d[0]);
+          for (unsigned int k=1; k<num_chars_; k++)
+            m = either(m, eq(v, d[k]));
+          unsigned int bits = mask(m);
+          if (!want)
+            bits = ~bits & all_bits();
+          if (bits != 0)
+            return p + __builtin_ctz(bits);
+          p += block_size;
+        }
+        return p;
+    }
+#endif
+
+    const char *scan(const char *p, const char *end, bool want) const
+    {
+#if defined(__AVX2__) || defined(__SSE2__)
+        if (simd_)
+        {
+          p = scan_blocks(p, end, want);
+          if (p < end && is_delim_[(unsigned char) *p] == want)
+            return p;
+        }
+#endif
+        while (p < end && is_delim_[(unsigned char) *p] != want)
+          p++;
+        return p;
+    }
+
+  public:
+
+    delimiter_set(const char *delimiters = " \t\n") : num_chars_(0),
+        simd_(false)
+    {
+        for (unsigned int c=0; c<256; c++)
+          is_delim_[c] = false;
+        for (const char *p = delimiters; *p; p++)
+        {
+          if (is_delim_[(unsigned char) *p])
+            continue;
+          is_delim_[(unsigned char) *p] = true;
+          if (num_chars_ < max_simd)
+            chars_[num_chars_] = *p;
+          num_chars_++;
+        }
+        simd_ = (num_chars_ > 0 && num_chars_ <= max_simd);
+    }
+
+    bool contains(char c) const { return is_delim_[(unsigned char) c]; }
+
+    /** first delimiter in [p, end), or end */
+    const char *find(const char *p, const char *end) const
+    {
+        return scan(p, end, true);
+    }
+
+    /** first non-delimiter in [p, end), or end */
+    const char *skip(const char *p, const char *end) const
+    {
+        return scan(p, end, false);
+    }
+};
+
+
+/**
+    Lazily splits a buffer into tokens separated by runs of delimiters
+    (as Tokenizer does), without copying.
+*/
+class str_tokenizer
+{
+  private:
+    delimiter_set delimiters_;
+    const char *p_;
+    const char *end_;
+
+  public:
+    str_tokenizer(const str_ref &s, const char *delimiters = " \t\n") :
+        delimiters_(delimiters), p_(s.begin()), end_(s.end()) {}
+
+    str_tokenizer(const str_ref &s, const delimiter_set &delimiters) :
+        delimiters_(delimiters), p_(s.begin()), end_(s.end()) {}
+
+    /** restart on a new buffer, keeping the delimiters */
+    void reset(const str_ref &s)
+    {
+        p_ = s.begin();
+        end_ = s.end();
+    }
+
+    /** @return false if there are no more tokens */
+    bool next(str_ref &token)
+    {
+        const char *b = delimiters_.skip(p_, end_);
+        if (b == end_)
+        {
+          p_ = end_;
+          return false;
+        }
+        p_ = delimiters_.find(b, end_);
+        token = str_ref(b, p_ - b);
+        return true;
+    }
+
+    /** the unscanned remainder of the buffer */
+    str_ref rest() const { return str_ref(p_, end_ - p_); }
+};
+
+
+/**
+    Iterates over the lines of a buffer (without their '\n', but with
+    any '\r').  A last line without a newline is returned too.
+*/
+class line_scanner
+{
+  private:
+    delimiter_set newline_;
+    const char *p_;
+    const char *end_;
+
+  public:
+    line_scanner(const char *data, size_t size) : newline_("\n"), p_(data),
+        end_(data + size) {}
+
+    bool next(str_ref &line)
+    {
+        if (p_ >= end_)
+          return false;
+        const char *e = newline_.find(p_, end_);
+        line = str_ref(p_, e - p_);
+        p_ = (e < end_ ? e + 1 : e);
+        return true;
+    }
+
+    /** position of the next line */
+    const char *position() const { return p_; }
+};
+
+
+/**
+    Zero-copy version of Tokenize(): appends str_refs into S to tokens.
+*/
+inline void Tokenize(const str_ref &S, std::vector<str_ref> &tokens,
+      const delimiter_set &delimiters)
+{
+    str_tokenizer T(S, delimiters);
+    str_ref token;
+    while (T.next(token))
+      tokens.push_back(token);
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_TOKEN_H_
@@ -0,0 +1,605 @@
+#ifndef NGRAPH_VERTEX_MAP_H_
+#define NGRAPH_VERTEX_MAP_H_
+
+/*
+   Vertex renumbering: the map files (.imap, .imap0, ...) that pipelines
+   such as g2mi.csh use to move between original vertex numbers and
+   0-based ones, and the tools that apply them (renumber, vmap, vimap,
+   mi0_2mi, g2g0, create_imap).
+
+   A vertex_map is a set of (from, to) pairs, held as two arrays sorted
+   by from.  Lookups binary-search the arrays, or, when the from values
+   are compact enough (at most a few times as large as the number of
+   pairs), index a dense table built alongside them.  inverse() gives
+   the map from to back to from.
+
+   Map files are text, one "from to" pair per line, or a binary file
+   written by save():
+
+        char     magic[8]       "NGVMAP1"
+        uint64_t size
+        unsigned from[size]     (sorted)
+        unsigned to[size]
+
+   read() accepts either.  If a text file lists a vertex more than once,
+   the last pair wins.
+
+   remap_lines() rewrites a text file (a .g, .v, .mi, ...) token by token
+   through a mapper, in parallel over chunks of lines, keeping the line
+   structure; lines starting with '%' or '#' are copied as is.  What
+   happens to tokens the mapper does not know is explicit:
+
+        unmapped_error      stop and report the first one
+        unmapped_keep       copy the token unchanged
+        unmapped_drop       drop the whole line (e.g. the edge)
+        unmapped_default    write the mapper's default (0, or an empty
+                            label), as the old map-based tools did
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include "str_ref.hpp"
+#include "mapped_file.hpp"
+#include "mtx_io.hpp"
+#include "edge_sort.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace NGraph
+{
+
+class vertex_map
+{
+  public:
+    typedef unsigned int vertex;
+    static const vertex no_vertex = 0xFFFFFFFFu;
+
+  private:
+    std::vector<vertex> from_;
+    std::vector<vertex> to_;
+    std::vector<vertex> dense_;     // dense_[from] = to, if in use
+
+    // from values below this bound get a dense table
+    //
+    static size_t dense_limit(size_t n) { return 4 * n + 1024; }
+
+    void build_dense()
+    {
+        dense_.clear();
+        if (from_.empty() || from_.back() >= dense_limit(from_.size()))
+          return;
+        dense_.assign((size_t) from_.back() + 1, (vertex) no_vertex);
+        for (size_t i=0; i<from_.size(); i++)
+          dense_[from_[i]] = to_[i];
+    }
+
+  public:
+
+    vertex_map() : from_(), to_(), dense_() {}
+
+    /**
+        Build from parallel arrays of pairs, in any order; for repeated
+        from values, the last pair wins.
+    */
+    void assign(const std::vector<vertex> &from, const std::vector<vertex> &to)
+    {
+        // sort (from, position) keys, so that the order among equal from
+        // values is the input order
+        //
+        const size_t n = from.size();
+        std::vector<uint64_t> keys(n), tmp(n);
+        for (size_t i=0; i<n; i++)
+          keys[i] = ((uint64_t) from[i] << 32) | i;
+        if (n > 0)
+          radix_sort(&keys[0], &tmp[0], n);
+
+        from_.clear();
+        to_.clear();
+        for (size_t i=0; i<n; i++)
+        {
+          vertex f = (vertex) (keys[i] >> 32);
+          vertex t = to[keys[i] & 0xFFFFFFFFUL];
+          if (!from_.empty() && from_.back() == f)
+            to_.back() = t;
+          else
+          {
+            from_.push_back(f);
+            to_.push_back(t);
+          }
+        }
+        build_dense();
+    }
+
+    /**
+        Number the sorted, distinct vertices V as base, base+1, ...
+    */
+    void compact(const std::vector<vertex> &V, vertex base = 0)
+    {
+        from_ = V;
+        to_.resize(V.size());
+        for (size_t i=0; i<V.size(); i++)
+          to_[i] = base + (vertex) i;
+        build_dense();
+    }
+
+    size_t size() const { return from_.size(); }
+    bool empty() const { return from_.empty(); }
+
+    vertex from(size_t i) const { return from_[i]; }
+    vertex to(size_t i) const { return to_[i]; }
+
+    /** true if lookups use a dense table */
+    bool is_dense() const { return !dense_.empty(); }
+
+    /** @return the image of v, or no_vertex if v is not mapped */
+    vertex find(vertex v) const
+    {
+        if (!dense_.empty())
+          return (v < dense_.size() ? dense_[v] : no_vertex);
+        std::vector<vertex>::const_iterator p =
+              std::lower_bound(from_.begin(), from_.end(), v);
+        if (p == from_.end() || *p != v)
+          return no_vertex;
+        return to_[p - from_.begin()];
+    }
+
+    /**
+        The map from to back to from.  If several vertices map to the
+        same one, the inverse keeps the largest of them.
+    */
+    vertex_map inverse() const
+    {
+        vertex_map I;
+        I.assign(to_, from_);
+        return I;
+    }
+
+    /**
+        Parse "from to" text pairs from data[0..size), in parallel.
+    */
+    bool parse(const char *data, size_t size, std::string &error)
+    {
+#ifdef _OPENMP
+        const unsigned int num_chunks = omp_get_max_threads();
+#else
+        const unsigned int num_chunks = 1;
+#endif
+        std::vector<const char *> bounds = line_chunks(data, size, num_chunks);
+        std::vector<std::vector<vertex> > F(num_chunks), T(num_chunks);
+        std::vector<const char *> bad(num_chunks, (const char *) 0);
+
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static, 1)
+#endif
+        for (int c=0; c<(int) num_chunks; c++)
+        {
+          const char *p = bounds[c];
+          const char *end = bounds[c+1];
+          while (p < end)
+          {
+            const char *line = p;
+            mtx_skip_blanks(p, end);
+            if (p == end || *p == '\n' || *p == '%' || *p == '#')
+            {
+              mtx_skip_line(p, end);
+              continue;
+            }
+            uint64_t f, t;
+            if (!mtx_parse_uint(p, end, f) || !mtx_parse_uint(p, end, t) ||
+                f >= no_vertex || t >= no_vertex)
+            {
+              bad[c] = line;
+              break;
+            }
+            F[c].push_back((vertex) f);
+            T[c].push_back((vertex) t);
+            mtx_skip_line(p, end);
+          }
+        }
+
+        for (unsigned int c=0; c<num_chunks; c++)
+          if (bad[c] != 0)
+          {
+            size_t line = 1 + std::count(data, bad[c], '\n');
+            char buf[32];
+            sprintf(buf, "%lu", (unsigned long) line);
+            error = std::string("map line ") + buf + " is not a vertex pair";
+            return false;
+          }
+
+        std::vector<vertex> from, to;
+        for (unsigned int c=0; c<num_chunks; c++)
+        {
+          from.insert(from.end(), F[c].begin(), F[c].end());
+          to.insert(to.end(), T[c].begin(), T[c].end());
+          std::vector<vertex>().swap(F[c]);
+          std::vector<vertex>().swap(T[c]);
+        }
+        assign(from, to);
+        return true;
+    }
+
+    bool save(FILE *f) const
+    {
+        char magic[8] = "NGVMAP1";
+        uint64_t n = from_.size();
+        if (fwrite(magic, sizeof(magic), 1, f) != 1 ||
+            fwrite(&n, sizeof(n), 1, f) != 1)
+          return false;
+        if (n > 0 && (fwrite(&from_[0], sizeof(vertex), n, f) != n ||
+                      fwrite(&to_[0], sizeof(vertex), n, f) != n))
+          return false;
+        return fflush(f) == 0;
+    }
+
+    void write_text(FILE *f) const
+    {
+        char buf[64];
+        for (size_t i=0; i<from_.size(); i++)
+        {
+          char *p = format_uint(buf, from_[i]);
+          *p++ = ' ';
+          p = format_uint(p, to_[i]);
+          *p++ = '\n';
+          fwrite(buf, 1, p - buf, f);
+        }
+    }
+
+    /**
+        Read a text or binary map file ("-" for stdin).
+    */
+    bool read(const char *filename, std::string &error)
+    {
+        mapped_file in(filename);
+        if (!in.good())
+        {
+          error = in.error();
+          return false;
+        }
+
+        const size_t header = 8 + sizeof(uint64_t);
+        if (in.size() >= header && memcmp(in.data(), "NGVMAP1", 8) == 0)
+        {
+          uint64_t n;
+          memcpy(&n, in.data() + 8, sizeof(n));
+          if (in.size() != header + 2 * n * sizeof(vertex))
+          {
+            error = std::string("[") + filename + "] is truncated";
+            return false;
+          }
+          const char *p = in.data() + header;
+          from_.resize(n);
+          to_.resize(n);
+          if (n > 0)
+          {
+            memcpy(&from_[0], p, n * sizeof(vertex));
+            memcpy(&to_[0], p + n * sizeof(vertex), n * sizeof(vertex));
+          }
+          build_dense();
+          return true;
+        }
+
+        if (!parse(in.data(), in.size(), error))
+        {
+          error = std::string("[") + filename + "] " + error;
+          return false;
+        }
+        return true;
+    }
+};
+
+
+// ---------------------------------------------------------------------
+//  remapping text files
+// ---------------------------------------------------------------------
+
+enum unmapped_policy
+{
+    unmapped_error,
+    unmapped_keep,
+    unmapped_drop,
+    unmapped_default
+};
+
+struct remap_options
+{
+    unmapped_policy unmapped;
+    int column;                 // only remap this column (0-based); -1: all
+
+    remap_options() : unmapped(unmapped_error), column(-1) {}
+};
+
+
+/**
+    Parse the command-line flags selecting an unmapped_policy (-k, -d,
+    -z), removing them from argv.
+*/
+inline void parse_unmapped_option(int &argc, char *argv[], remap_options &opt)
+{
+    int j = 1;
+    for (int i=1; i<argc; i++)
+    {
+      std::string a(argv[i]);
+      if (a == "-k")
+        opt.unmapped = unmapped_keep;
+      else if (a == "-d")
+        opt.unmapped = unmapped_drop;
+      else if (a == "-z")
+        opt.unmapped = unmapped_default;
+      else
+        argv[j++] = argv[i];
+    }
+    argc = j;
+}
+
+
+/**
+    Mapper for remap_lines(): vertex numbers through a vertex_map.
+*/
+class vertex_mapper
+{
+  private:
+    const vertex_map &M_;
+
+  public:
+    vertex_mapper(const vertex_map &M) : M_(M) {}
+
+    bool map(const str_ref &token, std::string &out) const
+    {
+        const char *p = token.begin();
+        uint64_t v;
+        if (!mtx_parse_uint(p, token.end(), v) || p != token.end() ||
+            v >= vertex_map::no_vertex)
+          return false;
+        vertex_map::vertex w = M_.find((vertex_map::vertex) v);
+        if (w == vertex_map::no_vertex)
+          return false;
+        char buf[24];
+        out.append(buf, format_uint(buf, w) - buf);
+        return true;
+    }
+
+    void map_default(std::string &out) const { out += '0'; }
+};
+
+
+/**
+    Rewrite the lines of data[0..size) to out, replacing each token
+    (separated by blanks) with its image under mapper, which provides
+
+        bool map(const str_ref &token, std::string &out) const
+        void map_default(std::string &out) const
+
+    Tokens of a line are separated by single spaces in the output.  Work
+    is split into chunks of lines, processed a round of one chunk per
+    thread at a time, so that the output buffered in memory is bounded.
+
+    @param num_unmapped  (if not null) set to the number of unmapped
+                         tokens met
+    @return false (with error) for unmapped tokens under unmapped_error,
+            or a write error
+*/
+template <class Mapper>
+bool remap_lines(const char *data, size_t size, const Mapper &mapper,
+      const remap_options &opt, FILE *out, std::string &error,
+      size_t *num_unmapped = 0)
+{
+#ifdef _OPENMP
+    const unsigned int num_threads = omp_get_max_threads();
+#else
+    const unsigned int num_threads = 1;
+#endif
+    const size_t chunk_bytes = 16 << 20;
+    unsigned int num_chunks = size / chunk_bytes + 1;
+    if (num_chunks < num_threads)
+      num_chunks = num_threads;
+
+    std::vector<const char *> bounds = line_chunks(data, size, num_chunks);
+    std::vector<std::string> buffer(num_threads);
+    std::vector<const char *> bad(num_threads);
+    std::vector<size_t> unmapped(num_threads);
+    size_t total_unmapped = 0;
+
+    for (unsigned int first = 0; first < num_chunks; first += num_threads)
+    {
+      const unsigned int round = std::min(num_threads, num_chunks - first);
+
+#ifdef _OPENMP
+      #pragma omp parallel for schedule(static, 1)
+#endif
+      for (int t=0; t<(int) round; t++)
+      {
+        std::string &B = buffer[t];
+        B.clear();
+        bad[t] = 0;
+        unmapped[t] = 0;
+
+        const char *p = bounds[first + t];
+        const char *end = bounds[first + t + 1];
+        while (p < end && bad[t] == 0)
+        {
+          const char *eol = (const char *) memchr(p, '\n', end - p);
+          if (eol == 0)
+            eol = end;
+          const char *q = p;
+          mtx_skip_blanks(q, eol);
+          if (q < eol && (*q == '%' || *q == '#'))
+          {
+            B.append(p, eol - p);
+            B += '\n';
+            p = eol + 1;
+            continue;
+          }
+
+          const size_t line_start = B.size();
+          bool drop = false;
+          int column = 0;
+          while (q < eol)
+          {
+            const char *e = q;
+            while (e < eol && !mtx_is_blank(*e))
+              e++;
+            if (column > 0)
+              B += ' ';
+            str_ref token(q, e - q);
+            if (opt.column >= 0 && column != opt.column)
+              B.append(q, e - q);
+            else if (!mapper.map(token, B))
+            {
+              unmapped[t]++;
+              if (opt.unmapped == unmapped_error)
+              {
+                bad[t] = q;
+                break;
+              }
+              else if (opt.unmapped == unmapped_keep)
+                B.append(q, e - q);
+              else if (opt.unmapped == unmapped_default)
+                mapper.map_default(B);
+              else
+                drop = true;
+            }
+            column++;
+            q = e;
+            mtx_skip_blanks(q, eol);
+          }
+
+          if (drop)
+            B.resize(line_start);
+          else
+            B += '\n';
+          p = eol + 1;
+        }
+      }
+
+      for (unsigned int t=0; t<round; t++)
+      {
+        total_unmapped += unmapped[t];
+        if (bad[t] != 0)
+        {
+          const char *e = bad[t];
+          while (e < data + size && !mtx_is_blank(*e) && *e != '\n')
+            e++;
+          size_t line = 1 + std::count(data, bad[t], '\n');
+          char buf[32];
+          sprintf(buf, "%lu", (unsigned long) line);
+          error = "[" + std::string(bad[t], e - bad[t]) + "] on line " +
+                buf + " is not in the map";
+          return false;
+        }
+        if (!buffer[t].empty() &&
+            fwrite(buffer[t].data(), 1, buffer[t].size(), out) !=
+                buffer[t].size())
+        {
+          error = "write failed";
+          return false;
+        }
+      }
+    }
+
+    if (num_unmapped != 0)
+      *num_unmapped = total_unmapped;
+    return true;
+}
+
+
+/**
+    Call visit(v) for each vertex number on the non-comment lines of
+    data[p..end); non-numeric tokens are skipped.
+*/
+template <class Visitor>
+void scan_vertices(const char *p, const char *end, Visitor &visit)
+{
+    while (p < end)
+    {
+      mtx_skip_blanks(p, end);
+      if (p < end && (*p == '%' || *p == '#'))
+      {
+        mtx_skip_line(p, end);
+        continue;
+      }
+      while (p < end && *p != '\n')
+      {
+        uint64_t v;
+        if (mtx_parse_uint(p, end, v))
+        {
+          if (v < vertex_map::no_vertex && (p == end || mtx_is_blank(*p) ||
+                *p == '\n'))
+            visit(v);
+        }
+        while (p < end && !mtx_is_blank(*p) && *p != '\n')
+          p++;
+        mtx_skip_blanks(p, end);
+      }
+      if (p < end)
+        p++;
+    }
+}
+
+
+namespace vertex_map_detail
+{
+
+struct append_key
+{
+    std::vector<uint64_t> &K;
+    append_key(std::vector<uint64_t> &k) : K(k) {}
+    void operator()(uint64_t v) { K.push_back(v); }
+};
+
+}
+// namespace vertex_map_detail
+
+
+/**
+    Collect the distinct vertex numbers on the non-comment lines of
+    data[0..size), in parallel, sorted.  Non-numeric tokens are
+    skipped.
+*/
+inline void collect_vertices(const char *data, size_t size,
+      std::vector<vertex_map::vertex> &V)
+{
+#ifdef _OPENMP
+    const unsigned int num_chunks = omp_get_max_threads();
+#else
+    const unsigned int num_chunks = 1;
+#endif
+    std::vector<const char *> bounds = line_chunks(data, size, num_chunks);
+    std::vector<std::vector<uint64_t> > K(num_chunks);
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1)
+#endif
+    for (int c=0; c<(int) num_chunks; c++)
+    {
+      vertex_map_detail::append_key visit(K[c]);
+      scan_vertices(bounds[c], bounds[c+1], visit);
+    }
+
+    std::vector<uint64_t> keys;
+    for (unsigned int c=0; c<num_chunks; c++)
+    {
+      keys.insert(keys.end(), K[c].begin(), K[c].end());
+      std::vector<uint64_t>().swap(K[c]);
+    }
+    std::vector<uint64_t> tmp(keys.size());
+    if (!keys.empty())
+      radix_sort(&keys[0], &tmp[0], keys.size());
+
+    V.clear();
+    for (size_t i=0; i<keys.size(); i++)
+      if (i == 0 || keys[i] != keys[i-1])
+        V.push_back((vertex_map::vertex) keys[i]);
+}
+
+}
+// namespace NGraph
+
+#endif
+// NGRAPH_VERTEX_MAP_H_
@@ -32,70 +32,111 @@ creates
 Note that this operation is a text-based, that is each column is considered 
 a separate text label. 
 
+Vertices not in the map are an error, unless -k (keep them as is), -d
+(drop their lines) or -z (write 0) is given.
+
 
 */
 
 
-#include <sstream>
-#include <fstream>
 #include <iostream>
 #include <string>
-#include <map>
-#include <set>
+#include <vector>
+#include <cstdio>
+#include "vertex_map.hpp"
+#include "string_intern.hpp"
+#include "token.hpp"
+#include "ngraph_stats.hpp"
 
 using namespace std;
+using namespace NGraph;
+
+/*
+   Labels are interned (string_intern.hpp); the id of a label indexes its
+   node number.
+*/
+class number_mapper
+{
+  private:
+    string_interner labels_;
+    vector<vertex_map::vertex> nodes_;
+
+  public:
+    void read(const mapped_file &f)
+    {
+      line_scanner lines(f.data(), f.size());
+      str_tokenizer T(str_ref(), " \t\r");
+      str_ref line, num, label;
+
+      while (lines.next(line))
+      {
+        T.reset(line);
+        if (!T.next(num))
+          continue;
+        const char *p = num.begin();
+        uint64_t v;
+        if (!mtx_parse_uint(p, num.end(), v) || v >= vertex_map::no_vertex)
+          continue;
+        if (!T.next(label))
+          label = str_ref();
+        unsigned int id = labels_.intern(label);
+        if (id >= nodes_.size())
+          nodes_.resize(id + 1);
+        nodes_[id] = (vertex_map::vertex) v;
+      }
+    }
+
+    bool map(const str_ref &token, string &out) const
+    {
+      unsigned int id = labels_.find(token);
+      if (id == string_interner::no_id)
+        return false;
+      char buf[24];
+      out.append(buf, format_uint(buf, nodes_[id]) - buf);
+      return true;
+    }
+
+    void map_default(string &out) const { out += '0'; }
+};
 
-typedef map<unsigned int, string> node_array_type;
 
 int main(int argc, char *argv[])
 {
+  NGraph::stats::parse_options(argc, argv);
 
-  typedef unsigned int uInt;
+  remap_options opt;
+  parse_unmapped_option(argc, argv, opt);
 
+  if (argc != 2)
+  {
+    cerr << "Usage: cat foo.v | " << argv[0] << " [-k | -d | -z] foo.map\n";
+    return 1;
+  }
 
-  ifstream t_file;
-  t_file.open(argv[1]);
-  if (!t_file) 
+  mapped_file t_file(argv[1]);
+  if (!t_file.good()) 
   {
-    exit(1);
+    cerr << "Error: " << t_file.error() << "\n";
+    return 1;
   }
   
 
   // read entire URL list into memory
   
-  map<string, uInt> M;
-  string line;
-  while ( getline(t_file, line))
+  number_mapper M;
   {
-      uInt node_num;
-      string label;
-      stringstream s(line);
-      s >> node_num ;
-      s >> label;
-      M[label] = node_num;
+    stats::scoped_phase phase("read map");
+    M.read(t_file);
   }
 
-
-  while (getline(cin, line))
+  mapped_file in("-");
+  string error;
+  stats::scoped_phase phase("remap");
+  if (!remap_lines(in.data(), in.size(), M, opt, stdout, error))
   {
-      if (line.length() > 0)
-      {
-        stringstream s(line);
-        string label;
-        while (s >> label)
-        {
-          cout <<  M[label] << " ";
-        }
-        cout << "\n";
-      }
-      else
-      {
-        cout << "\n";
-      }
-
+    cerr << "Error: " << error << "\n";
+    return 1;
   }
 
-
   return 0;
 }
-
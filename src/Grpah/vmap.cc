@@ -32,70 +32,115 @@ creates
 Note that this operation is a text-based, that is each column is considered 
 a separate text label. 
 
+Vertices not in the map are an error, unless -k (keep them as is), -d
+(drop their lines) or -z (write an empty label) is given.
+
 
 */
 
 
-#include <sstream>
-#include <fstream>
 #include <iostream>
 #include <string>
-#include <map>
-#include <set>
+#include <vector>
+#include <cstdio>
+#include "vertex_map.hpp"
+#include "token.hpp"
+#include "ngraph_stats.hpp"
 
 using namespace std;
+using namespace NGraph;
+
+/*
+   Vertex numbers are looked up in a vertex_map from node number to the
+   index of its label; labels refer directly into the mapped .map file.
+*/
+class label_mapper
+{
+  private:
+    vertex_map index_;
+    vector<str_ref> labels_;
+
+  public:
+    void read(const mapped_file &f)
+    {
+      line_scanner lines(f.data(), f.size());
+      str_tokenizer T(str_ref(), " \t\r");
+      str_ref line, num, label;
+      vector<vertex_map::vertex> from, to;
+
+      while (lines.next(line))
+      {
+        T.reset(line);
+        if (!T.next(num))
+          continue;
+        const char *p = num.begin();
+        uint64_t v;
+        if (!mtx_parse_uint(p, num.end(), v) || v >= vertex_map::no_vertex)
+          continue;
+        if (!T.next(label))
+          label = str_ref();
+        from.push_back((vertex_map::vertex) v);
+        to.push_back(labels_.size());
+        labels_.push_back(label);
+      }
+      index_.assign(from, to);
+    }
+
+    bool map(const str_ref &token, string &out) const
+    {
+      const char *p = token.begin();
+      uint64_t v;
+      if (!mtx_parse_uint(p, token.end(), v) || p != token.end() ||
+          v >= vertex_map::no_vertex)
+        return false;
+      vertex_map::vertex i = index_.find((vertex_map::vertex) v);
+      if (i == vertex_map::no_vertex)
+        return false;
+      out.append(labels_[i].data, labels_[i].size);
+      return true;
+    }
+
+    void map_default(string &) const {}
+};
 
-typedef map<unsigned int, string> node_array_type;
 
 int main(int argc, char *argv[])
 {
+  NGraph::stats::parse_options(argc, argv);
 
-  typedef unsigned int uInt;
+  remap_options opt;
+  parse_unmapped_option(argc, argv, opt);
 
+  if (argc != 2)
+  {
+    cerr << "Usage: cat foo.v | " << argv[0] << " [-k | -d | -z] foo.map\n";
+    return 1;
+  }
 
-  ifstream t_file;
-  t_file.open(argv[1]);
-  if (!t_file) 
+  mapped_file t_file(argv[1]);
+  if (!t_file.good()) 
   {
-    exit(1);
+    cerr << "Error: " << t_file.error() << "\n";
+    return 1;
   }
   
 
   // read entire URL list into memory
   
-  map<uInt, string> M;
-  string line;
-  while ( getline(t_file, line))
+  label_mapper M;
   {
-      uInt node_num;
-      string label;
-      stringstream s(line);
-      s >> node_num ;
-      s >> label;
-      M[node_num] = label;
+    stats::scoped_phase phase("read map");
+    M.read(t_file);
   }
 
-
-  while (getline(cin, line))
+  mapped_file in("-");
+  string error;
+  stats::scoped_phase phase("remap");
+  if (!remap_lines(in.data(), in.size(), M, opt, stdout, error))
   {
-      if (line.length() > 0)
-      {
-        stringstream s(line);
-        uInt node_num;
-        while (s>> node_num)
-        {
-          cout <<  M[node_num] << " ";
-        }
-        cout << "\n";
-      }
-      else
-      {
-        cout << "\n";
-      }
-
+    cerr << "Error: " << error << "\n";
+    return 1;
   }
 
-
   return 0;
 }
-
@@ -1,7 +1,11 @@
 #include <iostream>
 #include <string>
-#include <sstream>
-#include <map>
+#include <vector>
+#include <cstdio>
+#include "mapped_file.hpp"
+#include "string_intern.hpp"
+#include "token.hpp"
+#include "ngraph_stats.hpp"
 
 /*
     convert a general text file to integers by replacing each word in 
@@ -38,58 +42,145 @@
  5 was
  6 river
 
+   -s option numbers the words in alphabetical order, rather than in the
+   order in which they were encountered.
+
+ The input is split into chunks which are tokenized and interned in
+ parallel (see string_intern.hpp); the numbering does not depend on the
+ number of threads.
+
 */
 
 using namespace std;
+using namespace NGraph;
+
+typedef unsigned int UInt;
+
+// marks the end of a line in a chunk's token list
+//
+static const UInt end_of_line = sharded_string_interner::no_handle;
+
+
+// buffered output of the index lines
+//
+class index_writer
+{
+  private:
+    vector<char> buffer_;
+    size_t len_;
+
+  public:
+    index_writer() : buffer_(1 << 16), len_(0) {}
+    ~index_writer() { flush(); }
+
+    void put(UInt id)
+    {
+        if (len_ + 16 > buffer_.size())
+          flush();
+        char digits[12];
+        int n = 0;
+        do
+        {
+          digits[n++] = (char) ('0' + id % 10);
+          id /= 10;
+        } while (id != 0);
+        while (n > 0)
+          buffer_[len_++] = digits[--n];
+        buffer_[len_++] = ' ';
+    }
+
+    void newline()
+    {
+        if (len_ + 1 > buffer_.size())
+          flush();
+        buffer_[len_++] = '\n';
+    }
+
+    void flush()
+    {
+        fwrite(&buffer_[0], 1, len_, stdout);
+        len_ = 0;
+    }
+};
+
 
 int main(int argc, char *argv[])
 {
+    NGraph::stats::parse_options(argc, argv);
+
     bool perform_mapping_only = false;
+    intern_order order = intern_first_seen;
 
+    for (int i=1; i<argc; i++)
+    {
+      if ("-t" == string(argv[i]))
+        perform_mapping_only = true;
+      else if ("-s" == string(argv[i]))
+        order = intern_sorted;
+    }
 
-    if (argc > 1)
-      perform_mapping_only = ("-t" == string(argv[1]));
-   
-    typedef unsigned int UInt;
+    mapped_file in("-");
+    if (!in.good())
+    {
+      cerr << "Error: " << in.error() << "\n";
+      return 1;
+    }
 
-    typedef map<string, UInt> word_index;
-    word_index M;
+#ifdef _OPENMP
+    const UInt num_chunks = omp_get_max_threads();
+#else
+    const UInt num_chunks = 1;
+#endif
+    vector<const char *> bounds = line_chunks(in.data(), in.size(), num_chunks);
+
+    sharded_string_interner M;
+    vector<vector<UInt> > tokens(num_chunks);
 
-    std::string line;
-    while (getline(cin, line))
     {
-          string word;
-          stringstream s(line);
-          //while (!s.eof())
-          while (s >> word)
+      stats::scoped_phase phase("intern");
+#ifdef _OPENMP
+      #pragma omp parallel for schedule(static, 1)
+#endif
+      for (int t=0; t<(int) num_chunks; t++)
+      {
+        vector<UInt> &T = tokens[t];
+        line_scanner L(bounds[t], bounds[t+1] - bounds[t]);
+        str_tokenizer words(str_ref(), " \t\v\f\r");
+        str_ref line, word;
+        while (L.next(line))
+        {
+          words.reset(line);
+          while (words.next(word))
           {
-             word_index::iterator word_loc = M.find(word);
-             if (word_loc == M.end())  // word not found
-             {
-                  // new word; assign it a new number
-                  UInt new_index = M.size();
-                  M[word] = new_index;
-             }
-             if (!perform_mapping_only)
-             {
-                 cout << M[word] << " ";
-             }
+            UInt h = M.intern(word, word.data - in.data());
+            if (!perform_mapping_only)
+              T.push_back(h);
           }
           if (!perform_mapping_only)
-          {
-            cout << "\n";
-          }
+            T.push_back(end_of_line);
+        }
+      }
+      M.finalize(order);
     }
 
-   if (perform_mapping_only)
-   {
-     for (word_index::const_iterator p = M.begin(); p!= M.end(); p++)
-     {
-        cout <<  p->second << " " << p->first << "\n";
-     }
-   }
-
+    stats::scoped_phase phase("write");
+    if (perform_mapping_only)
+    {
+      vector<UInt> ids = M.sorted_ids();
+      for (UInt i=0; i<ids.size(); i++)
+        cout << ids[i] << " " << M.str(ids[i]) << "\n";
+      return 0;
+    }
 
-  return 0;
+    index_writer out;
+    for (UInt t=0; t<num_chunks; t++)
+      for (UInt i=0; i<tokens[t].size(); i++)
+      {
+        if (tokens[t][i] == end_of_line)
+          out.newline();
+        else
+          out.put(M.id(tokens[t][i]));
+      }
+
+    return 0;
 }
-